@@ -0,0 +1,185 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../../testing/support/public/simulation.hh"
+#include "../../testing/support/public/tox_network.hh"
+#include "../../toxcore/tox.h"
+#include "../../toxcore/tox_private.h"
+
+namespace {
+
+using tox::test::connect_friends;
+using tox::test::NetworkUniverse;
+using tox::test::SimulatedNode;
+using tox::test::Simulation;
+
+struct LinkProfile {
+    uint64_t latency_ms;
+    NetworkUniverse::LinkConditions link;
+};
+
+// 1 MB/s with a BDP sized queue.
+constexpr LinkProfile kCleanLink{20, {0, 0.0, 1024 * 1024, 64 * 1024}};
+// 512 KB/s with jitter and 1% random loss.
+constexpr LinkProfile kLossyLink{40, {10, 0.01, 512 * 1024, 64 * 1024}};
+// 256 KB/s behind a 1 MB queue, 4 seconds of buffer.
+constexpr LinkProfile kBloatedLink{20, {0, 0.0, 256 * 1024, 1024 * 1024}};
+
+constexpr const LinkProfile *kProfiles[] = {&kCleanLink, &kLossyLink, &kBloatedLink};
+
+constexpr uint64_t kRunTimeMs = 10000;
+
+struct Receiver {
+    uint64_t bytes = 0;
+};
+
+/**
+ * One sender streams lossless custom packets to state.range(2) friends at
+ * once for kRunTimeMs of simulated time. All streams share the sender's
+ * uplink, which is shaped by the link profile state.range(1). Both ends use
+ * the congestion controller state.range(0).
+ */
+void BM_CongestionControl(benchmark::State &state)
+{
+    const auto congestion_control = static_cast<Tox_Congestion_Control>(state.range(0));
+    const LinkProfile &profile = *kProfiles[state.range(1)];
+    const int num_connections = static_cast<int>(state.range(2));
+
+    Simulation sim{12345};
+    sim.net().set_latency(profile.latency_ms);
+
+    auto sender_node = sim.create_node();
+    auto sender = sender_node->create_tox();
+
+    if (!sender) {
+        state.SkipWithError("Failed to create Tox instances");
+        return;
+    }
+
+    tox_set_congestion_control(sender.get(), congestion_control);
+
+    std::vector<std::unique_ptr<SimulatedNode>> nodes;
+    std::vector<SimulatedNode::ToxPtr> receivers;
+    std::vector<Receiver> received(num_connections);
+
+    for (int i = 0; i < num_connections; ++i) {
+        nodes.push_back(sim.create_node());
+        receivers.push_back(nodes.back()->create_tox());
+
+        if (!receivers.back()) {
+            state.SkipWithError("Failed to create Tox instances");
+            return;
+        }
+
+        tox_set_congestion_control(receivers.back().get(), congestion_control);
+
+        if (!connect_friends(sim, *sender_node, sender.get(), *nodes.back(), receivers.back().get())) {
+            state.SkipWithError("Failed to connect toxes");
+            return;
+        }
+
+        tox_callback_friend_lossless_packet(receivers.back().get(),
+            [](Tox *, uint32_t, const uint8_t *, std::size_t length, void *user_data) {
+                static_cast<Receiver *>(user_data)->bytes += length;
+            });
+    }
+
+    sim.net().set_link_conditions(profile.link);
+
+    std::vector<uint8_t> packet(TOX_MAX_CUSTOM_PACKET_SIZE, 0);
+    packet[0] = 160;
+
+    double goodput_total = 0.0;
+    double fairness_total = 0.0;
+    double queue_delay_total = 0.0;
+    double queue_delay_max = 0.0;
+    double drop_rate_total = 0.0;
+    std::uint64_t runs = 0;
+
+    for (auto _ : state) {
+        for (Receiver &r : received) {
+            r.bytes = 0;
+        }
+
+        sim.net().reset_link_stats();
+
+        const std::uint64_t start_ms = sim.clock().current_time_ms();
+
+        while (sim.clock().current_time_ms() - start_ms < kRunTimeMs) {
+            // Fill every connection until net_crypto refuses more packets,
+            // so no stream is ever application limited.
+            for (uint32_t f = 0; f < static_cast<uint32_t>(num_connections); ++f) {
+                while (tox_friend_send_lossless_packet(
+                    sender.get(), f, packet.data(), packet.size(), nullptr)) {
+                }
+            }
+
+            sim.advance_time(1);
+            tox_iterate(sender.get(), nullptr);
+
+            for (int i = 0; i < num_connections; ++i) {
+                tox_iterate(receivers[i].get(), &received[i]);
+            }
+        }
+
+        const double seconds = static_cast<double>(kRunTimeMs) / 1000.0;
+        double sum = 0.0;
+        double sum_sq = 0.0;
+
+        for (const Receiver &r : received) {
+            const double goodput = static_cast<double>(r.bytes) / seconds;
+            sum += goodput;
+            sum_sq += goodput * goodput;
+        }
+
+        const NetworkUniverse::LinkStats stats = sim.net().link_stats();
+        const std::uint64_t offered = stats.packets + stats.lost + stats.queue_drops;
+
+        goodput_total += sum;
+        // Jain's fairness index: 1 if every connection got the same share, 1/n if one got all.
+        fairness_total += sum_sq > 0.0 ? (sum * sum) / (num_connections * sum_sq) : 0.0;
+        queue_delay_total += stats.packets > 0
+            ? static_cast<double>(stats.queue_delay_us_total) / static_cast<double>(stats.packets) / 1000.0
+            : 0.0;
+        queue_delay_max = std::max(queue_delay_max, static_cast<double>(stats.queue_delay_us_max) / 1000.0);
+        drop_rate_total += offered > 0
+            ? static_cast<double>(stats.lost + stats.queue_drops) / static_cast<double>(offered)
+            : 0.0;
+        ++runs;
+    }
+
+    if (runs == 0) {
+        return;
+    }
+
+    const double n = static_cast<double>(runs);
+    const double link_bandwidth = static_cast<double>(profile.link.bandwidth);
+
+    state.counters["goodput_KBps"] = benchmark::Counter(goodput_total / n / 1024.0);
+    state.counters["utilization"] = benchmark::Counter(goodput_total / n / link_bandwidth);
+    state.counters["fairness"] = benchmark::Counter(fairness_total / n);
+    state.counters["queue_delay_avg_ms"] = benchmark::Counter(queue_delay_total / n);
+    state.counters["queue_delay_max_ms"] = benchmark::Counter(queue_delay_max);
+    state.counters["drop_rate"] = benchmark::Counter(drop_rate_total / n);
+}
+
+// Args: controller (0 = default, 1 = bbr), link profile (0 = clean, 1 = lossy, 2 = bloated),
+// number of concurrent connections.
+BENCHMARK(BM_CongestionControl)
+    ->ArgNames({"cc", "link", "conns"})
+    ->ArgsProduct({{TOX_CONGESTION_CONTROL_DEFAULT, TOX_CONGESTION_CONTROL_BBR}, {0, 1, 2}, {1, 3}})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
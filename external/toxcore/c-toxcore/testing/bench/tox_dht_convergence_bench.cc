@@ -0,0 +1,472 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../testing/support/public/simulation.hh"
+#include "../../toxcore/DHT.h"
+#include "../../toxcore/Messenger.h"
+#include "../../toxcore/network.h"
+#include "../../toxcore/tox.h"
+#include "../../toxcore/tox_struct.h"
+
+namespace {
+
+using tox::test::NetworkUniverse;
+using tox::test::Packet;
+using tox::test::SimulatedNode;
+using tox::test::Simulation;
+
+constexpr int kNumBootstrapNodes = 8;
+constexpr int kBootstrapFanout = 2;
+constexpr int kMaxFriendPairs = 100;
+constexpr int kCloseNodeSamples = 200;
+constexpr std::uint64_t kConnectTimeoutMs = 120000;
+constexpr std::uint64_t kFriendTimeoutMs = 120000;
+constexpr std::uint64_t kSteadyStateMs = 30000;
+constexpr std::uint64_t kNatMappingTimeoutMs = 60000;
+
+using DhtId = std::array<std::uint8_t, TOX_PUBLIC_KEY_SIZE>;
+
+enum class NatType {
+    kOpen,
+    kRestrictedCone,  // Inbound only from IPs we sent to.
+    kPortRestricted,  // Inbound only from IP:ports we sent to.
+    kSymmetric,  // Port restricted, and a new external port per destination.
+};
+
+struct NetworkProfile {
+    const char *name;
+    std::uint64_t latency_ms;
+    NetworkUniverse::LinkConditions link;
+    // Share of the non-bootstrap nodes behind each kind of NAT, the rest is open.
+    double restricted_cone;
+    double port_restricted;
+    double symmetric;
+};
+
+const NetworkProfile kProfiles[] = {
+    {"clean", 10, {0, 0.0, 0, 0}, 0.0, 0.0, 0.0},
+    {"lossy", 50, {20, 0.05, 0, 0}, 0.0, 0.0, 0.0},
+    {"nat", 30, {10, 0.01, 0, 0}, 0.3, 0.3, 0.1},
+    {"mobile", 100, {50, 0.05, 128 * 1024, 64 * 1024}, 0.0, 0.3, 0.3},
+};
+
+/**
+ * NAT in front of some of the nodes, as a filter on the simulated network.
+ *
+ * Only UDP is translated, TCP connections always go through. Mappings and
+ * permissions expire after kNatMappingTimeoutMs without outbound traffic.
+ */
+class NatFilter {
+public:
+    explicit NatFilter(Simulation &sim)
+        : sim_(sim)
+    {
+    }
+
+    void set_type(const IP &ip, NatType type) { nodes_[ip.ip.v4.uint32].type = type; }
+
+    bool operator()(Packet &p)
+    {
+        if (p.is_tcp || ip_equal(&p.from.ip, &p.to.ip)) {
+            return true;
+        }
+
+        const std::uint64_t now = sim_.clock().current_time_ms();
+
+        if (auto it = nodes_.find(p.from.ip.ip.v4.uint32); it != nodes_.end()) {
+            outbound(it->second, p, now);
+        }
+
+        if (auto it = nodes_.find(p.to.ip.ip.v4.uint32); it != nodes_.end()) {
+            return inbound(it->second, p, now);
+        }
+
+        return true;
+    }
+
+private:
+    struct Endpoint {
+        std::uint32_t ip;
+        std::uint16_t port;
+
+        bool operator<(const Endpoint &other) const
+        {
+            return ip != other.ip ? ip < other.ip : port < other.port;
+        }
+    };
+
+    struct Mapping {
+        std::uint16_t internal_port;
+        Endpoint remote;
+        std::uint64_t last_used;
+    };
+
+    struct NatState {
+        NatType type = NatType::kOpen;
+        std::map<std::uint32_t, std::uint64_t> ip_permissions;
+        std::map<Endpoint, std::uint64_t> permissions;
+        // Symmetric only: (internal port, remote) -> external port and back.
+        std::map<std::pair<std::uint16_t, Endpoint>, std::uint16_t> external_ports;
+        std::map<std::uint16_t, Mapping> mappings;
+        std::uint16_t next_external_port = 40000;
+    };
+
+    static bool fresh(std::uint64_t last_used, std::uint64_t now)
+    {
+        return now - last_used < kNatMappingTimeoutMs;
+    }
+
+    static void outbound(NatState &nat, Packet &p, std::uint64_t now)
+    {
+        const Endpoint remote{p.to.ip.ip.v4.uint32, p.to.port};
+        nat.ip_permissions[remote.ip] = now;
+        nat.permissions[remote] = now;
+
+        if (nat.type != NatType::kSymmetric) {
+            return;
+        }
+
+        const auto key = std::make_pair(p.from.port, remote);
+        auto it = nat.external_ports.find(key);
+
+        if (it == nat.external_ports.end()) {
+            const std::uint16_t external = net_htons(nat.next_external_port++);
+            it = nat.external_ports.emplace(key, external).first;
+        }
+
+        nat.mappings[it->second] = Mapping{p.from.port, remote, now};
+        p.from.port = it->second;
+    }
+
+    static bool inbound(NatState &nat, Packet &p, std::uint64_t now)
+    {
+        const Endpoint remote{p.from.ip.ip.v4.uint32, p.from.port};
+
+        switch (nat.type) {
+        case NatType::kOpen:
+            return true;
+
+        case NatType::kRestrictedCone: {
+            const auto it = nat.ip_permissions.find(remote.ip);
+            return it != nat.ip_permissions.end() && fresh(it->second, now);
+        }
+
+        case NatType::kPortRestricted: {
+            const auto it = nat.permissions.find(remote);
+            return it != nat.permissions.end() && fresh(it->second, now);
+        }
+
+        case NatType::kSymmetric: {
+            const auto it = nat.mappings.find(p.to.port);
+
+            if (it == nat.mappings.end() || !fresh(it->second.last_used, now)
+                || it->second.remote.ip != remote.ip || it->second.remote.port != remote.port) {
+                return false;
+            }
+
+            p.to.port = it->second.internal_port;
+            return true;
+        }
+        }
+
+        return false;
+    }
+
+    Simulation &sim_;
+    std::unordered_map<std::uint32_t, NatState> nodes_;
+};
+
+struct Peer {
+    std::unique_ptr<SimulatedNode> node;
+    SimulatedNode::ToxPtr tox;
+    DhtId dht_id;
+};
+
+bool bootstrap_to(Tox *tox, const Peer &to)
+{
+    char ip_str[TOX_INET_ADDRSTRLEN];
+    ip_parse_addr(&to.node->ip, ip_str, sizeof(ip_str));
+
+    auto *socket = to.node->get_primary_socket();
+    return socket != nullptr && tox_bootstrap(tox, ip_str, socket->local_port(), to.dht_id.data(), nullptr);
+}
+
+double percentile(std::vector<std::uint64_t> values, double p)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    const std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return static_cast<double>(values[index]);
+}
+
+/** Whether a is closer to target than b by the DHT's own metric. */
+bool closer(const DhtId &target, const DhtId &a, const DhtId &b)
+{
+    return id_closest(target.data(), a.data(), b.data()) == 1;
+}
+
+/**
+ * Brings up state.range(0) nodes on the network profile state.range(1) and
+ * measures, in order:
+ *
+ * - how long until each node reports a DHT connection,
+ * - how long friend pairs take to find each other via the onion,
+ * - how close the nodes returned by get_close_nodes are to the ideal ones,
+ * - the per node packet rate once everything has settled.
+ *
+ * All times are virtual, the wall time is only the cost of simulating it.
+ */
+void BM_DhtConvergence(benchmark::State &state)
+{
+    const int num_nodes = static_cast<int>(state.range(0));
+    const NetworkProfile &profile = kProfiles[state.range(1)];
+    state.SetLabel(profile.name);
+
+    for (auto _ : state) {
+        Simulation sim{12345};
+        sim.net().set_latency(profile.latency_ms);
+        sim.net().set_link_conditions(profile.link);
+
+        auto nat = std::make_shared<NatFilter>(sim);
+        sim.net().add_filter([nat](Packet &p) { return (*nat)(p); });
+
+        std::uint64_t observed_packets = 0;
+        std::uint64_t observed_bytes = 0;
+        sim.net().add_observer([&](const Packet &p) {
+            ++observed_packets;
+            observed_bytes += p.data.size();
+        });
+
+        std::mt19937 rng(12345);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        std::vector<Peer> peers;
+        peers.reserve(num_nodes);
+
+        for (int i = 0; i < num_nodes; ++i) {
+            Peer peer;
+            peer.node = sim.create_node();
+            peer.tox = peer.node->create_tox();
+
+            if (!peer.tox) {
+                state.SkipWithError("Failed to create Tox instances");
+                return;
+            }
+
+            tox_self_get_dht_id(peer.tox.get(), peer.dht_id.data());
+
+            // Bootstrap nodes stay reachable, like the public ones.
+            if (i >= kNumBootstrapNodes) {
+                const double r = coin(rng);
+
+                if (r < profile.symmetric) {
+                    nat->set_type(peer.node->ip, NatType::kSymmetric);
+                } else if (r < profile.symmetric + profile.port_restricted) {
+                    nat->set_type(peer.node->ip, NatType::kPortRestricted);
+                } else if (r < profile.symmetric + profile.port_restricted + profile.restricted_cone) {
+                    nat->set_type(peer.node->ip, NatType::kRestrictedCone);
+                }
+            }
+
+            peers.push_back(std::move(peer));
+        }
+
+        const int num_bootstrap = std::min(kNumBootstrapNodes, num_nodes);
+        std::uniform_int_distribution<int> pick_bootstrap(0, num_bootstrap - 1);
+
+        for (int i = 0; i < num_nodes; ++i) {
+            for (int j = 0; j < kBootstrapFanout; ++j) {
+                const int to = i < num_bootstrap ? (i + j + 1) % num_bootstrap : pick_bootstrap(rng);
+
+                if (to != i && !bootstrap_to(peers[i].tox.get(), peers[to])) {
+                    state.SkipWithError("Failed to bootstrap");
+                    return;
+                }
+            }
+        }
+
+        const auto iterate_all = [&]() {
+            sim.advance_time(Simulation::kDefaultTickIntervalMs);
+
+            for (Peer &peer : peers) {
+                tox_iterate(peer.tox.get(), nullptr);
+            }
+        };
+
+        // Phase 1: DHT connection.
+        const std::uint64_t start_ms = sim.clock().current_time_ms();
+        std::vector<std::uint64_t> connect_ms(num_nodes, 0);
+        std::vector<std::uint64_t> connect_times;
+        connect_times.reserve(num_nodes);
+
+        while (static_cast<int>(connect_times.size()) < num_nodes
+            && sim.clock().current_time_ms() - start_ms < kConnectTimeoutMs) {
+            iterate_all();
+
+            for (int i = 0; i < num_nodes; ++i) {
+                if (connect_ms[i] == 0 && tox_self_get_connection_status(peers[i].tox.get()) != TOX_CONNECTION_NONE) {
+                    connect_ms[i] = sim.clock().current_time_ms() - start_ms;
+                    connect_times.push_back(connect_ms[i]);
+                }
+            }
+        }
+
+        // Phase 2: friend connections between random pairs of ordinary nodes.
+        std::vector<int> candidates;
+
+        for (int i = num_bootstrap; i < num_nodes; ++i) {
+            candidates.push_back(i);
+        }
+
+        std::shuffle(candidates.begin(), candidates.end(), rng);
+        const int num_pairs = std::min<int>(kMaxFriendPairs, static_cast<int>(candidates.size()) / 2);
+
+        struct FriendPair {
+            Tox *a;
+            std::uint32_t friend_number;
+            std::uint64_t connected_ms = 0;
+        };
+
+        std::vector<FriendPair> pairs;
+
+        for (int i = 0; i < num_pairs; ++i) {
+            Tox *a = peers[candidates[2 * i]].tox.get();
+            Tox *b = peers[candidates[2 * i + 1]].tox.get();
+            std::uint8_t a_pk[TOX_PUBLIC_KEY_SIZE];
+            std::uint8_t b_pk[TOX_PUBLIC_KEY_SIZE];
+            tox_self_get_public_key(a, a_pk);
+            tox_self_get_public_key(b, b_pk);
+            pairs.push_back(FriendPair{a, tox_friend_add_norequest(a, b_pk, nullptr)});
+            tox_friend_add_norequest(b, a_pk, nullptr);
+        }
+
+        const std::uint64_t friends_start_ms = sim.clock().current_time_ms();
+        std::vector<std::uint64_t> friend_times;
+
+        while (static_cast<int>(friend_times.size()) < num_pairs
+            && sim.clock().current_time_ms() - friends_start_ms < kFriendTimeoutMs) {
+            iterate_all();
+
+            for (FriendPair &pair : pairs) {
+                if (pair.connected_ms == 0
+                    && tox_friend_get_connection_status(pair.a, pair.friend_number, nullptr) != TOX_CONNECTION_NONE) {
+                    pair.connected_ms = sim.clock().current_time_ms() - friends_start_ms;
+                    friend_times.push_back(pair.connected_ms);
+                }
+            }
+        }
+
+        // Phase 3: close node quality. The node closest to a random key
+        // should know the next MAX_SENT_NODES closest ones.
+        std::uint64_t recall_hits = 0;
+        std::uint64_t recall_total = 0;
+        int best_hits = 0;
+
+        for (int s = 0; s < kCloseNodeSamples; ++s) {
+            DhtId target;
+
+            for (std::uint8_t &b : target) {
+                b = static_cast<std::uint8_t>(rng());
+            }
+
+            std::vector<int> order(num_nodes);
+
+            for (int i = 0; i < num_nodes; ++i) {
+                order[i] = i;
+            }
+
+            const int wanted = std::min(num_nodes - 1, MAX_SENT_NODES);
+            std::partial_sort(order.begin(), order.begin() + wanted + 1, order.end(), [&](int a, int b) {
+                return closer(target, peers[a].dht_id, peers[b].dht_id);
+            });
+
+            const DHT *dht = peers[order[0]].tox->m->dht;
+            Node_format nodes[MAX_SENT_NODES];
+            const int found = get_close_nodes(dht, target.data(), nodes, net_family_unspec(), false, false);
+
+            if (found <= 0 || wanted <= 0) {
+                recall_total += wanted;
+                continue;
+            }
+
+            const auto is_ideal = [&](const std::uint8_t *pk) {
+                for (int i = 1; i <= wanted; ++i) {
+                    if (std::memcmp(pk, peers[order[i]].dht_id.data(), TOX_PUBLIC_KEY_SIZE) == 0) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+            int best = 0;
+
+            for (int i = 0; i < found; ++i) {
+                recall_hits += is_ideal(nodes[i].public_key) ? 1 : 0;
+
+                if (id_closest(target.data(), nodes[i].public_key, nodes[best].public_key) == 1) {
+                    best = i;
+                }
+            }
+
+            recall_total += wanted;
+            best_hits += std::memcmp(nodes[best].public_key, peers[order[1]].dht_id.data(), TOX_PUBLIC_KEY_SIZE) == 0;
+        }
+
+        // Phase 4: steady state traffic.
+        observed_packets = 0;
+        observed_bytes = 0;
+        const std::uint64_t steady_start_ms = sim.clock().current_time_ms();
+
+        while (sim.clock().current_time_ms() - steady_start_ms < kSteadyStateMs) {
+            iterate_all();
+        }
+
+        const double steady_s = static_cast<double>(sim.clock().current_time_ms() - steady_start_ms) / 1000.0;
+        const double node_seconds = static_cast<double>(num_nodes) * steady_s;
+
+        state.counters["dht_connected_pct"]
+            = benchmark::Counter(100.0 * static_cast<double>(connect_times.size()) / num_nodes);
+        state.counters["dht_connect_p50_ms"] = benchmark::Counter(percentile(connect_times, 0.5));
+        state.counters["dht_connect_p90_ms"] = benchmark::Counter(percentile(connect_times, 0.9));
+        state.counters["dht_connect_max_ms"] = benchmark::Counter(percentile(connect_times, 1.0));
+        state.counters["friends_connected_pct"] = benchmark::Counter(
+            num_pairs > 0 ? 100.0 * static_cast<double>(friend_times.size()) / num_pairs : 0.0);
+        state.counters["friend_connect_p50_ms"] = benchmark::Counter(percentile(friend_times, 0.5));
+        state.counters["friend_connect_p90_ms"] = benchmark::Counter(percentile(friend_times, 0.9));
+        state.counters["friend_connect_max_ms"] = benchmark::Counter(percentile(friend_times, 1.0));
+        state.counters["close_nodes_recall"] = benchmark::Counter(
+            recall_total > 0 ? static_cast<double>(recall_hits) / static_cast<double>(recall_total) : 0.0);
+        state.counters["close_nodes_best_pct"]
+            = benchmark::Counter(100.0 * static_cast<double>(best_hits) / kCloseNodeSamples);
+        state.counters["packets_per_node_s"] = benchmark::Counter(static_cast<double>(observed_packets) / node_seconds);
+        state.counters["bytes_per_node_s"] = benchmark::Counter(static_cast<double>(observed_bytes) / node_seconds);
+    }
+}
+
+// Args: number of nodes, network profile (0 = clean, 1 = lossy, 2 = nat, 3 = mobile).
+BENCHMARK(BM_DhtConvergence)
+    ->ArgNames({"nodes", "profile"})
+    ->ArgsProduct({{500, 1000, 2000, 5000}, {0, 1, 2, 3}})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
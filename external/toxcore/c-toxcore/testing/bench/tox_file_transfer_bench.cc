@@ -0,0 +1,175 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../../testing/support/public/simulation.hh"
+#include "../../testing/support/public/tox_network.hh"
+#include "../../toxcore/tox.h"
+#include "../../toxcore/tox_private.h"
+
+namespace {
+
+using tox::test::connect_friends;
+using tox::test::SimulatedNode;
+using tox::test::Simulation;
+
+struct SenderContext {
+    const std::vector<uint8_t> *file_data = nullptr;
+    std::uint64_t callbacks = 0;
+};
+
+struct ReceiverContext {
+    std::uint64_t bytes_received = 0;
+    bool done = false;
+};
+
+/**
+ * Sends one file of state.range(0) KiB per iteration from tox1 to tox2 and
+ * runs the simulation until tox2 received all of it.
+ *
+ * With bulk = false the sender answers every file_chunk_request with
+ * tox_file_send_chunk, with bulk = true the transfer is switched to bulk mode
+ * and toxcore pulls the data through the file_bulk_read callback.
+ */
+void run_file_transfer(benchmark::State &state, bool bulk)
+{
+    Simulation sim{12345};
+    sim.net().set_latency(5);
+    auto node1 = sim.create_node();
+    auto node2 = sim.create_node();
+    auto tox1 = node1->create_tox();
+    auto tox2 = node2->create_tox();
+
+    if (!tox1 || !tox2) {
+        state.SkipWithError("Failed to create Tox instances");
+        return;
+    }
+
+    if (!connect_friends(sim, *node1, tox1.get(), *node2, tox2.get())) {
+        state.SkipWithError("Failed to connect toxes");
+        return;
+    }
+
+    const uint32_t f1 = 0;
+
+    const std::size_t file_size = static_cast<std::size_t>(state.range(0)) * 1024;
+    std::vector<uint8_t> file_data(file_size);
+    for (std::size_t i = 0; i < file_size; ++i) {
+        file_data[i] = static_cast<uint8_t>(i * 31);
+    }
+
+    SenderContext sender;
+    sender.file_data = &file_data;
+
+    tox_callback_file_chunk_request(tox1.get(),
+        [](Tox *tox, uint32_t friend_number, uint32_t file_number, uint64_t position,
+            std::size_t length, void *user_data) {
+            auto *ctx = static_cast<SenderContext *>(user_data);
+            ctx->callbacks++;
+            if (length == 0) {
+                return;
+            }
+            tox_file_send_chunk(tox, friend_number, file_number, position,
+                ctx->file_data->data() + position, length, nullptr);
+        });
+
+    tox_callback_file_bulk_read(tox1.get(),
+        [](Tox *, uint32_t, uint32_t, uint64_t position, uint8_t *data, std::size_t length,
+            void *file_user_data) -> int32_t {
+            auto *ctx = static_cast<SenderContext *>(file_user_data);
+            ctx->callbacks++;
+            std::memcpy(data, ctx->file_data->data() + position, length);
+            return static_cast<int32_t>(length);
+        });
+
+    tox_callback_file_recv(tox2.get(),
+        [](Tox *tox, uint32_t friend_number, uint32_t file_number, uint32_t, uint64_t,
+            const uint8_t *, std::size_t, void *) {
+            tox_file_control(tox, friend_number, file_number, TOX_FILE_CONTROL_RESUME, nullptr);
+        });
+
+    tox_callback_file_recv_chunk(tox2.get(),
+        [](Tox *, uint32_t, uint32_t, uint64_t, const uint8_t *, std::size_t length,
+            void *user_data) {
+            auto *ctx = static_cast<ReceiverContext *>(user_data);
+            ctx->bytes_received += length;
+            if (length == 0) {
+                ctx->done = true;
+            }
+        });
+
+    std::uint64_t sim_time_ms = 0;
+    std::uint64_t files_sent = 0;
+
+    for (auto _ : state) {
+        ReceiverContext receiver;
+
+        const uint32_t file_number = tox_file_send(tox1.get(), f1, TOX_FILE_KIND_DATA, file_size,
+            nullptr, reinterpret_cast<const uint8_t *>("bench"), 5, nullptr);
+        if (file_number == UINT32_MAX) {
+            state.SkipWithError("tox_file_send failed");
+            return;
+        }
+
+        if (bulk && !tox_file_send_bulk(tox1.get(), f1, file_number, &sender, nullptr)) {
+            state.SkipWithError("tox_file_send_bulk failed");
+            return;
+        }
+
+        const std::uint64_t start_ms = sim.clock().current_time_ms();
+        while (!receiver.done) {
+            sim.advance_time(1);
+            tox_iterate(tox1.get(), &sender);
+            tox_iterate(tox2.get(), &receiver);
+
+            if (sim.clock().current_time_ms() - start_ms > 600000) {
+                state.SkipWithError("Transfer did not finish within 10 simulated minutes");
+                return;
+            }
+        }
+
+        // let the sender see the final ack, so the slot is free for the next file
+        for (int i = 0; i < 50; ++i) {
+            sim.advance_time(1);
+            tox_iterate(tox1.get(), &sender);
+            tox_iterate(tox2.get(), nullptr);
+        }
+
+        sim_time_ms += sim.clock().current_time_ms() - start_ms;
+        ++files_sent;
+
+        if (receiver.bytes_received != file_size) {
+            state.SkipWithError("Received size mismatch");
+            return;
+        }
+    }
+
+    const double total_bytes = static_cast<double>(files_sent) * static_cast<double>(file_size);
+    const double total_mb = total_bytes / (1024.0 * 1024.0);
+
+    // bytes_per_second is measured against cpu time, so it doubles as cpu cost per MB
+    state.SetBytesProcessed(static_cast<int64_t>(total_bytes));
+    state.counters["sim_MBps"] = benchmark::Counter(
+        sim_time_ms > 0 ? total_mb / (static_cast<double>(sim_time_ms) / 1000.0) : 0.0);
+    state.counters["callbacks_per_MB"]
+        = benchmark::Counter(total_mb > 0 ? static_cast<double>(sender.callbacks) / total_mb : 0.0);
+}
+
+void BM_FileSendChunkRequest(benchmark::State &state) { run_file_transfer(state, false); }
+
+BENCHMARK(BM_FileSendChunkRequest)->Arg(256)->Arg(4096)->Unit(benchmark::kMillisecond);
+
+void BM_FileSendBulk(benchmark::State &state) { run_file_transfer(state, true); }
+
+BENCHMARK(BM_FileSendBulk)->Arg(256)->Arg(4096)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../../testing/support/public/simulation.hh"
+#include "../../toxcore/network.h"
+#include "../../toxcore/tox.h"
+#include "../../toxcore/tox_private.h"
+
+namespace {
+
+using tox::test::SimulatedNode;
+using tox::test::Simulation;
+
+constexpr int kNumDhtNodes = 12;
+constexpr int kNumOnlineFriends = 4;
+constexpr std::uint64_t kWarmupMs = 20000;
+constexpr std::uint64_t kTimeoutMs = 300000;
+
+struct Peer {
+    std::unique_ptr<SimulatedNode> node;
+    SimulatedNode::ToxPtr tox;
+};
+
+bool bootstrap_to(Tox *tox, const Peer &to)
+{
+    std::uint8_t dht_id[TOX_PUBLIC_KEY_SIZE];
+    tox_self_get_dht_id(to.tox.get(), dht_id);
+    char ip_str[TOX_INET_ADDRSTRLEN];
+    ip_parse_addr(&to.node->ip, ip_str, sizeof(ip_str));
+
+    auto *socket = to.node->get_primary_socket();
+    return socket != nullptr && tox_bootstrap(tox, ip_str, socket->local_port(), dht_id, nullptr);
+}
+
+std::uint64_t onion_packets_sent(const Tox *tox)
+{
+    return tox_netprof_get_packet_id_count(tox, TOX_NETPROF_PACKET_TYPE_UDP,
+               TOX_NETPROF_PACKET_ID_ONION_SEND_INITIAL, TOX_NETPROF_DIRECTION_SENT)
+        + tox_netprof_get_packet_id_count(tox, TOX_NETPROF_PACKET_TYPE_TCP,
+            TOX_NETPROF_PACKET_ID_TCP_ONION_REQUEST, TOX_NETPROF_DIRECTION_SENT);
+}
+
+/**
+ * A profile with state.range(0) friends, kNumOnlineFriends of which come
+ * online on a DHT of kNumDhtNodes nodes and have to be found via the onion.
+ * The rest are offline and only cost search traffic.
+ */
+void BM_OnionFriendSearch(benchmark::State &state)
+{
+    const int num_friends = static_cast<int>(state.range(0));
+
+    Simulation sim{12345};
+    std::vector<Peer> peers;
+
+    // DHT nodes first, then the online friends, then us.
+    for (int i = 0; i < kNumDhtNodes + kNumOnlineFriends + 1; ++i) {
+        Peer peer;
+        peer.node = sim.create_node();
+        peer.tox = peer.node->create_tox();
+
+        if (!peer.tox) {
+            state.SkipWithError("Failed to create Tox instances");
+            return;
+        }
+
+        // Each one knows the previous DHT node, nobody knows us directly.
+        if (i > 0 && !bootstrap_to(peer.tox.get(), peers[std::min(i, kNumDhtNodes) - 1])) {
+            state.SkipWithError("Failed to bootstrap");
+            return;
+        }
+
+        peers.push_back(std::move(peer));
+    }
+
+    Tox *main_tox = peers.back().tox.get();
+    const auto iterate_all = [&]() {
+        sim.advance_time(Simulation::kDefaultTickIntervalMs);
+
+        for (Peer &peer : peers) {
+            tox_iterate(peer.tox.get(), nullptr);
+        }
+    };
+
+    for (std::uint64_t t = 0; t < kWarmupMs; t += Simulation::kDefaultTickIntervalMs) {
+        iterate_all();
+    }
+
+    // Offline friends, only their keys matter.
+    std::mt19937 rng(12345);
+
+    for (int i = kNumOnlineFriends; i < num_friends; ++i) {
+        std::uint8_t pk[TOX_PUBLIC_KEY_SIZE];
+
+        for (std::uint8_t &b : pk) {
+            b = static_cast<std::uint8_t>(rng());
+        }
+
+        pk[TOX_PUBLIC_KEY_SIZE - 1] &= 0x7f;
+        tox_friend_add_norequest(main_tox, pk, nullptr);
+    }
+
+    std::uint8_t main_pk[TOX_PUBLIC_KEY_SIZE];
+    tox_self_get_public_key(main_tox, main_pk);
+    std::vector<std::uint32_t> online_friends;
+
+    for (int i = 0; i < kNumOnlineFriends; ++i) {
+        Tox *friend_tox = peers[kNumDhtNodes + i].tox.get();
+        std::uint8_t pk[TOX_PUBLIC_KEY_SIZE];
+        tox_self_get_public_key(friend_tox, pk);
+        online_friends.push_back(tox_friend_add_norequest(main_tox, pk, nullptr));
+        tox_friend_add_norequest(friend_tox, main_pk, nullptr);
+    }
+
+    const std::uint64_t packets_before = onion_packets_sent(main_tox);
+    const std::uint64_t searches_before = tox_onion_search_get_searches_sent(main_tox);
+    const std::uint64_t start_ms = sim.clock().current_time_ms();
+    std::vector<std::uint64_t> found_ms(kNumOnlineFriends, 0);
+    int found = 0;
+
+    for (auto _ : state) {
+        while (found < kNumOnlineFriends && sim.clock().current_time_ms() - start_ms < kTimeoutMs) {
+            iterate_all();
+
+            for (int i = 0; i < kNumOnlineFriends; ++i) {
+                if (found_ms[i] == 0
+                    && tox_friend_get_connection_status(main_tox, online_friends[i], nullptr) != TOX_CONNECTION_NONE) {
+                    found_ms[i] = sim.clock().current_time_ms() - start_ms;
+                    ++found;
+                }
+            }
+        }
+    }
+
+    if (found < kNumOnlineFriends) {
+        state.SkipWithError("Not all online friends were found");
+        return;
+    }
+
+    std::uint64_t total_ms = 0;
+
+    for (const std::uint64_t ms : found_ms) {
+        total_ms += ms;
+    }
+
+    const std::uint64_t elapsed_s = std::max<std::uint64_t>(1, (sim.clock().current_time_ms() - start_ms) / 1000);
+    const std::uint64_t packets = onion_packets_sent(main_tox) - packets_before;
+
+    state.counters["time_to_find_avg_ms"] = benchmark::Counter(static_cast<double>(total_ms) / kNumOnlineFriends);
+    state.counters["time_to_find_max_ms"]
+        = benchmark::Counter(static_cast<double>(*std::max_element(found_ms.begin(), found_ms.end())));
+    state.counters["onion_packets"] = benchmark::Counter(static_cast<double>(packets));
+    state.counters["onion_packets_per_s"] = benchmark::Counter(static_cast<double>(packets) / elapsed_s);
+    state.counters["searches_sent"]
+        = benchmark::Counter(static_cast<double>(tox_onion_search_get_searches_sent(main_tox) - searches_before));
+    state.counters["friends_found"] = benchmark::Counter(static_cast<double>(tox_onion_search_get_friends_found(main_tox)));
+}
+
+// Args: total number of friends.
+BENCHMARK(BM_OnionFriendSearch)->Arg(100)->Arg(1000)->Arg(5000)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,150 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../testing/support/public/simulation.hh"
+#include "../../testing/support/public/tox_network.hh"
+#include "../../toxcore/tox.h"
+#include "../../toxcore/tox_private.h"
+
+namespace {
+
+using tox::test::connect_friends;
+using tox::test::SimulatedNode;
+using tox::test::Simulation;
+
+constexpr int kNumFriends = 1000;
+
+struct NameSeen {
+    std::string name;
+};
+
+/**
+ * A profile with kNumFriends friends, one of which is online and renames
+ * itself before every save. state.range(0) selects a full save (0) or a
+ * journal entry on top of the last save (1).
+ */
+void BM_SaveAfterFriendRename(benchmark::State &state)
+{
+    const bool journal = state.range(0) != 0;
+
+    Simulation sim{12345};
+    auto main_node = sim.create_node();
+    auto main_tox = main_node->create_tox();
+    auto friend_node = sim.create_node();
+    auto friend_tox = friend_node->create_tox();
+
+    if (!main_tox || !friend_tox) {
+        state.SkipWithError("Failed to create Tox instances");
+        return;
+    }
+
+    if (!connect_friends(sim, *main_node, main_tox.get(), *friend_node, friend_tox.get())) {
+        state.SkipWithError("Failed to connect toxes");
+        return;
+    }
+
+    // The rest of the friends are offline, only their keys matter.
+    std::mt19937 rng(12345);
+
+    for (int i = 1; i < kNumFriends; ++i) {
+        std::uint8_t pk[TOX_PUBLIC_KEY_SIZE];
+
+        for (std::uint8_t &b : pk) {
+            b = static_cast<std::uint8_t>(rng());
+        }
+
+        pk[TOX_PUBLIC_KEY_SIZE - 1] &= 0x7f;
+        tox_friend_add_norequest(main_tox.get(), pk, nullptr);
+    }
+
+    tox_callback_friend_name(main_tox.get(),
+        [](Tox *, uint32_t, const uint8_t *name, std::size_t length, void *user_data) {
+            static_cast<NameSeen *>(user_data)->name.assign(reinterpret_cast<const char *>(name), length);
+        });
+
+    std::vector<std::uint8_t> base(tox_get_savedata_size(main_tox.get()));
+    tox_get_savedata(main_tox.get(), base.data());
+    tox_savedata_journal_reset(main_tox.get());
+
+    std::vector<std::uint8_t> saved;
+    std::uint64_t bytes_total = 0;
+    std::uint64_t saves = 0;
+    std::string name;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        name = "friend " + std::to_string(saves);
+        tox_self_set_name(friend_tox.get(), reinterpret_cast<const std::uint8_t *>(name.data()), name.size(),
+            nullptr);
+
+        NameSeen seen;
+
+        for (int tick = 0; tick < 200 && seen.name != name; ++tick) {
+            sim.advance_time(Simulation::kDefaultTickIntervalMs);
+            tox_iterate(friend_tox.get(), nullptr);
+            tox_iterate(main_tox.get(), &seen);
+        }
+
+        if (seen.name != name) {
+            state.SkipWithError("Rename did not arrive");
+            return;
+        }
+
+        state.ResumeTiming();
+
+        if (journal) {
+            saved.resize(tox_get_savedata_journal_size(main_tox.get()));
+            saved.resize(tox_get_savedata_journal(main_tox.get(), saved.data(), saved.size()));
+            base.insert(base.end(), saved.begin(), saved.end());
+        } else {
+            saved.resize(tox_get_savedata_size(main_tox.get()));
+            tox_get_savedata(main_tox.get(), saved.data());
+        }
+
+        bytes_total += saved.size();
+        ++saves;
+    }
+
+    if (saves == 0) {
+        return;
+    }
+
+    state.counters["bytes_written"] = benchmark::Counter(static_cast<double>(bytes_total) / saves);
+
+    // The save data with all journal entries has to load to the current state.
+    const std::vector<std::uint8_t> &check = journal ? base : saved;
+    Tox_Options *options = tox_options_new(nullptr);
+    tox_options_set_savedata_type(options, TOX_SAVEDATA_TYPE_TOX_SAVE);
+    tox_options_set_savedata_data(options, check.data(), check.size());
+    auto load_node = sim.create_node();
+    auto loaded = load_node->create_tox(options);
+    tox_options_free(options);
+
+    if (!loaded || tox_self_get_friend_list_size(loaded.get()) != kNumFriends) {
+        state.SkipWithError("Saved profile does not load");
+        return;
+    }
+
+    std::vector<std::uint8_t> loaded_name(tox_friend_get_name_size(loaded.get(), 0, nullptr));
+    tox_friend_get_name(loaded.get(), 0, loaded_name.data(), nullptr);
+
+    if (std::string(loaded_name.begin(), loaded_name.end()) != name) {
+        state.SkipWithError("Saved profile lost the rename");
+    }
+}
+
+// Args: 0 = full save, 1 = journal entry.
+BENCHMARK(BM_SaveAfterFriendRename)->ArgName("journal")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
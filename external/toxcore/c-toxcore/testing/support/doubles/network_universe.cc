@@ -1,5 +1,6 @@
 #include "network_universe.hh"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 
@@ -98,7 +99,12 @@ void NetworkUniverse::send_packet(Packet p)
         observer(p);
     }
 
-    p.delivery_time += global_latency_ms_;
+    // Filters may have set a delivery time, it is added to the latency as extra delay.
+    p.delivery_time += now_ms_ + global_latency_ms_;
+
+    if (!p.is_tcp && !apply_link_conditions(p)) {
+        return;
+    }
 
     p.sequence_number = next_packet_id_++;
 
@@ -118,6 +124,45 @@ void NetworkUniverse::send_packet(Packet p)
     event_queue_.push(std::move(p));
 }
 
+bool NetworkUniverse::apply_link_conditions(Packet &p)
+{
+    if (link_conditions_.loss > 0.0
+        && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < link_conditions_.loss) {
+        ++link_stats_.lost;
+        return false;
+    }
+
+    uint64_t queue_delay_us = 0;
+
+    if (link_conditions_.bandwidth != 0) {
+        const uint64_t now_us = now_ms_ * 1000;
+        uint64_t &busy_until_us = uplink_busy_until_us_[{p.from.ip, 0}];
+        const uint64_t start_us = std::max(busy_until_us, now_us);
+        queue_delay_us = start_us - now_us;
+
+        const uint64_t queued_bytes = queue_delay_us * link_conditions_.bandwidth / 1000000;
+        if (link_conditions_.queue_limit != 0
+            && queued_bytes + p.data.size() > link_conditions_.queue_limit) {
+            ++link_stats_.queue_drops;
+            return false;
+        }
+
+        busy_until_us = start_us + p.data.size() * 1000000 / link_conditions_.bandwidth;
+        p.delivery_time += (busy_until_us - now_us + 999) / 1000;
+    }
+
+    if (link_conditions_.jitter_ms != 0) {
+        p.delivery_time
+            += std::uniform_int_distribution<uint64_t>(0, link_conditions_.jitter_ms)(rng_);
+    }
+
+    ++link_stats_.packets;
+    link_stats_.bytes += p.data.size();
+    link_stats_.queue_delay_us_total += queue_delay_us;
+    link_stats_.queue_delay_us_max = std::max(link_stats_.queue_delay_us_max, queue_delay_us);
+    return true;
+}
+
 static bool is_ipv4_mapped(const IP &ip)
 {
     if (!net_family_is_ipv6(ip.family))
@@ -159,6 +204,11 @@ bool is_loopback(const IP &ip)
 
 void NetworkUniverse::process_events(uint64_t current_time_ms)
 {
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        now_ms_ = std::max(now_ms_, current_time_ms);
+    }
+
     while (true) {
         Packet p;
         std::vector<FakeTcpSocket *> tcp_targets;
@@ -287,6 +337,31 @@ void NetworkUniverse::process_events(uint64_t current_time_ms)
 
 void NetworkUniverse::set_latency(uint64_t ms) { global_latency_ms_ = ms; }
 
+void NetworkUniverse::set_link_conditions(const LinkConditions &conditions)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    link_conditions_ = conditions;
+    uplink_busy_until_us_.clear();
+}
+
+void NetworkUniverse::set_seed(uint64_t seed)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    rng_.seed(seed);
+}
+
+NetworkUniverse::LinkStats NetworkUniverse::link_stats()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return link_stats_;
+}
+
+void NetworkUniverse::reset_link_stats()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    link_stats_ = LinkStats{};
+}
+
 void NetworkUniverse::set_verbose(bool verbose) { verbose_ = verbose; }
 
 bool NetworkUniverse::is_verbose() const { return verbose_; }
@@ -7,6 +7,7 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <random>
 #include <vector>
 
 #include "../../../toxcore/attributes.h"
@@ -55,6 +56,28 @@ public:
     using PacketFilter = std::function<bool(Packet &)>;
     using PacketSink = std::function<void(const Packet &)>;
 
+    /**
+     * @brief Conditions of the UDP uplink of every node.
+     *
+     * Each sending IP has its own bottleneck, so all connections of one node
+     * compete for its bandwidth and share its queue. TCP is not affected.
+     */
+    struct LinkConditions {
+        uint64_t jitter_ms = 0;  // Extra delay, uniformly distributed in [0, jitter_ms].
+        double loss = 0.0;  // Probability that a packet is dropped.
+        uint64_t bandwidth = 0;  // Bytes per second, 0 for unlimited.
+        uint64_t queue_limit = 0;  // Bytes queued before the link drops packets, 0 for unlimited.
+    };
+
+    struct LinkStats {
+        uint64_t packets = 0;  // Packets that made it through the link.
+        uint64_t bytes = 0;
+        uint64_t lost = 0;  // Packets dropped by random loss.
+        uint64_t queue_drops = 0;  // Packets dropped because the queue was full.
+        uint64_t queue_delay_us_total = 0;
+        uint64_t queue_delay_us_max = 0;
+    };
+
     NetworkUniverse();
     ~NetworkUniverse();
 
@@ -72,6 +95,10 @@ public:
     // Simulation
     void process_events(uint64_t current_time_ms);
     void set_latency(uint64_t ms);
+    void set_link_conditions(const LinkConditions &conditions);
+    void set_seed(uint64_t seed);
+    LinkStats link_stats();
+    void reset_link_stats();
     void set_verbose(bool verbose);
     bool is_verbose() const;
     void add_filter(PacketFilter filter);
@@ -88,6 +115,9 @@ public:
     };
 
 private:
+    // Returns false if the packet got dropped.
+    bool apply_link_conditions(Packet &p);
+
     std::map<IP_Port_Key, FakeUdpSocket *> udp_bindings_;
     std::multimap<IP_Port_Key, FakeTcpSocket *> tcp_bindings_;
 
@@ -96,6 +126,13 @@ private:
     std::vector<PacketSink> observers_;
 
     uint64_t global_latency_ms_ = 0;
+    uint64_t now_ms_ = 0;
+
+    LinkConditions link_conditions_;
+    LinkStats link_stats_;
+    // Per sender IP (port 0): when the uplink finished sending the last queued packet.
+    std::map<IP_Port_Key, uint64_t> uplink_busy_until_us_;
+    std::mt19937_64 rng_;
     uint64_t next_packet_id_ = 0;
     bool verbose_ = false;
     std::recursive_mutex mutex_;
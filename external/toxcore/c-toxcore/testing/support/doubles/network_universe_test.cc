@@ -49,6 +49,68 @@ namespace {
         ASSERT_EQ(s2.recvfrom(buf, 10, &from), 4);
     }
 
+    TEST_F(NetworkUniverseTest, LatencyIsRelativeToSendTime)
+    {
+        universe.set_latency(100);
+        universe.process_events(1000);
+
+        IP_Port s2_addr;
+        ip_init(&s2_addr.ip, false);
+        s2_addr.ip.ip.v4.uint32 = net_htonl(0x7F000001);
+        s2_addr.port = net_htons(9004);
+        s2.bind(&s2_addr);
+
+        uint8_t data[] = "Ping";
+        s1.sendto(data, 4, &s2_addr);
+
+        IP_Port from;
+        uint8_t buf[10];
+        universe.process_events(1050);
+        ASSERT_EQ(s2.recvfrom(buf, 10, &from), -1);
+
+        universe.process_events(1100);
+        ASSERT_EQ(s2.recvfrom(buf, 10, &from), 4);
+    }
+
+    TEST_F(NetworkUniverseTest, BandwidthQueuesAndDropsPackets)
+    {
+        NetworkUniverse::LinkConditions link;
+        link.bandwidth = 1000;  // 100 bytes take 100ms
+        link.queue_limit = 300;
+        universe.set_link_conditions(link);
+
+        IP_Port s2_addr;
+        ip_init(&s2_addr.ip, false);
+        s2_addr.ip.ip.v4.uint32 = net_htonl(0x7F000001);
+        s2_addr.port = net_htons(9004);
+        s2.bind(&s2_addr);
+
+        uint8_t data[100] = {0};
+        for (int i = 0; i < 4; ++i) {
+            s1.sendto(data, sizeof(data), &s2_addr);
+        }
+
+        IP_Port from;
+        uint8_t buf[100];
+        universe.process_events(99);
+        ASSERT_EQ(s2.recvfrom(buf, sizeof(buf), &from), -1);
+        universe.process_events(100);
+        ASSERT_EQ(s2.recvfrom(buf, sizeof(buf), &from), 100);
+        ASSERT_EQ(s2.recvfrom(buf, sizeof(buf), &from), -1);
+        universe.process_events(200);
+        ASSERT_EQ(s2.recvfrom(buf, sizeof(buf), &from), 100);
+
+        // The fourth packet did not fit into the queue.
+        universe.process_events(1000);
+        ASSERT_EQ(s2.recvfrom(buf, sizeof(buf), &from), 100);
+        ASSERT_EQ(s2.recvfrom(buf, sizeof(buf), &from), -1);
+
+        const NetworkUniverse::LinkStats stats = universe.link_stats();
+        EXPECT_EQ(stats.packets, 3);
+        EXPECT_EQ(stats.queue_drops, 1);
+        EXPECT_EQ(stats.queue_delay_us_max, 200000);
+    }
+
     TEST_F(NetworkUniverseTest, RoutesBasedOnIpAndPort)
     {
         IP ip1{}, ip2{};
@@ -98,6 +98,7 @@ Simulation::Simulation(uint64_t seed)
     , net_(std::make_unique<NetworkUniverse>())
     , seed_(seed)
 {
+    net_->set_seed(seed);
 }
 
 Simulation::~Simulation() = default;
@@ -19,6 +19,11 @@
 #include "../toxcore/network.h"
 #include "../toxcore/util.h"
 
+/**
+ * Largest packet kept around to decode the FEC data of a lost frame from: the
+ * 4 byte sampling rate and one maximum size Opus frame.
+ */
+#define AUDIO_MAX_FEC_PACKET_SIZE (4 + 1275)
 
 struct ACSession {
     Mono_Time *_Nonnull mono_time;
@@ -44,6 +49,13 @@ struct ACSession {
 
     int16_t *_Nullable decode_buffer;
 
+    /* Copy of the packet following a lost one, for FEC decoding outside the queue lock. */
+    uint8_t fec_buffer[AUDIO_MAX_FEC_PACKET_SIZE];
+
+    /* Receive statistics, protected by queue_mutex. */
+    uint64_t concealed_frames;
+    uint64_t fec_recovered_frames;
+
     uint32_t friend_number;
     /* Audio frame receive callback */
     ac_audio_receive_frame_cb *_Nullable acb;
@@ -54,8 +66,11 @@ struct ACSession {
 static struct JitterBuffer *_Nullable jbuf_new(uint32_t capacity);
 static void jbuf_clear(struct JitterBuffer *_Nonnull q);
 static void jbuf_free(struct JitterBuffer *_Nullable q);
-static int jbuf_write(const Logger *_Nonnull log, struct JitterBuffer *_Nonnull q, struct RTPMessage *_Nonnull m);
-static struct RTPMessage *_Nullable jbuf_read(struct JitterBuffer *_Nonnull q, int32_t *_Nonnull success);
+static int jbuf_write(const Logger *_Nonnull log, struct JitterBuffer *_Nonnull q, struct RTPMessage *_Nonnull m,
+                      uint64_t now, uint32_t frame_duration);
+static struct RTPMessage *_Nullable jbuf_read(struct JitterBuffer *_Nonnull q, uint64_t now, int32_t *_Nonnull success);
+static const struct RTPMessage *_Nullable jbuf_peek(const struct JitterBuffer *_Nonnull q);
+static void jbuf_get_stats(const struct JitterBuffer *_Nonnull q, AC_Receive_Stats *_Nonnull stats);
 static OpusEncoder *_Nullable create_audio_encoder(const Logger *_Nonnull log, uint32_t bit_rate, uint32_t sampling_rate,
         uint8_t channel_count);
 static bool reconfigure_audio_encoder(const Logger *_Nonnull log, OpusEncoder *_Nonnull *_Nonnull e, uint32_t new_br, uint32_t new_sr,
@@ -166,35 +181,60 @@ void ac_iterate(ACSession *ac)
         return;
     }
 
-    /* TODO: fix this and jitter buffering */
-
     int rc = 0;
 
     pthread_mutex_lock(ac->queue_mutex);
 
     while (true) {
         struct JitterBuffer *const j_buf = (struct JitterBuffer *)ac->j_buf;
-        struct RTPMessage *msg = jbuf_read(j_buf, &rc);
+        struct RTPMessage *msg = jbuf_read(j_buf, current_time_monotonic(ac->mono_time), &rc);
 
         if (msg == nullptr && rc != 2) {
             break;
         }
 
-        pthread_mutex_unlock(ac->queue_mutex);
+        uint32_t fec_length = 0;
 
         if (rc == 2) {
-            /* Packet Loss Concealment (PLC) */
-            LOGGER_DEBUG(ac->log, "OPUS correction");
+            /* The frame at the head of the buffer is lost. If the packet after
+             * it already arrived, its in-band FEC data can restore the lost
+             * frame. Copy it, it may be freed once we release the lock. */
+            const struct RTPMessage *next = jbuf_peek(j_buf);
+
+            if (next != nullptr && rtp_message_len(next) > 4 && rtp_message_len(next) <= sizeof(ac->fec_buffer)) {
+                uint32_t next_sampling_rate;
+                memcpy(&next_sampling_rate, rtp_message_data(next), 4);
+
+                if (net_ntohl(next_sampling_rate) == ac->lp_sampling_rate) {
+                    fec_length = rtp_message_len(next);
+                    memcpy(ac->fec_buffer, rtp_message_data(next), fec_length);
+                }
+            }
+        }
 
+        pthread_mutex_unlock(ac->queue_mutex);
+
+        bool concealed = false;
+
+        if (rc == 2) {
             /* Use safe defaults or last known good values */
             const uint32_t sampling_rate = ac->lp_sampling_rate;
             const uint32_t frame_duration = ac->lp_frame_duration;
 
             if (sampling_rate == 0 || sampling_rate > AUDIO_MAX_SAMPLE_RATE || frame_duration > AUDIO_MAX_FRAME_DURATION_MS) {
                 LOGGER_WARNING(ac->log, "Invalid PLC parameters: sr %u, dur %u", sampling_rate, frame_duration);
+            } else if (fec_length != 0) {
+                /* Forward Error Correction (FEC) */
+                LOGGER_DEBUG(ac->log, "OPUS FEC");
+                const int fs = (sampling_rate * frame_duration) / 1000;
+                rc = opus_decode(ac->decoder, ac->fec_buffer + 4, fec_length - 4, ac->decode_buffer, fs, 1);
+                concealed = true;
             } else {
+                /* Packet Loss Concealment (PLC) */
+                LOGGER_DEBUG(ac->log, "OPUS correction");
                 const int fs = (sampling_rate * frame_duration) / 1000;
                 rc = opus_decode(ac->decoder, nullptr, 0, ac->decode_buffer, fs, 1);
+                concealed = true;
             }
         } else {
             const uint8_t *msg_data = rtp_message_data(msg);
@@ -202,7 +242,7 @@ void ac_iterate(ACSession *ac)
 
             if (msg_length <= 4) {
                 LOGGER_WARNING(ac->log, "Packet too short: %u", msg_length);
-                free(msg);
+                rtp_message_free(msg);
                 pthread_mutex_lock(ac->queue_mutex);
                 continue;
             }
@@ -217,7 +257,7 @@ void ac_iterate(ACSession *ac)
             if (channels < 1 || channels > AUDIO_MAX_CHANNEL_COUNT ||
                     sampling_rate == 0 || sampling_rate > AUDIO_MAX_SAMPLE_RATE) {
                 LOGGER_WARNING(ac->log, "Invalid packet parameters: sr %u, cc %d", sampling_rate, channels);
-                free(msg);
+                rtp_message_free(msg);
                 pthread_mutex_lock(ac->queue_mutex);
                 continue;
             }
@@ -227,7 +267,7 @@ void ac_iterate(ACSession *ac)
               */
             if (!reconfigure_audio_decoder(ac, sampling_rate, (uint8_t)channels)) {
                 LOGGER_WARNING(ac->log, "Failed to reconfigure decoder!");
-                free(msg);
+                rtp_message_free(msg);
                 pthread_mutex_lock(ac->queue_mutex);
                 continue;
             }
@@ -245,7 +285,7 @@ void ac_iterate(ACSession *ac)
              * into the decoded_frame array
              */
             rc = opus_decode(ac->decoder, msg_data + 4, msg_length - 4, ac->decode_buffer, AUDIO_MAX_BUFFER_SIZE_PCM16, 0);
-            free(msg);
+            rtp_message_free(msg);
         }
 
         if (rc < 0) {
@@ -258,6 +298,14 @@ void ac_iterate(ACSession *ac)
         }
 
         pthread_mutex_lock(ac->queue_mutex);
+
+        if (concealed && rc >= 0) {
+            if (fec_length != 0) {
+                ++ac->fec_recovered_frames;
+            } else {
+                ++ac->concealed_frames;
+            }
+        }
     }
 
     pthread_mutex_unlock(ac->queue_mutex);
@@ -268,29 +316,30 @@ int ac_queue_message(const Mono_Time *mono_time, void *cs, struct RTPMessage *ms
     ACSession *ac = (ACSession *)cs;
 
     if (ac == nullptr || msg == nullptr) {
-        free(msg);
+        rtp_message_free(msg);
         return -1;
     }
 
     if ((rtp_message_pt(msg) & 0x7f) == (RTP_TYPE_AUDIO + 2) % 128) {
         LOGGER_WARNING(ac->log, "Got dummy!");
-        free(msg);
+        rtp_message_free(msg);
         return 0;
     }
 
     if ((rtp_message_pt(msg) & 0x7f) != RTP_TYPE_AUDIO % 128) {
         LOGGER_WARNING(ac->log, "Invalid payload type!");
-        free(msg);
+        rtp_message_free(msg);
         return -1;
     }
 
     pthread_mutex_lock(ac->queue_mutex);
-    const int rc = jbuf_write(ac->log, (struct JitterBuffer *)ac->j_buf, msg);
+    const int rc = jbuf_write(ac->log, (struct JitterBuffer *)ac->j_buf, msg,
+                              current_time_monotonic(mono_time), ac->lp_frame_duration);
     pthread_mutex_unlock(ac->queue_mutex);
 
     if (rc == -1) {
         LOGGER_WARNING(ac->log, "Could not queue the message!");
-        free(msg);
+        rtp_message_free(msg);
         return -1;
     }
 
@@ -316,6 +365,15 @@ uint32_t ac_get_lp_frame_duration(const ACSession *ac)
     return ac->lp_frame_duration;
 }
 
+void ac_get_receive_stats(ACSession *ac, AC_Receive_Stats *stats)
+{
+    pthread_mutex_lock(ac->queue_mutex);
+    jbuf_get_stats((const struct JitterBuffer *)ac->j_buf, stats);
+    stats->concealed_frames = ac->concealed_frames;
+    stats->fec_recovered_frames = ac->fec_recovered_frames;
+    pthread_mutex_unlock(ac->queue_mutex);
+}
+
 int ac_encode(ACSession *ac, const int16_t *pcm, size_t sample_count, uint8_t *dest, size_t dest_max)
 {
     const int vrc = opus_encode(ac->encoder, pcm, (int)sample_count, dest, (int)dest_max);
@@ -327,12 +385,38 @@ int ac_encode(ACSession *ac, const int16_t *pcm, size_t sample_count, uint8_t *d
     return vrc;
 }
 
+/**
+ * Reorders incoming audio packets and decides when a missing one is given up
+ * on and concealed.
+ *
+ * A gap is concealed once more than `capacity` packets are queued behind it,
+ * or once the first packet behind it has waited for `target_delay` ms. The
+ * target delay follows the inter-arrival jitter, so the buffer only adds
+ * latency when the network needs it.
+ */
 struct JitterBuffer {
     struct RTPMessage *_Nullable *_Nonnull queue;
     uint32_t size;
+    /** Current depth limit in packets, between min_capacity and max_capacity. */
     uint32_t capacity;
+    uint32_t min_capacity;
+    uint32_t max_capacity;
     uint16_t bottom;
     uint16_t top;
+
+    /** Interarrival jitter in ms, scaled by 16 (RFC 3550, section 6.4.1). */
+    uint32_t jitter_q4;
+    /** Arrival time minus sender timestamp of the last packet. */
+    uint32_t last_transit;
+    bool has_transit;
+    uint32_t target_delay;
+
+    /** Whether the packet at `bottom` is missing and since when we wait for it. */
+    bool gap_pending;
+    uint64_t gap_since;
+
+    uint64_t late_packets;
+    uint64_t lost_frames;
 };
 
 static struct JitterBuffer *jbuf_new(uint32_t capacity)
@@ -358,16 +442,21 @@ static struct JitterBuffer *jbuf_new(uint32_t capacity)
 
     q->size = size;
     q->capacity = capacity;
+    q->min_capacity = capacity;
+    q->max_capacity = size / 2;
+    q->target_delay = AUDIO_JITTERBUFFER_MIN_DELAY_MS;
     return q;
 }
 
 static void jbuf_clear(struct JitterBuffer *q)
 {
     while (q->bottom != q->top) {
-        free(q->queue[q->bottom % q->size]);
+        rtp_message_free(q->queue[q->bottom % q->size]);
         q->queue[q->bottom % q->size] = nullptr;
         ++q->bottom;
     }
+
+    q->gap_pending = false;
 }
 
 static void jbuf_free(struct JitterBuffer *q)
@@ -381,11 +470,40 @@ static void jbuf_free(struct JitterBuffer *q)
     free(q);
 }
 
+/**
+ * Update the jitter estimate with a packet that arrived at @p now, and derive
+ * the target delay and depth from it.
+ */
+static void jbuf_update_jitter(struct JitterBuffer *_Nonnull q, const struct RTPMessage *_Nonnull m, uint64_t now,
+                               uint32_t frame_duration)
+{
+    const uint32_t transit = (uint32_t)now - rtp_message_timestamp(m);
+
+    if (q->has_transit) {
+        const int32_t d = (int32_t)(transit - q->last_transit);
+        const uint32_t abs_d = d < 0 ? (uint32_t)(-(int64_t)d) : (uint32_t)d;
+        /* J += (|D| - J) / 16, in fixed point. */
+        q->jitter_q4 = q->jitter_q4 + abs_d - ((q->jitter_q4 + 8) >> 4);
+    }
+
+    q->last_transit = transit;
+    q->has_transit = true;
+
+    const uint32_t jitter = q->jitter_q4 >> 4;
+    q->target_delay = max_u32(AUDIO_JITTERBUFFER_MIN_DELAY_MS,
+                              min_u32(jitter * AUDIO_JITTERBUFFER_JITTER_FACTOR, AUDIO_JITTERBUFFER_MAX_DELAY_MS));
+
+    if (frame_duration != 0) {
+        const uint32_t depth = (q->target_delay + frame_duration - 1) / frame_duration;
+        q->capacity = max_u32(q->min_capacity, min_u32(depth, q->max_capacity));
+    }
+}
+
 /*
  * if -1 is returned the RTPMessage m needs to be free'd by the caller
  * if  0 is returned the RTPMessage m is stored in the ringbuffer and must NOT be freed by the caller
  */
-static int jbuf_write(const Logger *log, struct JitterBuffer *q, struct RTPMessage *m)
+static int jbuf_write(const Logger *log, struct JitterBuffer *q, struct RTPMessage *m, uint64_t now, uint32_t frame_duration)
 {
     const uint16_t sequnum = rtp_message_sequnum(m);
 
@@ -394,6 +512,8 @@ static int jbuf_write(const Logger *log, struct JitterBuffer *q, struct RTPMessa
     const int16_t diff = (int16_t)(sequnum - q->bottom);
 
     if (diff < 0) {
+        /* Its turn has passed, it was played (then this is a duplicate) or concealed. */
+        ++q->late_packets;
         return -1;
     }
 
@@ -401,6 +521,7 @@ static int jbuf_write(const Logger *log, struct JitterBuffer *q, struct RTPMessa
         LOGGER_DEBUG(log, "Clearing filled jitter buffer: %p", (void *)q);
 
         jbuf_clear(q);
+        jbuf_update_jitter(q, m, now, frame_duration);
         q->bottom = sequnum - q->capacity;
         q->queue[num] = m;
         q->top = sequnum + 1;
@@ -411,6 +532,7 @@ static int jbuf_write(const Logger *log, struct JitterBuffer *q, struct RTPMessa
         return -1;
     }
 
+    jbuf_update_jitter(q, m, now, frame_duration);
     q->queue[num] = m;
 
     if ((sequnum - q->bottom) >= (q->top - q->bottom)) {
@@ -420,9 +542,11 @@ static int jbuf_write(const Logger *log, struct JitterBuffer *q, struct RTPMessa
     return 0;
 }
 
-static struct RTPMessage *jbuf_read(struct JitterBuffer *q, int32_t *success)
+static struct RTPMessage *jbuf_read(struct JitterBuffer *q, uint64_t now, int32_t *success)
 {
     if (q->top == q->bottom) {
+        /* Nothing left to wait for, the next missing packet starts a new gap. */
+        q->gap_pending = false;
         *success = 0;
         return nullptr;
     }
@@ -433,12 +557,26 @@ static struct RTPMessage *jbuf_read(struct JitterBuffer *q, int32_t *success)
         struct RTPMessage *ret = q->queue[num];
         q->queue[num] = nullptr;
         ++q->bottom;
+        q->gap_pending = false;
         *success = 1;
         return ret;
     }
 
-    if ((uint16_t)(q->top - q->bottom) > q->capacity) {
+    if (!q->gap_pending) {
+        q->gap_pending = true;
+        q->gap_since = now;
+    }
+
+    /* Once a gap waited long enough, every frame in it is concealed right
+     * away: the packets behind it are late already. */
+    if ((uint16_t)(q->top - q->bottom) > q->capacity || now - q->gap_since >= q->target_delay) {
         ++q->bottom;
+        ++q->lost_frames;
+
+        if (q->bottom == q->top) {
+            q->gap_pending = false;
+        }
+
         *success = 2;
         return nullptr;
     }
@@ -446,6 +584,25 @@ static struct RTPMessage *jbuf_read(struct JitterBuffer *q, int32_t *success)
     *success = 0;
     return nullptr;
 }
+
+/** The packet that is played next, if it already arrived. */
+static const struct RTPMessage *jbuf_peek(const struct JitterBuffer *q)
+{
+    if (q->top == q->bottom) {
+        return nullptr;
+    }
+
+    return q->queue[q->bottom % q->size];
+}
+
+static void jbuf_get_stats(const struct JitterBuffer *q, AC_Receive_Stats *stats)
+{
+    stats->late_packets = q->late_packets;
+    stats->lost_frames = q->lost_frames;
+    stats->jitter = q->jitter_q4 >> 4;
+    stats->target_delay = q->target_delay;
+}
+
 static OpusEncoder *create_audio_encoder(const Logger *log, uint32_t bit_rate, uint32_t sampling_rate,
         uint8_t channel_count)
 {
@@ -15,7 +15,13 @@
 extern "C" {
 #endif
 
+/** Minimum number of packets the jitter buffer holds behind a missing one before concealing it. */
 #define AUDIO_JITTERBUFFER_COUNT 3
+/** Bounds of the time a missing packet is waited for. */
+#define AUDIO_JITTERBUFFER_MIN_DELAY_MS 10
+#define AUDIO_JITTERBUFFER_MAX_DELAY_MS 200
+/** The wait time is this multiple of the measured interarrival jitter. */
+#define AUDIO_JITTERBUFFER_JITTER_FACTOR 4
 #define AUDIO_MAX_SAMPLE_RATE 48000
 #define AUDIO_MAX_CHANNEL_COUNT 2
 
@@ -40,6 +46,21 @@ typedef void ac_audio_receive_frame_cb(uint32_t friend_number, const int16_t *_N
 
 typedef struct ACSession ACSession;
 
+typedef struct AC_Receive_Stats {
+    /** Packets that arrived after their frame was played or concealed. */
+    uint64_t late_packets;
+    /** Frames that were missing when it was their turn to be played. */
+    uint64_t lost_frames;
+    /** Lost frames filled in by Opus packet loss concealment. */
+    uint64_t concealed_frames;
+    /** Lost frames restored from the in-band FEC data of the next packet. */
+    uint64_t fec_recovered_frames;
+    /** Current interarrival jitter estimate in ms. */
+    uint32_t jitter;
+    /** How long a missing packet is currently waited for in ms. */
+    uint32_t target_delay;
+} AC_Receive_Stats;
+
 struct RTPMessage;
 
 ACSession *_Nullable ac_new(Mono_Time *_Nonnull mono_time, const Logger *_Nonnull log, uint32_t friend_number,
@@ -50,6 +71,7 @@ int ac_queue_message(const Mono_Time *_Nonnull mono_time, void *_Nullable cs, st
 int ac_reconfigure_encoder(ACSession *_Nullable ac, uint32_t bit_rate, uint32_t sampling_rate, uint8_t channels);
 
 uint32_t ac_get_lp_frame_duration(const ACSession *_Nonnull ac);
+void ac_get_receive_stats(ACSession *_Nonnull ac, AC_Receive_Stats *_Nonnull stats);
 
 int ac_encode(ACSession *_Nonnull ac, const int16_t *_Nonnull pcm, size_t sample_count, uint8_t *_Nonnull dest, size_t dest_max);
 
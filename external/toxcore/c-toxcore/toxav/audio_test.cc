@@ -807,4 +807,112 @@ TEST_F(AudioTest, JitterBufferWrapAround)
     ac_kill(ac);
 }
 
+TEST_F(AudioTest, JitterBufferConcealsGapAfterTargetDelay)
+{
+    AudioTestData data;
+    ACSession *ac = ac_new(mono_time, log, 123, AudioTestData::receive_frame, &data);
+    ASSERT_NE(ac, nullptr);
+
+    RtpMock rtp_mock;
+    rtp_mock.auto_forward = false;
+    RTPSession *send_rtp = rtp_new(log, RTP_TYPE_AUDIO, mono_time, RtpMock::send_packet, &rtp_mock,
+        nullptr, nullptr, nullptr, ac, RtpMock::audio_cb);
+    RTPSession *recv_rtp = rtp_new(log, RTP_TYPE_AUDIO, mono_time, RtpMock::send_packet, &rtp_mock,
+        nullptr, nullptr, nullptr, ac, RtpMock::audio_cb);
+    rtp_mock.recv_session = recv_rtp;
+
+    std::uint8_t dummy_data[100] = {0};
+    std::uint32_t net_sr = net_htonl(48000);
+    std::memcpy(dummy_data, &net_sr, 4);
+
+    for (int i = 0; i < 3; ++i) {
+        rtp_send_data(log, send_rtp, dummy_data, sizeof(dummy_data), false);
+    }
+
+    // Packet 1 is missing, packet 2 is already here.
+    rtp_receive_packet(
+        recv_rtp, rtp_mock.captured_packets[0].data(), rtp_mock.captured_packets[0].size());
+    rtp_receive_packet(
+        recv_rtp, rtp_mock.captured_packets[2].data(), rtp_mock.captured_packets[2].size());
+
+    ac_iterate(ac);
+    AC_Receive_Stats stats;
+    ac_get_receive_stats(ac, &stats);
+    EXPECT_EQ(stats.lost_frames, 0u);
+
+    // Once the gap waited for the target delay, packet 1 is restored from the
+    // FEC data in packet 2, then packet 2 is played.
+    tm.t += AUDIO_JITTERBUFFER_MIN_DELAY_MS;
+    mono_time_update(mono_time);
+    ac_iterate(ac);
+
+    ac_get_receive_stats(ac, &stats);
+    EXPECT_EQ(stats.lost_frames, 1u);
+    EXPECT_EQ(stats.fec_recovered_frames, 1u);
+    EXPECT_EQ(stats.concealed_frames, 0u);
+
+    // Packet 1 finally shows up, too late.
+    rtp_receive_packet(
+        recv_rtp, rtp_mock.captured_packets[1].data(), rtp_mock.captured_packets[1].size());
+    ac_get_receive_stats(ac, &stats);
+    EXPECT_EQ(stats.late_packets, 1u);
+
+    rtp_kill(log, send_rtp);
+    rtp_kill(log, recv_rtp);
+    ac_kill(ac);
+}
+
+TEST_F(AudioTest, JitterBufferTargetDelayFollowsJitter)
+{
+    AudioTestData data;
+    ACSession *ac = ac_new(mono_time, log, 123, AudioTestData::receive_frame, &data);
+    ASSERT_NE(ac, nullptr);
+
+    RtpMock rtp_mock;
+    rtp_mock.auto_forward = false;
+    RTPSession *send_rtp = rtp_new(log, RTP_TYPE_AUDIO, mono_time, RtpMock::send_packet, &rtp_mock,
+        nullptr, nullptr, nullptr, ac, RtpMock::audio_cb);
+    RTPSession *recv_rtp = rtp_new(log, RTP_TYPE_AUDIO, mono_time, RtpMock::send_packet, &rtp_mock,
+        nullptr, nullptr, nullptr, ac, RtpMock::audio_cb);
+    rtp_mock.recv_session = recv_rtp;
+
+    std::uint8_t dummy_data[100] = {0};
+    std::uint32_t net_sr = net_htonl(48000);
+    std::memcpy(dummy_data, &net_sr, 4);
+
+    // One packet every 20ms, every other one is delayed by 15ms.
+    const auto send_frames = [&](int count, std::uint64_t odd_delay) {
+        for (int i = 0; i < count; ++i) {
+            rtp_send_data(log, send_rtp, dummy_data, sizeof(dummy_data), false);
+            const std::uint64_t delay = (i % 2 == 1) ? odd_delay : 0;
+            tm.t += delay;
+            mono_time_update(mono_time);
+            rtp_receive_packet(recv_rtp, rtp_mock.captured_packets.back().data(),
+                rtp_mock.captured_packets.back().size());
+            ac_iterate(ac);
+            tm.t += 20 - delay;
+            mono_time_update(mono_time);
+        }
+    };
+
+    send_frames(50, 15);
+
+    AC_Receive_Stats stats;
+    ac_get_receive_stats(ac, &stats);
+    EXPECT_GE(stats.jitter, 10u);
+    EXPECT_GE(stats.target_delay, 40u);
+    EXPECT_EQ(stats.lost_frames, 0u);
+
+    // The network calms down, so the buffer stops waiting that long.
+    send_frames(100, 0);
+
+    ac_get_receive_stats(ac, &stats);
+    EXPECT_EQ(stats.jitter, 0u);
+    EXPECT_EQ(stats.target_delay, AUDIO_JITTERBUFFER_MIN_DELAY_MS);
+
+    rtp_kill(log, send_rtp);
+    rtp_kill(log, recv_rtp);
+    ac_kill(ac);
+}
+
 }  // namespace
@@ -81,7 +81,7 @@ int RtpMock::video_cb(
 int RtpMock::noop_cb(
     const Mono_Time *_Nonnull /*mono_time*/, void *_Nullable /*cs*/, RTPMessage *_Nonnull msg)
 {
-    std::free(msg);
+    rtp_message_free(msg);
     return 0;
 }
 
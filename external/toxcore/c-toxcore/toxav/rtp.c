@@ -5,6 +5,7 @@
 #include "rtp.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -25,6 +26,26 @@
  */
 #define MAX_RTP_FRAME_SIZE (32 * 1024 * 1024)
 
+/**
+ * Received messages are allocated in power of two size classes, from 256 bytes
+ * (about one audio frame) up to MAX_RTP_FRAME_SIZE.
+ */
+#define RTP_POOL_MIN_CLASS_SHIFT 8
+#define RTP_POOL_MAX_CLASS_SHIFT 25
+#define RTP_POOL_CLASS_COUNT (RTP_POOL_MAX_CLASS_SHIFT - RTP_POOL_MIN_CLASS_SHIFT + 1)
+
+/**
+ * Number of released buffers kept per size class. The decoder holds on to at
+ * most a few frames, plus the ones being assembled in the work buffers.
+ */
+#define RTP_POOL_MAX_FREE_PER_CLASS 4
+
+/**
+ * Upper bound on the memory a session keeps in released buffers, so a burst of
+ * huge key frames does not stay allocated for the rest of the call.
+ */
+#define RTP_POOL_MAX_CACHED_BYTES (8 * 1024 * 1024)
+
 struct RTPHeader {
     /* Standard RTP header */
     unsigned ve: 2; /* Version has only 2 bits! */
@@ -72,7 +93,19 @@ struct RTPHeader {
     uint16_t data_length_lower;
 };
 
+struct RTPMessagePool;
+
 struct RTPMessage {
+    /**
+     * The pool this message is returned to by `rtp_message_free`.
+     */
+    struct RTPMessagePool *_Nonnull pool;
+    /**
+     * Size class of the buffer, the capacity of `data` is
+     * `1 << (size_class + RTP_POOL_MIN_CLASS_SHIFT)` bytes.
+     */
+    uint8_t size_class;
+
     /**
      * This is used in the old code that doesn't deal with large frames, i.e.
      * the audio code or receiving code for old 16 bit messages. We use it to
@@ -85,6 +118,28 @@ struct RTPMessage {
     uint8_t data[];
 };
 
+/**
+ * Per session free lists of released messages.
+ *
+ * Messages are handed to the decoder, which may release them on a different
+ * thread than the one receiving packets, and they can outlive the session: the
+ * video ring buffer and the audio jitter buffer are drained after `rtp_kill`.
+ * The pool is therefore only freed once it is closed and the last outstanding
+ * message came back.
+ */
+typedef struct RTPMessagePool {
+    pthread_mutex_t mutex;
+
+    struct RTPMessage *_Nullable free_list[RTP_POOL_CLASS_COUNT][RTP_POOL_MAX_FREE_PER_CLASS];
+    uint8_t free_count[RTP_POOL_CLASS_COUNT];
+    size_t cached_bytes;
+
+    uint64_t allocations;
+    uint64_t reuses;
+    uint32_t outstanding;
+    bool closed;
+} RTPMessagePool;
+
 /**
  * One slot in the work buffer list. Represents one frame that is currently
  * being assembled.
@@ -124,6 +179,7 @@ struct RTPSession {
     struct RTPMessage *_Nullable mp; /* Expected parted message */
     struct RTPWorkBufferList *_Nonnull work_buffer_list;
     uint8_t  first_packets_counter; /* dismiss first few lost video packets */
+    RTPMessagePool *_Nonnull pool;
     const Logger *_Nonnull log;
     Mono_Time *_Nonnull mono_time;
     bool rtp_receive_active; /* if this is set to false then incoming rtp packets will not be processed by rtp_receive_packet() */
@@ -159,6 +215,11 @@ uint16_t rtp_message_sequnum(const RTPMessage *msg)
     return msg->header.sequnum;
 }
 
+uint32_t rtp_message_timestamp(const RTPMessage *msg)
+{
+    return msg->header.timestamp;
+}
+
 uint64_t rtp_message_flags(const RTPMessage *msg)
 {
     return msg->header.flags;
@@ -187,6 +248,173 @@ void rtp_session_set_ssrc(RTPSession *session, uint32_t ssrc)
     session->ssrc = ssrc;
 }
 
+void rtp_session_get_pool_stats(const RTPSession *session, RTP_Pool_Stats *stats)
+{
+    RTPMessagePool *pool = session->pool;
+
+    pthread_mutex_lock(&pool->mutex);
+    stats->allocations = pool->allocations;
+    stats->reuses = pool->reuses;
+    stats->outstanding = pool->outstanding;
+    stats->cached_bytes = pool->cached_bytes;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static size_t rtp_pool_class_size(uint8_t size_class)
+{
+    return (size_t)1 << (size_class + RTP_POOL_MIN_CLASS_SHIFT);
+}
+
+static uint8_t rtp_pool_size_class(size_t size)
+{
+    uint8_t size_class = 0;
+
+    while (rtp_pool_class_size(size_class) < size) {
+        ++size_class;
+    }
+
+    return size_class;
+}
+
+static RTPMessagePool *_Nullable rtp_pool_new(void)
+{
+    RTPMessagePool *pool = (RTPMessagePool *)calloc(1, sizeof(RTPMessagePool));
+
+    if (pool == nullptr) {
+        return nullptr;
+    }
+
+    if (pthread_mutex_init(&pool->mutex, nullptr) != 0) {
+        free(pool);
+        return nullptr;
+    }
+
+    return pool;
+}
+
+static void rtp_pool_free(RTPMessagePool *_Nonnull pool)
+{
+    for (uint8_t i = 0; i < RTP_POOL_CLASS_COUNT; ++i) {
+        for (uint8_t j = 0; j < pool->free_count[i]; ++j) {
+            free(pool->free_list[i][j]);
+        }
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+}
+
+/**
+ * @brief Stop caching released messages, the session is going away.
+ *
+ * Frees the pool right away if no message is outstanding, otherwise the last
+ * `rtp_message_free` does.
+ */
+static void rtp_pool_close(RTPMessagePool *_Nonnull pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->closed = true;
+
+    for (uint8_t i = 0; i < RTP_POOL_CLASS_COUNT; ++i) {
+        for (uint8_t j = 0; j < pool->free_count[i]; ++j) {
+            free(pool->free_list[i][j]);
+            pool->free_list[i][j] = nullptr;
+        }
+
+        pool->free_count[i] = 0;
+    }
+
+    pool->cached_bytes = 0;
+
+    const bool unused = pool->outstanding == 0;
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (unused) {
+        rtp_pool_free(pool);
+    }
+}
+
+/**
+ * @brief Take a message with room for at least @p data_len bytes from the pool.
+ *
+ * Only the message header is cleared. Unlike with the `calloc` this replaces,
+ * a reused buffer still holds data of an earlier frame of the same session,
+ * which is what the decoder sees for pieces of a frame that never arrived.
+ */
+static struct RTPMessage *_Nullable rtp_pool_acquire(RTPMessagePool *_Nonnull pool, size_t data_len)
+{
+    if (data_len > MAX_RTP_FRAME_SIZE) {
+        return nullptr;
+    }
+
+    const uint8_t size_class = rtp_pool_size_class(data_len);
+    struct RTPMessage *msg = nullptr;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    if (pool->free_count[size_class] > 0) {
+        --pool->free_count[size_class];
+        msg = pool->free_list[size_class][pool->free_count[size_class]];
+        pool->free_list[size_class][pool->free_count[size_class]] = nullptr;
+        pool->cached_bytes -= rtp_pool_class_size(size_class);
+        ++pool->reuses;
+        ++pool->outstanding;
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (msg == nullptr) {
+        msg = (struct RTPMessage *)malloc(sizeof(struct RTPMessage) + rtp_pool_class_size(size_class));
+
+        if (msg == nullptr) {
+            return nullptr;
+        }
+
+        pthread_mutex_lock(&pool->mutex);
+        ++pool->allocations;
+        ++pool->outstanding;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    memset(msg, 0, sizeof(struct RTPMessage));
+    msg->pool = pool;
+    msg->size_class = size_class;
+    return msg;
+}
+
+void rtp_message_free(RTPMessage *msg)
+{
+    if (msg == nullptr) {
+        return;
+    }
+
+    RTPMessagePool *pool = msg->pool;
+    const uint8_t size_class = msg->size_class;
+    const size_t size = rtp_pool_class_size(size_class);
+
+    pthread_mutex_lock(&pool->mutex);
+    assert(pool->outstanding > 0);
+    --pool->outstanding;
+
+    if (!pool->closed
+            && pool->free_count[size_class] < RTP_POOL_MAX_FREE_PER_CLASS
+            && pool->cached_bytes + size <= RTP_POOL_MAX_CACHED_BYTES) {
+        pool->free_list[size_class][pool->free_count[size_class]] = msg;
+        ++pool->free_count[size_class];
+        pool->cached_bytes += size;
+        msg = nullptr;
+    }
+
+    const bool last = pool->closed && pool->outstanding == 0;
+    pthread_mutex_unlock(&pool->mutex);
+
+    free(msg);
+
+    if (last) {
+        rtp_pool_free(pool);
+    }
+}
+
 /**
  * The number of milliseconds we want to keep a keyframe in the buffer for,
  * even though there are no free slots for incoming frames.
@@ -194,7 +422,8 @@ void rtp_session_set_ssrc(RTPSession *session, uint32_t ssrc)
 #define VIDEO_KEEP_KEYFRAME_IN_BUFFER_FOR_MS 15
 
 // allocate_len is NOT including header!
-static struct RTPMessage *_Nullable new_message(const Logger *_Nonnull log, const struct RTPHeader *_Nonnull header, size_t allocate_len,
+static struct RTPMessage *_Nullable new_message(const Logger *_Nonnull log, RTPMessagePool *_Nonnull pool,
+        const struct RTPHeader *_Nonnull header, size_t allocate_len,
         const uint8_t *_Nonnull data, uint16_t data_length)
 {
     if (allocate_len < data_length) {
@@ -202,7 +431,7 @@ static struct RTPMessage *_Nullable new_message(const Logger *_Nonnull log, cons
         return nullptr;
     }
 
-    struct RTPMessage *msg = (struct RTPMessage *)calloc(1, sizeof(struct RTPMessage) + allocate_len);
+    struct RTPMessage *msg = rtp_pool_acquire(pool, allocate_len);
 
     if (msg == nullptr) {
         LOGGER_WARNING(log, "Could not allocate RTPMessage buffer");
@@ -351,7 +580,7 @@ static int8_t get_slot(const Logger *_Nonnull log, struct RTPWorkBufferList *_No
  *
  * If there are no frames ready, we return NULL. If this function returns
  * non-NULL, it transfers ownership of the message to the caller, i.e. the
- * caller is responsible for storing it elsewhere or calling `free()`.
+ * caller is responsible for storing it elsewhere or calling `rtp_message_free()`.
  */
 static struct RTPMessage *_Nullable process_frame(const Logger *_Nonnull log, struct RTPWorkBufferList *_Nonnull wkbl, uint8_t slot_id)
 {
@@ -402,6 +631,7 @@ static struct RTPMessage *_Nullable process_frame(const Logger *_Nonnull log, st
 
 /**
  * @param log A pointer to the Logger object.
+ * @param pool The pool new frame buffers are taken from.
  * @param wkbl The list of in-progress frames, i.e. all the slots.
  * @param slot_id The slot we want to fill the data into.
  * @param is_keyframe Whether the data is part of a key frame.
@@ -409,7 +639,8 @@ static struct RTPMessage *_Nullable process_frame(const Logger *_Nonnull log, st
  * @param incoming_data The pure payload without header.
  * @param incoming_data_length The length in bytes of the incoming data payload.
  */
-static bool fill_data_into_slot(const Logger *_Nonnull log, struct RTPWorkBufferList *_Nonnull wkbl, const uint8_t slot_id,
+static bool fill_data_into_slot(const Logger *_Nonnull log, RTPMessagePool *_Nonnull pool,
+                                struct RTPWorkBufferList *_Nonnull wkbl, const uint8_t slot_id,
                                 bool is_keyframe, const struct RTPHeader *_Nonnull header,
                                 const uint8_t *_Nonnull incoming_data, uint16_t incoming_data_length)
 {
@@ -429,9 +660,9 @@ static bool fill_data_into_slot(const Logger *_Nonnull log, struct RTPWorkBuffer
             return false;
         }
 
-        // No data for this slot has been received, yet, so we create a new
-        // message for it with enough memory for the entire frame.
-        struct RTPMessage *msg = (struct RTPMessage *)calloc(1, sizeof(struct RTPMessage) + header->data_length_full);
+        // No data for this slot has been received, yet, so we take a message
+        // with enough memory for the entire frame from the pool.
+        struct RTPMessage *msg = rtp_pool_acquire(pool, header->data_length_full);
 
         if (msg == nullptr) {
             LOGGER_ERROR(log, "Out of memory while trying to allocate for frame of size %u",
@@ -589,6 +820,7 @@ static int handle_video_packet(const Logger *_Nonnull log, RTPSession *_Nonnull
     // fill in this part into the slot buffer at the correct offset
     if (!fill_data_into_slot(
                 log,
+                session->pool,
                 session->work_buffer_list,
                 slot_id,
                 is_keyframe,
@@ -695,7 +927,7 @@ void rtp_receive_packet(RTPSession *session, const uint8_t *data, size_t length)
         /* The message came in the allowed time;
          */
 
-        session->mp = new_message(log, &header, payload_size - RTP_HEADER_SIZE, &payload[RTP_HEADER_SIZE], payload_size - RTP_HEADER_SIZE);
+        session->mp = new_message(log, session->pool, &header, payload_size - RTP_HEADER_SIZE, &payload[RTP_HEADER_SIZE], payload_size - RTP_HEADER_SIZE);
         session->mcb(session->mono_time, session->cs, session->mp);
         session->mp = nullptr;
         return;
@@ -774,7 +1006,7 @@ NEW_MULTIPARTED:
 
         /* Store message.
          */
-        session->mp = new_message(log, &header, header.data_length_lower, &payload[RTP_HEADER_SIZE], payload_size - RTP_HEADER_SIZE);
+        session->mp = new_message(log, session->pool, &header, header.data_length_lower, &payload[RTP_HEADER_SIZE], payload_size - RTP_HEADER_SIZE);
 
         if (session->mp != nullptr) {
             memmove(session->mp->data + header.offset_lower, session->mp->data, session->mp->len);
@@ -875,6 +1107,15 @@ RTPSession *rtp_new(const Logger *log, int payload_type, Mono_Time *mono_time,
         return nullptr;
     }
 
+    session->pool = rtp_pool_new();
+
+    if (session->pool == nullptr) {
+        LOGGER_ERROR(log, "out of memory while allocating message pool");
+        free(session->work_buffer_list);
+        free(session);
+        return nullptr;
+    }
+
     // First entry is free.
     session->work_buffer_list->next_free_entry = 0;
 
@@ -914,11 +1155,12 @@ void rtp_kill(const Logger *log, RTPSession *session)
 
     if (session->work_buffer_list != nullptr) {
         for (int8_t i = 0; i < session->work_buffer_list->next_free_entry; ++i) {
-            free(session->work_buffer_list->work_buffer[i].buf);
+            rtp_message_free(session->work_buffer_list->work_buffer[i].buf);
         }
         free(session->work_buffer_list);
     }
-    free(session->mp);
+    rtp_message_free(session->mp);
+    rtp_pool_close(session->pool);
     free(session);
 }
 
@@ -60,14 +60,41 @@ const uint8_t *_Nonnull rtp_message_data(const RTPMessage *_Nonnull msg);
 uint32_t rtp_message_len(const RTPMessage *_Nonnull msg);
 uint8_t rtp_message_pt(const RTPMessage *_Nonnull msg);
 uint16_t rtp_message_sequnum(const RTPMessage *_Nonnull msg);
+uint32_t rtp_message_timestamp(const RTPMessage *_Nonnull msg);
 uint64_t rtp_message_flags(const RTPMessage *_Nonnull msg);
 uint32_t rtp_message_data_length_full(const RTPMessage *_Nonnull msg);
 
+/**
+ * @brief Release a message that was passed to an `rtp_m_cb`.
+ *
+ * Received messages are taken from a buffer pool owned by the session that
+ * assembled them, so they must be released with this function and not with
+ * `free()`. Releasing a message after its session was killed is fine, the
+ * buffer is then freed directly.
+ */
+void rtp_message_free(RTPMessage *_Nullable msg);
+
 /* RTPSession accessors */
 bool rtp_session_is_receiving_active(const RTPSession *_Nullable session);
 uint32_t rtp_session_get_ssrc(const RTPSession *_Nonnull session);
 void rtp_session_set_ssrc(RTPSession *_Nonnull session, uint32_t ssrc);
 
+/**
+ * Counters of the receive buffer pool of an RTP session.
+ */
+typedef struct RTP_Pool_Stats {
+    /** Number of buffers that had to be allocated from the system. */
+    uint64_t allocations;
+    /** Number of buffers that were taken from the pool instead. */
+    uint64_t reuses;
+    /** Number of buffers currently held by the receiving side or the decoder. */
+    uint32_t outstanding;
+    /** Bytes of released buffers kept for reuse. */
+    size_t cached_bytes;
+} RTP_Pool_Stats;
+
+void rtp_session_get_pool_stats(const RTPSession *_Nonnull session, RTP_Pool_Stats *_Nonnull stats);
+
 #define USED_RTP_WORKBUFFER_COUNT 3
 #define DISMISS_FIRST_LOST_VIDEO_PACKET_COUNT 10
 
@@ -4,9 +4,11 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <random>
 #include <vector>
 
 #include "../toxcore/attributes.h"
@@ -71,6 +73,80 @@ BENCHMARK_DEFINE_F(RtpBench, ReceivePacket)(benchmark::State &state)
 }
 BENCHMARK_REGISTER_F(RtpBench, ReceivePacket)->Arg(100)->Arg(1000);
 
+/**
+ * Reassembles video frames of state.range(0) bytes. The packets of each frame
+ * are shuffled if state.range(1) is set, and state.range(2) percent of them
+ * are dropped, so some frames reach the decoder incomplete, either when a
+ * newer frame evicts them from the work buffer or when their last packet is
+ * lost.
+ */
+BENCHMARK_DEFINE_F(RtpBench, ReassembleFrames)(benchmark::State &state)
+{
+    constexpr std::size_t kFrames = 64;
+    const std::size_t frame_size = static_cast<std::size_t>(state.range(0));
+    const bool reorder = state.range(1) != 0;
+    const int loss_percent = static_cast<int>(state.range(2));
+
+    RtpMock sender_mock;
+    sender_mock.auto_forward = false;
+    RTPSession *sender = rtp_new(log, RTP_TYPE_VIDEO, mono_time, RtpMock::send_packet,
+        &sender_mock, nullptr, nullptr, nullptr, &sender_mock, RtpMock::noop_cb);
+
+    if (sender == nullptr) {
+        state.SkipWithError("rtp_new failed");
+        return;
+    }
+
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<std::uint8_t> data(frame_size, 0xAA);
+    std::vector<std::vector<std::vector<std::uint8_t>>> frames(kFrames);
+
+    for (auto &frame : frames) {
+        sender_mock.captured_packets.clear();
+        rtp_send_data(log, sender, data.data(), static_cast<std::uint32_t>(data.size()), false);
+
+        for (auto &packet : sender_mock.captured_packets) {
+            if (percent(rng) >= loss_percent) {
+                frame.push_back(std::move(packet));
+            }
+        }
+
+        if (reorder) {
+            std::shuffle(frame.begin(), frame.end(), rng);
+        }
+    }
+
+    rtp_kill(log, sender);
+
+    RTP_Pool_Stats before;
+    rtp_session_get_pool_stats(session, &before);
+
+    std::size_t next = 0;
+
+    for (auto _ : state) {
+        for (const auto &packet : frames[next]) {
+            rtp_receive_packet(session, packet.data(), packet.size());
+        }
+
+        next = (next + 1) % kFrames;
+    }
+
+    RTP_Pool_Stats after;
+    rtp_session_get_pool_stats(session, &after);
+
+    const double allocations = static_cast<double>(after.allocations - before.allocations);
+    const double buffers = allocations + static_cast<double>(after.reuses - before.reuses);
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * frame_size));
+    state.counters["allocs_per_frame"]
+        = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+    state.counters["pool_hit_rate"] = benchmark::Counter(buffers > 0 ? 1.0 - allocations / buffers : 0.0);
+}
+BENCHMARK_REGISTER_F(RtpBench, ReassembleFrames)
+    ->ArgNames({"size", "reorder", "loss"})
+    ->ArgsProduct({{10000, 100000, 500000}, {0, 1}, {0, 5}});
+
 }  // namespace
 
 BENCHMARK_MAIN();
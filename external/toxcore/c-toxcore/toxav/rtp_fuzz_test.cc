@@ -27,7 +27,7 @@ static int mock_send_packet(
 static int mock_m_cb(
     const Mono_Time *_Nonnull /*mono_time*/, void *_Nullable /*cs*/, RTPMessage *_Nonnull msg)
 {
-    std::free(msg);
+    rtp_message_free(msg);
     return 0;
 }
 
@@ -67,7 +67,7 @@ static int mock_m_cb(
     sd->received_full_lengths.push_back(full_len);
     sd->received_sequnums.push_back(rtp_message_sequnum(msg));
 
-    std::free(msg);
+    rtp_message_free(msg);
     return 0;
 }
 
@@ -239,6 +239,76 @@ TEST_F(RtpPublicTest, SsrcAccessors)
     rtp_kill(log, session);
 }
 
+TEST_F(RtpPublicTest, ReceivedFramesReusePooledBuffers)
+{
+    MockSessionData sd;
+    RTPSession *session = rtp_new(log, RTP_TYPE_VIDEO, mono_time, mock_send_packet, &sd,
+        mock_add_recv, mock_add_lost, &sd, &sd, mock_m_cb);
+
+    const std::uint32_t frame_size = MAX_CRYPTO_DATA_SIZE * 3;
+    std::vector<std::uint8_t> data(frame_size, 0x42);
+
+    for (int i = 0; i < 10; ++i) {
+        sd.sent_packets.clear();
+        rtp_send_data(log, session, data.data(), frame_size, false);
+
+        for (const auto &pkt : sd.sent_packets) {
+            rtp_receive_packet(session, pkt.data(), pkt.size());
+        }
+    }
+
+    ASSERT_EQ(sd.received_frames.size(), 10);
+    EXPECT_EQ(sd.received_frames.back(), data);
+
+    RTP_Pool_Stats stats;
+    rtp_session_get_pool_stats(session, &stats);
+    EXPECT_EQ(stats.allocations, 1);
+    EXPECT_EQ(stats.reuses, 9);
+    EXPECT_EQ(stats.outstanding, 0);
+    EXPECT_GE(stats.cached_bytes, frame_size);
+
+    rtp_kill(log, session);
+}
+
+static int keep_message_cb(
+    const Mono_Time *_Nonnull /*mono_time*/, void *_Nullable cs, RTPMessage *_Nonnull msg)
+{
+    static_cast<std::vector<RTPMessage *> *>(cs)->push_back(msg);
+    return 0;
+}
+
+TEST_F(RtpPublicTest, MessagesCanOutliveTheirSession)
+{
+    MockSessionData sd;
+    std::vector<RTPMessage *> kept;
+    RTPSession *session = rtp_new(log, RTP_TYPE_AUDIO, mono_time, mock_send_packet, &sd,
+        mock_add_recv, mock_add_lost, &sd, &kept, keep_message_cb);
+
+    std::uint8_t data[] = "Hello RTP";
+
+    for (int i = 0; i < 3; ++i) {
+        rtp_send_data(log, session, data, sizeof(data), false);
+    }
+
+    for (const auto &pkt : sd.sent_packets) {
+        rtp_receive_packet(session, pkt.data(), pkt.size());
+    }
+
+    ASSERT_EQ(kept.size(), 3);
+
+    RTP_Pool_Stats stats;
+    rtp_session_get_pool_stats(session, &stats);
+    EXPECT_EQ(stats.outstanding, 3);
+
+    rtp_kill(log, session);
+
+    // The decoder may still hold frames when the call ends.
+    for (RTPMessage *msg : kept) {
+        EXPECT_EQ(rtp_message_len(msg), sizeof(data));
+        rtp_message_free(msg);
+    }
+}
+
 TEST_F(RtpPublicTest, LargeAudioFragmentationOldProtocol)
 {
     MockSessionData sd;
@@ -1260,6 +1260,66 @@ void toxav_callback_video_receive_frame(ToxAV *_Nonnull av, toxav_video_receive_
     pthread_mutex_unlock(av->mutex);
 }
 
+uint64_t toxav_call_get_audio_receive_stat(ToxAV *_Nonnull av, Tox_Friend_Number friend_number, Toxav_Audio_Receive_Stat stat,
+        Toxav_Err_Call_Stats *_Nullable error)
+{
+    Toxav_Err_Call_Stats rc = TOXAV_ERR_CALL_STATS_OK;
+    AC_Receive_Stats stats = {0};
+    uint64_t value = 0;
+    ToxAVCall *call;
+
+    if (!tox_friend_exists(av->tox, friend_number)) {
+        rc = TOXAV_ERR_CALL_STATS_FRIEND_NOT_FOUND;
+        goto RETURN;
+    }
+
+    pthread_mutex_lock(av->mutex);
+    call = call_get(av, friend_number);
+
+    if (call == nullptr || !call->active || call->audio == nullptr) {
+        pthread_mutex_unlock(av->mutex);
+        rc = TOXAV_ERR_CALL_STATS_FRIEND_NOT_IN_CALL;
+        goto RETURN;
+    }
+
+    ac_get_receive_stats(call->audio, &stats);
+    pthread_mutex_unlock(av->mutex);
+
+    switch (stat) {
+        case TOXAV_AUDIO_RECEIVE_STAT_LATE_PACKETS:
+            value = stats.late_packets;
+            break;
+
+        case TOXAV_AUDIO_RECEIVE_STAT_LOST_FRAMES:
+            value = stats.lost_frames;
+            break;
+
+        case TOXAV_AUDIO_RECEIVE_STAT_CONCEALED_FRAMES:
+            value = stats.concealed_frames;
+            break;
+
+        case TOXAV_AUDIO_RECEIVE_STAT_FEC_RECOVERED_FRAMES:
+            value = stats.fec_recovered_frames;
+            break;
+
+        case TOXAV_AUDIO_RECEIVE_STAT_JITTER_MS:
+            value = stats.jitter;
+            break;
+
+        case TOXAV_AUDIO_RECEIVE_STAT_TARGET_DELAY_MS:
+            value = stats.target_delay;
+            break;
+    }
+
+RETURN:
+
+    if (error != nullptr) {
+        *error = rc;
+    }
+
+    return value;
+}
+
 /*******************************************************************************
  *
  * :: Internal
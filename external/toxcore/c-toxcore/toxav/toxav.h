@@ -756,6 +756,84 @@ typedef void toxav_video_receive_frame_cb(
  */
 void toxav_callback_video_receive_frame(ToxAV *av, toxav_video_receive_frame_cb *callback, void *user_data);
 
+/** @} */
+
+/** @{
+ * @brief Call statistics
+ */
+
+typedef enum Toxav_Audio_Receive_Stat {
+
+    /**
+     * Audio packets that arrived after their frame was already played or
+     * concealed.
+     */
+    TOXAV_AUDIO_RECEIVE_STAT_LATE_PACKETS,
+
+    /**
+     * Audio frames that were missing when it was their turn to be played.
+     */
+    TOXAV_AUDIO_RECEIVE_STAT_LOST_FRAMES,
+
+    /**
+     * Lost audio frames that were filled in by packet loss concealment.
+     */
+    TOXAV_AUDIO_RECEIVE_STAT_CONCEALED_FRAMES,
+
+    /**
+     * Lost audio frames that were restored from the forward error correction
+     * data of the packet after them.
+     */
+    TOXAV_AUDIO_RECEIVE_STAT_FEC_RECOVERED_FRAMES,
+
+    /**
+     * Current estimate of the audio packet interarrival jitter in
+     * milliseconds.
+     */
+    TOXAV_AUDIO_RECEIVE_STAT_JITTER_MS,
+
+    /**
+     * How long a missing audio packet is currently waited for before it is
+     * concealed, in milliseconds. This follows the jitter.
+     */
+    TOXAV_AUDIO_RECEIVE_STAT_TARGET_DELAY_MS,
+
+} Toxav_Audio_Receive_Stat;
+
+typedef enum Toxav_Err_Call_Stats {
+
+    /**
+     * The function returned successfully.
+     */
+    TOXAV_ERR_CALL_STATS_OK,
+
+    /**
+     * The friend_number passed did not designate a valid friend.
+     */
+    TOXAV_ERR_CALL_STATS_FRIEND_NOT_FOUND,
+
+    /**
+     * This client is currently not in a call with the friend, or not
+     * receiving audio from them.
+     */
+    TOXAV_ERR_CALL_STATS_FRIEND_NOT_IN_CALL,
+
+} Toxav_Err_Call_Stats;
+
+/**
+ * Query a statistic of the audio received from a friend in the current call.
+ *
+ * The counters start at 0 when the call starts.
+ *
+ * @param friend_number The friend number of the friend this client is in a call
+ *   with.
+ * @param stat The statistic to return.
+ *
+ * @return the value of the statistic, 0 on failure.
+ */
+uint64_t toxav_call_get_audio_receive_stat(ToxAV *av, Tox_Friend_Number friend_number, Toxav_Audio_Receive_Stat stat,
+        Toxav_Err_Call_Stats *error);
+
 
 
 /***
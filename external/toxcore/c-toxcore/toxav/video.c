@@ -17,6 +17,7 @@
 
 #include "ring_buffer.h"
 #include "rtp.h"
+#include "video_governor.h"
 
 #include "../toxcore/attributes.h"
 #include "../toxcore/ccompat.h"
@@ -32,6 +33,9 @@ struct VCSession {
     vpx_image_t raw_encoder_frame;
     bool raw_encoder_frame_allocated;
 
+    Video_Governor governor;
+    bool governor_enabled;
+
     /* decoding */
     vpx_codec_ctx_t decoder[1];
     struct RingBuffer *_Nonnull vbuf_raw; /* Un-decoded data */
@@ -48,20 +52,11 @@ struct VCSession {
     pthread_mutex_t *_Nonnull queue_mutex;
     const Logger *_Nonnull log;
     const Memory *_Nonnull mem;
+    const Mono_Time *_Nonnull mono_time;
 
     vpx_codec_iter_t iter;
 };
 
-/**
- * Codec control function to set encoder internal speed settings. Changes in
- * this value influences, among others, the encoder's selection of motion
- * estimation methods. Values greater than 0 will increase encoder speed at the
- * expense of quality.
- *
- * Note Valid range for VP8: `-16..16`
- */
-#define VP8E_SET_CPUUSED_VALUE 16
-
 /**
  * Initialize encoder with this value.
  *
@@ -94,6 +89,35 @@ static vpx_codec_iface_t *_Nonnull video_codec_encoder_interface(void)
 #define VPX_MAX_DECODER_THREADS 4
 #define VIDEO_VP8_DECODER_POST_PROCESSING_ENABLED 0
 
+/**
+ * Apply the per frame encoder controls chosen by the governor.
+ *
+ * VP8E_SET_CPUUSED sets the encoder internal speed settings. Changes in this
+ * value influence, among others, the encoder's selection of motion estimation
+ * methods. Values greater than 0 will increase encoder speed at the expense of
+ * quality. Valid range for VP8: `-16..16`.
+ *
+ * VP8E_SET_SCALEMODE makes the encoder scale frames down internally, the
+ * receiver gets the smaller frames.
+ */
+static vpx_codec_err_t vc_set_encoder_controls(vpx_codec_ctx_t *_Nonnull encoder, const Video_Encoder_Settings *_Nonnull settings)
+{
+    static const VPX_SCALING_MODE scaling_modes[VIDEO_GOVERNOR_SCALE_LEVELS] = {
+        VP8E_NORMAL, VP8E_FOURFIVE, VP8E_THREEFIVE, VP8E_ONETWO
+    };
+
+    const vpx_codec_err_t rc = vpx_codec_control(encoder, VP8E_SET_CPUUSED, settings->cpu_used);
+
+    if (rc != VPX_CODEC_OK) {
+        return rc;
+    }
+
+    const uint32_t scale_level = settings->scale_level < VIDEO_GOVERNOR_SCALE_LEVELS
+                                 ? settings->scale_level : VIDEO_GOVERNOR_SCALE_LEVELS - 1;
+    vpx_scaling_mode_t scaling_mode = {scaling_modes[scale_level], scaling_modes[scale_level]};
+    return vpx_codec_control(encoder, VP8E_SET_SCALEMODE, &scaling_mode);
+}
+
 static vpx_codec_err_t vc_init_encoder_cfg(const Logger *_Nonnull log, vpx_codec_enc_cfg_t *_Nonnull cfg,
         int16_t kf_max_dist)
 {
@@ -198,8 +222,6 @@ VCSession *vc_new(const Memory *mem, const Logger *log, const Mono_Time *mono_ti
         return nullptr;
     }
 
-    const int cpu_used_value = VP8E_SET_CPUUSED_VALUE;
-
     vc->vbuf_raw = rb_new(VIDEO_DECODE_BUFFER_SIZE);
 
     if (vc->vbuf_raw == nullptr) {
@@ -268,6 +290,10 @@ VCSession *vc_new(const Memory *mem, const Logger *log, const Mono_Time *mono_ti
         goto BASE_CLEANUP_1;
     }
 
+    video_governor_init(&vc->governor, VPX_MAX_ENCODER_THREADS, cfg.g_w, cfg.g_h);
+    vc->governor_enabled = true;
+    cfg.g_threads = vc->governor.settings.threads;
+
     LOGGER_DEBUG(log, "Using VP8 codec for encoder (0.1)");
     rc = vpx_codec_enc_init(vc->encoder, video_codec_encoder_interface(), &cfg, VPX_CODEC_USE_FRAME_THREADING);
 
@@ -281,7 +307,7 @@ VCSession *vc_new(const Memory *mem, const Logger *log, const Mono_Time *mono_ti
         goto BASE_CLEANUP_1;
     }
 
-    rc = vpx_codec_control(vc->encoder, VP8E_SET_CPUUSED, cpu_used_value);
+    rc = vc_set_encoder_controls(vc->encoder, &vc->governor.settings);
 
     if (rc != VPX_CODEC_OK) {
         LOGGER_ERROR(log, "Failed to set encoder control setting: %s", vpx_codec_err_to_string(rc));
@@ -311,6 +337,7 @@ VCSession *vc_new(const Memory *mem, const Logger *log, const Mono_Time *mono_ti
     vc->user_data = user_data;
     vc->friend_number = friend_number;
     vc->log = log;
+    vc->mono_time = mono_time;
     return vc;
 
 BASE_CLEANUP_1:
@@ -339,7 +366,7 @@ void vc_kill(VCSession *vc)
     void *p;
 
     while (rb_read(vc->vbuf_raw, &p)) {
-        free(p);
+        rtp_message_free((struct RTPMessage *)p);
     }
 
     rb_kill(vc->vbuf_raw);
@@ -384,14 +411,14 @@ void vc_iterate(VCSession *vc)
     if (full_data_len > rtp_message_len(p)) {
         LOGGER_ERROR(vc->log, "vc_iterate: Malicious packet detected! Lying length: %u actual: %u",
                      full_data_len, (uint32_t)rtp_message_len(p));
-        free(p);
+        rtp_message_free(p);
         return;
     }
 
     LOGGER_DEBUG(vc->log, "vc_iterate: rb_read p->len=%u", full_data_len);
     LOGGER_DEBUG(vc->log, "vc_iterate: rb_read rb size=%d", (int)log_rb_size);
     const vpx_codec_err_t rc = vpx_codec_decode(vc->decoder, rtp_message_data(p), full_data_len, nullptr, 0);
-    free(p);
+    rtp_message_free(p);
 
     if (rc != VPX_CODEC_OK) {
         LOGGER_ERROR(vc->log, "Error decoding video: %d %s", (int)rc, vpx_codec_err_to_string(rc));
@@ -421,27 +448,27 @@ int vc_queue_message(const Mono_Time *mono_time, void *cs, struct RTPMessage *ms
      * this function gets called from handle_rtp_packet()
      */
     if (vc == nullptr || msg == nullptr) {
-        free(msg);
+        rtp_message_free(msg);
 
         return -1;
     }
 
     if (rtp_message_pt(msg) == (RTP_TYPE_VIDEO + 2) % 128) {
         LOGGER_WARNING(vc->log, "Got dummy!");
-        free(msg);
+        rtp_message_free(msg);
         return 0;
     }
 
     if (rtp_message_pt(msg) != RTP_TYPE_VIDEO % 128) {
         LOGGER_WARNING(vc->log, "Invalid payload type! pt=%d", (int)rtp_message_pt(msg));
-        free(msg);
+        rtp_message_free(msg);
         return -1;
     }
 
     /* Security check: Sanitize message size to prevent memory exhaustion */
     if (rtp_message_data_length_full(msg) > VIDEO_MAX_FRAME_SIZE) {
         LOGGER_ERROR(vc->log, "Message too large! size=%u", (uint32_t)rtp_message_data_length_full(msg));
-        free(msg);
+        rtp_message_free(msg);
         return -1;
     }
 
@@ -451,7 +478,7 @@ int vc_queue_message(const Mono_Time *mono_time, void *cs, struct RTPMessage *ms
         LOGGER_DEBUG(vc->log, "rb_write msg->len=%d b0=%d b1=%d", (int)rtp_message_len(msg), (int)rtp_message_data(msg)[0], (int)rtp_message_data(msg)[1]);
     }
 
-    free(rb_write(vc->vbuf_raw, msg));
+    rtp_message_free((struct RTPMessage *)rb_write(vc->vbuf_raw, msg));
 
     /* Calculate time it took for peer to send us this frame */
     const uint32_t t_lcfd = current_time_monotonic(mono_time) - vc->linfts;
@@ -506,6 +533,16 @@ int vc_reconfigure_encoder(VCSession *vc, uint32_t bit_rate, uint16_t width, uin
         cfg.g_w = width;
         cfg.g_h = height;
 
+        /* The old settings were tuned for the old frame size. */
+        Video_Governor governor;
+        video_governor_init(&governor, VPX_MAX_ENCODER_THREADS, width, height);
+
+        if (!vc->governor_enabled) {
+            governor.settings = vc->governor.settings;
+        }
+
+        cfg.g_threads = governor.settings.threads;
+
         /* Atomic reconfiguration: Initialize new encoder first */
         vpx_codec_ctx_t new_encoder;
         LOGGER_DEBUG(vc->log, "Using VP8 codec for encoder");
@@ -521,9 +558,7 @@ int vc_reconfigure_encoder(VCSession *vc, uint32_t bit_rate, uint16_t width, uin
             return -1;
         }
 
-        const int cpu_used_value = VP8E_SET_CPUUSED_VALUE;
-
-        rc = vpx_codec_control(&new_encoder, VP8E_SET_CPUUSED, cpu_used_value);
+        rc = vc_set_encoder_controls(&new_encoder, &governor.settings);
 
         if (rc != VPX_CODEC_OK) {
             LOGGER_ERROR(vc->log, "Failed to set encoder control setting: %s", vpx_codec_err_to_string(rc));
@@ -534,12 +569,39 @@ int vc_reconfigure_encoder(VCSession *vc, uint32_t bit_rate, uint16_t width, uin
         /* Swap only on success */
         vpx_codec_destroy(vc->encoder);
         *vc->encoder = new_encoder;
+        vc->governor = governor;
         return 0;
     }
 
     return 0;
 }
 
+/** Apply changed governor settings to the running encoder, before the next frame is encoded. */
+static void vc_apply_encoder_settings(VCSession *_Nonnull vc)
+{
+    const Video_Encoder_Settings *settings = &vc->governor.settings;
+    vpx_codec_enc_cfg_t cfg = *vc->encoder->config.enc;
+    vpx_codec_err_t rc;
+
+    if (cfg.g_threads != settings->threads) {
+        cfg.g_threads = settings->threads;
+        rc = vpx_codec_enc_config_set(vc->encoder, &cfg);
+
+        if (rc != VPX_CODEC_OK) {
+            LOGGER_WARNING(vc->log, "Failed to set encoder threads: %s", vpx_codec_err_to_string(rc));
+        }
+    }
+
+    rc = vc_set_encoder_controls(vc->encoder, settings);
+
+    if (rc != VPX_CODEC_OK) {
+        LOGGER_WARNING(vc->log, "Failed to set encoder control setting: %s", vpx_codec_err_to_string(rc));
+    }
+
+    LOGGER_DEBUG(vc->log, "encoder settings: threads=%u cpu_used=%d scale_level=%u",
+                 settings->threads, settings->cpu_used, settings->scale_level);
+}
+
 int vc_encode(VCSession *vc, uint16_t width, uint16_t height, const uint8_t *y,
               const uint8_t *u, const uint8_t *v, int encode_flags)
 {
@@ -569,6 +631,7 @@ int vc_encode(VCSession *vc, uint16_t width, uint16_t height, const uint8_t *y,
         vpx_flags |= VPX_EFLAG_FORCE_KF;
     }
 
+    const uint64_t encode_start = current_time_monotonic(vc->mono_time);
     const vpx_codec_err_t vrc = vpx_codec_encode(vc->encoder, img,
                                 vc->frame_counter, 1, vpx_flags, VPX_DL_REALTIME);
 
@@ -577,6 +640,11 @@ int vc_encode(VCSession *vc, uint16_t width, uint16_t height, const uint8_t *y,
         return -1;
     }
 
+    if (vc->governor_enabled
+            && video_governor_frame_encoded(&vc->governor, encode_start, current_time_monotonic(vc->mono_time))) {
+        vc_apply_encoder_settings(vc);
+    }
+
     vc->iter = nullptr;
     return 0;
 }
@@ -618,3 +686,26 @@ void vc_increment_frame_counter(VCSession *vc)
 {
     ++vc->frame_counter;
 }
+
+void vc_set_encoder_governor(VCSession *vc, bool enabled)
+{
+    if (enabled == vc->governor_enabled) {
+        return;
+    }
+
+    const vpx_codec_enc_cfg_t *cfg = vc->encoder->config.enc;
+    video_governor_init(&vc->governor, VPX_MAX_ENCODER_THREADS, cfg->g_w, cfg->g_h);
+
+    if (!enabled) {
+        /* The fixed settings the encoder used before there was a governor. */
+        vc->governor.settings.threads = VPX_MAX_ENCODER_THREADS;
+    }
+
+    vc->governor_enabled = enabled;
+    vc_apply_encoder_settings(vc);
+}
+
+void vc_get_encoder_settings(const VCSession *vc, Video_Encoder_Settings *settings)
+{
+    *settings = vc->governor.settings;
+}
@@ -10,6 +10,7 @@
 
 #include "../toxcore/logger.h"
 #include "../toxcore/mono_time.h"
+#include "video_governor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,6 +44,16 @@ uint32_t vc_get_lcfd(const VCSession *_Nonnull vc);
 pthread_mutex_t *_Nonnull vc_get_queue_mutex(VCSession *_Nonnull vc);
 void vc_increment_frame_counter(VCSession *_Nonnull vc);
 
+/**
+ * @brief Turn the encoder governor on or off.
+ *
+ * The governor is on by default. Turning it off goes back to fixed encoder
+ * settings: the maximum number of threads and the fastest cpu_used.
+ */
+void vc_set_encoder_governor(VCSession *_Nonnull vc, bool enabled);
+/** @brief The encoder settings currently in use. */
+void vc_get_encoder_settings(const VCSession *_Nonnull vc, Video_Encoder_Settings *_Nonnull settings);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
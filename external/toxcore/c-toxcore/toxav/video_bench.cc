@@ -4,6 +4,8 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -197,6 +199,166 @@ BENCHMARK_REGISTER_F(VideoBench, FullSequence)
     ->Args({1280, 720})
     ->Args({1920, 1080});
 
+/**
+ * A clock for the encoder governor that advances by exactly one frame interval
+ * per frame, plus however long the encoder really took inside the frame. This
+ * lets the benchmark run frames back to back while the governor sees a 30 fps
+ * application.
+ */
+struct PacedClock {
+    std::uint64_t frame_start_ms = 1000;
+    std::chrono::steady_clock::time_point frame_start_real = std::chrono::steady_clock::now();
+
+    static std::uint64_t time_cb(void *_Nullable user_data)
+    {
+        const auto *self = static_cast<const PacedClock *>(user_data);
+        const auto elapsed = std::chrono::steady_clock::now() - self->frame_start_real;
+        return self->frame_start_ms
+            + static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+    }
+};
+
+constexpr std::uint64_t kPacedFrameIntervalMs = 33;
+
+/** Camera-like content: a gradient, sensor noise and a moving square. */
+void fill_textured_frame(std::uint16_t width, std::uint16_t height, int frame_index,
+    std::vector<std::uint8_t> &y, std::vector<std::uint8_t> &u, std::vector<std::uint8_t> &v)
+{
+    fill_video_frame(width, height, frame_index, y, u, v);
+
+    std::uint32_t seed = 0x9e3779b9u * static_cast<std::uint32_t>(frame_index + 1);
+
+    for (std::uint16_t row = 0; row < height; ++row) {
+        for (std::uint16_t col = 0; col < width; ++col) {
+            seed = seed * 1664525u + 1013904223u;
+            std::uint8_t &pixel = y[static_cast<std::size_t>(row) * width + col];
+            pixel = static_cast<std::uint8_t>(pixel / 2 + (col + row) % 64 + (seed >> 28));
+        }
+    }
+
+    for (std::size_t i = 0; i < u.size(); ++i) {
+        u[i] = static_cast<std::uint8_t>(112 + i % 32);
+        v[i] = static_cast<std::uint8_t>(144 - i % 32);
+    }
+}
+
+/**
+ * Per frame encode latency of a 30 fps stream at state.range(0) x
+ * state.range(1), with fixed encoder settings (governor = 0) or with the
+ * encoder governor adjusting them (governor = 1). The governor gets a few
+ * seconds of frames to settle before measuring.
+ */
+void BM_EncodeLatency(benchmark::State &state)
+{
+    const Memory *_Nonnull mem = os_memory();
+    const auto width = static_cast<std::uint16_t>(state.range(0));
+    const auto height = static_cast<std::uint16_t>(state.range(1));
+    const bool governor = state.range(2) != 0;
+
+    Logger *log = logger_new(mem);
+    PacedClock clock;
+    Mono_Time *mono_time = mono_time_new(mem, PacedClock::time_cb, &clock);
+    VCSession *vc = vc_new(mem, log, mono_time, 123, nullptr, nullptr);
+
+    if (vc == nullptr) {
+        state.SkipWithError("vc_new failed");
+        mono_time_free(mem, mono_time);
+        logger_kill(log);
+        return;
+    }
+
+    vc_set_encoder_governor(vc, governor);
+    vc_reconfigure_encoder(vc, 2000, width, height, -1);
+
+    const int num_prefilled = 30;
+    std::vector<std::vector<std::uint8_t>> ys(
+        num_prefilled, std::vector<std::uint8_t>(static_cast<std::size_t>(width) * height));
+    std::vector<std::vector<std::uint8_t>> us(
+        num_prefilled, std::vector<std::uint8_t>((width / 2) * (height / 2)));
+    std::vector<std::vector<std::uint8_t>> vs(
+        num_prefilled, std::vector<std::uint8_t>((width / 2) * (height / 2)));
+
+    for (int i = 0; i < num_prefilled; ++i) {
+        fill_textured_frame(width, height, i, ys[i], us[i], vs[i]);
+    }
+
+    int frame_index = 0;
+    std::vector<double> latencies_ms;
+
+    const auto encode_frame = [&]() {
+        clock.frame_start_ms += kPacedFrameIntervalMs;
+        clock.frame_start_real = std::chrono::steady_clock::now();
+
+        const int idx = frame_index % num_prefilled;
+        const int flags = (frame_index % 300 == 0) ? VC_EFLAG_FORCE_KF : VC_EFLAG_NONE;
+        vc_encode(vc, width, height, ys[idx].data(), us[idx].data(), vs[idx].data(), flags);
+        vc_increment_frame_counter(vc);
+
+        std::uint8_t *pkt_data;
+        std::uint32_t pkt_size;
+        bool is_keyframe;
+        while (vc_get_cx_data(vc, &pkt_data, &pkt_size, &is_keyframe)) {
+            benchmark::DoNotOptimize(pkt_data);
+            benchmark::DoNotOptimize(pkt_size);
+        }
+
+        ++frame_index;
+
+        const auto elapsed = std::chrono::steady_clock::now() - clock.frame_start_real;
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    };
+
+    // Ten seconds of frames, so the governor went through enough windows to settle.
+    for (int i = 0; i < 300; ++i) {
+        encode_frame();
+    }
+
+    for (auto _ : state) {
+        latencies_ms.push_back(encode_frame());
+    }
+
+    Video_Encoder_Settings settings;
+    vc_get_encoder_settings(vc, &settings);
+
+    vc_kill(vc);
+    mono_time_free(mem, mono_time);
+    logger_kill(log);
+
+    if (latencies_ms.empty()) {
+        return;
+    }
+
+    std::sort(latencies_ms.begin(), latencies_ms.end());
+    const auto percentile = [&latencies_ms](double p) {
+        const auto idx = static_cast<std::size_t>(p * static_cast<double>(latencies_ms.size() - 1));
+        return latencies_ms[idx];
+    };
+    const auto late = std::count_if(latencies_ms.begin(), latencies_ms.end(),
+        [](double ms) { return ms > static_cast<double>(kPacedFrameIntervalMs); });
+
+    state.counters["p50_ms"] = benchmark::Counter(percentile(0.50));
+    state.counters["p95_ms"] = benchmark::Counter(percentile(0.95));
+    state.counters["p99_ms"] = benchmark::Counter(percentile(0.99));
+    state.counters["late_ratio"]
+        = benchmark::Counter(static_cast<double>(late) / static_cast<double>(latencies_ms.size()));
+    state.counters["threads"] = benchmark::Counter(settings.threads);
+    state.counters["cpu_used"] = benchmark::Counter(settings.cpu_used);
+    state.counters["scale_level"] = benchmark::Counter(settings.scale_level);
+}
+
+// Args: width, height, governor (0 = fixed settings, 1 = governed).
+BENCHMARK(BM_EncodeLatency)
+    ->ArgNames({"w", "h", "governor"})
+    ->Args({640, 480, 0})
+    ->Args({640, 480, 1})
+    ->Args({1280, 720, 0})
+    ->Args({1280, 720, 1})
+    ->Args({1920, 1080, 0})
+    ->Args({1920, 1080, 1})
+    ->Iterations(300)
+    ->Unit(benchmark::kMillisecond);
+
 }
 
 BENCHMARK_MAIN();
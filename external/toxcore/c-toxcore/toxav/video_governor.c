@@ -0,0 +1,173 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+#include "video_governor.h"
+
+#include <string.h>
+
+/** Width and height of each scale level in percent of the source frame. */
+static const uint32_t video_governor_scale_percent[VIDEO_GOVERNOR_SCALE_LEVELS] = {100, 80, 60, 50};
+
+/** Pixels one encoder thread is expected to keep up with. */
+#define VIDEO_GOVERNOR_PIXELS_PER_THREAD (640 * 360)
+
+uint16_t video_governor_scaled_size(uint16_t size, uint32_t scale_level)
+{
+    if (scale_level >= VIDEO_GOVERNOR_SCALE_LEVELS) {
+        scale_level = VIDEO_GOVERNOR_SCALE_LEVELS - 1;
+    }
+
+    const uint32_t scaled = (uint32_t)size * video_governor_scale_percent[scale_level] / 100;
+    return (uint16_t)(scaled & ~1u);
+}
+
+static uint32_t video_governor_max_scale_level(const Video_Governor *_Nonnull gov)
+{
+    uint32_t level = 0;
+
+    while (level + 1 < VIDEO_GOVERNOR_SCALE_LEVELS
+            && video_governor_scaled_size(gov->width, level + 1) >= VIDEO_GOVERNOR_MIN_SCALED_WIDTH) {
+        ++level;
+    }
+
+    return level;
+}
+
+void video_governor_init(Video_Governor *gov, uint32_t max_threads, uint16_t width, uint16_t height)
+{
+    memset(gov, 0, sizeof(Video_Governor));
+
+    gov->max_threads = max_threads > 0 ? max_threads : 1;
+    gov->width = width;
+    gov->height = height;
+
+    const uint32_t pixels = (uint32_t)width * height;
+    uint32_t threads = (pixels + VIDEO_GOVERNOR_PIXELS_PER_THREAD - 1) / VIDEO_GOVERNOR_PIXELS_PER_THREAD;
+
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    if (threads > gov->max_threads) {
+        threads = gov->max_threads;
+    }
+
+    gov->settings.threads = threads;
+    gov->settings.cpu_used = VIDEO_GOVERNOR_CPU_USED_MAX;
+    gov->settings.scale_level = 0;
+}
+
+/** Make encoding cheaper: more threads first, then a faster encoder, then smaller frames. */
+static bool video_governor_shed_load(Video_Governor *_Nonnull gov)
+{
+    Video_Encoder_Settings *settings = &gov->settings;
+
+    if (settings->threads < gov->max_threads) {
+        ++settings->threads;
+        return true;
+    }
+
+    if (settings->cpu_used < VIDEO_GOVERNOR_CPU_USED_MAX) {
+        settings->cpu_used += VIDEO_GOVERNOR_CPU_USED_STEP;
+
+        if (settings->cpu_used > VIDEO_GOVERNOR_CPU_USED_MAX) {
+            settings->cpu_used = VIDEO_GOVERNOR_CPU_USED_MAX;
+        }
+
+        return true;
+    }
+
+    if (settings->scale_level < video_governor_max_scale_level(gov)) {
+        ++settings->scale_level;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Spend spare time, in the reverse order: get the resolution back first, then
+ * give back threads that aren't needed, then improve quality.
+ *
+ * Resolution and thread changes are only made if the load they are expected
+ * to cause stays below the high (resolution) or low (threads) watermark.
+ */
+static bool video_governor_add_load(Video_Governor *_Nonnull gov, uint64_t load)
+{
+    Video_Encoder_Settings *settings = &gov->settings;
+
+    if (settings->scale_level > 0) {
+        const uint64_t larger = video_governor_scale_percent[settings->scale_level - 1];
+        const uint64_t current = video_governor_scale_percent[settings->scale_level];
+
+        if (load * larger * larger < VIDEO_GOVERNOR_HIGH_LOAD * current * current) {
+            --settings->scale_level;
+            return true;
+        }
+
+        return false;
+    }
+
+    if (settings->threads > 1 && load * settings->threads < VIDEO_GOVERNOR_LOW_LOAD * (settings->threads - 1)) {
+        --settings->threads;
+        return true;
+    }
+
+    if (settings->cpu_used > VIDEO_GOVERNOR_CPU_USED_MIN) {
+        settings->cpu_used -= VIDEO_GOVERNOR_CPU_USED_STEP;
+
+        if (settings->cpu_used < VIDEO_GOVERNOR_CPU_USED_MIN) {
+            settings->cpu_used = VIDEO_GOVERNOR_CPU_USED_MIN;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool video_governor_frame_encoded(Video_Governor *gov, uint64_t start, uint64_t end)
+{
+    const uint64_t last_frame_start = gov->last_frame_start;
+    gov->last_frame_start = start;
+
+    // Without a clock that moves between frames there is nothing to measure against.
+    if (last_frame_start == 0 || start <= last_frame_start) {
+        return false;
+    }
+
+    const uint64_t interval = start - last_frame_start;
+    const uint64_t encode_time = end > start ? end - start : 0;
+
+    ++gov->window_frames;
+    gov->window_encode_ms += encode_time;
+    gov->window_interval_ms += interval;
+
+    if (encode_time > interval) {
+        ++gov->window_late_frames;
+    }
+
+    if (gov->window_frames < VIDEO_GOVERNOR_WINDOW) {
+        return false;
+    }
+
+    const uint64_t load = gov->window_encode_ms * 100 / gov->window_interval_ms;
+    // More than 10% of the frames took longer than the frame interval.
+    const bool late = gov->window_late_frames * 10 > gov->window_frames;
+    const bool no_late_frames = gov->window_late_frames == 0;
+
+    gov->window_frames = 0;
+    gov->window_late_frames = 0;
+    gov->window_encode_ms = 0;
+    gov->window_interval_ms = 0;
+
+    if (load > VIDEO_GOVERNOR_HIGH_LOAD || late) {
+        return video_governor_shed_load(gov);
+    }
+
+    if (load < VIDEO_GOVERNOR_LOW_LOAD && no_late_frames) {
+        return video_governor_add_load(gov, load);
+    }
+
+    return false;
+}
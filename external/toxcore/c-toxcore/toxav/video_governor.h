@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+/**
+ * Encoder governor for the video encoder.
+ *
+ * Measures how long each frame takes to encode against the interval at which
+ * the application sends frames, and trades encoder threads, encoder speed
+ * (cpu_used) and, as a last resort, resolution to keep encoding within that
+ * budget. When there is room to spare, the same knobs are turned back the
+ * other way.
+ */
+#ifndef C_TOXCORE_TOXAV_VIDEO_GOVERNOR_H
+#define C_TOXCORE_TOXAV_VIDEO_GOVERNOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../toxcore/attributes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of frames the governor looks at before making a decision. */
+#define VIDEO_GOVERNOR_WINDOW 30
+
+/** Encode time in percent of the frame interval above which the encoder is too slow. */
+#define VIDEO_GOVERNOR_HIGH_LOAD 80
+/** Encode time in percent of the frame interval below which there is room to spare. */
+#define VIDEO_GOVERNOR_LOW_LOAD 40
+
+/** Range and step of the VP8 cpu_used setting, higher is faster and lower quality. */
+#define VIDEO_GOVERNOR_CPU_USED_MIN 4
+#define VIDEO_GOVERNOR_CPU_USED_MAX 16
+#define VIDEO_GOVERNOR_CPU_USED_STEP 4
+
+/** Scale levels: full size, 4/5, 3/5 and 1/2 of the width and height. */
+#define VIDEO_GOVERNOR_SCALE_LEVELS 4
+/** The governor never scales frames narrower than this. */
+#define VIDEO_GOVERNOR_MIN_SCALED_WIDTH 320
+
+typedef struct Video_Encoder_Settings {
+    uint32_t threads;
+    int32_t cpu_used;
+    /** Index into the scale levels, 0 is full resolution. */
+    uint32_t scale_level;
+} Video_Encoder_Settings;
+
+typedef struct Video_Governor {
+    Video_Encoder_Settings settings;
+
+    uint32_t max_threads;
+    uint16_t width;
+    uint16_t height;
+
+    /** Start time of the previous frame, 0 before the first frame. */
+    uint64_t last_frame_start;
+
+    uint32_t window_frames;
+    uint32_t window_late_frames;
+    uint64_t window_encode_ms;
+    uint64_t window_interval_ms;
+} Video_Governor;
+
+/**
+ * @brief Reset the governor for a new frame size.
+ *
+ * Picks the initial thread count from the number of pixels per frame, up to
+ * `max_threads`, and starts at the fastest cpu_used at full resolution.
+ */
+void video_governor_init(Video_Governor *_Nonnull gov, uint32_t max_threads, uint16_t width, uint16_t height);
+
+/**
+ * @brief Account for one encoded frame.
+ *
+ * @param start monotonic time in ms at which the frame was handed to the encoder.
+ * @param end monotonic time in ms at which the encoder returned.
+ *
+ * @retval true if the encoder settings changed and need to be applied.
+ */
+bool video_governor_frame_encoded(Video_Governor *_Nonnull gov, uint64_t start, uint64_t end);
+
+/**
+ * @brief Size of one dimension at a scale level.
+ *
+ * Rounded down to an even number, as the chroma planes are subsampled.
+ */
+uint16_t video_governor_scaled_size(uint16_t size, uint32_t scale_level);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* C_TOXCORE_TOXAV_VIDEO_GOVERNOR_H */
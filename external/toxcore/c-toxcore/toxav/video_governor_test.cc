@@ -0,0 +1,130 @@
+#include "video_governor.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace {
+
+constexpr std::uint64_t kFrameInterval = 33;
+
+/** Feeds `frames` frames taking `encode_ms` each, 33ms apart. Returns how often the settings changed. */
+int feed_frames(Video_Governor *gov, std::uint64_t *now, int frames, std::uint64_t encode_ms)
+{
+    int changes = 0;
+
+    for (int i = 0; i < frames; ++i) {
+        if (video_governor_frame_encoded(gov, *now, *now + encode_ms)) {
+            ++changes;
+        }
+
+        *now += kFrameInterval;
+    }
+
+    return changes;
+}
+
+TEST(VideoGovernor, InitialThreadsFollowFrameSize)
+{
+    Video_Governor gov;
+
+    video_governor_init(&gov, 4, 320, 240);
+    EXPECT_EQ(gov.settings.threads, 1u);
+
+    video_governor_init(&gov, 4, 1280, 720);
+    EXPECT_EQ(gov.settings.threads, 4u);
+
+    video_governor_init(&gov, 2, 1920, 1080);
+    EXPECT_EQ(gov.settings.threads, 2u);
+    EXPECT_EQ(gov.settings.cpu_used, VIDEO_GOVERNOR_CPU_USED_MAX);
+    EXPECT_EQ(gov.settings.scale_level, 0u);
+}
+
+TEST(VideoGovernor, IgnoresFramesWithoutClockProgress)
+{
+    Video_Governor gov;
+    video_governor_init(&gov, 4, 640, 480);
+    const Video_Encoder_Settings before = gov.settings;
+
+    for (int i = 0; i < VIDEO_GOVERNOR_WINDOW * 4; ++i) {
+        EXPECT_FALSE(video_governor_frame_encoded(&gov, 1000, 1000));
+    }
+
+    EXPECT_EQ(gov.settings.threads, before.threads);
+    EXPECT_EQ(gov.settings.cpu_used, before.cpu_used);
+}
+
+TEST(VideoGovernor, OverloadAddsThreadsThenScalesDown)
+{
+    Video_Governor gov;
+    video_governor_init(&gov, 4, 1280, 720);
+    gov.settings.threads = 2;
+    std::uint64_t now = 1000;
+
+    // Every frame takes longer than the frame interval.
+    feed_frames(&gov, &now, VIDEO_GOVERNOR_WINDOW + 1, 50);
+    EXPECT_EQ(gov.settings.threads, 3u);
+    EXPECT_EQ(gov.settings.scale_level, 0u);
+
+    feed_frames(&gov, &now, VIDEO_GOVERNOR_WINDOW * 10, 50);
+    EXPECT_EQ(gov.settings.threads, 4u);
+    EXPECT_EQ(gov.settings.cpu_used, VIDEO_GOVERNOR_CPU_USED_MAX);
+    EXPECT_EQ(gov.settings.scale_level, VIDEO_GOVERNOR_SCALE_LEVELS - 1u);
+}
+
+TEST(VideoGovernor, NeverScalesBelowMinimumWidth)
+{
+    Video_Governor gov;
+    video_governor_init(&gov, 1, 400, 300);
+    std::uint64_t now = 1000;
+
+    feed_frames(&gov, &now, VIDEO_GOVERNOR_WINDOW * 10, 50);
+    EXPECT_GE(video_governor_scaled_size(gov.width, gov.settings.scale_level),
+        static_cast<std::uint16_t>(VIDEO_GOVERNOR_MIN_SCALED_WIDTH));
+    EXPECT_EQ(gov.settings.scale_level, 1u);
+}
+
+TEST(VideoGovernor, SpareTimeImprovesQualityAndReleasesThreads)
+{
+    Video_Governor gov;
+    video_governor_init(&gov, 4, 1280, 720);
+    std::uint64_t now = 1000;
+
+    // 2ms out of 33ms: 4 threads are not needed and there is room for a slower encoder.
+    feed_frames(&gov, &now, VIDEO_GOVERNOR_WINDOW * 20, 2);
+    EXPECT_EQ(gov.settings.threads, 1u);
+    EXPECT_EQ(gov.settings.cpu_used, VIDEO_GOVERNOR_CPU_USED_MIN);
+}
+
+TEST(VideoGovernor, RestoresResolutionBeforeQuality)
+{
+    Video_Governor gov;
+    video_governor_init(&gov, 1, 1280, 720);
+    gov.settings.scale_level = 2;
+    std::uint64_t now = 1000;
+
+    feed_frames(&gov, &now, VIDEO_GOVERNOR_WINDOW + 1, 5);
+    EXPECT_EQ(gov.settings.scale_level, 1u);
+    EXPECT_EQ(gov.settings.cpu_used, VIDEO_GOVERNOR_CPU_USED_MAX);
+}
+
+TEST(VideoGovernor, StaysPutBetweenWatermarks)
+{
+    Video_Governor gov;
+    video_governor_init(&gov, 2, 640, 480);
+    std::uint64_t now = 1000;
+
+    // 20ms out of 33ms is about 60%.
+    EXPECT_EQ(feed_frames(&gov, &now, VIDEO_GOVERNOR_WINDOW * 5, 20), 0);
+}
+
+TEST(VideoGovernor, ScaledSizeIsEven)
+{
+    EXPECT_EQ(video_governor_scaled_size(1280, 0), 1280);
+    EXPECT_EQ(video_governor_scaled_size(1280, 1), 1024);
+    EXPECT_EQ(video_governor_scaled_size(1080, 2), 648);
+    EXPECT_EQ(video_governor_scaled_size(1081, 3), 540);
+    EXPECT_EQ(video_governor_scaled_size(1081, 10), 540);
+}
+
+}  // namespace
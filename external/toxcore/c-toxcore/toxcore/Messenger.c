@@ -209,6 +209,7 @@ static int32_t init_new_friend(Messenger *_Nonnull m, const uint8_t *_Nonnull re
             m->friendlist[i].userstatus = USERSTATUS_NONE;
             m->friendlist[i].is_typing = false;
             m->friendlist[i].message_id = 0;
+            m->friendlist[i].save_dirty = true;
             friend_connection_callbacks(m->fr_c, friendcon_id, MESSENGER_CALLBACK_INDEX, &m_handle_status, &m_handle_packet,
                                         &m_handle_lossy_packet, m, i);
 
@@ -473,6 +474,22 @@ static int do_receipts(Messenger *_Nonnull m, int32_t friendnumber, void *_Nulla
     return 0;
 }
 
+/** Remember a deleted friend for the next savedata journal entry. */
+static void m_journal_friend_deleted(Messenger *_Nonnull m, const uint8_t *_Nonnull real_pk)
+{
+    uint8_t *deleted = (uint8_t *)mem_vrealloc(m->mem, m->journal_deleted_friends,
+                       m->journal_deleted_friends_length + 1, CRYPTO_PUBLIC_KEY_SIZE);
+
+    if (deleted == nullptr) {
+        LOGGER_ERROR(m->log, "could not record friend deletion, it needs a full save to persist");
+        return;
+    }
+
+    pk_copy(deleted + (size_t)m->journal_deleted_friends_length * CRYPTO_PUBLIC_KEY_SIZE, real_pk);
+    m->journal_deleted_friends = deleted;
+    ++m->journal_deleted_friends_length;
+}
+
 /** @brief Remove a friend.
  *
  * @retval 0 if success.
@@ -484,6 +501,7 @@ int m_delfriend(Messenger *m, int32_t friendnumber)
         return -1;
     }
 
+    m_journal_friend_deleted(m, m->friendlist[friendnumber].real_pk);
     clear_receipts(m, friendnumber);
     remove_request_received(m->fr, m->friendlist[friendnumber].real_pk);
     friend_connection_callbacks(m->fr_c, m->friendlist[friendnumber].friendcon_id, MESSENGER_CALLBACK_INDEX, nullptr,
@@ -668,6 +686,12 @@ int setfriendname(Messenger *m, int32_t friendnumber, const uint8_t *name, uint1
         return -1;
     }
 
+    Friend *const f = &m->friendlist[friendnumber];
+
+    if (f->name_length != length || memcmp(f->name, name, length) != 0) {
+        f->save_dirty = true;
+    }
+
     m->friendlist[friendnumber].name_length = length;
     memcpy(m->friendlist[friendnumber].name, name, length);
     return 0;
@@ -697,6 +721,7 @@ int setname(Messenger *m, const uint8_t *name, uint16_t length)
     }
 
     m->name_length = length;
+    messenger_journal_mark_dirty(m, STATE_TYPE_NAME);
 
     for (uint32_t i = 0; i < m->numfriends; ++i) {
         m->friendlist[i].name_sent = false;
@@ -771,6 +796,7 @@ int m_set_statusmessage(Messenger *m, const uint8_t *status, uint16_t length)
     }
 
     m->statusmessage_length = length;
+    messenger_journal_mark_dirty(m, STATE_TYPE_STATUSMESSAGE);
 
     for (uint32_t i = 0; i < m->numfriends; ++i) {
         m->friendlist[i].statusmessage_sent = false;
@@ -820,6 +846,7 @@ int m_set_userstatus(Messenger *m, uint8_t status)
     }
 
     userstatus_from_int(status, &m->userstatus);
+    messenger_journal_mark_dirty(m, STATE_TYPE_STATUS);
 
     for (uint32_t i = 0; i < m->numfriends; ++i) {
         m->friendlist[i].userstatus_sent = false;
@@ -960,6 +987,12 @@ static int set_friend_statusmessage(const Messenger *_Nonnull m, int32_t friendn
         return -1;
     }
 
+    Friend *const f = &m->friendlist[friendnumber];
+
+    if (f->statusmessage_length != length || (length > 0 && memcmp(f->statusmessage, status, length) != 0)) {
+        f->save_dirty = true;
+    }
+
     if (length > 0) {
         memcpy(m->friendlist[friendnumber].statusmessage, status, length);
     }
@@ -970,7 +1003,13 @@ static int set_friend_statusmessage(const Messenger *_Nonnull m, int32_t friendn
 
 static void set_friend_userstatus(const Messenger *_Nonnull m, int32_t friendnumber, uint8_t status)
 {
-    userstatus_from_int(status, &m->friendlist[friendnumber].userstatus);
+    Friend *const f = &m->friendlist[friendnumber];
+    const Userstatus old_status = f->userstatus;
+    userstatus_from_int(status, &f->userstatus);
+
+    if (f->userstatus != old_status) {
+        f->save_dirty = true;
+    }
 }
 
 static void set_friend_typing(const Messenger *_Nonnull m, int32_t friendnumber, bool is_typing)
@@ -1073,8 +1112,16 @@ static void check_friend_connectionstatus(Messenger *_Nonnull m, int32_t friendn
 
 static void set_friend_status(Messenger *_Nonnull m, int32_t friendnumber, uint8_t status, void *_Nullable userdata)
 {
+    const uint8_t old_status = m->friendlist[friendnumber].status;
+
     check_friend_connectionstatus(m, friendnumber, status, userdata);
     m->friendlist[friendnumber].status = status;
+
+    // Online friends are saved as confirmed, and going offline updates the last seen time.
+    if (old_status != status
+            && (status < FRIEND_CONFIRMED || old_status < FRIEND_CONFIRMED || old_status == FRIEND_ONLINE)) {
+        m->friendlist[friendnumber].save_dirty = true;
+    }
 }
 
 /*** CONFERENCES */
@@ -1136,6 +1183,12 @@ void callback_file_reqchunk(Messenger *m, m_file_chunk_request_cb *function)
     m->file_reqchunk = function;
 }
 
+/** @brief Set the callback for bulk file reads. */
+void callback_file_bulk_read(Messenger *m, m_file_bulk_read_cb *function)
+{
+    m->file_bulk_read = function;
+}
+
 #define MAX_FILENAME_LENGTH 255
 
 /** @brief Copy the file transfer file id to file_id
@@ -1287,6 +1340,10 @@ long int new_filesender(const Messenger *m, int32_t friendnumber, uint32_t file_
 
     ft->paused = FILE_PAUSE_NOT;
 
+    ft->bulk = false;
+
+    ft->bulk_user_data = nullptr;
+
     memcpy(ft->id, file_id, FILE_ID_LENGTH);
 
     return i;
@@ -1588,6 +1645,112 @@ int send_file_data(const Messenger *m, int32_t friendnumber, uint32_t filenumber
     return -6;
 }
 
+/** @brief Switch an outgoing file transfer to bulk mode.
+ *
+ * @retval 0 on success.
+ * @retval -1 if friend not valid.
+ * @retval -2 if friend not online.
+ * @retval -3 if filenumber invalid.
+ * @retval -4 if chunks have been requested that were not sent yet.
+ */
+int file_set_bulk_read(const Messenger *m, int32_t friendnumber, uint32_t filenumber, void *file_user_data)
+{
+    if (!m_friend_exists(m, friendnumber)) {
+        return -1;
+    }
+
+    if (m->friendlist[friendnumber].status != FRIEND_ONLINE) {
+        return -2;
+    }
+
+    if (filenumber >= MAX_CONCURRENT_FILE_PIPES) {
+        return -3;
+    }
+
+    struct File_Transfers *ft = &m->friendlist[friendnumber].file_sending[filenumber];
+
+    if (ft->status == FILESTATUS_NONE) {
+        return -3;
+    }
+
+    if (ft->requested != ft->transferred) {
+        return -4;
+    }
+
+    ft->bulk = true;
+    ft->bulk_user_data = file_user_data;
+
+    return 0;
+}
+
+/** Maximum number of packets a bulk transfer sends per round, so concurrent
+ * transfers still get their share of the send queue.
+ */
+#define FILE_BULK_BATCH_PACKETS 16
+
+/**
+ * Pull data for a bulk file transfer from the client and put it straight into
+ * the send queue.
+ *
+ * The free_slots parameter is updated by this function.
+ */
+static void do_bulk_filetransfer(Messenger *_Nonnull m, int32_t friendnumber, uint8_t filenumber, void *_Nullable userdata,
+                                 uint32_t *_Nonnull free_slots)
+{
+    Friend *const friendcon = &m->friendlist[friendnumber];
+    struct File_Transfers *const ft = &friendcon->file_sending[filenumber];
+    const int crypt_connection_id = friend_connection_crypt_connection_id(m->fr_c, friendcon->friendcon_id);
+
+    uint8_t packet[MAX_CRYPTO_DATA_SIZE];
+    packet[0] = PACKET_ID_FILE_DATA;
+    packet[1] = filenumber;
+
+    for (uint32_t i = 0; i < FILE_BULK_BATCH_PACKETS && *free_slots > 0; ++i) {
+        const uint16_t length = min_u64(ft->size - ft->transferred, MAX_FILE_DATA_SIZE);
+        int32_t read = 0;
+
+        if (length > 0) {
+            if (m->file_bulk_read == nullptr) {
+                return;
+            }
+
+            read = m->file_bulk_read(m, friendnumber, filenumber, ft->transferred, packet + 2, length, ft->bulk_user_data, userdata);
+
+            // the callback might have killed the transfer
+            if (ft->status != FILESTATUS_TRANSFERRING) {
+                return;
+            }
+
+            if (read < 0 || read > length || (read < length && ft->size != UINT64_MAX)) {
+                LOGGER_WARNING(m->log, "bulk read for file %u failed (%d of %u bytes), killing the transfer", filenumber, read, length);
+                file_control(m, friendnumber, filenumber, FILECONTROL_KILL);
+                return;
+            }
+        }
+
+        const int64_t ret = write_cryptpacket(m->net_crypto, crypt_connection_id, packet, 2 + read, true);
+
+        if (ret == -1) {
+            // queue full, the data gets read again next time
+            return;
+        }
+
+        ft->transferred += read;
+        ft->requested = ft->transferred;
+        --*free_slots;
+
+        if (read != MAX_FILE_DATA_SIZE || ft->size == ft->transferred) {
+            ft->status = FILESTATUS_FINISHED;
+            ft->last_packet_number = ret;
+            return;
+        }
+
+        if (max_speed_reached(m->net_crypto, crypt_connection_id)) {
+            return;
+        }
+    }
+}
+
 /**
  * Iterate over all file transfers and request chunks (from the client) for each
  * of them.
@@ -1642,6 +1805,11 @@ static bool do_all_filetransfers(Messenger *_Nonnull m, int32_t friendnumber, vo
             ft->status = FILESTATUS_NONE;
             --friendcon->num_sending_files;
         } else if (ft->status == FILESTATUS_TRANSFERRING && ft->paused == FILE_PAUSE_NOT) {
+            if (ft->bulk) {
+                do_bulk_filetransfer(m, friendnumber, i, userdata, free_slots);
+                continue;
+            }
+
             if (ft->size == 0) {
                 /* Send 0 data to friend if file is 0 length. */
                 send_file_data(m, friendnumber, i, 0, nullptr, 0);
@@ -2566,6 +2734,9 @@ void do_messenger(Messenger *m, void *userdata)
     do_gc_onion_friends(m);
     m_connection_status_callback(m, userdata);
 
+    // Everything that sends to TCP relays has run.
+    flush_tcp_connections(m->log, nc_get_tcp_c(m->net_crypto));
+
     if (mono_time_get(m->mono_time) > m->lastdump + DUMPING_CLIENTS_FRIENDS_EVERY_N_SECONDS) {
         m->lastdump = mono_time_get(m->mono_time);
         uint32_t last_pinged;
@@ -2941,6 +3112,40 @@ static uint32_t saved_friendslist_size(const Messenger *_Nonnull m)
     return count_friendlist(m) * friend_size();
 }
 
+static uint8_t *_Nonnull saved_friend_save(const Friend *_Nonnull f, uint8_t *_Nonnull data)
+{
+    struct Saved_Friend temp = { 0 };
+    temp.status = f->status;
+    memcpy(temp.real_pk, f->real_pk, CRYPTO_PUBLIC_KEY_SIZE);
+
+    if (temp.status < 3) {
+        // TODO(iphydf): Use uint16_t and min_u16 here.
+        const size_t friendrequest_length =
+            min_u32(f->info_size,
+                    min_u32(SAVED_FRIEND_REQUEST_SIZE, MAX_FRIEND_REQUEST_DATA_SIZE));
+        memcpy(temp.info, f->info, friendrequest_length);
+
+        temp.info_size = net_htons(f->info_size);
+        temp.friendrequest_nospam = f->friendrequest_nospam;
+    } else {
+        temp.status = 3;
+        memcpy(temp.name, f->name, f->name_length);
+        temp.name_length = net_htons(f->name_length);
+        memcpy(temp.statusmessage, f->statusmessage, f->statusmessage_length);
+        temp.statusmessage_length = net_htons(f->statusmessage_length);
+        temp.userstatus = f->userstatus;
+
+        net_pack_u64(temp.last_seen_time, f->last_seen_time);
+    }
+
+    uint8_t *next_data = friend_save(&temp, data);
+    assert(next_data - data == friend_size());
+#ifdef __LP64__
+    assert(memcmp(data, &temp, friend_size()) == 0);
+#endif /* __LP64__ */
+    return next_data;
+}
+
 static uint8_t *_Nonnull friends_list_save(const Messenger *_Nonnull m, uint8_t *_Nonnull data)
 {
     const uint32_t len = m_plugin_size(m, STATE_TYPE_FRIENDS);
@@ -2951,36 +3156,7 @@ static uint8_t *_Nonnull friends_list_save(const Messenger *_Nonnull m, uint8_t
 
     for (uint32_t i = 0; i < m->numfriends; ++i) {
         if (m->friendlist[i].status > 0) {
-            struct Saved_Friend temp = { 0 };
-            temp.status = m->friendlist[i].status;
-            memcpy(temp.real_pk, m->friendlist[i].real_pk, CRYPTO_PUBLIC_KEY_SIZE);
-
-            if (temp.status < 3) {
-                // TODO(iphydf): Use uint16_t and min_u16 here.
-                const size_t friendrequest_length =
-                    min_u32(m->friendlist[i].info_size,
-                            min_u32(SAVED_FRIEND_REQUEST_SIZE, MAX_FRIEND_REQUEST_DATA_SIZE));
-                memcpy(temp.info, m->friendlist[i].info, friendrequest_length);
-
-                temp.info_size = net_htons(m->friendlist[i].info_size);
-                temp.friendrequest_nospam = m->friendlist[i].friendrequest_nospam;
-            } else {
-                temp.status = 3;
-                memcpy(temp.name, m->friendlist[i].name, m->friendlist[i].name_length);
-                temp.name_length = net_htons(m->friendlist[i].name_length);
-                memcpy(temp.statusmessage, m->friendlist[i].statusmessage, m->friendlist[i].statusmessage_length);
-                temp.statusmessage_length = net_htons(m->friendlist[i].statusmessage_length);
-                temp.userstatus = m->friendlist[i].userstatus;
-
-                net_pack_u64(temp.last_seen_time, m->friendlist[i].last_seen_time);
-            }
-
-            uint8_t *next_data = friend_save(&temp, cur_data);
-            assert(next_data - cur_data == friend_size());
-#ifdef __LP64__
-            assert(memcmp(cur_data, &temp, friend_size()) == 0);
-#endif /* __LP64__ */
-            cur_data = next_data;
+            cur_data = saved_friend_save(&m->friendlist[i], cur_data);
             ++num;
         }
     }
@@ -2991,6 +3167,30 @@ static uint8_t *_Nonnull friends_list_save(const Messenger *_Nonnull m, uint8_t
     return data;
 }
 
+static void saved_friend_load(Messenger *_Nonnull m, const struct Saved_Friend *_Nonnull temp)
+{
+    if (temp->status >= 3) {
+        const int fnum = m_addfriend_norequest(m, temp->real_pk);
+
+        if (fnum < 0) {
+            return;
+        }
+
+        setfriendname(m, fnum, temp->name, net_ntohs(temp->name_length));
+        set_friend_statusmessage(m, fnum, temp->statusmessage, net_ntohs(temp->statusmessage_length));
+        set_friend_userstatus(m, fnum, temp->userstatus);
+        net_unpack_u64(temp->last_seen_time, &m->friendlist[fnum].last_seen_time);
+    } else if (temp->status != 0) {
+        /* TODO(irungentoo): This is not a good way to do this. */
+        uint8_t address[FRIEND_ADDRESS_SIZE];
+        pk_copy(address, temp->real_pk);
+        memcpy(address + CRYPTO_PUBLIC_KEY_SIZE, &temp->friendrequest_nospam, sizeof(uint32_t));
+        uint16_t checksum = data_checksum(address, FRIEND_ADDRESS_SIZE - sizeof(checksum));
+        memcpy(address + CRYPTO_PUBLIC_KEY_SIZE + sizeof(uint32_t), &checksum, sizeof(checksum));
+        m_addfriend(m, address, temp->info, net_ntohs(temp->info_size));
+    }
+}
+
 static State_Load_Status friends_list_load(Messenger *_Nonnull m, const uint8_t *_Nonnull data, uint32_t length)
 {
     const uint32_t l_friend_size = friend_size();
@@ -3008,26 +3208,61 @@ static State_Load_Status friends_list_load(Messenger *_Nonnull m, const uint8_t
         assert(next_data - cur_data == l_friend_size);
 
         cur_data = next_data;
+        saved_friend_load(m, &temp);
+    }
 
-        if (temp.status >= 3) {
-            const int fnum = m_addfriend_norequest(m, temp.real_pk);
+    return STATE_LOAD_STATUS_CONTINUE;
+}
 
-            if (fnum < 0) {
-                continue;
-            }
+// journal only: friends that were added or changed since the last journal entry
+static State_Load_Status changed_friends_load(Messenger *_Nonnull m, const uint8_t *_Nonnull data, uint32_t length)
+{
+    const uint32_t l_friend_size = friend_size();
+
+    if (length % l_friend_size != 0) {
+        return STATE_LOAD_STATUS_ERROR;
+    }
+
+    const uint32_t num = length / l_friend_size;
+    const uint8_t *cur_data = data;
+
+    for (uint32_t i = 0; i < num; ++i) {
+        struct Saved_Friend temp = { 0 };
+        cur_data = friend_load(&temp, cur_data);
+
+        const int32_t fnum = getfriend_id(m, temp.real_pk);
 
+        if (fnum >= 0 && m->friendlist[fnum].status >= FRIEND_CONFIRMED && temp.status >= 3) {
+            // Still a confirmed friend, keep the connection and update what is saved.
             setfriendname(m, fnum, temp.name, net_ntohs(temp.name_length));
             set_friend_statusmessage(m, fnum, temp.statusmessage, net_ntohs(temp.statusmessage_length));
             set_friend_userstatus(m, fnum, temp.userstatus);
             net_unpack_u64(temp.last_seen_time, &m->friendlist[fnum].last_seen_time);
-        } else if (temp.status != 0) {
-            /* TODO(irungentoo): This is not a good way to do this. */
-            uint8_t address[FRIEND_ADDRESS_SIZE];
-            pk_copy(address, temp.real_pk);
-            memcpy(address + CRYPTO_PUBLIC_KEY_SIZE, &temp.friendrequest_nospam, sizeof(uint32_t));
-            uint16_t checksum = data_checksum(address, FRIEND_ADDRESS_SIZE - sizeof(checksum));
-            memcpy(address + CRYPTO_PUBLIC_KEY_SIZE + sizeof(uint32_t), &checksum, sizeof(checksum));
-            m_addfriend(m, address, temp.info, net_ntohs(temp.info_size));
+            continue;
+        }
+
+        if (fnum >= 0) {
+            m_delfriend(m, fnum);
+        }
+
+        saved_friend_load(m, &temp);
+    }
+
+    return STATE_LOAD_STATUS_CONTINUE;
+}
+
+// journal only: public keys of deleted friends
+static State_Load_Status deleted_friends_load(Messenger *_Nonnull m, const uint8_t *_Nonnull data, uint32_t length)
+{
+    if (length % CRYPTO_PUBLIC_KEY_SIZE != 0) {
+        return STATE_LOAD_STATUS_ERROR;
+    }
+
+    for (uint32_t pos = 0; pos < length; pos += CRYPTO_PUBLIC_KEY_SIZE) {
+        const int32_t fnum = getfriend_id(m, data + pos);
+
+        if (fnum >= 0) {
+            m_delfriend(m, fnum);
         }
     }
 
@@ -3069,10 +3304,8 @@ static uint8_t *_Nonnull groups_save(const Messenger *_Nonnull m, uint8_t *_Nonn
 
     const uint32_t num_groups = gc_count_groups(c);
 
-    if (num_groups == 0) {
-        return data;
-    }
-
+    // An empty list is still saved: the section size includes it, and a
+    // savedata journal can't be appended behind unused bytes.
     const uint32_t len = m_plugin_size(m, STATE_TYPE_GROUPS);
 
     if (len == 0) {
@@ -3306,9 +3539,158 @@ static void m_register_default_plugins(Messenger *_Nonnull m)
     m_register_state_plugin(m, STATE_TYPE_PATH_NODE, path_node_size, load_path_nodes, save_path_nodes);
 }
 
+static bool m_journal_tracks(State_Type type)
+{
+    return type == STATE_TYPE_NOSPAMKEYS || type == STATE_TYPE_NAME
+           || type == STATE_TYPE_STATUSMESSAGE || type == STATE_TYPE_STATUS;
+}
+
+void messenger_journal_mark_dirty(Messenger *m, State_Type type)
+{
+    if (m_journal_tracks(type)) {
+        m->journal_dirty_sections |= 1u << type;
+    }
+}
+
+/** Hash of the saved group chats, to find out whether they changed without tracking every change. */
+static bool m_groups_hash(const Messenger *_Nonnull m, uint8_t hash[_Nonnull CRYPTO_SHA256_SIZE])
+{
+    const uint32_t len = saved_groups_size(m);
+    uint8_t *packed = (uint8_t *)mem_balloc(m->mem, len);
+
+    if (packed == nullptr) {
+        return false;
+    }
+
+    const bool ok = bin_pack_obj(pack_groupchats_handler, m->group_handler, m->log, packed, len);
+
+    if (ok) {
+        crypto_sha256(hash, packed, len);
+    }
+
+    mem_delete(m->mem, packed);
+    return ok;
+}
+
+static bool m_journal_section_dirty(const Messenger *_Nonnull m, State_Type type)
+{
+    if (m_journal_tracks(type)) {
+        return (m->journal_dirty_sections & (1u << type)) != 0;
+    }
+
+    if (type == STATE_TYPE_GROUPS) {
+        uint8_t hash[CRYPTO_SHA256_SIZE];
+        // If we can't tell, save them.
+        return !m_groups_hash(m, hash) || !crypto_sha256_eq(hash, m->journal_groups_hash);
+    }
+
+    return false;
+}
+
+static uint32_t m_journal_changed_friends(const Messenger *_Nonnull m)
+{
+    uint32_t num = 0;
+
+    for (uint32_t i = 0; i < m->numfriends; ++i) {
+        if (m->friendlist[i].status > 0 && m->friendlist[i].save_dirty) {
+            ++num;
+        }
+    }
+
+    return num;
+}
+
+uint32_t messenger_journal_size(const Messenger *m)
+{
+    const uint32_t sizesubhead = sizeof(uint32_t) * 2;
+    uint32_t size = 0;
+
+    if (m->journal_deleted_friends_length > 0) {
+        size += sizesubhead + m->journal_deleted_friends_length * CRYPTO_PUBLIC_KEY_SIZE;
+    }
+
+    const uint32_t changed_friends = m_journal_changed_friends(m);
+
+    if (changed_friends > 0) {
+        size += sizesubhead + changed_friends * friend_size();
+    }
+
+    for (uint8_t i = 0; i < m->options.state_plugins_length; ++i) {
+        const Messenger_State_Plugin *const plugin = &m->options.state_plugins[i];
+
+        if (m_journal_section_dirty(m, plugin->type)) {
+            size += sizesubhead + plugin->size(m);
+        }
+    }
+
+    return size;
+}
+
+uint8_t *messenger_journal_save(Messenger *m, uint8_t *data)
+{
+    // Deletions go first, so a friend that was deleted and added again ends up added.
+    if (m->journal_deleted_friends_length > 0) {
+        const uint32_t len = m->journal_deleted_friends_length * CRYPTO_PUBLIC_KEY_SIZE;
+        data = state_write_section_header(data, STATE_COOKIE_TYPE, len, STATE_TYPE_FRIEND_DELETED);
+        memcpy(data, m->journal_deleted_friends, len);
+        data += len;
+    }
+
+    const uint32_t changed_friends = m_journal_changed_friends(m);
+
+    if (changed_friends > 0) {
+        data = state_write_section_header(data, STATE_COOKIE_TYPE, changed_friends * friend_size(), STATE_TYPE_FRIEND);
+
+        for (uint32_t i = 0; i < m->numfriends; ++i) {
+            if (m->friendlist[i].status > 0 && m->friendlist[i].save_dirty) {
+                data = saved_friend_save(&m->friendlist[i], data);
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < m->options.state_plugins_length; ++i) {
+        const Messenger_State_Plugin plugin = m->options.state_plugins[i];
+
+        if (m_journal_section_dirty(m, plugin.type)) {
+            data = plugin.save(m, data);
+        }
+    }
+
+    messenger_journal_reset(m);
+
+    return data;
+}
+
+void messenger_journal_reset(Messenger *m)
+{
+    m->journal_dirty_sections = 0;
+
+    mem_delete(m->mem, m->journal_deleted_friends);
+    m->journal_deleted_friends = nullptr;
+    m->journal_deleted_friends_length = 0;
+
+    for (uint32_t i = 0; i < m->numfriends; ++i) {
+        m->friendlist[i].save_dirty = false;
+    }
+
+    if (!m->options.groups_persistence_enabled || !m_groups_hash(m, m->journal_groups_hash)) {
+        memzero(m->journal_groups_hash, sizeof(m->journal_groups_hash));
+    }
+}
+
 bool messenger_load_state_section(Messenger *m, const uint8_t *data, uint32_t length, uint16_t type,
                                   State_Load_Status *status)
 {
+    if (type == STATE_TYPE_FRIEND) {
+        *status = changed_friends_load(m, data, length);
+        return true;
+    }
+
+    if (type == STATE_TYPE_FRIEND_DELETED) {
+        *status = deleted_friends_load(m, data, length);
+        return true;
+    }
+
     for (uint8_t i = 0; i < m->options.state_plugins_length; ++i) {
         const Messenger_State_Plugin *const plugin = &m->options.state_plugins[i];
 
@@ -3642,6 +4024,7 @@ void kill_messenger(Messenger *m)
     }
 
     mem_delete(m->mem, m->friendlist);
+    mem_delete(m->mem, m->journal_deleted_friends);
     friendreq_kill(m->fr);
 
     mem_delete(m->mem, m->options.state_plugins);
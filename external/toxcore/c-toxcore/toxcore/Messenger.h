@@ -151,6 +151,8 @@ struct File_Transfers {
     uint32_t last_packet_number; /* number of the last packet sent. */
     uint64_t requested; /* total data requested by the request chunk callback */
     uint8_t id[FILE_ID_LENGTH];
+    bool bulk; /* data is pulled with the bulk read callback instead of chunk requests */
+    void *_Nullable bulk_user_data; /* passed to the bulk read callback */
 };
 typedef enum Filestatus {
     FILESTATUS_NONE,
@@ -201,6 +203,14 @@ typedef void m_file_chunk_request_cb(Messenger *_Nonnull m, uint32_t friend_numb
                                      size_t length, void *_Nullable user_data);
 typedef void m_file_recv_chunk_cb(Messenger *_Nonnull m, uint32_t friend_number, uint32_t file_number, uint64_t position,
                                   const uint8_t *_Nullable data, size_t length, void *_Nullable user_data);
+/** @brief Fill `data` with `length` bytes of the file starting at `position`.
+ *
+ * @return the number of bytes written. Less than `length` ends a streaming
+ *   transfer (size UINT64_MAX) and kills any other transfer.
+ * @retval -1 on error, the transfer gets killed.
+ */
+typedef int32_t m_file_bulk_read_cb(Messenger *_Nonnull m, uint32_t friend_number, uint32_t file_number, uint64_t position,
+                                    uint8_t *_Nonnull data, uint16_t length, void *_Nullable file_user_data, void *_Nullable user_data);
 typedef void m_friend_lossy_packet_cb(Messenger *_Nonnull m, uint32_t friend_number, uint8_t packet_id, const uint8_t *_Nonnull data,
                                       size_t length, void *_Nullable user_data);
 typedef void m_friend_lossless_packet_cb(Messenger *_Nonnull m, uint32_t friend_number, uint8_t packet_id, const uint8_t *_Nonnull data,
@@ -233,6 +243,7 @@ typedef struct Friend {
     uint32_t message_id; // a semi-unique id used in read receipts.
     uint32_t friendrequest_nospam; // The nospam number used in the friend request.
     uint64_t last_seen_time;
+    bool save_dirty; // true if the saved friend changed since the last savedata journal entry.
     Connection_Status last_connection_udp_tcp;
     struct File_Transfers file_sending[MAX_CONCURRENT_FILE_PIPES];
     uint32_t num_sending_files;
@@ -305,6 +316,7 @@ struct Messenger {
     m_file_recv_control_cb *_Nullable file_filecontrol;
     m_file_recv_chunk_cb *_Nullable file_filedata;
     m_file_chunk_request_cb *_Nullable file_reqchunk;
+    m_file_bulk_read_cb *_Nullable file_bulk_read;
 
     m_friend_lossy_packet_cb *_Nullable lossy_packethandler;
     m_friend_lossless_packet_cb *_Nullable lossless_packethandler;
@@ -312,6 +324,12 @@ struct Messenger {
     m_self_connection_status_cb *_Nullable core_connection_change;
     Onion_Connection_Status last_connection_status;
 
+    /* What changed since the last savedata journal entry, see messenger_journal_save(). */
+    uint32_t journal_dirty_sections; // bit (1 << State_Type) per section
+    uint8_t *_Nullable journal_deleted_friends; // public keys
+    uint32_t journal_deleted_friends_length;
+    uint8_t journal_groups_hash[CRYPTO_SHA256_SIZE];
+
     Messenger_Options options;
 };
 
@@ -621,6 +639,9 @@ void callback_file_data(Messenger *_Nonnull m, m_file_recv_chunk_cb *_Nonnull fu
 /** @brief Set the callback for file request chunk. */
 void callback_file_reqchunk(Messenger *_Nonnull m, m_file_chunk_request_cb *_Nonnull function);
 
+/** @brief Set the callback for bulk file reads. */
+void callback_file_bulk_read(Messenger *_Nonnull m, m_file_bulk_read_cb *_Nonnull function);
+
 /** @brief Copy the file transfer file id to file_id
  *
  * @retval 0 on success.
@@ -670,6 +691,21 @@ int file_control(const Messenger *_Nonnull m, int32_t friendnumber, uint32_t fil
  */
 int file_seek(const Messenger *_Nonnull m, int32_t friendnumber, uint32_t filenumber, uint64_t position);
 
+/** @brief Switch an outgoing file transfer to bulk mode.
+ *
+ * Instead of requesting each chunk from the client and waiting for it to come
+ * back through send_file_data, the data is pulled with the bulk read callback
+ * straight into the send queue, as many packets at once as the connection
+ * allows. Only the final chunk request of size 0 is still sent.
+ *
+ * @retval 0 on success.
+ * @retval -1 if friend not valid.
+ * @retval -2 if friend not online.
+ * @retval -3 if filenumber invalid.
+ * @retval -4 if chunks have been requested that were not sent yet.
+ */
+int file_set_bulk_read(const Messenger *_Nonnull m, int32_t friendnumber, uint32_t filenumber, void *_Nullable file_user_data);
+
 /** @brief Send file data.
  *
  * @retval 0 on success
@@ -762,6 +798,31 @@ uint32_t messenger_size(const Messenger *_Nonnull m);
 /** Save the messenger in data (must be allocated memory of size at least `Messenger_size()`) */
 uint8_t *_Nonnull messenger_save(const Messenger *_Nonnull m, uint8_t *_Nonnull data);
 
+/** @brief Mark a section of the save data as changed since the last journal entry. */
+void messenger_journal_mark_dirty(Messenger *_Nonnull m, State_Type type);
+
+/** @brief Size of the savedata journal entry written by messenger_journal_save.
+ *
+ * The entry holds the sections (and individual friends) that changed since
+ * the last messenger_journal_save or messenger_journal_reset. Our own name,
+ * status, status message and nospam are tracked when they are set, friends
+ * when they are added, changed or deleted, and group chats are compared with
+ * what was last saved. DHT nodes, TCP relays and onion path nodes are only
+ * refreshed by a full save.
+ *
+ * @return 0 if nothing changed.
+ */
+uint32_t messenger_journal_size(const Messenger *_Nonnull m);
+
+/** @brief Write the journal entry (without end section) and mark everything as saved.
+ *
+ * `data` must have room for messenger_journal_size() bytes.
+ */
+uint8_t *_Nonnull messenger_journal_save(Messenger *_Nonnull m, uint8_t *_Nonnull data);
+
+/** @brief Mark everything as saved, after a full save or a load. */
+void messenger_journal_reset(Messenger *_Nonnull m);
+
 /** @brief Load a state section.
  *
  * @param data Data to load.
@@ -146,15 +146,15 @@ static int proxy_http_generate_connection_request(TCP_Client_Connection *_Nonnul
     }
 
     const uint16_t port = net_ntohs(tcp_conn->ip_port.port);
-    const int written = snprintf((char *)tcp_conn->con.last_packet, MAX_PACKET_SIZE, "%s%s:%hu%s%s:%hu%s", one, ip, port,
+    const int written = snprintf((char *)tcp_conn->con.send_buffer, MAX_PACKET_SIZE, "%s%s:%hu%s%s:%hu%s", one, ip, port,
                                  two, ip, port, three);
 
     if (written < 0 || MAX_PACKET_SIZE < written) {
         return 0;
     }
 
-    tcp_conn->con.last_packet_length = written;
-    tcp_conn->con.last_packet_sent = 0;
+    tcp_conn->con.send_buffer_length = written;
+    tcp_conn->con.send_buffer_sent = 0;
     return 1;
 }
 
@@ -214,12 +214,12 @@ enum Tcp_Socks5_Proxy_Hs {
 
 static void proxy_socks5_generate_greetings(TCP_Client_Connection *_Nonnull tcp_conn)
 {
-    tcp_conn->con.last_packet[0] = TCP_SOCKS5_PROXY_HS_VERSION_SOCKS5;
-    tcp_conn->con.last_packet[1] = TCP_SOCKS5_PROXY_HS_AUTH_METHODS_SUPPORTED;
-    tcp_conn->con.last_packet[2] = TCP_SOCKS5_PROXY_HS_NO_AUTH;
+    tcp_conn->con.send_buffer[0] = TCP_SOCKS5_PROXY_HS_VERSION_SOCKS5;
+    tcp_conn->con.send_buffer[1] = TCP_SOCKS5_PROXY_HS_AUTH_METHODS_SUPPORTED;
+    tcp_conn->con.send_buffer[2] = TCP_SOCKS5_PROXY_HS_NO_AUTH;
 
-    tcp_conn->con.last_packet_length = 3;
-    tcp_conn->con.last_packet_sent = 0;
+    tcp_conn->con.send_buffer_length = 3;
+    tcp_conn->con.send_buffer_sent = 0;
 }
 
 /**
@@ -246,28 +246,28 @@ static int socks5_read_handshake_response(const Logger *_Nonnull logger, const T
 
 static void proxy_socks5_generate_connection_request(TCP_Client_Connection *_Nonnull tcp_conn)
 {
-    tcp_conn->con.last_packet[0] = TCP_SOCKS5_PROXY_HS_VERSION_SOCKS5;
-    tcp_conn->con.last_packet[1] = TCP_SOCKS5_PROXY_HS_COMM_ESTABLISH_REQUEST;
-    tcp_conn->con.last_packet[2] = TCP_SOCKS5_PROXY_HS_RESERVED;
+    tcp_conn->con.send_buffer[0] = TCP_SOCKS5_PROXY_HS_VERSION_SOCKS5;
+    tcp_conn->con.send_buffer[1] = TCP_SOCKS5_PROXY_HS_COMM_ESTABLISH_REQUEST;
+    tcp_conn->con.send_buffer[2] = TCP_SOCKS5_PROXY_HS_RESERVED;
     uint16_t length = 3;
 
     if (net_family_is_ipv4(tcp_conn->ip_port.ip.family)) {
-        tcp_conn->con.last_packet[3] = TCP_SOCKS5_PROXY_HS_ADDR_TYPE_IPV4;
+        tcp_conn->con.send_buffer[3] = TCP_SOCKS5_PROXY_HS_ADDR_TYPE_IPV4;
         ++length;
-        memcpy(tcp_conn->con.last_packet + length, tcp_conn->ip_port.ip.ip.v4.uint8, sizeof(IP4));
+        memcpy(tcp_conn->con.send_buffer + length, tcp_conn->ip_port.ip.ip.v4.uint8, sizeof(IP4));
         length += sizeof(IP4);
     } else {
-        tcp_conn->con.last_packet[3] = TCP_SOCKS5_PROXY_HS_ADDR_TYPE_IPV6;
+        tcp_conn->con.send_buffer[3] = TCP_SOCKS5_PROXY_HS_ADDR_TYPE_IPV6;
         ++length;
-        memcpy(tcp_conn->con.last_packet + length, tcp_conn->ip_port.ip.ip.v6.uint8, sizeof(IP6));
+        memcpy(tcp_conn->con.send_buffer + length, tcp_conn->ip_port.ip.ip.v6.uint8, sizeof(IP6));
         length += sizeof(IP6);
     }
 
-    memcpy(tcp_conn->con.last_packet + length, &tcp_conn->ip_port.port, sizeof(uint16_t));
+    memcpy(tcp_conn->con.send_buffer + length, &tcp_conn->ip_port.port, sizeof(uint16_t));
     length += sizeof(uint16_t);
 
-    tcp_conn->con.last_packet_length = length;
-    tcp_conn->con.last_packet_sent = 0;
+    tcp_conn->con.send_buffer_length = length;
+    tcp_conn->con.send_buffer_sent = 0;
 }
 
 /**
@@ -316,17 +316,17 @@ static int generate_handshake(TCP_Client_Connection *_Nonnull tcp_conn)
     crypto_new_keypair(tcp_conn->con.rng, plain, tcp_conn->temp_secret_key);
     random_nonce(tcp_conn->con.rng, tcp_conn->con.sent_nonce);
     memcpy(plain + CRYPTO_PUBLIC_KEY_SIZE, tcp_conn->con.sent_nonce, CRYPTO_NONCE_SIZE);
-    memcpy(tcp_conn->con.last_packet, tcp_conn->self_public_key, CRYPTO_PUBLIC_KEY_SIZE);
-    random_nonce(tcp_conn->con.rng, tcp_conn->con.last_packet + CRYPTO_PUBLIC_KEY_SIZE);
-    const int len = encrypt_data_symmetric(tcp_conn->con.mem, tcp_conn->con.shared_key, tcp_conn->con.last_packet + CRYPTO_PUBLIC_KEY_SIZE, plain,
-                                           sizeof(plain), tcp_conn->con.last_packet + CRYPTO_PUBLIC_KEY_SIZE + CRYPTO_NONCE_SIZE);
+    memcpy(tcp_conn->con.send_buffer, tcp_conn->self_public_key, CRYPTO_PUBLIC_KEY_SIZE);
+    random_nonce(tcp_conn->con.rng, tcp_conn->con.send_buffer + CRYPTO_PUBLIC_KEY_SIZE);
+    const int len = encrypt_data_symmetric(tcp_conn->con.mem, tcp_conn->con.shared_key, tcp_conn->con.send_buffer + CRYPTO_PUBLIC_KEY_SIZE, plain,
+                                           sizeof(plain), tcp_conn->con.send_buffer + CRYPTO_PUBLIC_KEY_SIZE + CRYPTO_NONCE_SIZE);
 
     if (len != sizeof(plain) + CRYPTO_MAC_SIZE) {
         return -1;
     }
 
-    tcp_conn->con.last_packet_length = CRYPTO_PUBLIC_KEY_SIZE + CRYPTO_NONCE_SIZE + sizeof(plain) + CRYPTO_MAC_SIZE;
-    tcp_conn->con.last_packet_sent = 0;
+    tcp_conn->con.send_buffer_length = CRYPTO_PUBLIC_KEY_SIZE + CRYPTO_NONCE_SIZE + sizeof(plain) + CRYPTO_MAC_SIZE;
+    tcp_conn->con.send_buffer_sent = 0;
     return 0;
 }
 
@@ -662,6 +662,7 @@ TCP_Client_Connection *new_tcp_connection(
     temp->con.sock = sock;
     temp->con.ip_port = *ip_port;
     temp->con.net_profile = net_profile;
+    temp->con.mono_time = mono_time;
     memcpy(temp->public_key, public_key, CRYPTO_PUBLIC_KEY_SIZE);
     memcpy(temp->self_public_key, self_public_key, CRYPTO_PUBLIC_KEY_SIZE);
     encrypt_precompute(temp->public_key, self_secret_key, temp->con.shared_key);
@@ -945,9 +946,19 @@ static int do_confirmed_tcp(const Logger *_Nonnull logger, TCP_Client_Connection
         /* Keep reading until error or out of data. */
     }
 
+    // Pongs and anything the callbacks sent.
+    send_pending_data(logger, &conn->con);
+
     return 0;
 }
 
+void tcp_con_flush(const Logger *logger, TCP_Client_Connection *tcp_connection)
+{
+    if (tcp_connection->status == TCP_CLIENT_CONFIRMED) {
+        send_pending_data(logger, &tcp_connection->con);
+    }
+}
+
 /** Run the TCP connection */
 void do_tcp_connection(const Logger *logger, const Mono_Time *mono_time,
                        TCP_Client_Connection *tcp_connection, void *userdata)
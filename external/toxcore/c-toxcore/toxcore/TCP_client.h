@@ -69,6 +69,12 @@ TCP_Client_Connection *_Nullable new_tcp_connection(
 /** Run the TCP connection */
 void do_tcp_connection(const Logger *_Nonnull logger, const Mono_Time *_Nonnull mono_time,
                        TCP_Client_Connection *_Nonnull tcp_connection, void *_Nullable userdata);
+/** @brief Write out the packets that were sent since the last call.
+ *
+ * Packets are collected and written to the socket together, call this once all
+ * packets of an iteration have been sent.
+ */
+void tcp_con_flush(const Logger *_Nonnull logger, TCP_Client_Connection *_Nonnull tcp_connection);
 /** Kill the TCP connection */
 void kill_tcp_connection(TCP_Client_Connection *_Nullable tcp_connection);
 typedef int tcp_onion_response_cb(void *_Nonnull object, const uint8_t *_Nonnull data, uint16_t length, void *_Nullable userdata);
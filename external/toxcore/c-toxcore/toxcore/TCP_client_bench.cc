@@ -0,0 +1,258 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+// clang-format off
+#include "../testing/support/public/simulated_environment.hh"
+#include "TCP_client.h"
+// clang-format on
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "TCP_common.h"
+#include "crypto_core.h"
+#include "logger.h"
+#include "mono_time.h"
+#include "net_profile.h"
+#include "network.h"
+
+namespace {
+
+using tox::test::FakeClock;
+using tox::test::SimulatedEnvironment;
+
+/**
+ * A TCP client connected to a hand-rolled relay over the fake network, with
+ * one routed connection to send data on. The relay side only reads the stream.
+ */
+class TcpClientFixture {
+public:
+    SimulatedEnvironment env{12345};
+    std::unique_ptr<tox::test::ScopedToxSystem> server_node = env.create_node(33445);
+    std::unique_ptr<tox::test::ScopedToxSystem> client_node = env.create_node(0);
+    Logger *server_log = logger_new(&server_node->c_memory);
+    Logger *client_log = logger_new(&client_node->c_memory);
+    Mono_Time *client_time = mono_time_new(&client_node->c_memory, nullptr, nullptr);
+    Net_Profile *client_profile = netprof_new(client_log, &client_node->c_memory);
+    Socket server_sock = net_invalid_socket();
+    Socket accepted_sock = net_invalid_socket();
+    TCP_Client_Connection *client_conn = nullptr;
+
+    std::uint8_t shared_key[CRYPTO_SHARED_KEY_SIZE];
+    std::uint8_t sent_nonce[CRYPTO_NONCE_SIZE] = {0};
+
+    ~TcpClientFixture()
+    {
+        kill_tcp_connection(client_conn);
+        netprof_kill(&client_node->c_memory, client_profile);
+        kill_sock(&server_node->c_network, server_sock);
+
+        if (sock_valid(accepted_sock)) {
+            kill_sock(&server_node->c_network, accepted_sock);
+        }
+
+        logger_kill(client_log);
+        logger_kill(server_log);
+        mono_time_free(&client_node->c_memory, client_time);
+    }
+
+    bool connect()
+    {
+        mono_time_set_current_time_callback(
+            client_time,
+            [](void *user_data) -> std::uint64_t {
+                return static_cast<FakeClock *>(user_data)->current_time_ms();
+            },
+            &env.fake_clock());
+
+        const Network *server_ns = &server_node->c_network;
+        server_sock = net_socket(server_ns, net_family_ipv4(), TOX_SOCK_STREAM, TOX_PROTO_TCP);
+
+        if (!sock_valid(server_sock) || !set_socket_nonblock(server_ns, server_sock)
+            || !bind_to_port(server_ns, server_sock, net_family_ipv4(), 33445)
+            || net_listen(server_ns, server_sock, 5) != 0) {
+            return false;
+        }
+
+        std::uint8_t server_pk[CRYPTO_PUBLIC_KEY_SIZE];
+        std::uint8_t server_sk[CRYPTO_SECRET_KEY_SIZE];
+        crypto_new_keypair(&server_node->c_random, server_pk, server_sk);
+        std::uint8_t client_pk[CRYPTO_PUBLIC_KEY_SIZE];
+        std::uint8_t client_sk[CRYPTO_SECRET_KEY_SIZE];
+        crypto_new_keypair(&client_node->c_random, client_pk, client_sk);
+
+        IP_Port server_ip_port;
+        server_ip_port.ip = server_node->node->ip;
+        server_ip_port.port = net_htons(33445);
+
+        client_conn = new_tcp_connection(client_log, &client_node->c_memory, client_time, &client_node->c_random,
+            &client_node->c_network, &server_ip_port, server_pk, client_pk, client_sk, nullptr, client_profile);
+
+        if (client_conn == nullptr) {
+            return false;
+        }
+
+        for (int i = 0; i < 500 && tcp_con_status(client_conn) != TCP_CLIENT_CONFIRMED; ++i) {
+            env.advance_time(10);
+            do_tcp_connection(client_log, client_time, client_conn, nullptr);
+
+            if (!sock_valid(accepted_sock)) {
+                accepted_sock = net_accept(server_ns, server_sock);
+
+                if (sock_valid(accepted_sock)) {
+                    set_socket_nonblock(server_ns, accepted_sock);
+                }
+
+                continue;
+            }
+
+            std::uint8_t buf[TCP_CLIENT_HANDSHAKE_SIZE];
+            IP_Port remote = {{{0}}};
+
+            if (net_recv(server_ns, server_log, accepted_sock, buf, sizeof(buf), &remote) == TCP_CLIENT_HANDSHAKE_SIZE) {
+                answer_handshake(buf, client_pk, server_sk);
+            }
+        }
+
+        if (tcp_con_status(client_conn) != TCP_CLIENT_CONFIRMED) {
+            return false;
+        }
+
+        // Route connection 0 to someone who is online.
+        std::uint8_t routing_response[1 + 1 + CRYPTO_PUBLIC_KEY_SIZE] = {TCP_PACKET_ROUTING_RESPONSE, NUM_RESERVED_PORTS};
+        server_send_packet(routing_response, sizeof(routing_response));
+        const std::uint8_t notification[1 + 1] = {TCP_PACKET_CONNECTION_NOTIFICATION, NUM_RESERVED_PORTS};
+        server_send_packet(notification, sizeof(notification));
+
+        for (int i = 0; i < 10; ++i) {
+            env.advance_time(10);
+            do_tcp_connection(client_log, client_time, client_conn, nullptr);
+        }
+
+        drain();
+        return true;
+    }
+
+    /** Read everything the client wrote, returning the number of bytes. */
+    std::size_t drain()
+    {
+        std::size_t total = 0;
+        std::uint8_t buf[65536];
+        IP_Port remote = {{{0}}};
+
+        while (true) {
+            const int len = net_recv(&server_node->c_network, server_log, accepted_sock, buf, sizeof(buf), &remote);
+
+            if (len <= 0) {
+                return total;
+            }
+
+            total += len;
+        }
+    }
+
+private:
+    void answer_handshake(const std::uint8_t *buf, const std::uint8_t *client_pk, const std::uint8_t *server_sk)
+    {
+        encrypt_precompute(client_pk, server_sk, shared_key);
+        std::uint8_t plain[TCP_HANDSHAKE_PLAIN_SIZE];
+
+        if (decrypt_data_symmetric(&server_node->c_memory, shared_key, buf + CRYPTO_PUBLIC_KEY_SIZE,
+                buf + CRYPTO_PUBLIC_KEY_SIZE + CRYPTO_NONCE_SIZE,
+                TCP_CLIENT_HANDSHAKE_SIZE - (CRYPTO_PUBLIC_KEY_SIZE + CRYPTO_NONCE_SIZE), plain)
+            != TCP_HANDSHAKE_PLAIN_SIZE) {
+            return;
+        }
+
+        std::uint8_t temp_pk[CRYPTO_PUBLIC_KEY_SIZE];
+        std::uint8_t temp_sk[CRYPTO_SECRET_KEY_SIZE];
+        crypto_new_keypair(&server_node->c_random, temp_pk, temp_sk);
+
+        std::uint8_t resp_plain[TCP_HANDSHAKE_PLAIN_SIZE];
+        std::memcpy(resp_plain, temp_pk, CRYPTO_PUBLIC_KEY_SIZE);
+        random_nonce(&server_node->c_random, resp_plain + CRYPTO_PUBLIC_KEY_SIZE);
+        std::memcpy(sent_nonce, resp_plain + CRYPTO_PUBLIC_KEY_SIZE, CRYPTO_NONCE_SIZE);
+
+        std::uint8_t response[TCP_SERVER_HANDSHAKE_SIZE];
+        random_nonce(&server_node->c_random, response);
+        encrypt_data_symmetric(&server_node->c_memory, shared_key, response, resp_plain, TCP_HANDSHAKE_PLAIN_SIZE,
+            response + CRYPTO_NONCE_SIZE);
+
+        IP_Port remote = {{{0}}};
+        net_send(&server_node->c_network, server_log, accepted_sock, response, sizeof(response), &remote, nullptr);
+
+        encrypt_precompute(plain, temp_sk, shared_key);
+    }
+
+    void server_send_packet(const std::uint8_t *data, std::uint16_t length)
+    {
+        const std::uint16_t packet_size = sizeof(std::uint16_t) + length + CRYPTO_MAC_SIZE;
+        std::vector<std::uint8_t> packet(packet_size);
+        const std::uint16_t c_length = net_htons(length + CRYPTO_MAC_SIZE);
+        std::memcpy(packet.data(), &c_length, sizeof(std::uint16_t));
+        encrypt_data_symmetric(&server_node->c_memory, shared_key, sent_nonce, data, length,
+            packet.data() + sizeof(std::uint16_t));
+        increment_nonce(sent_nonce);
+
+        IP_Port remote = {{{0}}};
+        net_send(&server_node->c_network, server_log, accepted_sock, packet.data(), packet_size, &remote, nullptr);
+    }
+};
+
+/**
+ * Sends state.range(1) packets of state.range(0) bytes to the relay per
+ * iteration, the way a client relaying for many friends does, and reports
+ * how many socket writes that took.
+ */
+void BM_TcpClientSend(benchmark::State &state)
+{
+    const auto payload_size = static_cast<std::uint16_t>(state.range(0));
+    const auto packets_per_iteration = static_cast<int>(state.range(1));
+
+    TcpClientFixture fixture;
+
+    if (!fixture.connect()) {
+        state.SkipWithError("Failed to connect to the relay");
+        return;
+    }
+
+    const std::vector<std::uint8_t> payload(payload_size, 0x42);
+    const std::uint64_t sends_before = netprof_get_packet_count_total(fixture.client_profile, PACKET_DIRECTION_SEND);
+    std::uint64_t packets = 0;
+    std::uint64_t bytes = 0;
+
+    for (auto _ : state) {
+        for (int i = 0; i < packets_per_iteration; ++i) {
+            if (send_data(fixture.client_log, fixture.client_conn, 0, payload.data(), payload.size()) == 1) {
+                ++packets;
+            }
+        }
+
+        tcp_con_flush(fixture.client_log, fixture.client_conn);
+
+        state.PauseTiming();
+        fixture.env.advance_time(1);
+        bytes += fixture.drain();
+        state.ResumeTiming();
+    }
+
+    const std::uint64_t sends = netprof_get_packet_count_total(fixture.client_profile, PACKET_DIRECTION_SEND) - sends_before;
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(packets));
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+    state.counters["sends_per_packet"] = benchmark::Counter(packets == 0 ? 0.0 : static_cast<double>(sends) / packets);
+}
+
+// Args: payload size, packets per iteration.
+BENCHMARK(BM_TcpClientSend)
+    ->ArgNames({"size", "packets"})
+    ->ArgsProduct({{64, 512, 1300}, {1, 16, 64}});
+
+}  // namespace
+
+BENCHMARK_MAIN();
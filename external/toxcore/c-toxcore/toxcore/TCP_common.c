@@ -12,6 +12,7 @@
 #include "crypto_core.h"
 #include "logger.h"
 #include "mem.h"
+#include "mono_time.h"
 #include "network.h"
 
 void wipe_priority_list(const Memory *mem, TCP_Priority_List *p)
@@ -30,12 +31,12 @@ void wipe_priority_list(const Memory *mem, TCP_Priority_List *p)
  */
 int send_pending_data_nonpriority(const Logger *logger, TCP_Connection *con)
 {
-    if (con->last_packet_length == 0) {
+    if (con->send_buffer_length == 0) {
         return 0;
     }
 
-    const uint16_t left = con->last_packet_length - con->last_packet_sent;
-    const int len = net_send(con->ns, logger, con->sock, con->last_packet + con->last_packet_sent, left, &con->ip_port,
+    const uint16_t left = con->send_buffer_length - con->send_buffer_sent;
+    const int len = net_send(con->ns, logger, con->sock, con->send_buffer + con->send_buffer_sent, left, &con->ip_port,
                              con->net_profile);
 
     if (len <= 0) {
@@ -43,12 +44,12 @@ int send_pending_data_nonpriority(const Logger *logger, TCP_Connection *con)
     }
 
     if (len == left) {
-        con->last_packet_length = 0;
-        con->last_packet_sent = 0;
+        con->send_buffer_length = 0;
+        con->send_buffer_sent = 0;
         return 0;
     }
 
-    con->last_packet_sent += len;
+    con->send_buffer_sent += len;
     return -1;
 }
 
@@ -130,6 +131,46 @@ static bool add_priority(TCP_Connection *_Nonnull con, const uint8_t *_Nonnull p
     return true;
 }
 
+/** @brief Make room for `size` more bytes in the send buffer.
+ *
+ * Moves the part that hasn't been sent yet to the front if needed.
+ */
+static bool send_buffer_reserve(TCP_Connection *_Nonnull con, uint16_t size)
+{
+    if (con->send_buffer_length + size <= TCP_SEND_BUFFER_SIZE) {
+        return true;
+    }
+
+    const uint16_t unsent = con->send_buffer_length - con->send_buffer_sent;
+
+    if (unsent + size > TCP_SEND_BUFFER_SIZE) {
+        return false;
+    }
+
+    memmove(con->send_buffer, con->send_buffer + con->send_buffer_sent, unsent);
+    con->send_buffer_length = unsent;
+    con->send_buffer_sent = 0;
+    return true;
+}
+
+/** @brief Write the length-prefixed encrypted packet to `packet`, which has room for
+ * `sizeof(uint16_t) + length + CRYPTO_MAC_SIZE` bytes.
+ */
+static bool encrypt_tcp_packet(TCP_Connection *_Nonnull con, const uint8_t *_Nonnull data, uint16_t length,
+                               uint8_t *_Nonnull packet)
+{
+    const uint16_t c_length = net_htons(length + CRYPTO_MAC_SIZE);
+    memcpy(packet, &c_length, sizeof(uint16_t));
+    const int len = encrypt_data_symmetric(con->mem, con->shared_key, con->sent_nonce, data, length, packet + sizeof(uint16_t));
+
+    if (len != length + CRYPTO_MAC_SIZE) {
+        return false;
+    }
+
+    increment_nonce(con->sent_nonce);
+    return true;
+}
+
 /**
  * @retval 1 on success.
  * @retval 0 if could not send packet.
@@ -142,60 +183,52 @@ int write_packet_tcp_secure_connection(const Logger *logger, TCP_Connection *con
         return -1;
     }
 
-    bool sendpriority = true;
+    const uint16_t packet_size = sizeof(uint16_t) + length + CRYPTO_MAC_SIZE;
 
-    if (send_pending_data(logger, con) == -1) {
-        if (priority) {
-            sendpriority = false;
-        } else {
-            return 0;
-        }
+    // Queued packets go before this one, and a full buffer has to be written
+    // out to make room.
+    if (con->priority_queue_start != nullptr || !send_buffer_reserve(con, packet_size)) {
+        send_pending_data(logger, con);
     }
 
-    const uint16_t packet_size = sizeof(uint16_t) + length + CRYPTO_MAC_SIZE;
-    VLA(uint8_t, packet, packet_size);
-
-    uint16_t c_length = net_htons(length + CRYPTO_MAC_SIZE);
-    memcpy(packet, &c_length, sizeof(uint16_t));
-    int len = encrypt_data_symmetric(con->mem, con->shared_key, con->sent_nonce, data, length, packet + sizeof(uint16_t));
+    const bool buffered = con->priority_queue_start == nullptr && send_buffer_reserve(con, packet_size);
 
-    if ((unsigned int)len != (packet_size - sizeof(uint16_t))) {
-        return -1;
+    if (!buffered && !priority) {
+        return 0;
     }
 
-    if (priority) {
-        len = sendpriority ? net_send(con->ns, logger, con->sock, packet, packet_size, &con->ip_port,
-                                      con->net_profile) : 0;
+    if (buffered) {
+        const bool was_empty = con->send_buffer_length == con->send_buffer_sent;
 
-        if (len <= 0) {
-            len = 0;
+        if (!encrypt_tcp_packet(con, data, length, con->send_buffer + con->send_buffer_length)) {
+            return -1;
         }
 
-        increment_nonce(con->sent_nonce);
+        con->send_buffer_length += packet_size;
 
-        if ((unsigned int)len == packet_size) {
-            return 1;
+        if (priority) {
+            // Written straight through, together with what is buffered before it.
+            send_pending_data(logger, con);
+        } else if (con->mono_time != nullptr) {
+            const uint64_t now = current_time_monotonic(con->mono_time);
+
+            if (was_empty) {
+                con->send_buffer_time = now;
+            } else if (now - con->send_buffer_time >= TCP_SEND_BUFFER_MAX_DELAY) {
+                send_pending_data(logger, con);
+            }
         }
 
-        return add_priority(con, packet, packet_size, len) ? 1 : 0;
-    }
-
-    len = net_send(con->ns, logger, con->sock, packet, packet_size, &con->ip_port, con->net_profile);
-
-    if (len <= 0) {
-        return 0;
+        return 1;
     }
 
-    increment_nonce(con->sent_nonce);
+    VLA(uint8_t, packet, packet_size);
 
-    if ((unsigned int)len == packet_size) {
-        return 1;
+    if (!encrypt_tcp_packet(con, data, length, packet)) {
+        return -1;
     }
 
-    memcpy(con->last_packet, packet, packet_size);
-    con->last_packet_length = packet_size;
-    con->last_packet_sent = len;
-    return 1;
+    return add_priority(con, packet, packet_size, 0) ? 1 : 0;
 }
 
 /** @brief Read length bytes from socket.
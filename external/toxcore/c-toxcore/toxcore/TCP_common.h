@@ -13,6 +13,7 @@
 #include "crypto_core.h"
 #include "logger.h"
 #include "mem.h"
+#include "mono_time.h"
 #include "net.h"
 #include "net_profile.h"
 #include "network.h"
@@ -63,6 +64,12 @@ bool tcp_packet_from_int(uint32_t value, Tcp_Packet *_Nonnull out_enum);
 
 #define MAX_PACKET_SIZE 2048
 
+/** Holds at least one packet of any size, and many small ones. */
+#define TCP_SEND_BUFFER_SIZE (2 * (sizeof(uint16_t) + MAX_PACKET_SIZE))
+
+/** Longest time in ms a packet waits in the send buffer for the end of the iteration. */
+#define TCP_SEND_BUFFER_MAX_DELAY 5
+
 typedef struct TCP_Connection {
     const Memory *_Nonnull mem;
     const Random *_Nonnull rng;
@@ -71,9 +78,16 @@ typedef struct TCP_Connection {
     IP_Port ip_port;  // for debugging.
     uint8_t sent_nonce[CRYPTO_NONCE_SIZE]; /* Nonce of sent packets. */
     uint8_t shared_key[CRYPTO_SHARED_KEY_SIZE];
-    uint8_t last_packet[2 + MAX_PACKET_SIZE];
-    uint16_t last_packet_length;
-    uint16_t last_packet_sent;
+
+    /** Packets (or handshake data) not yet written to the socket, sent together with one send. */
+    uint8_t send_buffer[TCP_SEND_BUFFER_SIZE];
+    uint16_t send_buffer_length;
+    uint16_t send_buffer_sent;
+    /** When the oldest unsent packet was added, in ms of current_time_monotonic. */
+    uint64_t send_buffer_time;
+
+    /** For TCP_SEND_BUFFER_MAX_DELAY. Without it the send buffer waits for send_pending_data. */
+    const Mono_Time *_Nullable mono_time;
 
     TCP_Priority_List *_Nullable priority_queue_start;
     TCP_Priority_List *_Nullable priority_queue_end;
@@ -89,13 +103,23 @@ typedef struct TCP_Connection {
  */
 int send_pending_data_nonpriority(const Logger *_Nonnull logger, TCP_Connection *_Nonnull con);
 
-/**
+/** @brief Write out the send buffer, then the priority queue.
+ *
+ * Packets are only collected by write_packet_tcp_secure_connection, so this
+ * needs to be called at the end of every iteration.
+ *
  * @retval 0 if pending data was sent completely
  * @retval -1 if it wasn't
  */
 int send_pending_data(const Logger *_Nonnull logger, TCP_Connection *_Nonnull con);
 
-/**
+/** @brief Encrypt a packet and add it to the send buffer.
+ *
+ * The send buffer is written out when it is full, when its oldest packet is
+ * older than TCP_SEND_BUFFER_MAX_DELAY, or by send_pending_data. Priority
+ * packets write it out right away. Priority packets that don't fit are queued
+ * until it has been written out, other packets are refused.
+ *
  * @retval 1 on success.
  * @retval 0 if could not send packet.
  * @retval -1 on failure (connection must be killed).
@@ -2,9 +2,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <vector>
 
 #include "logger.h"
+#include "mono_time.h"
 #include "os_memory.h"
 #include "os_random.h"
 
@@ -58,6 +61,15 @@ TEST(TCP_common, PriorityQueueOrderingAndIntegrity)
     uint8_t data2[] = "packet2";
     uint8_t data3[] = "packet3";
 
+    // Fill the send buffer. It can't be written out, so further packets have
+    // to be queued.
+    uint8_t filler[MAX_PACKET_SIZE - CRYPTO_MAC_SIZE] = {0};
+
+    while (write_packet_tcp_secure_connection(logger, &con, filler, sizeof(filler), false) == 1) {
+    }
+
+    ASSERT_EQ(con.priority_queue_start, nullptr);
+
     // First packet: will fail net_send (mocked to 0) and go to add_priority
     // Queue: [packet1]
     int ret1 = write_packet_tcp_secure_connection(logger, &con, data1, sizeof(data1), true);
@@ -97,4 +109,210 @@ TEST(TCP_common, PriorityQueueOrderingAndIntegrity)
     logger_kill(logger);
 }
 
+struct SendLog {
+    int calls = 0;
+    std::vector<uint8_t> written;
+    // Bytes accepted per call, 0 for all of them.
+    std::size_t limit = 0;
+};
+
+TEST(TCP_common, PacketsAreWrittenTogether)
+{
+    constexpr Network_Funcs mock_funcs = {
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        [](void *obj, Socket sock, const uint8_t *buf, std::size_t len) {
+            (void)sock;
+            auto *log = static_cast<SendLog *>(obj);
+            ++log->calls;
+            const std::size_t n = log->limit == 0 ? len : std::min(len, log->limit);
+            log->written.insert(log->written.end(), buf, buf + n);
+            return static_cast<int>(n);
+        },
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+    };
+
+    SendLog send_log;
+    TCP_Connection con;
+    memset(&con, 0, sizeof(con));
+    con.mem = os_memory();
+    con.rng = os_random();
+    Network ns = {&mock_funcs, &send_log};
+    con.ns = &ns;
+
+    Logger *logger = logger_new(con.mem);
+    ASSERT_NE(logger, nullptr);
+
+    memset(con.shared_key, 0x42, sizeof(con.shared_key));
+    memset(con.sent_nonce, 0x12, sizeof(con.sent_nonce));
+
+    uint8_t data[100] = {0};
+    constexpr std::size_t packet_size = sizeof(uint16_t) + sizeof(data) + CRYPTO_MAC_SIZE;
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), false), 1);
+    }
+
+    EXPECT_EQ(send_log.calls, 0);
+
+    // A short write keeps the rest for the next flush.
+    send_log.limit = 3 * packet_size;
+    EXPECT_EQ(send_pending_data(logger, &con), -1);
+    send_log.limit = 0;
+    EXPECT_EQ(send_pending_data(logger, &con), 0);
+
+    EXPECT_EQ(send_log.calls, 2);
+    ASSERT_EQ(send_log.written.size(), 10 * packet_size);
+
+    // Every packet is length-prefixed, in order.
+    for (std::size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(send_log.written[i * packet_size], 0);
+        EXPECT_EQ(send_log.written[i * packet_size + 1], sizeof(data) + CRYPTO_MAC_SIZE);
+    }
+
+    logger_kill(logger);
+}
+
+TEST(TCP_common, PriorityPacketsAreWrittenThrough)
+{
+    constexpr Network_Funcs mock_funcs = {
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        [](void *obj, Socket sock, const uint8_t *buf, std::size_t len) {
+            (void)sock;
+            auto *log = static_cast<SendLog *>(obj);
+            ++log->calls;
+            const std::size_t n = log->limit == 0 ? len : std::min(len, log->limit);
+            log->written.insert(log->written.end(), buf, buf + n);
+            return static_cast<int>(n);
+        },
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+    };
+
+    SendLog send_log;
+    TCP_Connection con;
+    memset(&con, 0, sizeof(con));
+    con.mem = os_memory();
+    con.rng = os_random();
+    Network ns = {&mock_funcs, &send_log};
+    con.ns = &ns;
+
+    Logger *logger = logger_new(con.mem);
+    ASSERT_NE(logger, nullptr);
+
+    memset(con.shared_key, 0x42, sizeof(con.shared_key));
+    memset(con.sent_nonce, 0x12, sizeof(con.sent_nonce));
+
+    uint8_t data[100] = {0};
+    constexpr std::size_t packet_size = sizeof(uint16_t) + sizeof(data) + CRYPTO_MAC_SIZE;
+
+    ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), false), 1);
+    ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), false), 1);
+    EXPECT_EQ(send_log.calls, 0);
+
+    // The priority packet takes what was buffered before it along.
+    ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), true), 1);
+    EXPECT_EQ(send_log.calls, 1);
+    EXPECT_EQ(send_log.written.size(), 3 * packet_size);
+    EXPECT_EQ(con.send_buffer_length, 0);
+
+    logger_kill(logger);
+}
+
+TEST(TCP_common, OldPacketsAreWrittenOut)
+{
+    constexpr Network_Funcs mock_funcs = {
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        [](void *obj, Socket sock, const uint8_t *buf, std::size_t len) {
+            (void)sock;
+            auto *log = static_cast<SendLog *>(obj);
+            ++log->calls;
+            const std::size_t n = log->limit == 0 ? len : std::min(len, log->limit);
+            log->written.insert(log->written.end(), buf, buf + n);
+            return static_cast<int>(n);
+        },
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+    };
+
+    SendLog send_log;
+    TCP_Connection con;
+    memset(&con, 0, sizeof(con));
+    con.mem = os_memory();
+    con.rng = os_random();
+    Network ns = {&mock_funcs, &send_log};
+    con.ns = &ns;
+
+    Mono_Time *mono_time = mono_time_new(con.mem, nullptr, nullptr);
+    ASSERT_NE(mono_time, nullptr);
+    uint64_t now = 1000;
+    mono_time_set_current_time_callback(
+        mono_time, [](void *user_data) { return *static_cast<uint64_t *>(user_data); }, &now);
+    con.mono_time = mono_time;
+
+    Logger *logger = logger_new(con.mem);
+    ASSERT_NE(logger, nullptr);
+
+    memset(con.shared_key, 0x42, sizeof(con.shared_key));
+    memset(con.sent_nonce, 0x12, sizeof(con.sent_nonce));
+
+    uint8_t data[100] = {0};
+    constexpr std::size_t packet_size = sizeof(uint16_t) + sizeof(data) + CRYPTO_MAC_SIZE;
+
+    ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), false), 1);
+    now += TCP_SEND_BUFFER_MAX_DELAY - 1;
+    ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), false), 1);
+    EXPECT_EQ(send_log.calls, 0);
+
+    // The first packet waited long enough, the iteration is taking too long.
+    now += 1;
+    ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), false), 1);
+    EXPECT_EQ(send_log.calls, 1);
+    EXPECT_EQ(send_log.written.size(), 3 * packet_size);
+
+    // The delay starts over with the next packet.
+    now += TCP_SEND_BUFFER_MAX_DELAY;
+    ASSERT_EQ(write_packet_tcp_secure_connection(logger, &con, data, sizeof(data), false), 1);
+    EXPECT_EQ(send_log.calls, 1);
+
+    logger_kill(logger);
+    mono_time_free(con.mem, mono_time);
+}
+
 }
@@ -1753,6 +1753,47 @@ void do_tcp_connections(const Logger *logger, TCP_Connections *tcp_c, void *user
     kill_nonused_tcp(tcp_c);
 }
 
+void flush_tcp_connections(const Logger *logger, TCP_Connections *tcp_c)
+{
+    for (uint32_t i = 0; i < tcp_c->tcp_connections_length; ++i) {
+        const TCP_con *tcp_con = get_tcp_connection(tcp_c, i);
+
+        if (tcp_con == nullptr || tcp_con->status != TCP_CONN_CONNECTED || tcp_con->connection == nullptr) {
+            continue;
+        }
+
+        tcp_con_flush(logger, tcp_con->connection);
+    }
+}
+
+int flush_tcp_connection_to(const TCP_Connections *tcp_c, int connections_number)
+{
+    const TCP_Connection_to *con_to = get_connection(tcp_c, connections_number);
+
+    if (con_to == nullptr) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < MAX_FRIEND_TCP_CONNECTIONS; ++i) {
+        uint32_t tcp_con_num = con_to->connections[i].tcp_connection;
+
+        if (tcp_con_num == 0 || con_to->connections[i].status == TCP_CONNECTIONS_STATUS_NONE) {
+            continue;
+        }
+
+        tcp_con_num -= 1;
+        const TCP_con *tcp_con = get_tcp_connection(tcp_c, tcp_con_num);
+
+        if (tcp_con == nullptr || tcp_con->status != TCP_CONN_CONNECTED || tcp_con->connection == nullptr) {
+            continue;
+        }
+
+        tcp_con_flush(tcp_c->logger, tcp_con->connection);
+    }
+
+    return 0;
+}
+
 void kill_tcp_connections(TCP_Connections *tcp_c)
 {
     if (tcp_c == nullptr) {
@@ -277,5 +277,22 @@ TCP_Connections *_Nullable new_tcp_connections(const Logger *_Nonnull logger, co
 int kill_tcp_relay_connection(TCP_Connections *_Nonnull tcp_c, int tcp_connections_number);
 
 void do_tcp_connections(const Logger *_Nonnull logger, TCP_Connections *_Nonnull tcp_c, void *_Nullable userdata);
+
+/** @brief Write out what was sent to the relays since the last call.
+ *
+ * Packets to a relay are collected and written together. Call this at the end
+ * of every iteration, after everything that sends packets has run.
+ */
+void flush_tcp_connections(const Logger *_Nonnull logger, TCP_Connections *_Nonnull tcp_c);
+
+/** @brief Write out what was sent to the relays of this connection, without
+ * waiting for flush_tcp_connections.
+ *
+ * For packets that lose their worth when late, like audio and video.
+ *
+ * return 0 on success.
+ * return -1 on failure.
+ */
+int flush_tcp_connection_to(const TCP_Connections *_Nonnull tcp_c, int connections_number);
 void kill_tcp_connections(TCP_Connections *_Nullable tcp_c);
 #endif /* C_TOXCORE_TOXCORE_TCP_CONNECTION_H */
@@ -234,6 +234,7 @@ static int add_accepted(TCP_Server *_Nonnull tcp_server, const Mono_Time *_Nonnu
     tcp_server->accepted_connection_array[index].last_pinged = mono_time_get(mono_time);
     tcp_server->accepted_connection_array[index].ping_id = 0;
     tcp_server->accepted_connection_array[index].con.net_profile = tcp_server->net_profile;
+    tcp_server->accepted_connection_array[index].con.mono_time = mono_time;
 
     return index;
 }
@@ -1356,6 +1357,22 @@ static void do_tcp_epoll(TCP_Server *_Nonnull tcp_server, const Mono_Time *_Nonn
 }
 #endif /* TCP_SERVER_USE_EPOLL */
 
+/** Write out what was relayed to each client in this iteration. */
+static void do_tcp_flush(TCP_Server *_Nonnull tcp_server)
+{
+    for (uint32_t i = 0; i < tcp_server->size_accepted_connections; ++i) {
+        TCP_Secure_Connection *conn = &tcp_server->accepted_connection_array[i];
+
+        if (conn->status != TCP_STATUS_CONFIRMED) {
+            continue;
+        }
+
+        if (conn->con.send_buffer_length != 0 || conn->con.priority_queue_start != nullptr) {
+            send_pending_data(tcp_server->logger, &conn->con);
+        }
+    }
+}
+
 void do_tcp_server(TCP_Server *tcp_server, const Mono_Time *mono_time)
 {
 #ifdef TCP_SERVER_USE_EPOLL
@@ -1368,6 +1385,7 @@ void do_tcp_server(TCP_Server *tcp_server, const Mono_Time *mono_time)
 #endif /* TCP_SERVER_USE_EPOLL */
 
     do_tcp_confirmed(tcp_server, mono_time);
+    do_tcp_flush(tcp_server);
 }
 
 void kill_tcp_server(TCP_Server *tcp_server)
@@ -0,0 +1,413 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+/**
+ * Congestion controllers for net_crypto.
+ */
+#include "congestion_control.h"
+
+#include "attributes.h"
+#include "ccompat.h"
+#include "mem.h"
+
+/**
+ * If the send queue is SEND_QUEUE_RATIO times larger than the
+ * calculated link speed the packet send speed will be reduced
+ * by a value depending on this number.
+ */
+#define SEND_QUEUE_RATIO 2.0
+
+typedef struct Congestion_Default {
+    uint32_t last_sendqueue_size[CONGESTION_QUEUE_ARRAY_SIZE];
+    uint32_t last_sendqueue_counter;
+    long signed int last_num_packets_sent[CONGESTION_LAST_SENT_ARRAY_SIZE];
+    long signed int last_num_packets_resent[CONGESTION_LAST_SENT_ARRAY_SIZE];
+    uint64_t last_congestion_event;
+} Congestion_Default;
+
+static void *_Nullable default_new(const Memory *_Nonnull mem)
+{
+    return mem_alloc(mem, sizeof(Congestion_Default));
+}
+
+static void default_kill(const Memory *_Nonnull mem, void *_Nullable state)
+{
+    mem_delete(mem, state);
+}
+
+static void default_update(void *_Nonnull state, const Congestion_Sample *_Nonnull sample, Congestion_Rates *_Nonnull rates)
+{
+    Congestion_Default *cc = (Congestion_Default *)state;
+
+    const unsigned int pos = cc->last_sendqueue_counter % CONGESTION_QUEUE_ARRAY_SIZE;
+    cc->last_sendqueue_size[pos] = sample->send_queue_size;
+
+    long signed int sum = 0;
+    sum = (long signed int)cc->last_sendqueue_size[pos] -
+          (long signed int)cc->last_sendqueue_size[(pos + 1) % CONGESTION_QUEUE_ARRAY_SIZE];
+
+    const unsigned int n_p_pos = cc->last_sendqueue_counter % CONGESTION_LAST_SENT_ARRAY_SIZE;
+    cc->last_num_packets_sent[n_p_pos] = sample->packets_sent;
+    cc->last_num_packets_resent[n_p_pos] = sample->packets_resent;
+
+    cc->last_sendqueue_counter = (cc->last_sendqueue_counter + 1) %
+                                 (CONGESTION_QUEUE_ARRAY_SIZE * CONGESTION_LAST_SENT_ARRAY_SIZE);
+
+    if (sample->rates_frozen) {
+        return;
+    }
+
+    long signed int total_sent = 0;
+    long signed int total_resent = 0;
+
+    // TODO(irungentoo): use real delay
+    unsigned int delay = (unsigned int)(((double)sample->rtt_min / CONGESTION_SAMPLE_INTERVAL) + 0.5);
+    const unsigned int packets_set_rem_array = CONGESTION_LAST_SENT_ARRAY_SIZE - CONGESTION_QUEUE_ARRAY_SIZE;
+
+    if (delay > packets_set_rem_array) {
+        delay = packets_set_rem_array;
+    }
+
+    for (unsigned j = 0; j < CONGESTION_QUEUE_ARRAY_SIZE; ++j) {
+        const unsigned int ind = (j + (packets_set_rem_array  - delay) + n_p_pos) % CONGESTION_LAST_SENT_ARRAY_SIZE;
+        total_sent += cc->last_num_packets_sent[ind];
+        total_resent += cc->last_num_packets_resent[ind];
+    }
+
+    if (sum > 0) {
+        total_sent -= sum;
+    } else {
+        if (total_resent > -sum) {
+            total_resent = -sum;
+        }
+    }
+
+    /* if queue is too big only allow resending packets. */
+    const uint32_t npackets = sample->send_queue_size;
+    double min_speed = 1000.0 * (((double)total_sent) / ((double)CONGESTION_QUEUE_ARRAY_SIZE *
+                                 CONGESTION_SAMPLE_INTERVAL));
+
+    const double min_speed_request = 1000.0 * (((double)(total_sent + total_resent)) / (
+                                         (double)CONGESTION_QUEUE_ARRAY_SIZE * CONGESTION_SAMPLE_INTERVAL));
+
+    if (min_speed < CONGESTION_MIN_RATE) {
+        min_speed = CONGESTION_MIN_RATE;
+    }
+
+    const double send_array_ratio = (double)npackets / min_speed;
+
+    // TODO(irungentoo): Improve formula?
+    if (send_array_ratio > SEND_QUEUE_RATIO && CONGESTION_MIN_QUEUE_LENGTH < npackets) {
+        rates->send_rate = min_speed * (1.0 / (send_array_ratio / SEND_QUEUE_RATIO));
+    } else if (cc->last_congestion_event + CONGESTION_EVENT_TIMEOUT < sample->now) {
+        rates->send_rate = min_speed * 1.2;
+    } else {
+        rates->send_rate = min_speed * 0.9;
+    }
+
+    rates->send_rate_requested = min_speed_request * 1.2;
+}
+
+static void default_congestion_event(void *_Nonnull state, uint64_t now)
+{
+    Congestion_Default *cc = (Congestion_Default *)state;
+    cc->last_congestion_event = now;
+}
+
+static const Congestion_Control_Funcs default_funcs = {
+    "default",
+    default_new,
+    default_kill,
+    default_update,
+    default_congestion_event,
+};
+
+const Congestion_Control_Funcs *congestion_control_default(void)
+{
+    return &default_funcs;
+}
+
+/** Number of rounds the bottleneck bandwidth estimate is the maximum over. */
+#define BBR_BW_FILTER_ROUNDS 10
+
+/** Time in ms after which the minimum RTT is considered stale and gets re-probed. */
+#define BBR_MIN_RTT_WINDOW 10000
+
+/** Time in ms spent in PROBE_RTT with a reduced rate to drain the queue. */
+#define BBR_PROBE_RTT_DURATION 200
+
+/** 2/ln(2), the smallest gain that doubles the delivery rate every round. */
+#define BBR_STARTUP_GAIN 2.885
+
+/** The pipe is considered full once the bandwidth grew less than this for BBR_FULL_BW_ROUNDS rounds. */
+#define BBR_FULL_BW_GROWTH 1.25
+#define BBR_FULL_BW_ROUNDS 3
+
+/** An RTT this many times above the minimum means we built a standing queue. */
+#define BBR_QUEUE_RTT_RATIO 1.5
+
+/** Headroom for resent packets on top of the pacing rate. */
+#define BBR_REQUESTED_GAIN 1.25
+
+#define BBR_GAIN_CYCLE_LENGTH 8
+
+static const double bbr_pacing_gain_cycle[BBR_GAIN_CYCLE_LENGTH] = {1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+
+typedef enum Bbr_Mode {
+    BBR_STARTUP,
+    BBR_DRAIN,
+    BBR_PROBE_BW,
+    BBR_PROBE_RTT,
+} Bbr_Mode;
+
+typedef struct Congestion_Bbr {
+    Bbr_Mode mode;
+
+    /* Delivery rate (packets/s) of the last rounds, the estimate is their maximum. */
+    double round_bw[BBR_BW_FILTER_ROUNDS];
+    uint32_t round_bw_index;
+    uint64_t round_start;
+    uint32_t round_acked;
+
+    /* UINT64_MAX until the first RTT sample. */
+    uint64_t rtt_min;
+    uint64_t rtt_min_stamp;
+
+    double full_bw;
+    uint32_t full_bw_rounds;
+    bool filled_pipe;
+
+    uint32_t cycle_index;
+    uint64_t cycle_start;
+    uint64_t probe_rtt_done;
+
+    uint64_t last_congestion_event;
+} Congestion_Bbr;
+
+static void *_Nullable bbr_new(const Memory *_Nonnull mem)
+{
+    Congestion_Bbr *cc = (Congestion_Bbr *)mem_alloc(mem, sizeof(Congestion_Bbr));
+
+    if (cc == nullptr) {
+        return nullptr;
+    }
+
+    // Memsetting float/double to 0 is non-portable, so we explicitly set them to 0
+    for (uint32_t i = 0; i < BBR_BW_FILTER_ROUNDS; ++i) {
+        cc->round_bw[i] = 0.0;
+    }
+
+    cc->full_bw = 0.0;
+    cc->mode = BBR_STARTUP;
+    cc->rtt_min = UINT64_MAX;
+    return cc;
+}
+
+static void bbr_kill(const Memory *_Nonnull mem, void *_Nullable state)
+{
+    mem_delete(mem, state);
+}
+
+static double bbr_max_bw(const Congestion_Bbr *_Nonnull cc)
+{
+    double bw = 0.0;
+
+    for (uint32_t i = 0; i < BBR_BW_FILTER_ROUNDS; ++i) {
+        if (cc->round_bw[i] > bw) {
+            bw = cc->round_bw[i];
+        }
+    }
+
+    return bw;
+}
+
+/** A round is one minimum RTT, but at least one sample interval. */
+static uint64_t bbr_round_length(const Congestion_Bbr *_Nonnull cc, const Congestion_Sample *_Nonnull sample)
+{
+    const uint64_t rtt = cc->rtt_min != UINT64_MAX ? cc->rtt_min : sample->rtt_min;
+    return rtt > CONGESTION_SAMPLE_INTERVAL ? rtt : CONGESTION_SAMPLE_INTERVAL;
+}
+
+static bool bbr_queue_building(const Congestion_Bbr *_Nonnull cc, const Congestion_Sample *_Nonnull sample)
+{
+    return cc->rtt_min != UINT64_MAX && sample->interval_rtt_avg != 0
+           && (double)sample->interval_rtt_avg > (double)cc->rtt_min * BBR_QUEUE_RTT_RATIO;
+}
+
+/** @brief Close the current round and feed its delivery rate into the max filter.
+ *
+ * @retval true if a round ended.
+ */
+static bool bbr_update_round(Congestion_Bbr *_Nonnull cc, const Congestion_Sample *_Nonnull sample)
+{
+    cc->round_acked += sample->packets_acked;
+
+    if (cc->round_start == 0) {
+        cc->round_start = sample->now;
+        cc->round_acked = 0;
+        return false;
+    }
+
+    if (cc->round_start + bbr_round_length(cc, sample) > sample->now) {
+        return false;
+    }
+
+    const double delivery_rate = (double)cc->round_acked * 1000.0 / (double)(sample->now - cc->round_start);
+
+    /* If the send bucket never ran empty we did not send as fast as allowed,
+     * so the delivery rate says nothing about the link unless it is higher. */
+    const bool app_limited = cc->last_congestion_event < cc->round_start;
+
+    if (!app_limited || delivery_rate > bbr_max_bw(cc)) {
+        cc->round_bw_index = (cc->round_bw_index + 1) % BBR_BW_FILTER_ROUNDS;
+        cc->round_bw[cc->round_bw_index] = delivery_rate;
+    }
+
+    if (cc->mode == BBR_STARTUP && !app_limited) {
+        const double bw = bbr_max_bw(cc);
+
+        if (bw >= cc->full_bw * BBR_FULL_BW_GROWTH) {
+            cc->full_bw = bw;
+            cc->full_bw_rounds = 0;
+        } else {
+            ++cc->full_bw_rounds;
+        }
+
+        if (cc->full_bw_rounds >= BBR_FULL_BW_ROUNDS) {
+            cc->filled_pipe = true;
+        }
+    }
+
+    cc->round_start = sample->now;
+    cc->round_acked = 0;
+    return true;
+}
+
+static void bbr_update(void *_Nonnull state, const Congestion_Sample *_Nonnull sample, Congestion_Rates *_Nonnull rates)
+{
+    Congestion_Bbr *cc = (Congestion_Bbr *)state;
+    const uint64_t now = sample->now;
+
+    const bool rtt_min_expired = cc->rtt_min != UINT64_MAX && cc->rtt_min_stamp + BBR_MIN_RTT_WINDOW < now;
+
+    if (sample->interval_rtt_min != 0 && (sample->interval_rtt_min <= cc->rtt_min || rtt_min_expired)) {
+        cc->rtt_min = sample->interval_rtt_min;
+        cc->rtt_min_stamp = now;
+    }
+
+    bbr_update_round(cc, sample);
+
+    if (sample->rates_frozen) {
+        return;
+    }
+
+    const uint64_t round_length = bbr_round_length(cc, sample);
+    const bool queue_building = bbr_queue_building(cc, sample);
+
+    switch (cc->mode) {
+        case BBR_STARTUP: {
+            /* Unlike loss based slow start, leave startup as soon as the RTT
+             * shows a queue forming, not only when the bandwidth plateaus. */
+            if (cc->filled_pipe || (queue_building && cc->full_bw > 0.0)) {
+                cc->filled_pipe = true;
+                cc->mode = BBR_DRAIN;
+            }
+
+            break;
+        }
+
+        case BBR_DRAIN: {
+            if (!queue_building) {
+                cc->mode = BBR_PROBE_BW;
+                cc->cycle_index = 2;
+                cc->cycle_start = now;
+            }
+
+            break;
+        }
+
+        case BBR_PROBE_BW: {
+            if (cc->cycle_start + round_length <= now) {
+                cc->cycle_index = (cc->cycle_index + 1) % BBR_GAIN_CYCLE_LENGTH;
+                cc->cycle_start = now;
+            }
+
+            break;
+        }
+
+        case BBR_PROBE_RTT: {
+            if (cc->probe_rtt_done <= now) {
+                cc->rtt_min_stamp = now;
+                cc->mode = cc->filled_pipe ? BBR_PROBE_BW : BBR_STARTUP;
+                cc->cycle_start = now;
+            }
+
+            break;
+        }
+    }
+
+    if (cc->mode != BBR_PROBE_RTT && cc->rtt_min != UINT64_MAX && cc->rtt_min_stamp + BBR_MIN_RTT_WINDOW < now) {
+        cc->mode = BBR_PROBE_RTT;
+        cc->probe_rtt_done = now + (round_length > BBR_PROBE_RTT_DURATION ? round_length : BBR_PROBE_RTT_DURATION);
+    }
+
+    double gain = 1.0;
+
+    switch (cc->mode) {
+        case BBR_STARTUP: {
+            gain = BBR_STARTUP_GAIN;
+            break;
+        }
+
+        case BBR_DRAIN: {
+            gain = 1.0 / BBR_STARTUP_GAIN;
+            break;
+        }
+
+        case BBR_PROBE_BW: {
+            gain = bbr_pacing_gain_cycle[cc->cycle_index];
+
+            /* Only probe for more bandwidth if there is no standing queue. */
+            if (gain > 1.0 && queue_building) {
+                gain = 1.0;
+            }
+
+            break;
+        }
+
+        case BBR_PROBE_RTT: {
+            gain = 0.5;
+            break;
+        }
+    }
+
+    const double bw = bbr_max_bw(cc);
+
+    if (bw <= 0.0) {
+        /* Nothing was acked yet, keep the initial rate. */
+        return;
+    }
+
+    rates->send_rate = bw * gain;
+    rates->send_rate_requested = rates->send_rate * BBR_REQUESTED_GAIN;
+}
+
+static void bbr_congestion_event(void *_Nonnull state, uint64_t now)
+{
+    Congestion_Bbr *cc = (Congestion_Bbr *)state;
+    cc->last_congestion_event = now;
+}
+
+static const Congestion_Control_Funcs bbr_funcs = {
+    "bbr",
+    bbr_new,
+    bbr_kill,
+    bbr_update,
+    bbr_congestion_event,
+};
+
+const Congestion_Control_Funcs *congestion_control_bbr(void)
+{
+    return &bbr_funcs;
+}
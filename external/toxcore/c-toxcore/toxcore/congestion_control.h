@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+/**
+ * Congestion controllers for net_crypto.
+ *
+ * net_crypto paces lossless packets with a token bucket. How fast that bucket
+ * refills is decided by a congestion controller, which is fed one
+ * Congestion_Sample every CONGESTION_SAMPLE_INTERVAL ms per established
+ * connection.
+ */
+#ifndef C_TOXCORE_TOXCORE_CONGESTION_CONTROL_H
+#define C_TOXCORE_TOXCORE_CONGESTION_CONTROL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "attributes.h"
+#include "mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Interval in ms at which net_crypto samples a connection and updates its rates. */
+#define CONGESTION_SAMPLE_INTERVAL 50
+
+/**
+ * Base current transfer speed on last CONGESTION_QUEUE_ARRAY_SIZE number of points taken
+ * every CONGESTION_SAMPLE_INTERVAL ms.
+ */
+#define CONGESTION_QUEUE_ARRAY_SIZE 12
+#define CONGESTION_LAST_SENT_ARRAY_SIZE (CONGESTION_QUEUE_ARRAY_SIZE * 2)
+
+/** Minimum packets per second a connection is allowed to send at. */
+#define CONGESTION_MIN_RATE 4.0
+
+/** Send queue length below which the queue is never considered too long. */
+#define CONGESTION_MIN_QUEUE_LENGTH 64
+
+/** @brief Timeout for increasing speed after congestion event (in ms). */
+#define CONGESTION_EVENT_TIMEOUT 1000
+
+/** What happened on a connection during the last sample interval. */
+typedef struct Congestion_Sample {
+    /** Current monotonic time in ms. */
+    uint64_t now;
+    /** Length of the interval in ms. */
+    uint32_t interval;
+
+    /** Number of new lossless packets sent during the interval. */
+    uint32_t packets_sent;
+    /** Number of packets resent because the peer requested them. */
+    uint32_t packets_resent;
+    /** Number of packets the peer confirmed as received in order. */
+    uint32_t packets_acked;
+    /** Number of packets in the send array (in flight or waiting to be sent). */
+    uint32_t send_queue_size;
+
+    /** Lowest round trip time ever seen on this connection, in ms. */
+    uint64_t rtt_min;
+    /** Lowest and average round trip time seen during the interval, 0 if there was no sample. */
+    uint64_t interval_rtt_min;
+    uint64_t interval_rtt_avg;
+
+    /**
+     * True right after the connection switched from TCP to UDP. The rates
+     * should be left alone, the samples still go into the history.
+     */
+    bool rates_frozen;
+} Congestion_Sample;
+
+/** Packet rates (packets per second) the token buckets are refilled with. */
+typedef struct Congestion_Rates {
+    /** Rate for new and resent packets. */
+    double send_rate;
+    /** Rate for resent packets only, net_crypto keeps it above send_rate. */
+    double send_rate_requested;
+} Congestion_Rates;
+
+/** @brief Allocate the per connection state of a controller. */
+typedef void *_Nullable congestion_new_cb(const Memory *_Nonnull mem);
+/** @brief Free the per connection state of a controller. */
+typedef void congestion_kill_cb(const Memory *_Nonnull mem, void *_Nullable state);
+/** @brief Update the rates from the sample taken over the last interval. */
+typedef void congestion_update_cb(void *_Nonnull state, const Congestion_Sample *_Nonnull sample, Congestion_Rates *_Nonnull rates);
+/** @brief The send token bucket ran empty, more data was queued than the rate allows. */
+typedef void congestion_event_cb(void *_Nonnull state, uint64_t now);
+
+typedef struct Congestion_Control_Funcs {
+    const char *_Nonnull name;
+    congestion_new_cb *_Nonnull new_callback;
+    congestion_kill_cb *_Nonnull kill_callback;
+    congestion_update_cb *_Nonnull update_callback;
+    congestion_event_cb *_Nonnull event_callback;
+} Congestion_Control_Funcs;
+
+/**
+ * @brief The loss and queue size based controller net_crypto always used.
+ *
+ * Speeds up by 20% per interval unless the send queue grew or the bucket ran
+ * empty in the last CONGESTION_EVENT_TIMEOUT ms.
+ */
+const Congestion_Control_Funcs *_Nonnull congestion_control_default(void);
+
+/**
+ * @brief A delay based controller modelled after BBR.
+ *
+ * Estimates the bottleneck bandwidth from the delivery rate and the
+ * propagation delay from the windowed minimum RTT, and paces at the estimated
+ * bandwidth while periodically probing for more. Losses are not treated as a
+ * congestion signal, a growing RTT is.
+ */
+const Congestion_Control_Funcs *_Nonnull congestion_control_bbr(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* C_TOXCORE_TOXCORE_CONGESTION_CONTROL_H */
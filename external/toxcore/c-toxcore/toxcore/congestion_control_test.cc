@@ -0,0 +1,165 @@
+// clang-format off
+#include "../testing/support/public/simulated_environment.hh"
+#include "congestion_control.h"
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include "mem.h"
+
+namespace {
+
+using tox::test::SimulatedEnvironment;
+
+class CongestionControl {
+public:
+    CongestionControl(const Congestion_Control_Funcs *funcs, const Memory *mem)
+        : funcs_(funcs)
+        , mem_(mem)
+        , state_(funcs->new_callback(mem))
+    {
+        rates.send_rate = CONGESTION_MIN_RATE;
+        rates.send_rate_requested = CONGESTION_MIN_RATE;
+    }
+
+    ~CongestionControl() { funcs_->kill_callback(mem_, state_); }
+
+    CongestionControl(const CongestionControl &) = delete;
+    CongestionControl &operator=(const CongestionControl &) = delete;
+
+    bool ok() const { return state_ != nullptr; }
+
+    void update(const Congestion_Sample &sample) { funcs_->update_callback(state_, &sample, &rates); }
+    void congestion_event(uint64_t now) { funcs_->event_callback(state_, now); }
+
+    Congestion_Rates rates;
+
+private:
+    const Congestion_Control_Funcs *funcs_;
+    const Memory *mem_;
+    void *state_;
+};
+
+/** A link delivering `acked` packets per sample interval at a constant RTT. */
+Congestion_Sample steady_sample(uint64_t now, uint32_t acked, uint64_t rtt_min, uint64_t rtt_avg)
+{
+    Congestion_Sample sample{};
+    sample.now = now;
+    sample.interval = CONGESTION_SAMPLE_INTERVAL;
+    sample.packets_sent = acked;
+    sample.packets_acked = acked;
+    sample.send_queue_size = acked * 2;
+    sample.rtt_min = rtt_min;
+    sample.interval_rtt_min = rtt_min;
+    sample.interval_rtt_avg = rtt_avg;
+    return sample;
+}
+
+TEST(CongestionControl, DefaultKeepsRatesWhileFrozen)
+{
+    SimulatedEnvironment env{12345};
+    auto c_mem = env.fake_memory().c_memory();
+
+    CongestionControl cc(congestion_control_default(), &c_mem);
+    ASSERT_TRUE(cc.ok());
+    cc.rates.send_rate = 123.0;
+    cc.rates.send_rate_requested = 456.0;
+
+    Congestion_Sample sample = steady_sample(10000, 20, 100, 100);
+    sample.rates_frozen = true;
+    cc.update(sample);
+
+    EXPECT_EQ(cc.rates.send_rate, 123.0);
+    EXPECT_EQ(cc.rates.send_rate_requested, 456.0);
+}
+
+TEST(CongestionControl, DefaultSlowsDownAfterCongestionEvent)
+{
+    SimulatedEnvironment env{12345};
+    auto c_mem = env.fake_memory().c_memory();
+
+    CongestionControl calm(congestion_control_default(), &c_mem);
+    CongestionControl congested(congestion_control_default(), &c_mem);
+    ASSERT_TRUE(calm.ok());
+    ASSERT_TRUE(congested.ok());
+
+    uint64_t now = 10000;
+
+    for (int i = 0; i < CONGESTION_LAST_SENT_ARRAY_SIZE; ++i) {
+        now += CONGESTION_SAMPLE_INTERVAL;
+        congested.congestion_event(now);
+        calm.update(steady_sample(now, 20, 100, 100));
+        congested.update(steady_sample(now, 20, 100, 100));
+    }
+
+    EXPECT_GT(calm.rates.send_rate, congested.rates.send_rate);
+    EXPECT_GE(calm.rates.send_rate_requested, calm.rates.send_rate);
+}
+
+TEST(CongestionControl, BbrConvergesToDeliveryRate)
+{
+    SimulatedEnvironment env{12345};
+    auto c_mem = env.fake_memory().c_memory();
+
+    CongestionControl cc(congestion_control_bbr(), &c_mem);
+    ASSERT_TRUE(cc.ok());
+
+    // 50 packets per 50ms: the link delivers 1000 packets per second.
+    uint64_t now = 10000;
+
+    for (int i = 0; i < 100; ++i) {
+        now += CONGESTION_SAMPLE_INTERVAL;
+        cc.congestion_event(now);
+        cc.update(steady_sample(now, 50, 100, 100));
+    }
+
+    // After startup the pacing gain cycles between 0.75 and 1.25.
+    EXPECT_GE(cc.rates.send_rate, 750.0 - 1.0);
+    EXPECT_LE(cc.rates.send_rate, 1250.0 + 1.0);
+    EXPECT_GE(cc.rates.send_rate_requested, cc.rates.send_rate);
+}
+
+TEST(CongestionControl, BbrDoesNotProbeIntoStandingQueue)
+{
+    SimulatedEnvironment env{12345};
+    auto c_mem = env.fake_memory().c_memory();
+
+    CongestionControl cc(congestion_control_bbr(), &c_mem);
+    ASSERT_TRUE(cc.ok());
+
+    uint64_t now = 10000;
+
+    for (int i = 0; i < 100; ++i) {
+        now += CONGESTION_SAMPLE_INTERVAL;
+        cc.congestion_event(now);
+        cc.update(steady_sample(now, 50, 100, 100));
+    }
+
+    // The RTT triples, so there is a queue: never send faster than the link.
+    for (int i = 0; i < 40; ++i) {
+        now += CONGESTION_SAMPLE_INTERVAL;
+        cc.congestion_event(now);
+        cc.update(steady_sample(now, 50, 100, 300));
+        EXPECT_LE(cc.rates.send_rate, 1000.0 + 1.0);
+    }
+}
+
+TEST(CongestionControl, BbrKeepsInitialRateUntilSomethingIsAcked)
+{
+    SimulatedEnvironment env{12345};
+    auto c_mem = env.fake_memory().c_memory();
+
+    CongestionControl cc(congestion_control_bbr(), &c_mem);
+    ASSERT_TRUE(cc.ok());
+
+    uint64_t now = 10000;
+
+    for (int i = 0; i < 10; ++i) {
+        now += CONGESTION_SAMPLE_INTERVAL;
+        cc.update(steady_sample(now, 0, 1000, 0));
+    }
+
+    EXPECT_EQ(cc.rates.send_rate, CONGESTION_MIN_RATE);
+}
+
+}  // namespace
@@ -7172,6 +7172,10 @@ void do_gc(GC_Session *c, void *userdata)
         do_new_connection_cooldown(chat);
         do_peer_delete(c, chat, userdata);
 
+        if (chat->tcp_conn != nullptr) {
+            flush_tcp_connections(chat->log, chat->tcp_conn);
+        }
+
         if (chat->flag_exit) {  // should always come last as it modifies the chats array
             group_delete(c, chat);
         }
@@ -32,20 +32,37 @@
 #include <pthread.h>
 #include <time.h>
 
+/* Readers of the cached time are everywhere, so they shouldn't take a lock.
+ * Without lock-free 64 bit atomics we fall back to a rwlock. */
+#if !defined(ESP_PLATFORM) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#if ATOMIC_LLONG_LOCK_FREE == 2
+#define MONO_TIME_ATOMIC
+#endif /* ATOMIC_LLONG_LOCK_FREE */
+#endif /* __STDC_NO_ATOMICS__ */
+
 #include "attributes.h"
 #include "ccompat.h"
 #include "mem.h"
 #include "util.h"
 
+#if !defined(ESP_PLATFORM) && !defined(MONO_TIME_ATOMIC)
+#define MONO_TIME_RWLOCK
+#endif /* !ESP_PLATFORM && !MONO_TIME_ATOMIC */
+
 /** don't call into system billions of times for no reason */
 struct Mono_Time {
+#ifdef MONO_TIME_ATOMIC
+    _Atomic uint64_t cur_time;
+#else
     uint64_t cur_time;
+#endif /* MONO_TIME_ATOMIC */
     uint64_t base_time;
 
-#ifndef ESP_PLATFORM
+#ifdef MONO_TIME_RWLOCK
     /** protect @ref cur_time from concurrent access */
     pthread_rwlock_t *_Nonnull time_update_lock;
-#endif /* ESP_PLATFORM */
+#endif /* MONO_TIME_RWLOCK */
 
     mono_time_current_time_cb *_Nonnull current_time_callback;
     void *_Nullable user_data;
@@ -115,7 +132,7 @@ Mono_Time *mono_time_new(const Memory *mem, mono_time_current_time_cb *current_t
         return nullptr;
     }
 
-#ifndef ESP_PLATFORM
+#ifdef MONO_TIME_RWLOCK
     pthread_rwlock_t *const rwlock = (pthread_rwlock_t *)mem_alloc(mem, sizeof(pthread_rwlock_t));
 
     if (rwlock == nullptr) {
@@ -130,11 +147,15 @@ Mono_Time *mono_time_new(const Memory *mem, mono_time_current_time_cb *current_t
     }
 
     mono_time->time_update_lock = rwlock;
-#endif /* ESP_PLATFORM */
+#endif /* MONO_TIME_RWLOCK */
 
     mono_time_set_current_time_callback(mono_time, current_time_callback, user_data);
 
+#ifdef MONO_TIME_ATOMIC
+    atomic_init(&mono_time->cur_time, 0);
+#else
     mono_time->cur_time = 0;
+#endif /* MONO_TIME_ATOMIC */
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
     // Maximum reproducibility. Never return time = 0.
     mono_time->base_time = 1000000000;
@@ -154,10 +175,10 @@ void mono_time_free(const Memory *mem, Mono_Time *mono_time)
     if (mono_time == nullptr) {
         return;
     }
-#ifndef ESP_PLATFORM
+#ifdef MONO_TIME_RWLOCK
     pthread_rwlock_destroy(mono_time->time_update_lock);
     mem_delete(mem, mono_time->time_update_lock);
-#endif /* ESP_PLATFORM */
+#endif /* MONO_TIME_RWLOCK */
     mem_delete(mem, mono_time);
 }
 
@@ -166,26 +187,35 @@ void mono_time_update(Mono_Time *mono_time)
     const uint64_t cur_time =
         mono_time->base_time + mono_time->current_time_callback(mono_time->user_data);
 
-#ifndef ESP_PLATFORM
+#ifdef MONO_TIME_ATOMIC
+    // Only the value itself is published, nothing else is ordered against it.
+    atomic_store_explicit(&mono_time->cur_time, cur_time, memory_order_relaxed);
+#else
+#ifdef MONO_TIME_RWLOCK
     pthread_rwlock_wrlock(mono_time->time_update_lock);
-#endif /* ESP_PLATFORM */
+#endif /* MONO_TIME_RWLOCK */
     mono_time->cur_time = cur_time;
-#ifndef ESP_PLATFORM
+#ifdef MONO_TIME_RWLOCK
     pthread_rwlock_unlock(mono_time->time_update_lock);
-#endif /* ESP_PLATFORM */
+#endif /* MONO_TIME_RWLOCK */
+#endif /* MONO_TIME_ATOMIC */
 }
 
 uint64_t mono_time_get_ms(const Mono_Time *mono_time)
 {
-#if !defined(ESP_PLATFORM) && !defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION)
+#ifdef MONO_TIME_ATOMIC
+    return atomic_load_explicit(&mono_time->cur_time, memory_order_relaxed);
+#else
+#if defined(MONO_TIME_RWLOCK) && !defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION)
     // Fuzzing is only single thread for now, no locking needed */
     pthread_rwlock_rdlock(mono_time->time_update_lock);
-#endif /* !ESP_PLATFORM */
+#endif /* MONO_TIME_RWLOCK */
     const uint64_t cur_time = mono_time->cur_time;
-#if !defined(ESP_PLATFORM) && !defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION)
+#if defined(MONO_TIME_RWLOCK) && !defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION)
     pthread_rwlock_unlock(mono_time->time_update_lock);
-#endif /* !ESP_PLATFORM */
+#endif /* MONO_TIME_RWLOCK */
     return cur_time;
+#endif /* MONO_TIME_ATOMIC */
 }
 
 uint64_t mono_time_get(const Mono_Time *mono_time)
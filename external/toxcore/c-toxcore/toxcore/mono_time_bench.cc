@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "mono_time.h"
+#include "os_memory.h"
+
+namespace {
+
+void BM_MonoTimeGetMs(benchmark::State &state)
+{
+    const Memory *mem = os_memory();
+    Mono_Time *mono_time = mono_time_new(mem, nullptr, nullptr);
+
+    if (mono_time == nullptr) {
+        state.SkipWithError("mono_time_new failed");
+        return;
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mono_time_get_ms(mono_time));
+    }
+
+    mono_time_free(mem, mono_time);
+}
+
+BENCHMARK(BM_MonoTimeGetMs);
+
+Mono_Time *g_shared_mono_time = nullptr;
+std::atomic<bool> g_updater_running{false};
+std::thread g_updater;
+
+/**
+ * All threads read the same Mono_Time while another thread keeps updating
+ * it, like the toxav threads do while tox_iterate runs.
+ */
+void BM_MonoTimeGetMsContended(benchmark::State &state)
+{
+    const Memory *mem = os_memory();
+
+    // Everyone waits for thread 0 at the start of the loop, and thread 0 waits
+    // for everyone at the end of it.
+    if (state.thread_index() == 0) {
+        g_shared_mono_time = mono_time_new(mem, nullptr, nullptr);
+        g_updater_running = true;
+        g_updater = std::thread([]() {
+            while (g_updater_running) {
+                mono_time_update(g_shared_mono_time);
+            }
+        });
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mono_time_get_ms(g_shared_mono_time));
+    }
+
+    if (state.thread_index() == 0) {
+        g_updater_running = false;
+        g_updater.join();
+        mono_time_free(mem, g_shared_mono_time);
+        g_shared_mono_time = nullptr;
+    }
+}
+
+BENCHMARK(BM_MonoTimeGetMsContended)->Threads(1)->Threads(4)->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
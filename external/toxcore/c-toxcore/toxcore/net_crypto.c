@@ -110,15 +110,19 @@ typedef struct Crypto_Connection {
     uint64_t last_packets_left_requested_set;
     double last_packets_left_requested_rem;
 
-    uint32_t last_sendqueue_size[CONGESTION_QUEUE_ARRAY_SIZE];
-    uint32_t last_sendqueue_counter;
-    long signed int last_num_packets_sent[CONGESTION_LAST_SENT_ARRAY_SIZE];
-    long signed int last_num_packets_resent[CONGESTION_LAST_SENT_ARRAY_SIZE];
     uint32_t packets_sent;
     uint32_t packets_resent;
-    uint64_t last_congestion_event;
+    uint32_t packets_acked;
     uint64_t rtt_time;
 
+    /* RTT samples since the last congestion control update. */
+    uint64_t interval_rtt_min;
+    uint64_t interval_rtt_sum;
+    uint32_t interval_rtt_count;
+
+    const Congestion_Control_Funcs *_Nullable cc_funcs;
+    void *_Nullable cc_state;
+
     /* TCP_connection connection_number */
     unsigned int connection_number_tcp;
 
@@ -161,6 +165,8 @@ struct Net_Crypto {
     /* The current optimal sleep time */
     uint32_t current_sleep_time;
 
+    const Congestion_Control_Funcs *_Nonnull cc_funcs;
+
     BS_List ip_port_list;
 
     /* Rate limiter for cookie requests */
@@ -1541,9 +1547,13 @@ static int handle_data_packet_core(Net_Crypto *_Nonnull c, int crypt_connection_
             rtt_calc_time = packet_time->sent_time;
         }
 
+        const uint32_t old_buffer_start = conn->send_array.buffer_start;
+
         if (clear_buffer_until(c->mem, &conn->send_array, buffer_start) != 0) {
             return -1;
         }
+
+        conn->packets_acked += buffer_start - old_buffer_start;
     }
 
     const uint8_t *real_data = data + (sizeof(uint32_t) * 2);
@@ -1638,6 +1648,13 @@ static int handle_data_packet_core(Net_Crypto *_Nonnull c, int crypt_connection_
         if (rtt_time < conn->rtt_time) {
             conn->rtt_time = rtt_time;
         }
+
+        if (conn->interval_rtt_count == 0 || rtt_time < conn->interval_rtt_min) {
+            conn->interval_rtt_min = rtt_time;
+        }
+
+        conn->interval_rtt_sum += rtt_time;
+        ++conn->interval_rtt_count;
     }
 
     return 0;
@@ -1782,6 +1799,8 @@ static int realloc_cryptoconnection(Net_Crypto *_Nonnull c, uint32_t num)
     return 0;
 }
 
+static int wipe_crypto_connection(Net_Crypto *_Nonnull c, int crypt_connection_id);
+
 /** @brief Create a new empty crypto connection.
  *
  * @retval -1 on failure.
@@ -1816,6 +1835,14 @@ static int create_crypto_connection(Net_Crypto *_Nonnull c)
 
         // TODO(Green-Sky): This enum is likely unneeded and the same as FREE.
         c->crypto_connections[id].status = CRYPTO_CONN_NO_CONNECTION;
+
+        c->crypto_connections[id].cc_funcs = c->cc_funcs;
+        c->crypto_connections[id].cc_state = c->cc_funcs->new_callback(c->mem);
+
+        if (c->crypto_connections[id].cc_state == nullptr) {
+            wipe_crypto_connection(c, id);
+            return -1;
+        }
     }
 
     return id;
@@ -1844,6 +1871,12 @@ static int wipe_crypto_connection(Net_Crypto *_Nonnull c, int crypt_connection_i
 
     uint32_t i;
 
+    const Crypto_Connection *conn = &c->crypto_connections[crypt_connection_id];
+
+    if (conn->cc_funcs != nullptr) {
+        conn->cc_funcs->kill_callback(c->mem, conn->cc_state);
+    }
+
     crypto_memzero(&c->crypto_connections[crypt_connection_id], sizeof(Crypto_Connection));
 
     /* check if we can resize the connections array */
@@ -2475,23 +2508,13 @@ static int udp_handle_packet(void *_Nonnull object, const IP_Port *_Nonnull sour
 /** @brief The dT for the average packet receiving rate calculations.
  * Also used as the
  */
-#define PACKET_COUNTER_AVERAGE_INTERVAL 50
+#define PACKET_COUNTER_AVERAGE_INTERVAL CONGESTION_SAMPLE_INTERVAL
 
 /** @brief Ratio of recv queue size / recv packet rate (in seconds) times
  * the number of ms between request packets to send at that ratio
  */
 #define REQUEST_PACKETS_COMPARE_CONSTANT (0.125 * 100.0)
 
-/** @brief Timeout for increasing speed after congestion event (in ms). */
-#define CONGESTION_EVENT_TIMEOUT 1000
-
-/**
- * If the send queue is SEND_QUEUE_RATIO times larger than the
- * calculated link speed the packet send speed will be reduced
- * by a value depending on this number.
- */
-#define SEND_QUEUE_RATIO 2.0
-
 static void send_crypto_packets(Net_Crypto *_Nonnull c)
 {
     const uint64_t temp_time = current_time_monotonic(c->mono_time);
@@ -2554,85 +2577,42 @@ static void send_crypto_packets(Net_Crypto *_Nonnull c)
                 conn->packet_counter = 0;
                 conn->packet_counter_set = temp_time;
 
-                const uint32_t packets_sent = conn->packets_sent;
-                conn->packets_sent = 0;
+                Congestion_Sample sample = {0};
+                sample.now = temp_time;
+                sample.interval = (uint32_t)dt;
+                sample.packets_sent = conn->packets_sent;
+                sample.packets_resent = conn->packets_resent;
+                sample.packets_acked = conn->packets_acked;
+                sample.send_queue_size = num_packets_array(&conn->send_array);
+                sample.rtt_min = conn->rtt_time;
+
+                if (conn->interval_rtt_count != 0) {
+                    sample.interval_rtt_min = conn->interval_rtt_min;
+                    sample.interval_rtt_avg = conn->interval_rtt_sum / conn->interval_rtt_count;
+                }
 
-                const uint32_t packets_resent = conn->packets_resent;
+                conn->packets_sent = 0;
                 conn->packets_resent = 0;
-
-                /* conjestion control
-                 *  calculate a new value of conn->packet_send_rate based on some data
-                 */
-
-                const unsigned int pos = conn->last_sendqueue_counter % CONGESTION_QUEUE_ARRAY_SIZE;
-                conn->last_sendqueue_size[pos] = num_packets_array(&conn->send_array);
-
-                long signed int sum = 0;
-                sum = (long signed int)conn->last_sendqueue_size[pos] -
-                      (long signed int)conn->last_sendqueue_size[(pos + 1) % CONGESTION_QUEUE_ARRAY_SIZE];
-
-                const unsigned int n_p_pos = conn->last_sendqueue_counter % CONGESTION_LAST_SENT_ARRAY_SIZE;
-                conn->last_num_packets_sent[n_p_pos] = packets_sent;
-                conn->last_num_packets_resent[n_p_pos] = packets_resent;
-
-                conn->last_sendqueue_counter = (conn->last_sendqueue_counter + 1) %
-                                               (CONGESTION_QUEUE_ARRAY_SIZE * CONGESTION_LAST_SENT_ARRAY_SIZE);
+                conn->packets_acked = 0;
+                conn->interval_rtt_sum = 0;
+                conn->interval_rtt_count = 0;
 
                 bool direct_connected = false;
                 /* return value can be ignored since the `if` above ensures the connection is established */
                 crypto_connection_status(c, i, &direct_connected, nullptr);
 
                 /* When switching from TCP to UDP, don't change the packet send rate for CONGESTION_EVENT_TIMEOUT ms. */
-                if (!(direct_connected && conn->last_tcp_sent + CONGESTION_EVENT_TIMEOUT > temp_time)) {
-                    long signed int total_sent = 0;
-                    long signed int total_resent = 0;
-
-                    // TODO(irungentoo): use real delay
-                    unsigned int delay = (unsigned int)(((double)conn->rtt_time / PACKET_COUNTER_AVERAGE_INTERVAL) + 0.5);
-                    const unsigned int packets_set_rem_array = CONGESTION_LAST_SENT_ARRAY_SIZE - CONGESTION_QUEUE_ARRAY_SIZE;
-
-                    if (delay > packets_set_rem_array) {
-                        delay = packets_set_rem_array;
-                    }
-
-                    for (unsigned j = 0; j < CONGESTION_QUEUE_ARRAY_SIZE; ++j) {
-                        const unsigned int ind = (j + (packets_set_rem_array  - delay) + n_p_pos) % CONGESTION_LAST_SENT_ARRAY_SIZE;
-                        total_sent += conn->last_num_packets_sent[ind];
-                        total_resent += conn->last_num_packets_resent[ind];
-                    }
-
-                    if (sum > 0) {
-                        total_sent -= sum;
-                    } else {
-                        if (total_resent > -sum) {
-                            total_resent = -sum;
-                        }
-                    }
+                sample.rates_frozen = direct_connected && conn->last_tcp_sent + CONGESTION_EVENT_TIMEOUT > temp_time;
 
-                    /* if queue is too big only allow resending packets. */
-                    const uint32_t npackets = num_packets_array(&conn->send_array);
-                    double min_speed = 1000.0 * (((double)total_sent) / ((double)CONGESTION_QUEUE_ARRAY_SIZE *
-                                                 PACKET_COUNTER_AVERAGE_INTERVAL));
+                Congestion_Rates rates;
+                rates.send_rate = conn->packet_send_rate;
+                rates.send_rate_requested = conn->packet_send_rate_requested;
 
-                    const double min_speed_request = 1000.0 * (((double)(total_sent + total_resent)) / (
-                                                         (double)CONGESTION_QUEUE_ARRAY_SIZE * PACKET_COUNTER_AVERAGE_INTERVAL));
+                conn->cc_funcs->update_callback(conn->cc_state, &sample, &rates);
 
-                    if (min_speed < CRYPTO_PACKET_MIN_RATE) {
-                        min_speed = CRYPTO_PACKET_MIN_RATE;
-                    }
-
-                    const double send_array_ratio = (double)npackets / min_speed;
-
-                    // TODO(irungentoo): Improve formula?
-                    if (send_array_ratio > SEND_QUEUE_RATIO && CRYPTO_MIN_QUEUE_LENGTH < npackets) {
-                        conn->packet_send_rate = min_speed * (1.0 / (send_array_ratio / SEND_QUEUE_RATIO));
-                    } else if (conn->last_congestion_event + CONGESTION_EVENT_TIMEOUT < temp_time) {
-                        conn->packet_send_rate = min_speed * 1.2;
-                    } else {
-                        conn->packet_send_rate = min_speed * 0.9;
-                    }
-
-                    conn->packet_send_rate_requested = min_speed_request * 1.2;
+                if (!sample.rates_frozen) {
+                    conn->packet_send_rate = rates.send_rate;
+                    conn->packet_send_rate_requested = rates.send_rate_requested;
 
                     if (conn->packet_send_rate < CRYPTO_PACKET_MIN_RATE) {
                         conn->packet_send_rate = CRYPTO_PACKET_MIN_RATE;
@@ -2695,7 +2675,7 @@ static void send_crypto_packets(Net_Crypto *_Nonnull c)
                 if ((unsigned int)ret < conn->packets_left) {
                     conn->packets_left -= ret;
                 } else {
-                    conn->last_congestion_event = temp_time;
+                    conn->cc_funcs->event_callback(conn->cc_state, temp_time);
                     conn->packets_left = 0;
                 }
             }
@@ -2871,6 +2851,11 @@ int send_lossy_cryptpacket(const Net_Crypto *c, int crypt_connection_id, const u
         const uint32_t buffer_start = conn->recv_array.buffer_start;
         const uint32_t buffer_end = conn->send_array.buffer_end;
         ret = send_data_packet_helper(c, crypt_connection_id, buffer_start, buffer_end, data, length);
+
+        // Lossy packets (audio, video) don't wait for the end of the iteration.
+        if (ret == 0) {
+            flush_tcp_connection_to(c->tcp_c, conn->connection_number_tcp);
+        }
     }
 
     return ret;
@@ -2999,6 +2984,7 @@ Net_Crypto *new_net_crypto(const Logger *log, const Memory *mem, const Random *r
     new_symmetric_key(rng, temp->secret_symmetric_key);
 
     temp->current_sleep_time = CRYPTO_SEND_PACKET_INTERVAL;
+    temp->cc_funcs = congestion_control_default();
 
     networking_registerhandler(net, NET_PACKET_COOKIE_REQUEST, &udp_handle_cookie_request, temp);
     networking_registerhandler(net, NET_PACKET_COOKIE_RESPONSE, &udp_handle_packet, temp);
@@ -3041,6 +3027,11 @@ static void kill_timedout(Net_Crypto *_Nonnull c, void *_Nullable userdata)
     }
 }
 
+void nc_set_congestion_control(Net_Crypto *c, const Congestion_Control_Funcs *funcs)
+{
+    c->cc_funcs = funcs;
+}
+
 /** return the optimal interval in ms for running do_net_crypto. */
 uint32_t crypto_run_interval(const Net_Crypto *c)
 {
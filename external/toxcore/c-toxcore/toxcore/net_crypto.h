@@ -16,6 +16,7 @@
 #include "TCP_client.h"
 #include "TCP_connection.h"
 #include "attributes.h"
+#include "congestion_control.h"
 #include "crypto_core.h"
 #include "logger.h"
 #include "mem.h"
@@ -94,10 +95,10 @@ typedef enum Packet_Id {
 #define CRYPTO_PACKET_BUFFER_SIZE 32768 // Must be a power of 2
 
 /** Minimum packet rate per second. */
-#define CRYPTO_PACKET_MIN_RATE 4.0
+#define CRYPTO_PACKET_MIN_RATE CONGESTION_MIN_RATE
 
 /** Minimum packet queue max length. */
-#define CRYPTO_MIN_QUEUE_LENGTH 64
+#define CRYPTO_MIN_QUEUE_LENGTH CONGESTION_MIN_QUEUE_LENGTH
 
 /** Maximum total size of packets that net_crypto sends. */
 #define MAX_CRYPTO_PACKET_SIZE 1400
@@ -125,13 +126,6 @@ typedef enum Packet_Id {
 /** All packets will be padded a number of bytes based on this number. */
 #define CRYPTO_MAX_PADDING 8
 
-/**
- * Base current transfer speed on last CONGESTION_QUEUE_ARRAY_SIZE number of points taken
- * at the dT defined in net_crypto.c
- */
-#define CONGESTION_QUEUE_ARRAY_SIZE 12
-#define CONGESTION_LAST_SENT_ARRAY_SIZE (CONGESTION_QUEUE_ARRAY_SIZE * 2)
-
 /** Default connection ping in ms. */
 #define DEFAULT_PING_CONNECTION 1000
 #define DEFAULT_TCP_PING_CONNECTION 500
@@ -387,6 +381,12 @@ Net_Crypto *_Nullable new_net_crypto(const Logger *_Nonnull log, const Memory *_
                                      Networking_Core *_Nonnull net, void *_Nonnull dht, const Net_Crypto_DHT_Funcs *_Nonnull dht_funcs,
                                      const TCP_Proxy_Info *_Nonnull proxy_info, Net_Profile *_Nonnull tcp_np);
 
+/** @brief Set the congestion controller used for connections created from now on.
+ *
+ * Existing connections keep the controller they were created with.
+ */
+void nc_set_congestion_control(Net_Crypto *_Nonnull c, const Congestion_Control_Funcs *_Nonnull funcs);
+
 /** return the optimal interval in ms for running do_net_crypto. */
 uint32_t crypto_run_interval(const Net_Crypto *_Nonnull c);
 
@@ -92,6 +92,9 @@ struct Onion_Friend {
     uint32_t run_count;
     uint32_t pings;  // how many sucessful pings we've made for this friend
 
+    uint64_t search_due; // when the friend is due in the search queue (ms), 0 if it isn't queued
+    bool search_found; // we got their DHT public key since they went offline
+
     Last_Pinged last_pinged[MAX_STORED_PINGED_NODES];
     uint8_t last_pinged_index;
 
@@ -165,8 +168,39 @@ struct Onion_Client {
 
     onion_group_announce_cb *_Nullable group_announce_response;
     void *_Nullable group_announce_response_user_data;
+
+    Onion_Search_Queue search_queue;
+    bool search_queue_rebuild; // the queue lost a friend or has too many stale entries
+    Onion_Search_Budget search_budget;
+    Onion_Search_Stats search_stats;
 };
 
+void onion_get_search_stats(const Onion_Client *onion_c, Onion_Search_Stats *stats)
+{
+    *stats = onion_c->search_stats;
+}
+
+/** @brief Queue a search for a friend at `due` ms, unless one is already queued for earlier. */
+static void onion_friend_schedule_search(Onion_Client *_Nonnull onion_c, uint32_t friend_num, uint64_t due)
+{
+    Onion_Friend *o_friend = &onion_c->friends_list[friend_num];
+
+    // 0 means not queued.
+    due = max_u64(due, 1);
+
+    if (o_friend->search_due != 0 && o_friend->search_due <= due) {
+        return;
+    }
+
+    if (!onion_search_queue_push(&onion_c->search_queue, due, friend_num)) {
+        // The entry already in the queue (if any) still works, it is only early.
+        onion_c->search_queue_rebuild = true;
+        return;
+    }
+
+    o_friend->search_due = due;
+}
+
 uint32_t onion_get_friend_count(const Onion_Client *const onion_c)
 {
     return onion_c->num_friends;
@@ -678,7 +712,13 @@ static int client_send_announce_request(Onion_Client *_Nonnull onion_c, uint32_t
     Ip_Ntoa ip_str;
     LOGGER_TRACE(onion_c->logger, "sending onion packet to %s:%d (%02x, %d bytes)",
                  net_ip_ntoa(&dest->ip, &ip_str), net_ntohs(dest->port), request[0], len);
-    return send_onion_packet_tcp_udp(onion_c, &path, dest, request, len);
+    const int ret = send_onion_packet_tcp_udp(onion_c, &path, dest, request, len);
+
+    if (ret == 0 && num != 0) {
+        ++onion_c->search_stats.searches_sent;
+    }
+
+    return ret;
 }
 
 typedef struct Onion_Node_Cmp {
@@ -1209,6 +1249,11 @@ static int handle_dhtpk_announce(void *_Nonnull object, const uint8_t *_Nonnull
 
     onion_c->friends_list[friend_num].last_noreplay = no_replay;
 
+    if (!onion_c->friends_list[friend_num].is_online && !onion_c->friends_list[friend_num].search_found) {
+        onion_c->friends_list[friend_num].search_found = true;
+        ++onion_c->search_stats.friends_found;
+    }
+
     if (onion_c->friends_list[friend_num].dht_pk_callback != nullptr) {
         onion_c->friends_list[friend_num].dht_pk_callback(onion_c->friends_list[friend_num].dht_pk_callback_object,
                 onion_c->friends_list[friend_num].dht_pk_callback_number, data + 1 + sizeof(uint64_t), userdata);
@@ -1574,6 +1619,8 @@ int onion_addfriend(Onion_Client *onion_c, const uint8_t *public_key)
         return -1;
     }
 
+    onion_friend_schedule_search(onion_c, index, mono_time_get_ms(onion_c->mono_time));
+
     return index;
 }
 
@@ -1737,6 +1784,7 @@ int onion_set_friend_online(Onion_Client *onion_c, int friend_num, bool is_onlin
         return -1;
     }
 
+    const bool was_online = onion_c->friends_list[friend_num].is_online;
     onion_c->friends_list[friend_num].is_online = is_online;
 
     /* This should prevent some clock related issues */
@@ -1745,6 +1793,12 @@ int onion_set_friend_online(Onion_Client *onion_c, int friend_num, bool is_onlin
         onion_c->friends_list[friend_num].run_count = 0;
     }
 
+    if (was_online && !is_online && onion_c->friends_list[friend_num].is_valid) {
+        // Recently seen friends are the most likely to be found again soon.
+        onion_c->friends_list[friend_num].search_found = false;
+        onion_friend_schedule_search(onion_c, friend_num, mono_time_get_ms(onion_c->mono_time));
+    }
+
     return 0;
 }
 
@@ -1774,50 +1828,66 @@ static void populate_path_nodes(Onion_Client *_Nonnull onion_c)
 /* Max exponent when calculating the announce request interval */
 #define MAX_RUN_COUNT_EXPONENT 12
 
-static void do_friend(Onion_Client *_Nonnull onion_c, uint32_t friendnum)
+/** How often we ping a node for a friend, in seconds. */
+static uint32_t friend_ping_interval(const Onion_Friend *_Nonnull o_friend)
+{
+    if (o_friend->run_count <= ANNOUNCE_FRIEND_RUN_COUNT_BEGINNING) {
+        return ANNOUNCE_FRIEND_NEW_INTERVAL;
+    }
+
+    // how often we ping a node for a friend depends on how many times we've already tried.
+    // the interval increases exponentially, as the longer a friend has been offline, the less
+    // likely the case is that they're online and failed to find us
+    const uint32_t c = 1 << min_u32(MAX_RUN_COUNT_EXPONENT, o_friend->run_count - 2);
+    return min_u32(c, ANNOUNCE_FRIEND_MAX_INTERVAL);
+}
+
+/** @brief Search for a friend.
+ *
+ * @return the number of packets sent.
+ */
+static uint32_t do_friend(Onion_Client *_Nonnull onion_c, uint32_t friendnum)
 {
     if (friendnum >= onion_c->num_friends) {
-        return;
+        return 0;
     }
 
     Onion_Friend *o_friend = &onion_c->friends_list[friendnum];
 
     if (!o_friend->is_valid) {
-        return;
+        return 0;
     }
 
-    uint32_t interval;
     const uint64_t tm = mono_time_get(onion_c->mono_time);
     const bool friend_is_new = o_friend->run_count <= ANNOUNCE_FRIEND_RUN_COUNT_BEGINNING;
-
-    if (!friend_is_new) {
-        // how often we ping a node for a friend depends on how many times we've already tried.
-        // the interval increases exponentially, as the longer a friend has been offline, the less
-        // likely the case is that they're online and failed to find us
-        const uint32_t c = 1 << min_u32(MAX_RUN_COUNT_EXPONENT, o_friend->run_count - 2);
-        interval = min_u32(c, ANNOUNCE_FRIEND_MAX_INTERVAL);
-    } else {
-        interval = ANNOUNCE_FRIEND_NEW_INTERVAL;
-    }
+    const uint32_t interval = friend_ping_interval(o_friend);
 
     if (o_friend->is_online) {
-        return;
+        return 0;
     }
 
     assert(interval >= ANNOUNCE_FRIEND_NEW_INTERVAL); // an int overflow would be devastating
 
+    uint32_t sent = 0;
+
     /* send packets to friend telling them our DHT public key. */
     if (mono_time_is_timeout(onion_c->mono_time, onion_c->friends_list[friendnum].last_dht_pk_onion_sent,
                              ONION_DHTPK_SEND_INTERVAL)) {
-        if (send_dhtpk_announce(onion_c, friendnum, 0) >= 1) {
+        const int dhtpk_sent = send_dhtpk_announce(onion_c, friendnum, 0);
+
+        if (dhtpk_sent >= 1) {
             onion_c->friends_list[friendnum].last_dht_pk_onion_sent = tm;
+            sent += dhtpk_sent;
         }
     }
 
     if (mono_time_is_timeout(onion_c->mono_time, onion_c->friends_list[friendnum].last_dht_pk_dht_sent,
                              DHT_DHTPK_SEND_INTERVAL)) {
-        if (send_dhtpk_announce(onion_c, friendnum, 1) >= 1) {
+        const int dhtpk_sent = send_dhtpk_announce(onion_c, friendnum, 1);
+
+        if (dhtpk_sent >= 1) {
             onion_c->friends_list[friendnum].last_dht_pk_dht_sent = tm;
+            sent += dhtpk_sent;
         }
     }
 
@@ -1858,6 +1928,7 @@ static void do_friend(Onion_Client *_Nonnull onion_c, uint32_t friendnum)
             o_friend->time_last_pinged = tm;
             ++node_list[i].pings_since_last_response;
             ++o_friend->pings;
+            ++sent;
 
             if (o_friend->pings % (MAX_ONION_CLIENTS / 2) == 0) {
                 ++o_friend->run_count;
@@ -1870,7 +1941,7 @@ static void do_friend(Onion_Client *_Nonnull onion_c, uint32_t friendnum)
             o_friend->last_populated = tm;
         }
 
-        return;
+        return sent;
     }
 
     // check if path nodes list for this friend needs to be repopulated
@@ -1880,17 +1951,111 @@ static void do_friend(Onion_Client *_Nonnull onion_c, uint32_t friendnum)
         const uint16_t n = min_u16(num_nodes, MAX_PATH_NODES / 4);
 
         if (n == 0) {
-            return;
+            return sent;
         }
 
         o_friend->last_populated = tm;
 
         for (uint16_t i = 0; i < n; ++i) {
             const uint32_t num = random_range_u32(onion_c->rng, num_nodes);
-            client_send_announce_request(onion_c, friendnum + 1, &onion_c->path_nodes[num].ip_port,
-                                         onion_c->path_nodes[num].public_key, nullptr, -1);
+
+            if (client_send_announce_request(onion_c, friendnum + 1, &onion_c->path_nodes[num].ip_port,
+                                             onion_c->path_nodes[num].public_key, nullptr, -1) == 0) {
+                ++sent;
+            }
         }
     }
+
+    return sent;
+}
+
+/** @brief Time in ms until do_friend has something to do for this friend again.
+ *
+ * Friends that have been offline for long are pinged less often (see
+ * friend_ping_interval). Jitter keeps friends added or gone offline at the
+ * same time from staying in lockstep.
+ */
+static uint64_t friend_search_delay(const Onion_Client *_Nonnull onion_c, const Onion_Friend *_Nonnull o_friend)
+{
+    // do_friend spaces out pings to the friend's nodes by this much.
+    uint64_t delay = (uint64_t)friend_ping_interval(o_friend) * 1000 / (MAX_ONION_CLIENTS / 2);
+
+    // Keep telling friends that can hear us where we are.
+    if (o_friend->last_dht_pk_onion_sent != 0 || o_friend->last_dht_pk_dht_sent != 0) {
+        delay = min_u64(delay, DHT_DHTPK_SEND_INTERVAL * 1000);
+    }
+
+    delay = min_u64(delay, ANNOUNCE_POPULATE_TIMEOUT * 1000);
+
+    // do_onion_client runs once a second.
+    if (delay <= 1000) {
+        return 1000;
+    }
+
+    return delay + random_range_u32(onion_c->rng, (uint32_t)(delay / 4));
+}
+
+/** Put every friend that isn't queued back into the queue, dropping stale entries. */
+static void rebuild_search_queue(Onion_Client *_Nonnull onion_c, uint64_t now)
+{
+    onion_search_queue_clear(&onion_c->search_queue);
+    onion_c->search_queue_rebuild = false;
+
+    for (uint32_t i = 0; i < onion_c->num_friends; ++i) {
+        Onion_Friend *o_friend = &onion_c->friends_list[i];
+
+        if (!o_friend->is_valid || o_friend->is_online) {
+            o_friend->search_due = 0;
+            continue;
+        }
+
+        const uint64_t due = o_friend->search_due != 0 ? o_friend->search_due : now;
+        o_friend->search_due = 0;
+        onion_friend_schedule_search(onion_c, i, due);
+    }
+}
+
+/** @brief Search for the friends that are due, as far as the packet budget allows.
+ *
+ * Friends that don't fit in the budget stay at the front of the queue, so the
+ * ones that have waited longest go first next time.
+ */
+static void do_friend_searches(Onion_Client *_Nonnull onion_c)
+{
+    const uint64_t now = mono_time_get_ms(onion_c->mono_time);
+
+    // Every friend has at most one live entry, the rest are from rescheduling.
+    if (onion_c->search_queue_rebuild || onion_c->search_queue.length > onion_c->num_friends * 2 + 64) {
+        rebuild_search_queue(onion_c, now);
+    }
+
+    Onion_Search_Entry entry;
+
+    while (onion_search_budget_available(&onion_c->search_budget, now) > 0
+            && onion_search_queue_pop_due(&onion_c->search_queue, now, &entry)) {
+        if (entry.friend_num >= onion_c->num_friends) {
+            continue;
+        }
+
+        Onion_Friend *o_friend = &onion_c->friends_list[entry.friend_num];
+
+        if (!o_friend->is_valid || o_friend->search_due != entry.due) {
+            continue;
+        }
+
+        o_friend->search_due = 0;
+
+        if (o_friend->is_online) {
+            // Queued again when they go offline.
+            continue;
+        }
+
+        onion_search_budget_spend(&onion_c->search_budget, do_friend(onion_c, entry.friend_num));
+
+        // Aligned to the second do_onion_client runs in, so a 1 second delay means the next run.
+        const uint64_t second = now - now % 1000;
+        onion_friend_schedule_search(onion_c, entry.friend_num, second + friend_search_delay(onion_c, o_friend));
+    }
 }
 
 /** Function to call when onion data packet with contents beginning with byte is received. */
@@ -2115,8 +2280,12 @@ static void reset_friend_run_counts(Onion_Client *_Nonnull onion_c)
 
         if (o_friend->is_valid) {
             o_friend->run_count = 0;
+            // Search for everyone again, now that we can.
+            o_friend->search_due = 0;
         }
     }
+
+    onion_c->search_queue_rebuild = true;
 }
 
 #define ONION_CONNECTION_SECONDS 3
@@ -2169,9 +2338,7 @@ void do_onion_client(Onion_Client *onion_c)
     }
 
     if (onion_connection_status(onion_c) != ONION_CONNECTION_STATUS_NONE) {
-        for (uint32_t i = 0; i < onion_c->num_friends; ++i) {
-            do_friend(onion_c, i);
-        }
+        do_friend_searches(onion_c);
     }
 
     if (onion_c->last_run == 0) {
@@ -2211,6 +2378,8 @@ Onion_Client *new_onion_client(const Logger *logger, const Memory *mem, const Ra
     onion_c->c = c;
     onion_c->friends_list_capacity = 0;
     bs_list_init(&onion_c->friends_lookup, mem, CRYPTO_PUBLIC_KEY_SIZE, 0, memcmp);
+    onion_search_queue_init(&onion_c->search_queue, mem);
+    onion_search_budget_init(&onion_c->search_budget, ONION_SEARCH_PACKETS_PER_SECOND, mono_time_get_ms(mono_time));
 
     new_symmetric_key(rng, onion_c->secret_symmetric_key);
     crypto_new_keypair(rng, onion_c->temp_public_key, onion_c->temp_secret_key);
@@ -2235,6 +2404,7 @@ void kill_onion_client(Onion_Client *onion_c)
     ping_array_kill(onion_c->announce_ping_array);
     realloc_onion_friends(onion_c, 0);
     bs_list_free(&onion_c->friends_lookup);
+    onion_search_queue_free(&onion_c->search_queue);
     networking_registerhandler(onion_c->net, NET_PACKET_ANNOUNCE_RESPONSE, nullptr, nullptr);
     networking_registerhandler(onion_c->net, NET_PACKET_ANNOUNCE_RESPONSE_OLD, nullptr, nullptr);
     networking_registerhandler(onion_c->net, NET_PACKET_ONION_DATA_RESPONSE, nullptr, nullptr);
@@ -23,6 +23,7 @@
 #include "net_crypto.h"
 #include "network.h"
 #include "onion_announce.h"
+#include "onion_search.h"
 
 #define MAX_ONION_CLIENTS 8
 #define MAX_ONION_CLIENTS_ANNOUNCE 12 // Number of nodes to announce ourselves to.
@@ -51,6 +52,9 @@
 
 #define MAX_PATH_NODES 32
 
+/** How many packets per second searching for offline friends may send. */
+#define ONION_SEARCH_PACKETS_PER_SECOND 256
+
 #define GCA_MAX_DATA_LENGTH GCA_PUBLIC_ANNOUNCE_MAX_SIZE
 
 /**
@@ -212,6 +216,15 @@ typedef enum Onion_Connection_Status {
 
 Onion_Connection_Status onion_connection_status(const Onion_Client *_Nonnull onion_c);
 
+typedef struct Onion_Search_Stats {
+    /** Announce requests sent to find friends. */
+    uint64_t searches_sent;
+    /** Offline friends that told us their DHT public key, i.e. that were found. */
+    uint64_t friends_found;
+} Onion_Search_Stats;
+
+void onion_get_search_stats(const Onion_Client *_Nonnull onion_c, Onion_Search_Stats *_Nonnull stats);
+
 typedef struct Onion_Friend Onion_Friend;
 
 uint32_t onion_get_friend_count(const Onion_Client *_Nonnull onion_c);
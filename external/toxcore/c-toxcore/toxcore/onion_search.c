@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+#include "onion_search.h"
+
+#include "ccompat.h"
+
+void onion_search_queue_init(Onion_Search_Queue *queue, const Memory *mem)
+{
+    queue->mem = mem;
+    queue->entries = nullptr;
+    queue->length = 0;
+    queue->capacity = 0;
+}
+
+void onion_search_queue_free(Onion_Search_Queue *queue)
+{
+    mem_delete(queue->mem, queue->entries);
+    queue->entries = nullptr;
+    queue->length = 0;
+    queue->capacity = 0;
+}
+
+void onion_search_queue_clear(Onion_Search_Queue *queue)
+{
+    queue->length = 0;
+}
+
+static bool onion_search_entry_less(const Onion_Search_Entry *_Nonnull a, const Onion_Search_Entry *_Nonnull b)
+{
+    if (a->due != b->due) {
+        return a->due < b->due;
+    }
+
+    return a->friend_num < b->friend_num;
+}
+
+static void onion_search_entry_swap(Onion_Search_Entry *_Nonnull a, Onion_Search_Entry *_Nonnull b)
+{
+    const Onion_Search_Entry tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+bool onion_search_queue_push(Onion_Search_Queue *queue, uint64_t due, uint32_t friend_num)
+{
+    if (queue->length == queue->capacity) {
+        const uint32_t new_capacity = queue->capacity == 0 ? 16 : queue->capacity * 2;
+
+        if (new_capacity < queue->capacity) {
+            return false;
+        }
+
+        Onion_Search_Entry *entries = (Onion_Search_Entry *)mem_vrealloc(
+                                          queue->mem, queue->entries, new_capacity, sizeof(Onion_Search_Entry));
+
+        if (entries == nullptr) {
+            return false;
+        }
+
+        queue->entries = entries;
+        queue->capacity = new_capacity;
+    }
+
+    Onion_Search_Entry *entries = queue->entries;
+    uint32_t i = queue->length;
+    ++queue->length;
+    entries[i].due = due;
+    entries[i].friend_num = friend_num;
+
+    while (i > 0) {
+        const uint32_t parent = (i - 1) / 2;
+
+        if (!onion_search_entry_less(&entries[i], &entries[parent])) {
+            break;
+        }
+
+        onion_search_entry_swap(&entries[i], &entries[parent]);
+        i = parent;
+    }
+
+    return true;
+}
+
+bool onion_search_queue_pop_due(Onion_Search_Queue *queue, uint64_t now, Onion_Search_Entry *entry)
+{
+    if (queue->length == 0 || queue->entries[0].due > now) {
+        return false;
+    }
+
+    Onion_Search_Entry *entries = queue->entries;
+    *entry = entries[0];
+
+    --queue->length;
+    entries[0] = entries[queue->length];
+
+    uint32_t i = 0;
+
+    while (true) {
+        const uint32_t left = 2 * i + 1;
+        const uint32_t right = left + 1;
+        uint32_t smallest = i;
+
+        if (left < queue->length && onion_search_entry_less(&entries[left], &entries[smallest])) {
+            smallest = left;
+        }
+
+        if (right < queue->length && onion_search_entry_less(&entries[right], &entries[smallest])) {
+            smallest = right;
+        }
+
+        if (smallest == i) {
+            break;
+        }
+
+        onion_search_entry_swap(&entries[i], &entries[smallest]);
+        i = smallest;
+    }
+
+    return true;
+}
+
+void onion_search_budget_init(Onion_Search_Budget *budget, uint32_t rate, uint64_t now)
+{
+    budget->rate = rate;
+    budget->tokens = rate;
+    budget->last_refill = now;
+}
+
+uint32_t onion_search_budget_available(Onion_Search_Budget *budget, uint64_t now)
+{
+    if (budget->rate == 0 || now <= budget->last_refill) {
+        return budget->tokens;
+    }
+
+    const uint64_t refill = (now - budget->last_refill) * budget->rate / 1000;
+
+    if (budget->tokens + refill >= budget->rate) {
+        budget->tokens = budget->rate;
+        budget->last_refill = now;
+    } else if (refill > 0) {
+        budget->tokens += (uint32_t)refill;
+        // Keep the fraction of a token that was not added yet.
+        budget->last_refill += refill * 1000 / budget->rate;
+    }
+
+    return budget->tokens;
+}
+
+void onion_search_budget_spend(Onion_Search_Budget *budget, uint32_t packets)
+{
+    budget->tokens = packets < budget->tokens ? budget->tokens - packets : 0;
+}
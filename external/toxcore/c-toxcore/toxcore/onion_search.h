@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright © 2026 The TokTok team.
+ */
+
+/** @file
+ * @brief Scheduling of onion friend searches.
+ *
+ * A queue ordered by the time each friend is due to be searched for again, and
+ * a budget that limits how many search packets are sent per second, so that
+ * large friend lists are spread out over time instead of all being walked on
+ * every iteration.
+ */
+#ifndef C_TOXCORE_TOXCORE_ONION_SEARCH_H
+#define C_TOXCORE_TOXCORE_ONION_SEARCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "attributes.h"
+#include "mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Onion_Search_Entry {
+    /** Monotonic time in milliseconds at which the friend is due. */
+    uint64_t due;
+    uint32_t friend_num;
+} Onion_Search_Entry;
+
+/**
+ * @brief Min-heap of friends by due time.
+ *
+ * Entries are never updated in place: rescheduling a friend pushes a new
+ * entry, and the owner drops entries that no longer match its own record of
+ * when the friend is due when they are popped.
+ */
+typedef struct Onion_Search_Queue {
+    const Memory *_Nonnull mem;
+    Onion_Search_Entry *_Nullable entries;
+    uint32_t length;
+    uint32_t capacity;
+} Onion_Search_Queue;
+
+void onion_search_queue_init(Onion_Search_Queue *_Nonnull queue, const Memory *_Nonnull mem);
+void onion_search_queue_free(Onion_Search_Queue *_Nonnull queue);
+
+/** @brief Remove all entries, keeping the allocated memory. */
+void onion_search_queue_clear(Onion_Search_Queue *_Nonnull queue);
+
+/**
+ * @retval true on success.
+ * @retval false if memory allocation failed.
+ */
+bool onion_search_queue_push(Onion_Search_Queue *_Nonnull queue, uint64_t due, uint32_t friend_num);
+
+/**
+ * @brief Remove the entry with the earliest due time if it is due at `now`.
+ *
+ * @retval true if an entry was removed and stored in `entry`.
+ */
+bool onion_search_queue_pop_due(Onion_Search_Queue *_Nonnull queue, uint64_t now, Onion_Search_Entry *_Nonnull entry);
+
+/**
+ * @brief Token bucket for search packets.
+ *
+ * Refills at `rate` packets per second up to `rate` packets.
+ */
+typedef struct Onion_Search_Budget {
+    uint32_t rate;
+    uint32_t tokens;
+    /** Time in milliseconds up to which tokens have been added. */
+    uint64_t last_refill;
+} Onion_Search_Budget;
+
+void onion_search_budget_init(Onion_Search_Budget *_Nonnull budget, uint32_t rate, uint64_t now);
+
+/** @brief Number of packets that may be sent at `now`. */
+uint32_t onion_search_budget_available(Onion_Search_Budget *_Nonnull budget, uint64_t now);
+
+/** @brief Account for packets that were sent. Spending more than is available empties the budget. */
+void onion_search_budget_spend(Onion_Search_Budget *_Nonnull budget, uint32_t packets);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* C_TOXCORE_TOXCORE_ONION_SEARCH_H */
@@ -0,0 +1,153 @@
+#include "onion_search.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "mem.h"
+#include "os_memory.h"
+
+namespace {
+
+TEST(OnionSearchQueue, PopsInDueOrder)
+{
+    Onion_Search_Queue queue;
+    onion_search_queue_init(&queue, os_memory());
+
+    const std::uint64_t dues[] = {500, 100, 900, 300, 100, 700, 200};
+
+    for (std::uint32_t i = 0; i < sizeof(dues) / sizeof(dues[0]); ++i) {
+        ASSERT_TRUE(onion_search_queue_push(&queue, dues[i], i));
+    }
+
+    std::vector<std::uint64_t> popped;
+    Onion_Search_Entry entry;
+
+    while (onion_search_queue_pop_due(&queue, UINT64_MAX, &entry)) {
+        popped.push_back(entry.due);
+    }
+
+    EXPECT_EQ(popped, (std::vector<std::uint64_t>{100, 100, 200, 300, 500, 700, 900}));
+    EXPECT_EQ(queue.length, 0);
+
+    onion_search_queue_free(&queue);
+}
+
+TEST(OnionSearchQueue, TiesAreOrderedByFriendNumber)
+{
+    Onion_Search_Queue queue;
+    onion_search_queue_init(&queue, os_memory());
+
+    ASSERT_TRUE(onion_search_queue_push(&queue, 10, 3));
+    ASSERT_TRUE(onion_search_queue_push(&queue, 10, 1));
+    ASSERT_TRUE(onion_search_queue_push(&queue, 10, 2));
+
+    Onion_Search_Entry entry;
+
+    for (std::uint32_t expected = 1; expected <= 3; ++expected) {
+        ASSERT_TRUE(onion_search_queue_pop_due(&queue, 10, &entry));
+        EXPECT_EQ(entry.friend_num, expected);
+    }
+
+    onion_search_queue_free(&queue);
+}
+
+TEST(OnionSearchQueue, OnlyPopsWhatIsDue)
+{
+    Onion_Search_Queue queue;
+    onion_search_queue_init(&queue, os_memory());
+
+    ASSERT_TRUE(onion_search_queue_push(&queue, 2000, 0));
+    ASSERT_TRUE(onion_search_queue_push(&queue, 1000, 1));
+
+    Onion_Search_Entry entry;
+    EXPECT_FALSE(onion_search_queue_pop_due(&queue, 999, &entry));
+
+    ASSERT_TRUE(onion_search_queue_pop_due(&queue, 1000, &entry));
+    EXPECT_EQ(entry.friend_num, 1);
+    EXPECT_FALSE(onion_search_queue_pop_due(&queue, 1999, &entry));
+
+    onion_search_queue_clear(&queue);
+    EXPECT_FALSE(onion_search_queue_pop_due(&queue, 3000, &entry));
+
+    onion_search_queue_free(&queue);
+}
+
+TEST(OnionSearchQueue, GrowsPastInitialCapacity)
+{
+    Onion_Search_Queue queue;
+    onion_search_queue_init(&queue, os_memory());
+
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(onion_search_queue_push(&queue, (i * 7919) % 1000, i));
+    }
+
+    Onion_Search_Entry entry;
+    std::uint64_t last = 0;
+    std::uint32_t count = 0;
+
+    while (onion_search_queue_pop_due(&queue, UINT64_MAX, &entry)) {
+        EXPECT_GE(entry.due, last);
+        last = entry.due;
+        ++count;
+    }
+
+    EXPECT_EQ(count, 1000);
+
+    onion_search_queue_free(&queue);
+}
+
+TEST(OnionSearchBudget, StartsFullAndRefillsOverTime)
+{
+    Onion_Search_Budget budget;
+    onion_search_budget_init(&budget, 100, 1000);
+
+    EXPECT_EQ(onion_search_budget_available(&budget, 1000), 100);
+
+    onion_search_budget_spend(&budget, 100);
+    EXPECT_EQ(onion_search_budget_available(&budget, 1000), 0);
+
+    // 100 per second is one every 10ms.
+    EXPECT_EQ(onion_search_budget_available(&budget, 1005), 0);
+    EXPECT_EQ(onion_search_budget_available(&budget, 1010), 1);
+    EXPECT_EQ(onion_search_budget_available(&budget, 1500), 50);
+}
+
+TEST(OnionSearchBudget, KeepsFractionsOfTokens)
+{
+    Onion_Search_Budget budget;
+    onion_search_budget_init(&budget, 100, 0);
+    onion_search_budget_spend(&budget, 100);
+
+    // Asking every 15ms must not lose the 5ms left over each time.
+    for (std::uint64_t now = 15; now <= 600; now += 15) {
+        onion_search_budget_available(&budget, now);
+    }
+
+    EXPECT_EQ(onion_search_budget_available(&budget, 600), 60);
+}
+
+TEST(OnionSearchBudget, IsCappedAtTheRate)
+{
+    Onion_Search_Budget budget;
+    onion_search_budget_init(&budget, 100, 0);
+    onion_search_budget_spend(&budget, 30);
+
+    EXPECT_EQ(onion_search_budget_available(&budget, 60000), 100);
+
+    // Idle time does not carry over once the bucket is full.
+    onion_search_budget_spend(&budget, 100);
+    EXPECT_EQ(onion_search_budget_available(&budget, 60010), 1);
+}
+
+TEST(OnionSearchBudget, OverspendingEmptiesTheBudget)
+{
+    Onion_Search_Budget budget;
+    onion_search_budget_init(&budget, 10, 0);
+
+    onion_search_budget_spend(&budget, 25);
+    EXPECT_EQ(onion_search_budget_available(&budget, 0), 0);
+}
+
+}  // namespace
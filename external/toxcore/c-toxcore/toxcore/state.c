@@ -4,6 +4,7 @@
  */
 #include "state.h"
 
+#include <assert.h>
 #include <string.h>
 
 #include "ccompat.h"
@@ -70,6 +71,151 @@ int state_load(const Logger *log, state_load_cb *state_load_callback, void *oute
     return 0;
 }
 
+#define STATE_SECTION_HEADER_SIZE (sizeof(uint32_t) * 2)
+
+/** Number of section types that are tracked individually when replaying a journal. */
+#define STATE_JOURNAL_TYPES 256
+
+typedef struct State_Section {
+    const uint8_t *_Nullable data;
+    uint32_t length;
+    uint16_t type;
+} State_Section;
+
+/**
+ * @brief Parse the section header at `data`.
+ *
+ * @retval false if the section is truncated or has the wrong cookie.
+ */
+static bool state_read_section(const uint8_t *_Nonnull data, uint32_t length, uint16_t cookie_inner,
+                               State_Section *_Nonnull section)
+{
+    if (length < STATE_SECTION_HEADER_SIZE) {
+        return false;
+    }
+
+    uint32_t length_sub;
+    lendian_bytes_to_host32(&length_sub, data);
+
+    uint32_t cookie_type;
+    lendian_bytes_to_host32(&cookie_type, data + sizeof(uint32_t));
+
+    if (length - STATE_SECTION_HEADER_SIZE < length_sub) {
+        return false;
+    }
+
+    if (lendian_to_host16(cookie_type >> 16) != cookie_inner) {
+        return false;
+    }
+
+    section->data = data + STATE_SECTION_HEADER_SIZE;
+    section->length = length_sub;
+    section->type = lendian_to_host16(cookie_type & 0xFFFF);
+    return true;
+}
+
+/**
+ * @brief Find the end of the last complete journal entry.
+ *
+ * @return the number of bytes that can be loaded, 0 if not even the save data
+ *   itself is complete.
+ */
+static uint32_t state_journal_valid_length(const Logger *_Nonnull log, const uint8_t *_Nonnull data, uint32_t length,
+        uint16_t cookie_inner)
+{
+    uint32_t pos = 0;
+    uint32_t committed = 0;
+    State_Section section;
+
+    while (pos < length && state_read_section(data + pos, length - pos, cookie_inner, &section)) {
+        pos += STATE_SECTION_HEADER_SIZE + section.length;
+
+        if (section.type == STATE_TYPE_END) {
+            committed = pos;
+        }
+    }
+
+    if (committed == 0) {
+        // Old save data may not have an end section, it still has to parse completely.
+        return pos == length ? length : 0;
+    }
+
+    if (committed != length) {
+        LOGGER_WARNING(log, "ignoring %u bytes of incomplete journal entry", length - committed);
+    }
+
+    return committed;
+}
+
+bool state_type_is_delta(uint16_t type)
+{
+    return type == STATE_TYPE_FRIEND || type == STATE_TYPE_FRIEND_DELETED;
+}
+
+int state_load_journal(const Logger *log, state_load_cb *state_load_callback, void *outer,
+                       const uint8_t *data, uint32_t length, uint16_t cookie_inner)
+{
+    if (state_load_callback == nullptr || data == nullptr) {
+        LOGGER_ERROR(log, "state_load_journal() called with invalid args.");
+        return -1;
+    }
+
+    const uint32_t valid_length = state_journal_valid_length(log, data, length, cookie_inner);
+
+    if (valid_length == 0) {
+        LOGGER_ERROR(log, "state file truncated or garbled");
+        return -1;
+    }
+
+    // Offsets of the first and last section of each type, plus one so 0 means none.
+    uint32_t first_offset[STATE_JOURNAL_TYPES] = {0};
+    uint32_t last_offset[STATE_JOURNAL_TYPES] = {0};
+    State_Section section;
+
+    for (uint32_t pos = 0; pos < valid_length; pos += STATE_SECTION_HEADER_SIZE + section.length) {
+        state_read_section(data + pos, valid_length - pos, cookie_inner, &section);
+
+        if (section.type >= STATE_JOURNAL_TYPES || state_type_is_delta(section.type)) {
+            continue;
+        }
+
+        if (first_offset[section.type] == 0) {
+            first_offset[section.type] = pos + 1;
+        }
+
+        last_offset[section.type] = pos + 1;
+    }
+
+    for (uint32_t pos = 0; pos < valid_length; pos += STATE_SECTION_HEADER_SIZE + section.length) {
+        state_read_section(data + pos, valid_length - pos, cookie_inner, &section);
+
+        if (section.type == STATE_TYPE_END) {
+            continue;
+        }
+
+        State_Section load = section;
+
+        if (section.type < STATE_JOURNAL_TYPES && !state_type_is_delta(section.type)) {
+            if (first_offset[section.type] != pos + 1) {
+                // Already loaded the latest version in place of the first one.
+                continue;
+            }
+
+            const uint32_t last = last_offset[section.type] - 1;
+            state_read_section(data + last, valid_length - last, cookie_inner, &load);
+        }
+
+        assert(load.data != nullptr);
+
+        if (state_load_callback(outer, load.data, load.length, load.type) == STATE_LOAD_STATUS_ERROR) {
+            LOGGER_ERROR(log, "Error occcured in state file (type: 0x%02x).", load.type);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 uint8_t *state_write_section_header(uint8_t *data, uint16_t cookie_type, uint32_t len, uint32_t section_type)
 {
     host_to_lendian_bytes32(data, len);
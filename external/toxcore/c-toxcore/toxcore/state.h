@@ -17,6 +17,7 @@
 #ifndef C_TOXCORE_TOXCORE_STATE_H
 #define C_TOXCORE_TOXCORE_STATE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "attributes.h"
@@ -40,6 +41,10 @@ typedef enum State_Type {
     STATE_TYPE_GROUPS        = 7,
     STATE_TYPE_TCP_RELAY     = 10,
     STATE_TYPE_PATH_NODE     = 11,
+    // Journal only: saved friends that were added or changed.
+    STATE_TYPE_FRIEND        = 12,
+    // Journal only: public keys of friends that were deleted.
+    STATE_TYPE_FRIEND_DELETED = 13,
     STATE_TYPE_CONFERENCES   = 20,
     STATE_TYPE_END           = 255,
 } State_Type;
@@ -59,6 +64,27 @@ typedef State_Load_Status state_load_cb(void *_Nonnull outer, const uint8_t *_No
 /** state load/save */
 int state_load(const Logger *_Nonnull log, state_load_cb *_Nonnull state_load_callback, void *_Nonnull outer, const uint8_t *_Nonnull data, uint32_t length, uint16_t cookie_inner);
 
+/**
+ * @brief Load save data followed by journal entries.
+ *
+ * A journal entry is a list of sections terminated by a STATE_TYPE_END
+ * section, appended to the save data (which ends the same way). A section in
+ * a later entry replaces the same section from the save data or an earlier
+ * entry, and is loaded at the position where that section first appeared so
+ * the load order of the save data is kept. Delta sections (see
+ * state_type_is_delta) don't replace anything, they are all loaded in order.
+ *
+ * An incomplete or garbled entry at the end (e.g. from a write that was
+ * interrupted) is ignored, as long as the data before it is complete.
+ *
+ * @retval 0 on success.
+ * @retval -1 if the save data itself is invalid or a section failed to load.
+ */
+int state_load_journal(const Logger *_Nonnull log, state_load_cb *_Nonnull state_load_callback, void *_Nonnull outer, const uint8_t *_Nonnull data, uint32_t length, uint16_t cookie_inner);
+
+/** @brief Whether sections of this type add to the state instead of replacing it. */
+bool state_type_is_delta(uint16_t type);
+
 uint8_t *_Nonnull state_write_section_header(uint8_t *_Nonnull data, uint16_t cookie_type, uint32_t len, uint32_t section_type);
 
 // Utilities for state data serialisation.
@@ -225,6 +225,22 @@ static void tox_file_chunk_request_handler(Messenger *m, uint32_t friend_number,
     }
 }
 
+static m_file_bulk_read_cb tox_file_bulk_read_handler;
+static int32_t tox_file_bulk_read_handler(Messenger *m, uint32_t friend_number, uint32_t file_number, uint64_t position,
+        uint8_t *data, uint16_t length, void *file_user_data, void *user_data)
+{
+    struct Tox_Userdata *tox_data = (struct Tox_Userdata *)user_data;
+    if (tox_data->tox->file_bulk_read_callback == nullptr) {
+        return -1;
+    }
+
+    tox_unlock(tox_data->tox);
+    const int32_t ret = tox_data->tox->file_bulk_read_callback(tox_data->tox, friend_number, file_number, position, data, length,
+                        file_user_data);
+    tox_lock(tox_data->tox);
+    return ret;
+}
+
 static m_file_recv_cb tox_file_recv_handler;
 static void tox_file_recv_handler(Messenger *m, uint32_t friend_number, uint32_t file_number, uint32_t kind,
                                   uint64_t file_size, const uint8_t *filename, size_t filename_length, void *user_data)
@@ -631,8 +647,44 @@ static int tox_load(Tox *_Nonnull tox, const uint8_t *_Nonnull data, uint32_t le
         return -1;
     }
 
-    return state_load(tox->m->log, state_load_callback, tox, data + cookie_len,
-                      length - cookie_len, STATE_COOKIE_TYPE);
+    return state_load_journal(tox->m->log, state_load_callback, tox, data + cookie_len,
+                              length - cookie_len, STATE_COOKIE_TYPE);
+}
+
+/** @brief Hash of the saved conferences, to find out whether they changed. */
+static bool conferences_hash(const Tox *_Nonnull tox, uint8_t hash[_Nonnull CRYPTO_SHA256_SIZE])
+{
+    const uint32_t len = conferences_size(tox->m->conferences_object);
+    uint8_t *saved = (uint8_t *)mem_balloc(tox->sys.mem, len);
+
+    if (saved == nullptr) {
+        return false;
+    }
+
+    conferences_save(tox->m->conferences_object, saved);
+    crypto_sha256(hash, saved, len);
+    mem_delete(tox->sys.mem, saved);
+    return true;
+}
+
+static bool conferences_changed(const Tox *_Nonnull tox)
+{
+    uint8_t hash[CRYPTO_SHA256_SIZE];
+    // If we can't tell, save them.
+    return !conferences_hash(tox, hash) || !crypto_sha256_eq(hash, tox->journal_conferences_hash);
+}
+
+static void conferences_journal_reset(Tox *_Nonnull tox)
+{
+    if (!conferences_hash(tox, tox->journal_conferences_hash)) {
+        memzero(tox->journal_conferences_hash, sizeof(tox->journal_conferences_hash));
+    }
+}
+
+static void savedata_journal_reset(Tox *_Nonnull tox)
+{
+    messenger_journal_reset(tox->m);
+    conferences_journal_reset(tox);
 }
 
 static Tox *_Nullable tox_new_system(const struct Tox_Options *_Nullable options, Tox_Err_New *_Nullable error, const Tox_System *_Nullable sys)
@@ -932,6 +984,7 @@ static Tox *_Nullable tox_new_system(const struct Tox_Options *_Nullable options
     m_callback_friendmessage(tox->m, tox_friend_message_handler);
     callback_file_control(tox->m, tox_file_recv_control_handler);
     callback_file_reqchunk(tox->m, tox_file_chunk_request_handler);
+    callback_file_bulk_read(tox->m, tox_file_bulk_read_handler);
     callback_file_sendrequest(tox->m, tox_file_recv_handler);
     callback_file_data(tox->m, tox_file_recv_chunk_handler);
     dht_callback_nodes_response(tox->m->dht, tox_dht_nodes_response_handler);
@@ -963,6 +1016,9 @@ static Tox *_Nullable tox_new_system(const struct Tox_Options *_Nullable options
     gc_callback_rejected(tox->m, tox_group_join_fail_handler);
     gc_callback_voice_state(tox->m, tox_group_voice_state_handler);
 
+    // Loading changed everything, but nothing that isn't in the savedata.
+    savedata_journal_reset(tox);
+
     tox_unlock(tox);
 
     SET_ERROR_PARAMETER(error, TOX_ERR_NEW_OK);
@@ -1074,6 +1130,86 @@ void tox_get_savedata(const Tox *_Nonnull tox, uint8_t *_Nullable savedata)
     tox_unlock(tox);
 }
 
+static size_t savedata_journal_size(const Tox *_Nonnull tox)
+{
+    const uint32_t messenger_changes = messenger_journal_size(tox->m);
+    const uint32_t conferences_changes = conferences_changed(tox) ? conferences_size(tox->m->conferences_object) : 0;
+
+    if (messenger_changes == 0 && conferences_changes == 0) {
+        return 0;
+    }
+
+    return messenger_changes + conferences_changes + end_size();
+}
+
+size_t tox_get_savedata_journal_size(const Tox *_Nonnull tox)
+{
+    assert(tox != nullptr);
+    tox_lock(tox);
+    const size_t ret = savedata_journal_size(tox);
+    tox_unlock(tox);
+    return ret;
+}
+
+size_t tox_get_savedata_journal(Tox *_Nonnull tox, uint8_t *_Nonnull journal, size_t length)
+{
+    assert(tox != nullptr);
+    assert(journal != nullptr);
+    tox_lock(tox);
+
+    const size_t size = savedata_journal_size(tox);
+
+    if (size == 0 || size > length) {
+        tox_unlock(tox);
+        return 0;
+    }
+
+    memzero(journal, size);
+
+    uint8_t *data = journal;
+    const bool save_conferences = conferences_changed(tox);
+    data = messenger_journal_save(tox->m, data);
+
+    if (save_conferences) {
+        data = conferences_save(tox->m->conferences_object, data);
+    }
+
+    end_save(data);
+
+    conferences_journal_reset(tox);
+
+    tox_unlock(tox);
+    return size;
+}
+
+void tox_savedata_journal_reset(Tox *_Nonnull tox)
+{
+    assert(tox != nullptr);
+    tox_lock(tox);
+    savedata_journal_reset(tox);
+    tox_unlock(tox);
+}
+
+uint64_t tox_onion_search_get_searches_sent(const Tox *_Nonnull tox)
+{
+    assert(tox != nullptr);
+    tox_lock(tox);
+    Onion_Search_Stats stats;
+    onion_get_search_stats(tox->m->onion_c, &stats);
+    tox_unlock(tox);
+    return stats.searches_sent;
+}
+
+uint64_t tox_onion_search_get_friends_found(const Tox *_Nonnull tox)
+{
+    assert(tox != nullptr);
+    tox_lock(tox);
+    Onion_Search_Stats stats;
+    onion_get_search_stats(tox->m->onion_c, &stats);
+    tox_unlock(tox);
+    return stats.friends_found;
+}
+
 static int32_t resolve_bootstrap_node(Tox *_Nullable tox, const char *_Nullable host, uint16_t port,
                                       const Tox_Dht_Id _Nonnull public_key,
                                       IP_Port *_Nonnull *root, Tox_Err_Bootstrap *_Nullable error)
@@ -1269,6 +1405,7 @@ void tox_self_set_nospam(Tox *_Nonnull tox, uint32_t nospam)
     assert(tox != nullptr);
     tox_lock(tox);
     set_nospam(tox->m->fr, net_htonl(nospam));
+    messenger_journal_mark_dirty(tox->m, STATE_TYPE_NOSPAMKEYS);
     tox_unlock(tox);
 }
 
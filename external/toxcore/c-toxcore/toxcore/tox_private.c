@@ -14,6 +14,7 @@
 #include "Messenger.h"
 #include "TCP_server.h"
 #include "ccompat.h"
+#include "congestion_control.h"
 #include "crypto_core.h"
 #include "group_chats.h"
 #include "group_common.h"
@@ -104,6 +105,73 @@ void tox_callback_dht_nodes_response(Tox *tox, tox_dht_nodes_response_cb *callba
     tox->dht_nodes_response_callback = callback;
 }
 
+void tox_callback_file_bulk_read(Tox *tox, tox_file_bulk_read_cb *callback)
+{
+    assert(tox != nullptr);
+    tox->file_bulk_read_callback = callback;
+}
+
+bool tox_file_send_bulk(Tox *tox, uint32_t friend_number, uint32_t file_number, void *file_user_data,
+                        Tox_Err_File_Send_Bulk *error)
+{
+    assert(tox != nullptr);
+    tox_lock(tox);
+    const int ret = file_set_bulk_read(tox->m, friend_number, file_number, file_user_data);
+    tox_unlock(tox);
+
+    switch (ret) {
+        case 0: {
+            SET_ERROR_PARAMETER(error, TOX_ERR_FILE_SEND_BULK_OK);
+            return true;
+        }
+
+        case -1: {
+            SET_ERROR_PARAMETER(error, TOX_ERR_FILE_SEND_BULK_FRIEND_NOT_FOUND);
+            return false;
+        }
+
+        case -2: {
+            SET_ERROR_PARAMETER(error, TOX_ERR_FILE_SEND_BULK_FRIEND_NOT_CONNECTED);
+            return false;
+        }
+
+        case -3: {
+            SET_ERROR_PARAMETER(error, TOX_ERR_FILE_SEND_BULK_NOT_FOUND);
+            return false;
+        }
+
+        case -4: {
+            SET_ERROR_PARAMETER(error, TOX_ERR_FILE_SEND_BULK_CHUNKS_PENDING);
+            return false;
+        }
+    }
+
+    /* can't happen */
+    LOGGER_FATAL(tox->m->log, "impossible return value: %d", ret);
+
+    return false;
+}
+
+void tox_set_congestion_control(Tox *tox, Tox_Congestion_Control congestion_control)
+{
+    assert(tox != nullptr);
+    tox_lock(tox);
+
+    switch (congestion_control) {
+        case TOX_CONGESTION_CONTROL_DEFAULT: {
+            nc_set_congestion_control(tox->m->net_crypto, congestion_control_default());
+            break;
+        }
+
+        case TOX_CONGESTION_CONTROL_BBR: {
+            nc_set_congestion_control(tox->m->net_crypto, congestion_control_bbr());
+            break;
+        }
+    }
+
+    tox_unlock(tox);
+}
+
 bool tox_dht_send_nodes_request(const Tox *tox, const uint8_t *public_key, const char *ip, uint16_t port,
                                 const uint8_t *target_public_key, Tox_Err_Dht_Send_Nodes_Request *error)
 {
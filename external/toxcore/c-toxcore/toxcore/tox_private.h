@@ -220,6 +220,177 @@ uint16_t tox_dht_get_num_closelist(const Tox *_Nonnull tox);
  */
 uint16_t tox_dht_get_num_closelist_announce_capable(const Tox *_Nonnull tox);
 
+/*******************************************************************************
+ *
+ * :: Bulk file sending
+ *
+ ******************************************************************************/
+
+
+/**
+ * @param friend_number The friend number of the receiving friend.
+ * @param file_number The file transfer identifier returned by tox_file_send.
+ * @param position The file or stream position to read from.
+ * @param data The buffer to fill.
+ * @param length The number of bytes to read.
+ * @param file_user_data The pointer passed to tox_file_send_bulk.
+ *
+ * @return the number of bytes written to data. Less than length ends a
+ *   streaming transfer (file size UINT64_MAX) and kills any other transfer.
+ *   A negative value kills the transfer.
+ */
+typedef int32_t tox_file_bulk_read_cb(
+    Tox *_Nonnull tox, uint32_t friend_number, uint32_t file_number, uint64_t position,
+    uint8_t *_Nonnull data, size_t length, void *_Nullable file_user_data);
+
+/**
+ * Set the callback for bulk file reads. Pass NULL to unset.
+ *
+ * The callback is invoked synchronously from within tox_iterate, once for
+ * every file data packet of a transfer in bulk mode. It must not call back
+ * into this Tox instance.
+ */
+void tox_callback_file_bulk_read(Tox *_Nonnull tox, tox_file_bulk_read_cb *_Nullable callback);
+
+typedef enum Tox_Err_File_Send_Bulk {
+    /**
+     * The function returned successfully.
+     */
+    TOX_ERR_FILE_SEND_BULK_OK,
+
+    /**
+     * The friend_number passed did not designate a valid friend.
+     */
+    TOX_ERR_FILE_SEND_BULK_FRIEND_NOT_FOUND,
+
+    /**
+     * This client is currently not connected to the friend.
+     */
+    TOX_ERR_FILE_SEND_BULK_FRIEND_NOT_CONNECTED,
+
+    /**
+     * No outgoing file transfer with the given file number exists.
+     */
+    TOX_ERR_FILE_SEND_BULK_NOT_FOUND,
+
+    /**
+     * Chunks were requested with the file_chunk_request event that have not
+     * been sent yet.
+     */
+    TOX_ERR_FILE_SEND_BULK_CHUNKS_PENDING,
+} Tox_Err_File_Send_Bulk;
+
+/**
+ * @brief Switch an outgoing file transfer to bulk mode.
+ *
+ * Instead of a file_chunk_request event per chunk, which then has to be
+ * answered with tox_file_send_chunk, the file data is pulled with the
+ * file_bulk_read callback straight into the send queue, as many packets per
+ * iteration as the connection allows. The final file_chunk_request with
+ * length 0 is still emitted once the friend received everything.
+ *
+ * @param file_user_data Passed to every file_bulk_read call for this transfer.
+ *
+ * @return true on success.
+ */
+bool tox_file_send_bulk(Tox *_Nonnull tox, uint32_t friend_number, uint32_t file_number, void *_Nullable file_user_data,
+                        Tox_Err_File_Send_Bulk *_Nullable error);
+
+/*******************************************************************************
+ *
+ * :: Congestion control
+ *
+ ******************************************************************************/
+
+
+typedef enum Tox_Congestion_Control {
+    /**
+     * The loss and send queue based controller toxcore always used.
+     */
+    TOX_CONGESTION_CONTROL_DEFAULT,
+
+    /**
+     * A delay based controller modelled after BBR. It paces at the measured
+     * delivery rate and backs off when the round trip time grows.
+     */
+    TOX_CONGESTION_CONTROL_BBR,
+} Tox_Congestion_Control;
+
+/**
+ * @brief Set the congestion controller for lossless friend connection data.
+ *
+ * Only affects connections established after the call, so this is best
+ * called right after tox_new.
+ */
+void tox_set_congestion_control(Tox *_Nonnull tox, Tox_Congestion_Control congestion_control);
+
+/*******************************************************************************
+ *
+ * :: Savedata journal
+ *
+ ******************************************************************************/
+
+
+/**
+ * @brief The size of the next savedata journal entry.
+ *
+ * A journal entry holds only what changed since the savedata was loaded, the
+ * last tox_get_savedata_journal, or the last tox_savedata_journal_reset: our
+ * own name, status, status message and nospam, friends that were added,
+ * changed or deleted, and group chats and conferences if they changed.
+ * Appending it to the savedata (or the previous entry) gives savedata that
+ * tox_new loads to the same state. The DHT nodes, TCP relays and onion path
+ * nodes in it are only refreshed by a full save, so clients should write the
+ * full savedata every now and then and start a new journal behind it.
+ *
+ * Loaders that don't know about journals stop at the end of the savedata and
+ * ignore the entries behind it.
+ *
+ * @return 0 if nothing changed.
+ */
+size_t tox_get_savedata_journal_size(const Tox *_Nonnull tox);
+
+/**
+ * @brief Write the savedata journal entry and start the next one.
+ *
+ * @param journal A buffer of at least tox_get_savedata_journal_size bytes.
+ * @param length The size of the buffer.
+ *
+ * @return the number of bytes written, 0 if nothing changed or the buffer is
+ *   too small. Nothing is lost in that case, the changes stay in the next entry.
+ */
+size_t tox_get_savedata_journal(Tox *_Nonnull tox, uint8_t *_Nonnull journal, size_t length);
+
+/**
+ * @brief Start a new journal behind the current state.
+ *
+ * Call this after writing the full savedata from tox_get_savedata, so the
+ * next journal entry only holds what changed after it.
+ */
+void tox_savedata_journal_reset(Tox *_Nonnull tox);
+
+/*******************************************************************************
+ *
+ * :: Onion friend search
+ *
+ ******************************************************************************/
+
+
+/**
+ * @brief Number of onion announce requests sent to look for offline friends.
+ *
+ * Friends are searched for less often the longer they have been offline, and
+ * the searches of all friends together are limited to a fixed number of
+ * packets per second.
+ */
+uint64_t tox_onion_search_get_searches_sent(const Tox *_Nonnull tox);
+
+/**
+ * @brief Number of times an offline friend's DHT public key was found via the
+ * onion.
+ */
+uint64_t tox_onion_search_get_friends_found(const Tox *_Nonnull tox);
+
 /*******************************************************************************
  *
  * :: Network profiler
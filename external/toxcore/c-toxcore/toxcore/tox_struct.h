@@ -8,6 +8,7 @@
 
 #include <pthread.h>
 
+#include "crypto_core.h"
 #include "mono_time.h"
 #include "tox.h"
 #include "tox_options.h" // tox_log_cb
@@ -36,6 +37,7 @@ struct Tox {
     tox_friend_message_cb *_Nullable friend_message_callback;
     tox_file_recv_control_cb *_Nullable file_recv_control_callback;
     tox_file_chunk_request_cb *_Nullable file_chunk_request_callback;
+    tox_file_bulk_read_cb *_Nullable file_bulk_read_callback;
     tox_file_recv_cb *_Nullable file_recv_callback;
     tox_file_recv_chunk_cb *_Nullable file_recv_chunk_callback;
     tox_conference_invite_cb *_Nullable conference_invite_callback;
@@ -67,6 +69,9 @@ struct Tox {
     tox_group_moderation_cb *_Nullable group_moderation_callback;
 
     void *_Nullable toxav_object; // workaround to store a ToxAV object (setter and getter functions are available)
+
+    // Hash of the conferences in the last savedata or journal entry.
+    uint8_t journal_conferences_hash[CRYPTO_SHA256_SIZE];
 };
 
 #ifdef __cplusplus
@@ -218,4 +218,95 @@ TEST(Tox, OneTest)
     tox_kill(tox2);
 }
 
+/** Loads `savedata` into a new Tox, nullptr if it fails. */
+static Tox *load_savedata(Tox_Options_Testing *testing_opts, const std::vector<std::uint8_t> &savedata)
+{
+    struct Tox_Options *options = tox_options_new(nullptr);
+    tox_options_set_savedata_type(options, TOX_SAVEDATA_TYPE_TOX_SAVE);
+    tox_options_set_savedata_data(options, savedata.data(), savedata.size());
+    Tox *tox = tox_new_testing(options, nullptr, testing_opts, nullptr);
+    tox_options_free(options);
+    return tox;
+}
+
+static std::vector<std::uint8_t> get_journal(Tox *tox)
+{
+    std::vector<std::uint8_t> journal(tox_get_savedata_journal_size(tox));
+    EXPECT_EQ(tox_get_savedata_journal(tox, journal.data(), journal.size()), journal.size());
+    return journal;
+}
+
+TEST(Tox, SavedataJournalReplaysChanges)
+{
+    SimulatedEnvironment env{12345};
+    struct Tox_Options *options = tox_options_new(nullptr);
+    ASSERT_NE(options, nullptr);
+
+    auto node = env.create_node(33445);
+    Tox_Options_Testing testing_opts = {};
+    testing_opts.operating_system = &node->system;
+
+    Tox *tox = tox_new_testing(options, nullptr, &testing_opts, nullptr);
+    tox_options_free(options);
+    ASSERT_NE(tox, nullptr);
+
+    std::array<std::uint8_t, TOX_PUBLIC_KEY_SIZE> friend1;
+    std::array<std::uint8_t, TOX_PUBLIC_KEY_SIZE> friend2;
+    std::array<std::uint8_t, TOX_SECRET_KEY_SIZE> sk;
+    crypto_new_keypair(&node->c_random, friend1.data(), sk.data());
+    crypto_new_keypair(&node->c_random, friend2.data(), sk.data());
+
+    std::vector<std::uint8_t> savedata(tox_get_savedata_size(tox));
+    tox_get_savedata(tox, savedata.data());
+    tox_savedata_journal_reset(tox);
+    EXPECT_EQ(tox_get_savedata_journal_size(tox), 0);
+
+    const std::uint8_t name[] = "journal";
+    tox_self_set_name(tox, name, sizeof(name), nullptr);
+    const std::uint32_t friend1_number = tox_friend_add_norequest(tox, friend1.data(), nullptr);
+    const std::vector<std::uint8_t> entry1 = get_journal(tox);
+    ASSERT_FALSE(entry1.empty());
+    // Nothing changed since the entry was written.
+    EXPECT_EQ(tox_get_savedata_journal_size(tox), 0);
+    // Only what changed is in it.
+    EXPECT_LT(entry1.size(), savedata.size());
+
+    tox_friend_delete(tox, friend1_number, nullptr);
+    tox_friend_add_norequest(tox, friend2.data(), nullptr);
+    const std::vector<std::uint8_t> entry2 = get_journal(tox);
+    ASSERT_FALSE(entry2.empty());
+
+    const std::uint8_t torn_name[] = "torn";
+    tox_self_set_name(tox, torn_name, sizeof(torn_name), nullptr);
+    const std::vector<std::uint8_t> entry3 = get_journal(tox);
+    ASSERT_FALSE(entry3.empty());
+    tox_kill(tox);
+
+    savedata.insert(savedata.end(), entry1.begin(), entry1.end());
+    savedata.insert(savedata.end(), entry2.begin(), entry2.end());
+    // An interrupted append: the entry is ignored, the rest still loads.
+    savedata.insert(savedata.end(), entry3.begin(), entry3.begin() + entry3.size() / 2);
+
+    auto node2 = env.create_node(33446);
+    Tox_Options_Testing testing_opts2 = {};
+    testing_opts2.operating_system = &node2->system;
+    Tox *loaded = load_savedata(&testing_opts2, savedata);
+    ASSERT_NE(loaded, nullptr);
+
+    std::vector<std::uint8_t> loaded_name(tox_self_get_name_size(loaded));
+    tox_self_get_name(loaded, loaded_name.data());
+    EXPECT_EQ(loaded_name, std::vector<std::uint8_t>(name, name + sizeof(name)));
+
+    ASSERT_EQ(tox_self_get_friend_list_size(loaded), 1);
+    std::uint32_t friend_number;
+    tox_self_get_friend_list(loaded, &friend_number);
+    std::array<std::uint8_t, TOX_PUBLIC_KEY_SIZE> loaded_friend;
+    tox_friend_get_public_key(loaded, friend_number, loaded_friend.data(), nullptr);
+    EXPECT_EQ(loaded_friend, friend2);
+
+    // Loading marks nothing as changed.
+    EXPECT_EQ(tox_get_savedata_journal_size(loaded), 0);
+    tox_kill(loaded);
+}
+
 }  // namespace
@@ -0,0 +1,140 @@
+#include "./animated_image_stream.hpp"
+
+#include "./image_scaler.hpp"
+
+#include <solanaceae/util/time.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+AnimatedImageStream::AnimatedImageStream(std::unique_ptr<ImageLoaderI::FrameDecoderI>&& dec, uint32_t width, uint32_t height, size_t ring_size) :
+	_dec(std::move(dec)), _width(width), _height(height), _ring_size(ring_size)
+{
+}
+
+bool AnimatedImageStream::decodeNext(ImageLoaderI::ImageResult::Frame& frame_out) {
+	if (_dec->next(frame_out)) {
+		return true;
+	}
+
+	// end, loop
+	if (!_dec->rewind()) {
+		return false;
+	}
+
+	return _dec->next(frame_out);
+}
+
+const std::vector<uint8_t>& AnimatedImageStream::scaled(ImageLoaderI::ImageResult::Frame& frame) {
+	if (_width == _dec->width && _height == _dec->height) {
+		return frame.data;
+	}
+
+	_scaled.resize(size_t(_width)*_height*4);
+	image_scale(_scaled.data(), _width, _height, frame.data.data(), _dec->width, _dec->height);
+	return _scaled;
+}
+
+std::optional<TextureEntry> AnimatedImageStream::load(
+	TextureUploaderI& tu,
+	std::unique_ptr<ImageLoaderI::FrameDecoderI>&& dec,
+	uint32_t w, uint32_t h,
+	uint64_t memory_cap
+) {
+	if (!dec || dec->width == 0 || dec->height == 0) {
+		return std::nullopt;
+	}
+
+	const uint32_t src_width = dec->width;
+	const uint32_t src_height = dec->height;
+
+	uint32_t width = src_width;
+	uint32_t height = src_height;
+	if (w != 0 && h != 0 && w < width && h < height) {
+		width = w;
+		height = h;
+	}
+
+	// the ring needs the current and atleast one upcoming frame
+	const size_t ring_size = std::max<uint64_t>(2, std::min<uint64_t>(lookahead_frames, memory_cap / (uint64_t(width)*height*4)));
+
+	auto stream = std::make_shared<AnimatedImageStream>(std::move(dec), width, height, ring_size);
+
+	if (!stream->_dec->next(stream->_frame)) {
+		return std::nullopt;
+	}
+
+	// streaming access, the slot gets the frame ring_size frames later
+	const auto& data = stream->scaled(stream->_frame);
+	const auto n_t = tu.upload(data.data(), width, height, TextureUploaderI::RGBA, TextureUploaderI::LINEAR, TextureUploaderI::STREAMING);
+	if (n_t == 0) {
+		std::cerr << "AIS error: failed to upload frame\n";
+		return std::nullopt;
+	}
+
+	TextureEntry new_entry;
+	new_entry.timestamp_last_rendered = getTimeMS();
+	new_entry.current_texture = 0;
+	new_entry.src_width = src_width;
+	new_entry.src_height = src_height;
+	new_entry.width = width;
+	new_entry.height = height;
+	new_entry.textures.push_back(n_t);
+	new_entry.frame_duration.push_back(stream->_frame.ms);
+	new_entry.stream = stream;
+
+	return new_entry;
+}
+
+void AnimatedImageStream::refill(TextureUploaderI& tu, TextureEntry& te) {
+	const size_t ring_size = te.textures.size();
+	if (ring_size == 0) {
+		return;
+	}
+
+	// every slot from the last refill up to current holds a frame that was shown,
+	// and gets the one ring_size frames later
+	const size_t consumed = (te.current_texture + ring_size - _last_slot) % ring_size;
+	for (size_t i = 0; i < consumed; i++) {
+		const size_t slot = (_last_slot + i) % ring_size;
+
+		if (!decodeNext(_frame)) {
+			std::cerr << "AIS error: failed to decode frame\n";
+			break;
+		}
+
+		const auto& data = scaled(_frame);
+		tu.update(te.textures.at(slot), data.data(), data.size());
+		te.frame_duration.at(slot) = _frame.ms;
+	}
+
+	_last_slot = te.current_texture;
+
+	if (ring_size >= _ring_size) {
+		return;
+	}
+
+	// grow by one frame per refill, so no single refill decodes the whole ring
+	if (ring_size == 1 && !_dec->next(_frame)) {
+		// only one frame, stays a static image
+		_ring_size = 1;
+		return;
+	} else if (ring_size > 1 && !decodeNext(_frame)) {
+		std::cerr << "AIS error: failed to decode frame\n";
+		return;
+	}
+
+	const auto& data = scaled(_frame);
+	const auto n_t = tu.upload(data.data(), _width, _height, TextureUploaderI::RGBA, TextureUploaderI::LINEAR, TextureUploaderI::STREAMING);
+	if (n_t == 0) {
+		std::cerr << "AIS error: failed to upload frame\n";
+		_ring_size = ring_size;
+		return;
+	}
+
+	// the new frame is the furthest ahead, so it goes right before current
+	te.textures.insert(te.textures.begin() + te.current_texture, n_t);
+	te.frame_duration.insert(te.frame_duration.begin() + te.current_texture, _frame.ms);
+	te.current_texture++;
+	_last_slot = te.current_texture;
+}
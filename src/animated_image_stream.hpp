@@ -0,0 +1,56 @@
+#pragma once
+
+#include "./image_loader.hpp"
+#include "./texture_cache.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+// keeps the compressed animation and a decoder cursor,
+// and decodes/uploads frames into a ring of textures just ahead of playback.
+// load() only uploads the first frame, the ring fills up during playback.
+class AnimatedImageStream : public TextureStreamI {
+	std::unique_ptr<ImageLoaderI::FrameDecoderI> _dec;
+
+	// texture size, smaller than the decoder's if scaled down
+	uint32_t _width {0};
+	uint32_t _height {0};
+
+	// frames the ring grows to
+	size_t _ring_size {0};
+
+	// ring slot playback was at during the last refill
+	size_t _last_slot {0};
+
+	// reused buffers
+	ImageLoaderI::ImageResult::Frame _frame;
+	std::vector<uint8_t> _scaled;
+
+	// wraps around at the end, false on error
+	bool decodeNext(ImageLoaderI::ImageResult::Frame& frame_out);
+
+	// returns the frame data in texture size
+	const std::vector<uint8_t>& scaled(ImageLoaderI::ImageResult::Frame& frame);
+
+	public:
+		// frames decoded ahead of playback
+		static constexpr size_t lookahead_frames {3};
+		// upper bound for the rgba bytes of the ring, it holds atleast 2 frames
+		static constexpr uint64_t default_memory_cap {32*1024*1024};
+
+		AnimatedImageStream(std::unique_ptr<ImageLoaderI::FrameDecoderI>&& dec, uint32_t width, uint32_t height, size_t ring_size);
+
+		// decodes and uploads the first frame, refill() adds the rest.
+		// w and h are the requested size, 0 for the source size.
+		static std::optional<TextureEntry> load(
+			TextureUploaderI& tu,
+			std::unique_ptr<ImageLoaderI::FrameDecoderI>&& dec,
+			uint32_t w, uint32_t h,
+			uint64_t memory_cap = default_memory_cap
+		);
+
+		void refill(TextureUploaderI& tu, TextureEntry& te) override;
+};
+
@@ -0,0 +1,198 @@
+#include "./audio_mixer_node.hpp"
+
+#include <solanaceae/object_store/object_store.hpp>
+
+#include <imgui.h>
+
+#include "./trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <cinttypes>
+
+#include <iostream>
+
+static float linearToDB(float v) {
+	return 20.f * std::log10(std::max(v, 0.00001f));
+}
+
+static float dBToLinear(float db) {
+	return std::pow(10.f, db / 20.f);
+}
+
+// peak as the bar, rms as text
+static void levelMeter(float peak, float rms) {
+	// -60dB .. 0dB
+	const float fraction = std::clamp((linearToDB(peak) + 60.f) / 60.f, 0.f, 1.f);
+	const std::string label = rms > 0.f ? std::to_string(int(std::round(linearToDB(rms)))) + " dB" : "-";
+	ImGui::ProgressBar(fraction, {ImGui::GetFontSize() * 8, 0.f}, label.c_str());
+}
+
+AudioMixerNode::AudioMixerNode(ObjectStore2& os, StreamManager& sm) : _os(os), _sm(sm) {
+	_node = {_os.registry(), _os.registry().create()};
+	try {
+		_node.emplace<Components::FrameStream2Sink<AudioFrame2>>(
+			std::make_unique<AudioMixerSink>(_mixer)
+		);
+		_node.emplace<Components::FrameStream2Source<AudioFrame2>>(
+			std::make_unique<AudioMixerSource>(_mixer)
+		);
+
+		_node.emplace<Components::StreamSink>(Components::StreamSink::create<AudioFrame2>("Audio Mixer"));
+		_node.emplace<Components::StreamSource>(Components::StreamSource::create<AudioFrame2>("Audio Mixer"));
+
+		_os.throwEventConstruct(_node);
+	} catch (...) {
+		std::cerr << "AMN error: failed to create mixer node\n";
+		_os.registry().destroy(_node);
+		return;
+	}
+
+	_thread = std::thread([this](void) {
+		Trace::setThreadName("audio mixer");
+
+		const auto block_interval = std::chrono::milliseconds(_mixer.config().block_ms);
+		auto next_block = std::chrono::steady_clock::now() + block_interval;
+		while (!_stop) {
+			if (_mixer.inputs().empty()) {
+				// nothing connected, nothing to keep in time
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				next_block = std::chrono::steady_clock::now() + block_interval;
+				continue;
+			}
+
+			std::this_thread::sleep_until(next_block);
+
+			{
+				TRACE_ZONE("audio mix");
+				_mixer.mixBlock();
+			}
+
+			next_block += block_interval;
+
+			// fell far behind (eg the process was suspended), dont try to catch up
+			const auto now = std::chrono::steady_clock::now();
+			if (now > next_block + block_interval * _mixer.config().latency_blocks) {
+				next_block = now + block_interval;
+			}
+		}
+	});
+}
+
+AudioMixerNode::~AudioMixerNode(void) {
+	_stop = true;
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+
+	if (static_cast<bool>(_node)) {
+		_os.registry().destroy(_node);
+	}
+}
+
+float AudioMixerNode::render(void) {
+	{ // main window menubar injection
+		// assumes the window "tomato" was rendered already by cg
+		if (ImGui::Begin("tomato")) {
+			if (ImGui::BeginMenuBar()) {
+				if (ImGui::BeginMenu("ObjectStore")) {
+					if (ImGui::MenuItem("Audio Mixer", nullptr, _show_window)) {
+						_show_window = !_show_window;
+					}
+					ImGui::EndMenu();
+				}
+				ImGui::EndMenuBar();
+			}
+		}
+		ImGui::End();
+	}
+
+	if (!_show_window || !static_cast<bool>(_node)) {
+		return 1000.f;
+	}
+
+	if (ImGui::Begin("Audio Mixer", &_show_window)) {
+		const auto& config = _mixer.config();
+		ImGui::Text(
+			"%uHz %zuch, %ums blocks, %ums latency",
+			config.sample_rate,
+			config.channels,
+			config.block_ms,
+			config.block_ms * config.latency_blocks
+		);
+
+		{ // master
+			float gain_db = linearToDB(_mixer.gain);
+			ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10);
+			if (ImGui::SliderFloat("master", &gain_db, -40.f, 12.f, "%.1f dB")) {
+				_mixer.gain = dBToLinear(gain_db);
+			}
+			ImGui::SameLine();
+			levelMeter(_mixer.peak, _mixer.peak);
+			ImGui::SameLine();
+			ImGui::Text("clipped: %" PRIu64, _mixer.clipped_samples.load());
+			ImGui::SetItemTooltip("samples that went through the soft clipper");
+		}
+
+		ImGui::SeparatorText("inputs");
+
+		const auto inputs = _mixer.inputs();
+		if (inputs.empty()) {
+			ImGui::TextDisabled("connect audio sources to the 'Audio Mixer' sink in the Stream Manager");
+		}
+
+		if (!inputs.empty() && ImGui::BeginTable("inputs", 5, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_BordersInnerV)) {
+			ImGui::TableSetupColumn("source", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("gain");
+			ImGui::TableSetupColumn("mute");
+			ImGui::TableSetupColumn("level");
+			ImGui::TableSetupColumn("underruns/dropped");
+			ImGui::TableHeadersRow();
+
+			for (const auto& input : inputs) {
+				ImGui::PushID(input.get());
+
+				// find who is writing to us
+				std::string name {"???"};
+				_sm.forEachConnectedExt(_node, [&](ObjectHandle o, const void*, const void* writer) {
+					if (writer == input.get() && o.all_of<Components::StreamSource>()) {
+						name = o.get<Components::StreamSource>().name;
+					}
+				});
+
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(name.c_str());
+
+				ImGui::TableNextColumn();
+				float gain_db = linearToDB(input->gain);
+				ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10);
+				if (ImGui::SliderFloat("##gain", &gain_db, -40.f, 12.f, "%.1f dB")) {
+					input->gain = dBToLinear(gain_db);
+				}
+
+				ImGui::TableNextColumn();
+				bool mute = input->mute;
+				if (ImGui::Checkbox("##mute", &mute)) {
+					input->mute = mute;
+				}
+
+				ImGui::TableNextColumn();
+				levelMeter(input->peak, input->rms);
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%" PRIu64 "/%" PRIu64, input->underruns.load(), input->dropped_samples.load());
+
+				ImGui::PopID();
+			}
+
+			ImGui::EndTable();
+		}
+	}
+	ImGui::End();
+
+	// meters
+	return 1.f/30.f;
+}
+
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <solanaceae/object_store/fwd.hpp>
+#include "./frame_streams/stream_manager.hpp"
+#include "./frame_streams/audio_mixer.hpp"
+
+#include <atomic>
+#include <thread>
+
+// posts a mixer as audio sink and source into the stream graph,
+// runs the block clock and provides a window with gains, mutes and meters
+class AudioMixerNode {
+	ObjectStore2& _os;
+	StreamManager& _sm;
+
+	AudioMixer _mixer;
+
+	ObjectHandle _node;
+
+	std::atomic_bool _stop {false};
+	std::thread _thread;
+
+	bool _show_window {false};
+
+	public:
+		AudioMixerNode(ObjectStore2& os, StreamManager& sm);
+		~AudioMixerNode(void);
+
+		float render(void);
+};
+
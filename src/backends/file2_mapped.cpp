@@ -0,0 +1,113 @@
+#include "./file2_mapped.hpp"
+
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+File2RMapped::File2RMapped(std::string_view file_path) : File2I(false, true, true) {
+#ifdef _WIN32
+	const auto w_path = std::filesystem::u8path(file_path).wstring();
+	HANDLE file = CreateFileW(w_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	_file_handle = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+		return; // empty files can not be mapped
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		return;
+	}
+	_mapping_handle = mapping;
+
+	const void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (ptr == nullptr) {
+		return;
+	}
+
+	_data = static_cast<const uint8_t*>(ptr);
+	_size = size.QuadPart;
+#else
+	const auto path_str = std::filesystem::u8path(file_path).string();
+	const int fd = ::open(path_str.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return; // empty files can not be mapped
+	}
+
+	void* ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps its own reference
+	::close(fd);
+	if (ptr == MAP_FAILED) {
+		return;
+	}
+
+	_data = static_cast<const uint8_t*>(ptr);
+	_size = st.st_size;
+#endif
+
+	file_size = _size;
+}
+
+File2RMapped::~File2RMapped(void) {
+#ifdef _WIN32
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping_handle != nullptr) {
+		CloseHandle(_mapping_handle);
+	}
+	if (_file_handle != nullptr) {
+		CloseHandle(_file_handle);
+	}
+#else
+	if (_data != nullptr) {
+		::munmap(const_cast<uint8_t*>(_data), _size);
+	}
+#endif
+}
+
+bool File2RMapped::isGood(void) {
+	return _data != nullptr;
+}
+
+bool File2RMapped::write(const ByteSpan, int64_t) {
+	return false;
+}
+
+ByteSpanWithOwnership File2RMapped::read(uint64_t size, int64_t pos) {
+	if (pos < 0) {
+		pos = _pos;
+	}
+
+	if (_data == nullptr || uint64_t(pos) >= _size) {
+		return ByteSpan{};
+	}
+
+	const uint64_t ret_size = std::min<uint64_t>(size, _size - pos);
+	_pos = pos + ret_size;
+
+	// non owning, points into the mapping
+	return ByteSpan{_data + pos, ret_size};
+}
+
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <solanaceae/file/file2.hpp>
+
+#include <string_view>
+#include <cstdint>
+
+// read only memory mapped file.
+// reads return non owning spans into the mapping, so no heap copy is made.
+// they are only valid as long as the file object lives.
+// do NOT use on files that might get truncated while mapped.
+struct File2RMapped : public File2I {
+	const uint8_t* _data {nullptr};
+	uint64_t _size {0};
+	uint64_t _pos {0};
+
+#ifdef _WIN32
+	void* _file_handle {nullptr};
+	void* _mapping_handle {nullptr};
+#endif
+
+	File2RMapped(std::string_view file_path);
+	virtual ~File2RMapped(void);
+
+	bool isGood(void) override;
+
+	bool write(const ByteSpan data, int64_t pos = -1) override;
+	ByteSpanWithOwnership read(uint64_t size, int64_t pos = -1) override;
+};
+
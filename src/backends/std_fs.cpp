@@ -4,6 +4,7 @@
 #include <solanaceae/object_store/meta_components_file.hpp>
 
 #include <solanaceae/file/file2_std.hpp>
+#include "./file2_mapped.hpp"
 
 #include <iostream>
 
@@ -86,7 +87,17 @@ std::unique_ptr<File2I> STDFS::file2(Object ov, FILE2_FLAGS flags) {
 	if ((flags & FILE2_WRITE) != 0 && (flags & FILE2_READ) != 0) {
 		res = std::make_unique<File2RWFile>(file_path);
 	} else if (flags & FILE2_READ) {
-		res = std::make_unique<File2RFile>(file_path);
+		// complete files are not written to anymore, so they are safe to map.
+		// reads are zero copy then.
+		if (o.all_of<ObjComp::F::TagLocalHaveAll>()) {
+			auto mapped = std::make_unique<File2RMapped>(file_path);
+			if (mapped->isGood()) {
+				res = std::move(mapped);
+			}
+		}
+		if (!res) {
+			res = std::make_unique<File2RFile>(file_path);
+		}
 	} else if ((flags & FILE2_WRITE) && o.all_of<ObjComp::File::SingleInfo>()) {
 		// HACK: use info and presize the file AND truncate
 		// TODO: actually support streaming :P
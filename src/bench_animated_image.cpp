@@ -0,0 +1,215 @@
+// decodes an animated image the old way (all frames at once) or streamed,
+// and prints the time until the entry can be shown (first frame) and the peak rss.
+// peak rss only grows, so run each mode in its own process.
+// usage:
+//   bench_animated_image gen <out.webp> [frames] [size]
+//   bench_animated_image decode_all|stream <in> [playback_frames]
+
+#include "./image_codec_registry.hpp"
+#include "./image_loader_webp.hpp"
+#include "./animated_image_stream.hpp"
+#include "./texture_uploader.hpp"
+#include "./bench_support.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+	#include <sys/resource.h>
+#endif
+
+// keeps a copy of every texture, standing in for gpu memory
+struct CopyTextureUploader : public TextureUploaderI {
+	uint64_t _next_id {1};
+	std::map<uint64_t, std::vector<uint8_t>> _textures;
+
+	uint64_t uploadRGBA(const uint8_t* data, uint32_t width, uint32_t height, Filter filter, Access access) override {
+		return upload(data, width, height, RGBA, filter, access);
+	}
+	bool updateRGBA(uint64_t tex_id, const uint8_t* data, size_t size) override {
+		return update(tex_id, data, size);
+	}
+
+	uint64_t upload(const uint8_t* data, uint32_t width, uint32_t height, Format, Filter, Access) override {
+		const auto id = _next_id++;
+		_textures[id] = std::vector<uint8_t>(data, data + size_t(width)*height*4);
+		return id;
+	}
+	bool update(uint64_t tex_id, const uint8_t* data, size_t size) override {
+		auto it = _textures.find(tex_id);
+		if (it == _textures.end() || it->second.size() != size) {
+			return false;
+		}
+		std::memcpy(it->second.data(), data, size);
+		return true;
+	}
+	bool updateRect(uint64_t, uint32_t, uint32_t, uint32_t, uint32_t, const uint8_t*) override {
+		return false; // animations are uploaded whole
+	}
+
+	void destroy(uint64_t tex_id) override {
+		_textures.erase(tex_id);
+	}
+};
+
+// in bytes, 0 if unknown
+static uint64_t peakRSS(void) {
+#if defined(__linux__) || defined(__APPLE__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	#if defined(__APPLE__)
+		return usage.ru_maxrss;
+	#else
+		return uint64_t(usage.ru_maxrss) * 1024;
+	#endif
+#else
+	return 0;
+#endif
+}
+
+static int gen(const std::string& path, uint32_t frame_count, uint32_t size) {
+	ImageEncoderWebP::ImageResult img;
+	img.width = size;
+	img.height = size;
+
+	// moving gradient, so frames dont collapse
+	for (uint32_t f = 0; f < frame_count; f++) {
+		auto& frame = img.frames.emplace_back();
+		frame.ms = 40;
+		frame.data.resize(size_t(size)*size*4);
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				uint8_t* px = frame.data.data() + (size_t(y)*size + x)*4;
+				px[0] = uint8_t(x + f*3);
+				px[1] = uint8_t(y + f*5);
+				px[2] = uint8_t((x ^ y) + f);
+				px[3] = 0xff;
+			}
+		}
+	}
+
+	const auto data = ImageEncoderWebP{}.encodeToMemoryRGBA(img, {{"quality", 50.f}});
+	if (data.empty()) {
+		std::cerr << "failed to encode\n";
+		return 1;
+	}
+
+	std::ofstream file(path, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	std::cout << "wrote " << frame_count << " frames of " << size << "x" << size << " (" << data.size() << " bytes)\n";
+
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " gen <out.webp> [frames] [size]\n";
+		std::cerr << "       " << argv[0] << " decode_all|stream <in> [playback_frames]\n";
+		return 1;
+	}
+
+	const std::string mode = argv[1];
+	const std::string path = argv[2];
+
+	if (mode == "gen") {
+		return gen(
+			path,
+			argc > 3 ? std::max(2, std::atoi(argv[3])) : 300,
+			argc > 4 ? std::max(1, std::atoi(argv[4])) : 512
+		);
+	}
+
+	const int playback_frames = argc > 3 ? std::max(0, std::atoi(argv[3])) : 1000;
+
+	std::vector<uint8_t> data;
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			std::cerr << "failed to open " << path << "\n";
+			return 1;
+		}
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	const uint64_t rss_before = peakRSS();
+
+	ImageCodecRegistry icr;
+	CopyTextureUploader tu;
+	ImageCodecRegistry::Format format {ImageCodecRegistry::Format::unknown};
+
+	const auto start = std::chrono::steady_clock::now();
+
+	TextureEntry te;
+	if (mode == "decode_all") {
+		auto res = icr.loadFromMemoryRGBA(data.data(), data.size(), format);
+		if (res.frames.empty()) {
+			std::cerr << "failed to decode\n";
+			return 1;
+		}
+		te.width = te.src_width = res.width;
+		te.height = te.src_height = res.height;
+		for (const auto& frame : res.frames) {
+			te.textures.push_back(tu.upload(frame.data.data(), res.width, res.height, TextureUploaderI::RGBA, TextureUploaderI::LINEAR, TextureUploaderI::STATIC));
+			te.frame_duration.push_back(frame.ms);
+		}
+	} else if (mode == "stream") {
+		auto entry_opt = AnimatedImageStream::load(tu, icr.newFrameDecoder(data.data(), data.size(), format), 0, 0);
+		if (!entry_opt.has_value()) {
+			std::cerr << "failed to decode (or not an animation)\n";
+			return 1;
+		}
+		te = entry_opt.value();
+	} else {
+		std::cerr << "unknown mode " << mode << "\n";
+		return 1;
+	}
+
+	// the entry is returned, so the cache can show it
+	const auto first_frame = std::chrono::steady_clock::now();
+
+	// step through the animation, like TextureCache::update() does
+	std::vector<double> step_times; // ms
+	step_times.reserve(playback_frames);
+	for (int i = 0; i < playback_frames; i++) {
+		const auto step_start = std::chrono::steady_clock::now();
+
+		te.current_texture = (te.current_texture + 1) % te.textures.size();
+		if (te.stream) {
+			te.stream->refill(tu, te);
+		}
+
+		step_times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - step_start).count());
+	}
+
+	std::sort(step_times.begin(), step_times.end());
+
+	std::cout
+		<< "mode: " << mode
+		<< " " << te.src_width << "x" << te.src_height
+		<< " textures: " << te.textures.size()
+		<< " first frame: " << std::chrono::duration<double, std::milli>(first_frame - start).count() << "ms"
+		<< " peak rss: " << (peakRSS() - rss_before) / (1024*1024) << "MiB (over baseline)"
+	;
+	if (!step_times.empty()) {
+		std::cout
+			<< " step p50: " << percentile(step_times, 50) << "ms"
+			<< " p99: " << percentile(step_times, 99) << "ms"
+			<< " max: " << step_times.back() << "ms"
+		;
+	}
+	std::cout << "\n";
+
+	return 0;
+}
+
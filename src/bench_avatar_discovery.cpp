@@ -0,0 +1,121 @@
+// discovers and hashes the avatars of synthetic contacts with ToxAvatarManager
+// and prints how long the main thread was blocked and how long until every contact had its avatar,
+// once with a cold hash cache and once with a warm one.
+// usage: bench_avatar_discovery [contacts] [dir]
+
+#include "./tox_avatar_manager.hpp"
+#include "./bench_support.hpp"
+
+#include <solanaceae/util/simple_config_model.hpp>
+#include <solanaceae/util/utils.hpp>
+#include <solanaceae/object_store/object_store.hpp>
+#include <solanaceae/contact/contact_store_impl.hpp>
+#include <solanaceae/contact/components.hpp>
+#include <solanaceae/toxcore/tox_default_impl.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+// never started, ToxAvatarManager only uses it for toxHash()
+struct HashOnlyTox : public ToxDefaultImpl {
+};
+
+static void benchDiscovery(const char* name, const std::vector<std::vector<uint8_t>>& ids, ConfigModelI& conf, HashOnlyTox& t) {
+	ObjectStore2 os;
+	ContactStore4Impl cs;
+
+	auto& cr = cs.registry();
+	for (const auto& id : ids) {
+		cr.emplace<Contact::Components::ID>(cr.create()).data = id;
+	}
+
+	const auto start = clock_type::now();
+	ToxAvatarManager tam{os, cs, conf, t};
+	const double ctor_ms = msSince(start);
+
+	double iterate_max_ms {0.0};
+	double iterate_total_ms {0.0};
+	size_t found {0};
+	while (found < ids.size() && msSince(start) < 60'000.0) {
+		const auto iterate_start = clock_type::now();
+		tam.iterate();
+		const double iterate_ms = msSince(iterate_start);
+		iterate_max_ms = std::max(iterate_max_ms, iterate_ms);
+		iterate_total_ms += iterate_ms;
+
+		found = cr.storage<Contact::Components::AvatarObj>().size();
+
+		// roughly a frame
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	const double done_ms = msSince(start);
+
+	std::cout
+		<< name
+		<< " contacts: " << ids.size()
+		<< " found: " << found
+		<< " ctor: " << ctor_ms << "ms"
+		<< " done after: " << done_ms << "ms"
+		<< " iterate total: " << iterate_total_ms << "ms"
+		<< " iterate max: " << iterate_max_ms << "ms"
+		<< "\n"
+	;
+}
+
+int main(int argc, char** argv) {
+	size_t contact_count = 1'000;
+	if (argc > 1) {
+		contact_count = std::max<long long>(1, std::atoll(argv[1]));
+	}
+
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "tomato_bench_avatar_discovery";
+	if (argc > 2) {
+		dir = argv[2];
+	}
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+
+	SimpleConfigModel conf;
+	conf.set("ToxAvatarManager", "save_path", std::string_view{dir.generic_u8string()});
+
+	// avatars are capped at 64KiB by the spec
+	std::mt19937 rng{1337};
+	std::uniform_int_distribution<size_t> size_dist{4*1024, 64*1024};
+	std::vector<std::vector<uint8_t>> ids;
+	ids.reserve(contact_count);
+	for (size_t i = 0; i < contact_count; i++) {
+		auto& id = ids.emplace_back(32);
+		for (auto& b : id) {
+			b = uint8_t(rng());
+		}
+
+		std::vector<char> avatar(size_dist(rng));
+		for (auto& b : avatar) {
+			b = char(rng());
+		}
+		std::ofstream{dir / (bin2hex(id) + ".png"), std::ios::binary}.write(avatar.data(), avatar.size());
+	}
+
+	HashOnlyTox t;
+
+	// no hash cache yet, every avatar gets read and hashed
+	benchDiscovery("cold", ids, conf, t);
+
+	// hash cache written by the cold run, only stats
+	benchDiscovery("warm", ids, conf, t);
+
+	std::filesystem::remove_all(dir);
+
+	return 0;
+}
@@ -0,0 +1,240 @@
+// builds a search index over a synthetic message history and prints
+// build throughput, query latencies and snapshot/journal costs.
+// words follow a zipf distribution over a generated vocabulary,
+// history is added newest chunk first, like the message store loads it.
+// usage: bench_search_index [messages] [dir]
+
+#include "./search_index.hpp"
+#include "./bench_support.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+struct Corpus {
+	std::vector<std::string> vocabulary; // most frequent first
+	std::vector<std::string> texts;
+	std::vector<uint64_t> timestamps;
+	size_t text_bytes {0};
+};
+
+static Corpus generateCorpus(size_t message_count) {
+	Corpus corpus;
+
+	std::mt19937 rng{1337};
+
+	const size_t vocabulary_size = 50'000;
+	std::uniform_int_distribution<int> letter_dist{'a', 'z'};
+	std::uniform_int_distribution<size_t> len_dist{2, 10};
+	corpus.vocabulary.reserve(vocabulary_size);
+	for (size_t i = 0; i < vocabulary_size; i++) {
+		std::string word(len_dist(rng), 'a');
+		for (auto& c : word) {
+			c = char(letter_dist(rng));
+		}
+		corpus.vocabulary.push_back(std::move(word));
+	}
+
+	// zipf, s = 1
+	std::vector<double> cdf(vocabulary_size);
+	double sum {0.0};
+	for (size_t i = 0; i < vocabulary_size; i++) {
+		sum += 1.0 / (i + 1);
+		cdf[i] = sum;
+	}
+	std::uniform_real_distribution<double> word_dist{0.0, sum};
+
+	std::uniform_int_distribution<size_t> words_dist{1, 20};
+	std::uniform_int_distribution<uint64_t> gap_dist{500, 120'000};
+	std::bernoulli_distribution capital_dist{0.1};
+
+	corpus.texts.reserve(message_count);
+	corpus.timestamps.reserve(message_count);
+	uint64_t ts {1'600'000'000'000ull};
+	for (size_t i = 0; i < message_count; i++) {
+		std::string text;
+		const size_t words = words_dist(rng);
+		for (size_t w = 0; w < words; w++) {
+			const size_t word_i = std::lower_bound(cdf.cbegin(), cdf.cend(), word_dist(rng)) - cdf.cbegin();
+			if (w > 0) {
+				text += ' ';
+			}
+			text += corpus.vocabulary[std::min(word_i, vocabulary_size - 1)];
+			if (w == 0 && capital_dist(rng)) {
+				text[0] = char(text[0] - 'a' + 'A');
+			}
+		}
+		text += '.';
+
+		corpus.text_bytes += text.size();
+		corpus.texts.push_back(std::move(text));
+
+		ts += gap_dist(rng);
+		corpus.timestamps.push_back(ts);
+	}
+
+	return corpus;
+}
+
+struct QueryCase {
+	std::string name;
+	std::string q;
+};
+
+static void benchQueries(const SearchIndex& index, const std::vector<QueryCase>& cases, int repeats) {
+	for (const auto& qc : cases) {
+		std::vector<double> times; // us
+		times.reserve(repeats);
+		size_t total {0};
+		for (int i = 0; i < repeats; i++) {
+			const auto start = clock_type::now();
+			const auto res = index.query(qc.q, 1000);
+			times.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - start).count());
+			total = res.total;
+		}
+
+		std::sort(times.begin(), times.end());
+		double sum {0.0};
+		for (const double t : times) {
+			sum += t;
+		}
+
+		std::cout
+			<< "  query " << qc.name << " '" << qc.q << "'"
+			<< " hits: " << total
+			<< " mean: " << sum / times.size() << "us"
+			<< " p99: " << percentile(times, 99) << "us"
+			<< "\n"
+		;
+	}
+}
+
+int main(int argc, char** argv) {
+	size_t message_count = 1'000'000;
+	if (argc > 1) {
+		message_count = std::max<long long>(1000, std::atoll(argv[1]));
+	}
+
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "tomato_bench_search_index";
+	if (argc > 2) {
+		dir = argv[2];
+	}
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	const std::string index_path = (dir / "bench").generic_u8string();
+
+	std::cout << "generating " << message_count << " messages\n";
+	const auto corpus = generateCorpus(message_count);
+	std::cout << "  " << corpus.text_bytes / (1024.0*1024.0) << "MiB of text\n";
+
+	SearchIndex index{index_path};
+
+	{ // build, newest chunk first
+		const size_t chunk = 1000;
+		const auto start = clock_type::now();
+		for (size_t chunk_end = message_count; chunk_end > 0;) {
+			const size_t chunk_begin = chunk_end > chunk ? chunk_end - chunk : 0;
+			for (size_t i = chunk_begin; i < chunk_end; i++) {
+				index.add(corpus.timestamps[i], corpus.texts[i]);
+			}
+			chunk_end = chunk_begin;
+		}
+		const double ms = msSince(start);
+		std::cout
+			<< "build: " << ms << "ms"
+			<< " (" << message_count / ms * 1000.0 << " msg/s, "
+			<< corpus.text_bytes / (1024.0*1024.0) / ms * 1000.0 << "MiB/s)"
+			<< " terms: " << index.termCount()
+			<< " postings: " << index.postingsCount()
+			<< "\n"
+		;
+	}
+
+	{ // messages loaded again are skipped
+		const auto start = clock_type::now();
+		size_t added {0};
+		for (size_t i = 0; i < message_count; i++) {
+			added += index.add(corpus.timestamps[i], corpus.texts[i]) ? 1 : 0;
+		}
+		const double ms = msSince(start);
+		std::cout << "re-add known: " << ms << "ms (" << message_count / ms * 1000.0 << " msg/s) added: " << added << "\n";
+	}
+
+	const auto& vocab = corpus.vocabulary;
+	// a trailing space makes the last term exact, like when typing the next word
+	const std::vector<QueryCase> cases {
+		{"common", vocab[0] + " "},
+		{"mid", vocab[100] + " "},
+		{"rare", vocab[20'000] + " "},
+		{"two common", vocab[0] + " " + vocab[1] + " "},
+		{"common+rare", vocab[0] + " " + vocab[20'000] + " "},
+		{"three", vocab[3] + " " + vocab[10] + " " + vocab[50] + " "},
+		{"prefix 2", vocab[7].substr(0, 2)},
+		{"prefix 4", vocab[7].substr(0, 4)},
+		{"word + prefix", vocab[2] + " " + vocab[30].substr(0, 3)},
+		{"miss", "zzzzzzzzzzzz "},
+	};
+	std::cout << "queries (limit 1000):\n";
+	benchQueries(index, cases, 200);
+
+	{ // journal
+		const auto start = clock_type::now();
+		// appends everything to the journal, which is then large enough to get compacted
+		const bool ok = index.flush();
+		const double ms = msSince(start);
+		std::error_code ec;
+		std::cout
+			<< "flush (journal " << (index.journalDocs() == 0 ? "compacted" : "kept") << "): " << ms << "ms ok: " << ok
+			<< " snapshot: " << std::filesystem::file_size(index_path + ".idx", ec) / (1024.0*1024.0) << "MiB"
+			<< "\n"
+		;
+	}
+
+	{ // compact explicitly, for a clean number
+		const auto start = clock_type::now();
+		const bool ok = index.compact();
+		std::cout << "compact: " << msSince(start) << "ms ok: " << ok << "\n";
+	}
+
+	{ // incremental, new messages arriving
+		SearchIndex loaded{index_path};
+		auto start = clock_type::now();
+		loaded.load();
+		std::cout << "load snapshot: " << msSince(start) << "ms docs: " << loaded.docCount() << "\n";
+
+		const size_t new_count = 1000;
+		uint64_t ts = corpus.timestamps.back();
+		start = clock_type::now();
+		for (size_t i = 0; i < new_count; i++) {
+			loaded.add(++ts, corpus.texts[i]);
+		}
+		const double add_ms = msSince(start);
+		start = clock_type::now();
+		loaded.flush();
+		const double flush_ms = msSince(start);
+		std::cout << "add " << new_count << " new: " << add_ms << "ms, append to journal: " << flush_ms << "ms\n";
+
+		SearchIndex reloaded{index_path};
+		start = clock_type::now();
+		reloaded.load();
+		std::cout << "load snapshot + journal: " << msSince(start) << "ms docs: " << reloaded.docCount() << "\n";
+
+		if (reloaded.query(vocab[0], 10).total != loaded.query(vocab[0], 10).total) {
+			std::cerr << "error: reloaded index differs\n";
+			return 1;
+		}
+	}
+
+	std::filesystem::remove_all(dir);
+
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include "./bench_support.hpp"
+
+#include <solanaceae/contact/contact_store_i.hpp>
+#include <solanaceae/contact/components.hpp>
+
+#include <algorithm>
+
+double msSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double percentile(const std::vector<double>& sorted, size_t p) {
+	return sorted.at(std::min(sorted.size() - 1, sorted.size() * p / 100));
+}
+
+Contact4 createBenchContact(ContactRegistry4& cr, const std::string& name, size_t i) {
+	const auto c = cr.create();
+	cr.emplace<Contact::Components::Name>(c).name = name;
+
+	auto& cstate = cr.emplace<Contact::Components::ConnectionState>(c);
+	cstate.state = (i % 3 == 0)
+		? Contact::Components::ConnectionState::direct
+		: (i % 3 == 1)
+		? Contact::Components::ConnectionState::cloud
+		: Contact::Components::ConnectionState::disconnected
+	;
+
+	auto& slt = cr.emplace<Contact::Components::StatusText>(c);
+	slt.text = "status of " + name + "\nsecond line";
+	slt.first_line_length = slt.text.find('\n');
+
+	return c;
+}
+
+void fillBenchContacts(ContactRegistry4& cr, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		const auto c = createBenchContact(cr, "contact " + std::to_string(i), i);
+		cr.emplace<Contact::Components::TagBig>(c);
+
+		// for identicons
+		auto& id = cr.emplace<Contact::Components::ID>(c).data;
+		id.resize(32);
+		for (size_t j = 0; j < id.size(); j++) {
+			id[j] = uint8_t((i >> (j % 4 * 8)) + j * 31);
+		}
+
+		if (i % 10 == 0) {
+			cr.emplace<Contact::Components::TagGroup>(c);
+		} else {
+			cr.emplace<Contact::Components::TagPrivate>(c);
+		}
+
+		cr.emplace<Contact::Components::LastActivity>(c).ts = 1'000'000 + (i * 7919) % count;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "./texture_uploader.hpp"
+
+#include <solanaceae/contact/fwd.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// helpers shared by the bench_* executables
+
+double msSince(std::chrono::steady_clock::time_point start);
+
+// p in percent, of already sorted values
+double percentile(const std::vector<double>& sorted, size_t p);
+
+// hands out ids, but never touches a gpu
+struct NullTextureUploader : public TextureUploaderI {
+	uint64_t _next_id {1};
+
+	uint64_t uploadRGBA(const uint8_t*, uint32_t, uint32_t, Filter, Access) override { return _next_id++; }
+	bool updateRGBA(uint64_t, const uint8_t*, size_t) override { return true; }
+
+	uint64_t upload(const uint8_t*, uint32_t, uint32_t, Format, Filter, Access) override { return _next_id++; }
+	bool update(uint64_t, const uint8_t*, size_t) override { return true; }
+	bool updateRect(uint64_t, uint32_t, uint32_t, uint32_t, uint32_t, const uint8_t*) override { return true; }
+
+	void destroy(uint64_t) override {}
+};
+
+// name, connection state (cycling by i) and a two line status
+Contact4 createBenchContact(ContactRegistry4& cr, const std::string& name, size_t i);
+
+// big contacts with ids (for identicons) and scattered last activity,
+// every 10th is a group
+void fillBenchContacts(ContactRegistry4& cr, size_t count);
@@ -0,0 +1,580 @@
+// renders ChatGui4 headless (no renderer backend) against synthetic contacts,
+// group peers and message histories, and prints frame time and allocation stats.
+// usage: bench_ui [key=value ...] [scenario ...]
+//   keys: frames, contacts, peers, messages, images, idle (seconds)
+//   scenarios: contacts, group, images, idle (default all)
+
+#include "./chat_gui4.hpp"
+#include "./chat_gui/theme.hpp"
+#include "./chat_gui/texture_cache_defs.hpp"
+#include "./backends/std_fs.hpp"
+#include "./image_codec_registry.hpp"
+#include "./image_loader_qoi.hpp"
+#include "./message_image_loader.hpp"
+#include "./tox_avatar_loader.hpp"
+#include "./unread_index.hpp"
+#include "./message_search_index.hpp"
+#include "./render_damage.hpp"
+#include "./bench_support.hpp"
+
+#include <solanaceae/util/simple_config_model.hpp>
+#include <solanaceae/object_store/object_store.hpp>
+#include <solanaceae/object_store/meta_components_file.hpp>
+#include <solanaceae/contact/contact_store_impl.hpp>
+#include <solanaceae/contact/components.hpp>
+#include <solanaceae/message3/registry_message_model_impl.hpp>
+#include <solanaceae/message3/components.hpp>
+
+#include <imgui.h>
+#include <imgui_internal.h> // to find the chat log scroll window
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// counts every allocation, on all threads.
+// imgui does not use new, it gets its own counting allocator below
+static std::atomic_uint64_t g_alloc_count {0};
+static std::atomic_uint64_t g_alloc_bytes {0};
+
+void* operator new(size_t size) {
+	g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+	g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size); ptr != nullptr) {
+		return ptr;
+	}
+	throw std::bad_alloc{};
+}
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+	g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+	return std::malloc(size == 0 ? 1 : size);
+}
+void* operator new[](size_t size, const std::nothrow_t& nt) noexcept {
+	return operator new(size, nt);
+}
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+static void* imguiAlloc(size_t size, void*) {
+	g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+	g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+	return std::malloc(size);
+}
+static void imguiFree(void* ptr, void*) {
+	std::free(ptr);
+}
+
+struct BenchParams {
+	int frames {300};
+	size_t contacts {5'000};
+	size_t peers {200};
+	size_t messages {50'000};
+	size_t images {400};
+	int idle {300}; // simulated seconds
+};
+
+// no files from the bench
+static ConfigModelI& withoutPersistence(ConfigModelI& conf) {
+	conf.set("MessageSearchIndex", "save_path", std::string_view{""});
+	return conf;
+}
+
+// everything MainScreen would own, minus tox
+struct BenchState {
+	SimpleConfigModel conf;
+	ObjectStore2 os;
+	ContactStore4Impl cs;
+	RegistryMessageModelImpl rmm{cs};
+	UnreadIndex unread{rmm};
+	MessageSearchIndex msi{cs, rmm, withoutPersistence(conf)};
+	RenderDamage damage{rmm, cs, os};
+	Backends::STDFS stdfs{os};
+	ImageCodecRegistry icr;
+	NullTextureUploader ntu;
+	TextureAtlas avatar_atlas{ntu}; // like main screen
+	ToxAvatarLoader tal{cs, os, icr, avatar_atlas};
+	ContactTextureCache contact_tc{tal, ntu};
+	MessageImageLoader mil{icr};
+	MessageTextureCache msg_tc{mil, ntu};
+	Theme theme = getDefaultThemeDark();
+
+	ChatGui4 cg{conf, os, rmm, unread, msi, cs, ntu, contact_tc, msg_tc, icr, theme};
+
+	Contact4 self {entt::null};
+};
+
+static void fillContacts(BenchState& s, size_t count) {
+	auto& cr = s.cs.registry();
+
+	fillBenchContacts(cr, count);
+
+	s.self = cr.create();
+	cr.emplace<Contact::Components::TagSelfStrong>(s.self);
+	cr.emplace<Contact::Components::Name>(s.self).name = "self";
+
+	for (const auto c : cr.view<Contact::Components::TagBig>()) {
+		cr.emplace<Contact::Components::Self>(c, s.self);
+	}
+}
+
+static Contact4 createGroup(BenchState& s, size_t peer_count) {
+	auto& cr = s.cs.registry();
+
+	const auto group = createBenchContact(cr, "bench group", 0);
+	cr.emplace<Contact::Components::TagBig>(group);
+	cr.emplace<Contact::Components::TagGroup>(group);
+	cr.emplace<Contact::Components::LastActivity>(group).ts = 2'000'000;
+
+	auto& parent_of = cr.emplace<Contact::Components::ParentOf>(group);
+
+	const auto group_self = createBenchContact(cr, "self", 0);
+	cr.emplace<Contact::Components::TagSelfStrong>(group_self);
+	cr.emplace<Contact::Components::Parent>(group_self, group);
+	cr.emplace<Contact::Components::Self>(group, group_self);
+	parent_of.subs.push_back(group_self);
+
+	for (size_t i = 0; i < peer_count; i++) {
+		const auto peer = createBenchContact(cr, "peer " + std::to_string(i), i);
+		cr.emplace<Contact::Components::TagPrivate>(peer);
+		cr.emplace<Contact::Components::Parent>(peer, group);
+		parent_of.subs.push_back(peer);
+	}
+
+	return group;
+}
+
+// messages in timestamp order, from random peers.
+// every image_every-th message is a file message with one of the image objects
+static void fillMessages(BenchState& s, Contact4 group, size_t count, const std::vector<Object>& image_objects, size_t image_every) {
+	auto* reg = s.rmm.get(group);
+	if (reg == nullptr) {
+		std::cerr << "failed to get message registry\n";
+		return;
+	}
+
+	const auto& subs = s.cs.registry().get<Contact::Components::ParentOf>(group).subs;
+
+	uint64_t ts = 1'700'000'000'000ull;
+	for (size_t i = 0; i < count; i++) {
+		const auto m = reg->create();
+		reg->emplace<Message::Components::ContactFrom>(m, subs.at((i * 7919) % subs.size()));
+		reg->emplace<Message::Components::ContactTo>(m, group);
+		reg->emplace<Message::Components::Timestamp>(m, ts);
+
+		if (!image_objects.empty() && image_every != 0 && i % image_every == 0) {
+			reg->emplace<Message::Components::MessageFileObject>(m, s.os.objectHandle(image_objects.at((i / image_every) % image_objects.size())));
+		} else {
+			std::string text = "message " + std::to_string(i);
+			// some longer ones, that wrap
+			for (size_t j = 0; j < i % 7; j++) {
+				text += " lorem ipsum dolor sit amet";
+			}
+			reg->emplace<Message::Components::MessageText>(m, std::move(text));
+		}
+
+		ts += 1'000 + (i * 104729) % 60'000;
+	}
+}
+
+static std::vector<Object> createImageObjects(BenchState& s, const std::filesystem::path& dir, size_t count) {
+	std::filesystem::create_directories(dir);
+
+	std::vector<Object> objects;
+	for (size_t i = 0; i < count; i++) {
+		ImageEncoderQOI::ImageResult img;
+		img.width = 640;
+		img.height = 480;
+		auto& frame = img.frames.emplace_back();
+		frame.data.resize(size_t(img.width) * img.height * 4);
+		for (uint32_t y = 0; y < img.height; y++) {
+			for (uint32_t x = 0; x < img.width; x++) {
+				uint8_t* px = frame.data.data() + (size_t(y) * img.width + x) * 4;
+				px[0] = uint8_t(x + i * 40);
+				px[1] = uint8_t(y + i * 20);
+				px[2] = uint8_t(x ^ y);
+				px[3] = 0xff;
+			}
+		}
+
+		const auto data = ImageEncoderQOI{}.encodeToMemoryRGBA(img);
+		const auto file_path = dir / ("image_" + std::to_string(i) + ".qoi");
+		{
+			std::ofstream file(file_path, std::ios::binary);
+			file.write(reinterpret_cast<const char*>(data.data()), data.size());
+		}
+
+		const std::vector<uint8_t> id{uint8_t(i), uint8_t(i >> 8), 0xbe, 0x9c};
+		auto o = s.stdfs.newObject(ByteSpan{id}, false);
+		o.emplace<ObjComp::F::SingleInfoLocal>(file_path.generic_string());
+		o.emplace<ObjComp::F::SingleInfo>(file_path.filename().generic_string(), data.size());
+		o.emplace<ObjComp::F::TagLocalHaveAll>();
+		o.emplace<ObjComp::F::FrameDims>(uint16_t(img.width), uint16_t(img.height));
+
+		objects.push_back(o);
+	}
+
+	return objects;
+}
+
+// the chat log is the window with the most to scroll
+static void scrollLargestWindowToMiddle(void) {
+	ImGuiWindow* largest = nullptr;
+	for (ImGuiWindow* window : ImGui::GetCurrentContext()->Windows) {
+		if (largest == nullptr || window->ScrollMax.y > largest->ScrollMax.y) {
+			largest = window;
+		}
+	}
+
+	if (largest != nullptr && largest->ScrollMax.y > 0.f) {
+		ImGui::SetScrollY(largest, largest->ScrollMax.y * 0.5f);
+	}
+}
+
+static void runFrames(const char* name, BenchState& s, int frames, bool scroll_to_middle) {
+	ImGuiIO& io = ImGui::GetIO();
+
+	// first frames open the chat, measure the log and load textures
+	constexpr int warmup_frames {10};
+
+	std::vector<double> frame_times; // ms
+	std::vector<double> frame_allocs;
+	std::vector<double> frame_alloc_bytes;
+	frame_times.reserve(frames);
+	frame_allocs.reserve(frames);
+	frame_alloc_bytes.reserve(frames);
+
+	for (int i = 0; i < warmup_frames + frames; i++) {
+		if (scroll_to_middle && i == warmup_frames/2) {
+			scrollLargestWindowToMiddle();
+		}
+
+		const uint64_t allocs_before = g_alloc_count.load(std::memory_order_relaxed);
+		const uint64_t alloc_bytes_before = g_alloc_bytes.load(std::memory_order_relaxed);
+		const auto start = std::chrono::steady_clock::now();
+
+		// same order as MainScreen::render()
+		io.DeltaTime = 1.f/60.f;
+		s.contact_tc.update();
+		s.msg_tc.update();
+
+		ImGui::NewFrame();
+		s.cg.render(io.DeltaTime, false, true);
+		ImGui::Render();
+
+		s.contact_tc.workLoadQueue();
+		s.msg_tc.workLoadQueue();
+
+		const auto end = std::chrono::steady_clock::now();
+
+		if (i >= warmup_frames) {
+			frame_times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			frame_allocs.push_back(double(g_alloc_count.load(std::memory_order_relaxed) - allocs_before));
+			frame_alloc_bytes.push_back(double(g_alloc_bytes.load(std::memory_order_relaxed) - alloc_bytes_before));
+		}
+	}
+
+	if (frame_times.empty()) {
+		return;
+	}
+
+	std::sort(frame_times.begin(), frame_times.end());
+	std::sort(frame_allocs.begin(), frame_allocs.end());
+	std::sort(frame_alloc_bytes.begin(), frame_alloc_bytes.end());
+
+	double sum {0.0};
+	for (const auto t : frame_times) {
+		sum += t;
+	}
+	double allocs_sum {0.0};
+	for (const auto a : frame_allocs) {
+		allocs_sum += a;
+	}
+
+	std::cout
+		<< name
+		<< " frames: " << frame_times.size()
+		<< " mean: " << sum / frame_times.size() << "ms"
+		<< " p50: " << percentile(frame_times, 50) << "ms"
+		<< " p90: " << percentile(frame_times, 90) << "ms"
+		<< " p99: " << percentile(frame_times, 99) << "ms"
+		<< " max: " << frame_times.back() << "ms"
+		<< " allocs/frame mean: " << allocs_sum / frame_allocs.size()
+		<< " p99: " << percentile(frame_allocs, 99)
+		<< " alloc bytes/frame p50: " << percentile(frame_alloc_bytes, 50)
+		<< "\n"
+	;
+}
+
+struct IdleResult {
+	uint64_t frames {0};
+	double cpu_ms {0.0};
+};
+
+// a client in the background (not focused), with the group chat open and a message arriving now and then.
+// runs the main loop over simulated time, so only the frames cost cpu.
+// frames are paced by scheduleRender() with the normal perf profile, like MainScreen::render().
+// fixed renders every render interval (skip unchanged frames off),
+// on_damage only on damage, timers and the heartbeat, like MainScreen::nextRender().
+static IdleResult runIdle(const char* name, BenchState& s, Contact4 group, int idle_seconds, bool on_damage) {
+	ImGuiIO& io = ImGui::GetIO();
+
+	const auto& profile = RenderPerfProfile::get(0);
+	float render_interval {1.f/60.f};
+	float time_since_event {0.f};
+
+	constexpr int steps_per_second {100}; // main loop wakeups
+	constexpr int message_every {20}; // seconds
+
+	auto* reg = s.rmm.get(group);
+	const auto& subs = s.cs.registry().get<Contact::Components::ParentOf>(group).subs;
+
+	const auto frame = [&](float time_delta) {
+		s.damage.beginFrame(time_delta);
+
+		// same order as MainScreen::render()
+		io.DeltaTime = time_delta;
+		const float ctc_interval = s.contact_tc.update();
+		const float msgtc_interval = s.msg_tc.update();
+
+		ImGui::NewFrame();
+		const float cg_interval = s.cg.render(io.DeltaTime, false, false);
+		ImGui::Render();
+
+		const uint64_t loaded_before = s.contact_tc.loaded_count + s.msg_tc.loaded_count;
+		bool unfinished_work_queue = s.contact_tc.workLoadQueue();
+		unfinished_work_queue = unfinished_work_queue || s.msg_tc.workLoadQueue();
+		if (s.contact_tc.loaded_count + s.msg_tc.loaded_count != loaded_before) {
+			s.damage.add(RenderDamage::TEXTURE);
+		}
+
+		render_interval = scheduleRender(
+			s.damage,
+			profile,
+			std::min(cg_interval, unfinished_work_queue ? 0.1f : 1000.f),
+			std::min(ctc_interval, msgtc_interval),
+			time_since_event,
+			false,
+			io.WantTextInput,
+			io.ConfigInputTextCursorBlink
+		);
+		time_since_event += time_delta;
+	};
+
+	// open the chat, measure the log and load textures
+	for (int i = 0; i < 10; i++) {
+		frame(1.f/60.f);
+	}
+
+	// long after the last input
+	time_since_event = profile.mid_delay_window;
+
+	const uint64_t frames_before = s.damage.frames();
+	uint64_t messages {0};
+	float since_render {0.f};
+	uint64_t ts = 1'800'000'000'000ull;
+
+	const std::clock_t cpu_start = std::clock();
+	for (int step = 1; step <= idle_seconds * steps_per_second; step++) {
+		since_render += 1.f/steps_per_second;
+
+		if (step % (message_every * steps_per_second) == 0) {
+			const auto m = reg->create();
+			reg->emplace<Message::Components::ContactFrom>(m, subs.at(messages % subs.size()));
+			reg->emplace<Message::Components::ContactTo>(m, group);
+			reg->emplace<Message::Components::Timestamp>(m, ts + messages * message_every * 1000);
+			reg->emplace<Message::Components::MessageText>(m, "idle message " + std::to_string(messages));
+			s.rmm.throwEventConstruct(*reg, m);
+			messages++;
+		}
+
+		const float next = on_damage ? s.damage.nextFrame(render_interval, profile.heartbeat) : render_interval;
+		if (since_render < next) {
+			continue;
+		}
+
+		frame(since_render);
+		since_render = 0.f;
+	}
+	const std::clock_t cpu_end = std::clock();
+
+	IdleResult res;
+	res.frames = s.damage.frames() - frames_before;
+	res.cpu_ms = double(cpu_end - cpu_start) * 1000.0 / CLOCKS_PER_SEC;
+
+	const double minutes = idle_seconds / 60.0;
+	std::cout
+		<< name
+		<< " frames: " << res.frames
+		<< " (" << res.frames / double(idle_seconds) << "fps)"
+		<< " messages: " << messages
+		<< " cpu: " << res.cpu_ms << "ms"
+		<< " (" << res.cpu_ms / minutes << "ms per idle minute, "
+		<< res.cpu_ms / (idle_seconds * 1000.0) * 100.0 << "% of a core)"
+		<< "\n"
+	;
+	if (on_damage) {
+		std::cout << "  frames by damage:";
+		for (uint8_t r = 0; r < RenderDamage::MAX; r++) {
+			std::cout << " " << RenderDamage::reasonName(RenderDamage::Reason(r)) << "=" << s.damage.frames(RenderDamage::Reason(r));
+		}
+		std::cout << " (includes warmup)\n";
+	}
+
+	return res;
+}
+
+static void newImGuiContext(void) {
+	ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree);
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = {1280.f, 720.f};
+	io.Fonts->Build(); // no renderer, so no texture updates
+}
+
+static void benchContacts(const BenchParams& p) {
+	newImGuiContext();
+	{
+		BenchState s;
+		fillContacts(s, p.contacts);
+		runFrames(("contacts(" + std::to_string(p.contacts) + ")").c_str(), s, p.frames, false);
+	}
+	ImGui::DestroyContext();
+}
+
+static void benchGroup(const BenchParams& p) {
+	newImGuiContext();
+	{
+		BenchState s;
+		fillContacts(s, 100);
+		const auto group = createGroup(s, p.peers);
+		fillMessages(s, group, p.messages, {}, 0);
+		s.cg.openContact(group);
+		runFrames(("group(" + std::to_string(p.peers) + " peers, " + std::to_string(p.messages) + " messages)").c_str(), s, p.frames, true);
+	}
+	ImGui::DestroyContext();
+}
+
+static void benchImages(const BenchParams& p) {
+	const auto dir = std::filesystem::temp_directory_path() / "tomato_bench_ui";
+
+	newImGuiContext();
+	{
+		BenchState s;
+		fillContacts(s, 100);
+		const auto group = createGroup(s, p.peers);
+		const auto image_objects = createImageObjects(s, dir, 16);
+		// spread the images over 5x as many messages
+		fillMessages(s, group, p.images * 5, image_objects, 5);
+		s.cg.openContact(group);
+		runFrames(("images(" + std::to_string(p.images) + " inline images)").c_str(), s, p.frames, true);
+	}
+	ImGui::DestroyContext();
+
+	std::error_code ec;
+	std::filesystem::remove_all(dir, ec);
+}
+
+static void benchIdle(const BenchParams& p) {
+	const std::string params = std::to_string(p.idle) + "s, " + std::to_string(p.peers) + " peers, " + std::to_string(p.messages) + " messages";
+
+	IdleResult results[2];
+	for (const bool on_damage : {false, true}) {
+		newImGuiContext();
+		{
+			BenchState s;
+			fillContacts(s, 100);
+			const auto group = createGroup(s, p.peers);
+			fillMessages(s, group, p.messages, {}, 0);
+			s.cg.openContact(group);
+			results[on_damage] = runIdle(
+				((on_damage ? "idle on damage(" : "idle fixed(") + params + ")").c_str(),
+				s, group, p.idle, on_damage
+			);
+		}
+		ImGui::DestroyContext();
+	}
+
+	if (results[1].cpu_ms > 0.0) {
+		std::cout << "idle cpu on damage vs fixed: " << results[0].cpu_ms / results[1].cpu_ms << "x less\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	BenchParams p;
+	std::vector<std::string> scenarios;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const auto eq = arg.find('=');
+		if (eq == std::string::npos) {
+			scenarios.push_back(arg);
+			continue;
+		}
+
+		const auto key = arg.substr(0, eq);
+		const auto value = std::strtoull(arg.c_str() + eq + 1, nullptr, 10);
+		if (key == "frames") {
+			p.frames = std::max<int>(1, int(value));
+		} else if (key == "contacts") {
+			p.contacts = value;
+		} else if (key == "peers") {
+			p.peers = std::max<size_t>(1, value);
+		} else if (key == "messages") {
+			p.messages = value;
+		} else if (key == "images") {
+			p.images = value;
+		} else if (key == "idle") {
+			p.idle = std::max<int>(1, int(value));
+		} else {
+			std::cerr << "unknown option " << key << "\n";
+			return 1;
+		}
+	}
+
+	if (scenarios.empty()) {
+		scenarios = {"contacts", "group", "images", "idle"};
+	}
+
+	for (const auto& scenario : scenarios) {
+		if (scenario == "contacts") {
+			benchContacts(p);
+		} else if (scenario == "group") {
+			benchGroup(p);
+		} else if (scenario == "images") {
+			benchImages(p);
+		} else if (scenario == "idle") {
+			benchIdle(p);
+		} else {
+			std::cerr << "unknown scenario " << scenario << "\n";
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
@@ -0,0 +1,154 @@
+// renders the contact list headless (no renderer backend) with synthetic
+// contacts and prints frame time and draw call stats, with and without the avatar atlas.
+// usage: bench_contact_list [frames]
+
+#include "./contact_list.hpp"
+#include "./contact_list_sorter.hpp"
+#include "./contact_info_window.hpp"
+#include "./theme.hpp"
+#include "../unread_index.hpp"
+#include "../image_codec_registry.hpp"
+#include "../tox_avatar_loader.hpp"
+#include "../texture_atlas.hpp"
+#include "../bench_support.hpp"
+
+#include <solanaceae/object_store/object_store.hpp>
+#include <solanaceae/contact/contact_store_impl.hpp>
+#include <solanaceae/contact/components.hpp>
+#include <solanaceae/message3/registry_message_model_impl.hpp>
+
+#include <imgui.h>
+
+#include <entt/entity/runtime_view.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void benchContactList(size_t contact_count, int frames, bool use_atlas) {
+	ObjectStore2 os;
+	ContactStore4Impl cs;
+	RegistryMessageModelImpl rmm{cs};
+	UnreadIndex unread{rmm};
+	ImageCodecRegistry icr;
+	NullTextureUploader ntu;
+	TextureAtlas atlas{ntu};
+	atlas.setEnabled(use_atlas);
+	ToxAvatarLoader tal{cs, os, icr, atlas};
+	ContactTextureCache contact_tc{tal, ntu};
+	ContactInfoWindows ciw{cs};
+	ContactListSorter cls{cs};
+	ContactListCache cache;
+	const Theme theme = getDefaultThemeDark();
+
+	auto& cr = cs.registry();
+	fillBenchContacts(cr, contact_count);
+	cls.sort();
+
+	ImGuiIO& io = ImGui::GetIO();
+
+	std::vector<double> frame_times; // ms
+	frame_times.reserve(frames);
+	uint64_t draw_cmds {0}; // of the measured frames
+
+	ContactHandle4 selected_c{};
+	for (int i = 0; i < frames; i++) {
+		const auto start = std::chrono::steady_clock::now();
+
+		io.DeltaTime = 1.f/60.f;
+		ImGui::NewFrame();
+
+		ImGui::SetNextWindowPos({0.f, 0.f});
+		ImGui::SetNextWindowSize(io.DisplaySize);
+		if (ImGui::Begin("contact list bench")) {
+			if (i == 1) {
+				// middle of the list, from here on
+				ImGui::SetScrollY(ImGui::GetScrollMaxY() * 0.5f);
+			}
+
+			cache.update(
+				contact_const_runtime_view{}.iterate(cr.storage<Contact::Components::ContactSortTag>()),
+				cls.generation()
+			);
+
+			renderContactList(
+				cs,
+				cr,
+				rmm,
+				unread,
+				theme,
+				contact_tc,
+				cache,
+				ciw,
+				selected_c
+			);
+		}
+		ImGui::End();
+
+		ImGui::Render();
+
+		const auto end = std::chrono::steady_clock::now();
+		frame_times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+		if (i >= 2) {
+			for (const ImDrawList* draw_list : ImGui::GetDrawData()->CmdLists) {
+				draw_cmds += draw_list->CmdBuffer.Size;
+			}
+		}
+
+		// avatars of the visible rows, not part of the frame time
+		while (contact_tc.workLoadQueue()) {}
+		contact_tc.update();
+	}
+
+	// first frames measure the list and set the scroll
+	frame_times.erase(frame_times.begin(), frame_times.begin() + std::min<size_t>(2, frame_times.size()));
+	if (frame_times.empty()) {
+		return;
+	}
+
+	std::sort(frame_times.begin(), frame_times.end());
+	double sum {0.0};
+	for (const auto t : frame_times) {
+		sum += t;
+	}
+
+	std::cout
+		<< "contacts: " << contact_count
+		<< " atlas: " << (use_atlas ? "on " : "off")
+		<< " frames: " << frame_times.size()
+		<< " mean: " << sum / frame_times.size() << "ms"
+		<< " p50: " << percentile(frame_times, 50) << "ms"
+		<< " p99: " << percentile(frame_times, 99) << "ms"
+		<< " max: " << frame_times.back() << "ms"
+		<< " draw cmds: " << double(draw_cmds) / frame_times.size()
+		<< " avatar textures: " << contact_tc.rendered_texture_count << "/" << contact_tc.rendered_count
+		<< "\n"
+	;
+}
+
+int main(int argc, char** argv) {
+	int frames = 500;
+	if (argc > 1) {
+		frames = std::max(3, std::atoi(argv[1]));
+	}
+
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = {1280.f, 720.f};
+	io.Fonts->Build(); // no renderer, so no texture updates
+
+	for (const size_t count : {100, 1'000, 10'000}) {
+		benchContactList(count, frames, false);
+		benchContactList(count, frames, true);
+	}
+
+	ImGui::DestroyContext();
+
+	return 0;
+}
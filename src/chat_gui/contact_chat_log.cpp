@@ -19,6 +19,7 @@
 
 #include "../string_formatter_utils.hpp"
 #include "../sdl_clipboard_utils.hpp"
+#include "../search_index.hpp"
 
 #include <imgui.h>
 #include <imgui_internal.h> // TODO: remove, renderframe
@@ -94,6 +95,15 @@ float ContactChatLog::render(bool window_focused, float time_delta, const std::v
 
 	fadeSystem(window_focused, time_delta);
 
+	if (_jump.has_value()) {
+		_jump->time_left -= time_delta;
+		if (_jump->time_left <= 0.f) {
+			std::cerr << "CG warning: message to jump to did not show up\n";
+			_jump.reset();
+		}
+	}
+	_jump_highlight_fade = std::max(0.f, _jump_highlight_fade - time_delta/3.f);
+
 	// TODO: optimize
 	TEXT_BASE_WIDTH = ImGui::CalcTextSize("A").x;
 	TEXT_BASE_HEIGHT = ImGui::GetTextLineHeightWithSpacing();
@@ -162,6 +172,7 @@ float ContactChatLog::render(bool window_focused, float time_delta, const std::v
 		//) {
 		//uint64_t prev_ts {0};
 		Components::ConvertedTimeCache prev_time {};
+		bool jump_ts_seen {false};
 		auto tmp_view = msg_reg->view<Message::Components::Timestamp>();
 		for (auto view_it = tmp_view.rbegin(), view_last = tmp_view.rend(); view_it != view_last; view_it++) {
 			const Message3 e = *view_it;
@@ -204,6 +215,18 @@ float ContactChatLog::render(bool window_focused, float time_delta, const std::v
 
 			ImGui::PushID(entt::to_integral(e));
 
+			if (_jump.has_value() && ts.ts == _jump->ts) {
+				jump_ts_seen = true;
+				const auto* txt_comp_ptr = msg_reg->try_get<Message::Components::MessageText>(e);
+				if (txt_comp_ptr != nullptr && SearchIndex::hashText(txt_comp_ptr->text) == _jump->text_hash) {
+					ImGui::SetScrollHereY(0.5f);
+					manually_scrolled = true;
+					_jump_highlight = e;
+					_jump_highlight_fade = 1.f;
+					_jump.reset();
+				}
+			}
+
 			// name
 			if (ImGui::TableNextColumn()) {
 				const float img_y {TEXT_BASE_HEIGHT - ImGui::GetStyle().FramePadding.y*2};
@@ -284,6 +307,13 @@ float ContactChatLog::render(bool window_focused, float time_delta, const std::v
 
 					ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, ImGui::GetColorU32(res_color));
 				}
+
+				// jumped to
+				if (e == _jump_highlight && _jump_highlight_fade > 0.f) {
+					ImVec4 hi_color = ImGui::GetStyleColorVec4(ImGuiCol_TextSelectedBg);
+					hi_color.w *= _jump_highlight_fade;
+					ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, ImGui::GetColorU32(hi_color));
+				}
 			}
 
 			// content (msgtext/file)
@@ -440,8 +470,17 @@ float ContactChatLog::render(bool window_focused, float time_delta, const std::v
 
 			auto& cg_view = msg_reg->ctx().get<Context::CGView>();
 
-			// any message in view
-			if (!static_cast<bool>(message_view_oldest)) {
+			if (_jump.has_value() && static_cast<bool>(cg_view.begin) && static_cast<bool>(cg_view.end)) {
+				// not loaded, point the view at it so the message store loads it
+				auto& begin_ts = cg_view.begin.get_or_emplace<Message::Components::Timestamp>().ts;
+				auto& end_ts = cg_view.end.get_or_emplace<Message::Components::Timestamp>().ts;
+				if (begin_ts != _jump->ts || end_ts != _jump->ts) {
+					begin_ts = _jump->ts;
+					end_ts = _jump->ts;
+					_rmm.throwEventUpdate(cg_view.begin);
+					_rmm.throwEventUpdate(cg_view.end);
+				}
+			} else if (!static_cast<bool>(message_view_oldest)) {
 				// no message in view, we setup a view at current time, so the next frags are loaded
 				if (!static_cast<bool>(cg_view.begin) || !static_cast<bool>(cg_view.end)) {
 					// fix invalid state
@@ -514,6 +553,12 @@ float ContactChatLog::render(bool window_focused, float time_delta, const std::v
 		}
 
 		ImGui::EndTable();
+
+		if (_jump.has_value() && jump_ts_seen) {
+			// the message is here, but its text changed since it got indexed (edit)
+			std::cerr << "CG warning: message to jump to was edited\n";
+			_jump.reset();
+		}
 	}
 
 	if (ImGui::Shortcut(ImGuiKey_G | ImGuiMod_Shift, ImGuiInputFlags_RouteGlobal) || ImGui::Shortcut(ImGuiKey_End, ImGuiInputFlags_RouteGlobal)) {
@@ -526,9 +571,22 @@ float ContactChatLog::render(bool window_focused, float time_delta, const std::v
 		ImGui::SetScrollHereY(1.f);
 	}
 
+	// fades and jumps only progress while rendering
+	if (
+		(window_focused && !msg_reg->storage<Components::UnreadFade>().empty()) ||
+		_jump.has_value() ||
+		_jump_highlight_fade > 0.f
+	) {
+		return 1.f/10.f;
+	}
+
 	return 2000.f;
 }
 
+void ContactChatLog::jumpTo(uint64_t ts, uint32_t text_hash) {
+	_jump = JumpTarget{ts, text_hash};
+}
+
 void ContactChatLog::fadeSystem(bool window_focused, float time_delta) {
 	assert(msg_reg != nullptr);
 
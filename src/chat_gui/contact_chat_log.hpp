@@ -4,6 +4,8 @@
 
 #include "./texture_cache_defs.hpp"
 
+#include <optional>
+
 // fwd
 struct Theme;
 struct FileSelector;
@@ -38,6 +40,16 @@ struct ContactChatLog {
 	float TEXT_BASE_WIDTH {1};
 	float TEXT_BASE_HEIGHT {1};
 
+	// message to scroll to, identified like in the search index
+	struct JumpTarget {
+		uint64_t ts {0};
+		uint32_t text_hash {0};
+		float time_left {10.f}; // gives up if it does not show up
+	};
+	std::optional<JumpTarget> _jump;
+	Message3 _jump_highlight {entt::null};
+	float _jump_highlight_fade {0.f};
+
 	ContactChatLog(
 		ContactStore4I& cs,
 		RegistryMessageModelI& rmm,
@@ -55,6 +67,9 @@ struct ContactChatLog {
 
 	float render(bool window_focused, float time_delta, const std::vector<Contact4>* sub_contacts);
 
+	// scrolls to the message with the timestamp and text (hash), once it is loaded
+	void jumpTo(uint64_t ts, uint32_t text_hash);
+
 	private:
 		void fadeSystem(bool window_focused, float time_delta);
 
@@ -14,6 +14,8 @@
 
 #include <entt/entity/runtime_view.hpp>
 
+#include "../unread_index.hpp"
+
 #include "./icons/direct.hpp"
 #include "./icons/cloud.hpp"
 #include "./icons/mail.hpp"
@@ -49,12 +51,13 @@ void renderAvatar(
 		const auto [g_scale_x, g_scyle_y] = ImGui::GetIO().DisplayFramebufferScale;
 
 		// avatar
-		const auto [id, width, height] = contact_tc.get(c, box.x*g_scale_x, box.y*g_scyle_y);
+		// small avatars share atlas pages
+		const auto region = contact_tc.getRegion(c, box.x*g_scale_x, box.y*g_scyle_y);
 		ImGui::Image(
-			id,
+			region.id,
 			box,
-			{0, 0},
-			{1, 1},
+			{region.u0, region.v0},
+			{region.u1, region.v1},
 			{1, 1, 1, 1},
 			color_current
 		);
@@ -319,133 +322,165 @@ bool renderContactBig(
 	return got_selected;
 }
 
+void ContactListCache::update(const contact_const_runtime_view& view, uint64_t new_generation) {
+	if (valid && generation == new_generation && rows.size() == view.size_hint()) {
+		return;
+	}
+
+	rows.clear();
+	rows.reserve(view.size_hint());
+	for (const auto c : view) {
+		rows.push_back(c);
+	}
+
+	generation = new_generation;
+	valid = true;
+	selected_row = -1;
+}
+
+int64_t ContactListCache::findSelected(Contact4 c) {
+	if (selected_row >= 0 && size_t(selected_row) < rows.size() && rows[selected_row] == c) {
+		return selected_row;
+	}
+
+	// only happens when the selection or the order changed
+	selected_row = -1;
+	for (size_t i = 0; i < rows.size(); i++) {
+		if (rows[i] == c) {
+			selected_row = i;
+			break;
+		}
+	}
+
+	return selected_row;
+}
+
 bool renderContactList(
 	ContactStore4Impl& cs,
 	ContactRegistry4& cr,
 	RegistryMessageModelI& rmm,
+	UnreadIndex& unread,
 	const Theme& th,
 	ContactTextureCache& contact_tc,
-	const contact_const_runtime_view& view,
+	ContactListCache& cache,
 	ContactInfoWindows& ciw,
 
 	// in/out
 	ContactHandle4& selected_c
 ) {
+	const auto& rows = cache.rows;
+
 	// keep track for navigation
-	ContactHandle4 pre_sel;
-	float pre_pos{};
-	ContactHandle4 post_sel;
-	float post_pos{};
+	const int64_t selected_row = selected_c ? cache.findSelected(selected_c) : -1;
+	const float list_start_pos = ImGui::GetCursorPosY();
 
 	bool selection_changed {false};
-	for (auto c_it = view.begin(); c_it != view.end(); c_it++) {
-		ImGui::PushID(entt::to_integral(*c_it));
-		ContactHandle4 c{cr, *c_it};
-		const bool selected = selected_c == c;
-
-		// TODO: is there a better way?
-		// maybe cache mm?
-		bool has_unread = false;
-		auto* mm = rmm.get(c);
-		if (mm != nullptr) {
-			const auto* unread_storage = static_cast<const Message3Registry*>(mm)->storage<Message::Components::TagUnread>();
-			if (unread_storage != nullptr) {
-				has_unread = !unread_storage->empty();
-			}
-		}
 
-		if (selected_c) {
-			if (!pre_sel) {
-				auto it_copy = c_it;
-				++it_copy;
-				if (it_copy != view.end() && *it_copy == selected_c) {
-					// next is selected
-					pre_sel = c;
-					pre_pos = ImGui::GetCursorPosY() - ImGui::GetScrollY();
-				}
+	ImGuiListClipper clipper;
+	clipper.Begin(rows.size());
+	while (clipper.Step()) {
+		for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+			if (!cr.valid(rows[row])) {
+				// destroyed this frame, rows get rebuilt next frame
+				continue;
 			}
 
-			if (!post_sel && c_it != view.begin()) {
-				auto it_copy = c_it;
-				--it_copy;
-				if (*it_copy == selected_c) {
-					// prev is selected
-					post_sel = c;
-					post_pos = ImGui::GetCursorPosY() - ImGui::GetScrollY();
-				}
-			}
-		}
+			ImGui::PushID(entt::to_integral(rows[row]));
+			ContactHandle4 c{cr, rows[row]};
+			const bool selected = selected_c == c;
 
-		// TODO: expose line_height
-		if (renderContactBig(th, contact_tc, c, 2, has_unread, true, selected)) {
-			selected_c = c;
-			selection_changed = true;
-		}
+			const bool has_unread = unread.hasUnread(c);
 
-		// TODO: move to own function
-		if (ImGui::BeginPopupContextItem("contact_context")) {
-			if (mm != nullptr) {
-				if (ImGui::MenuItem("mark all read", nullptr, false, has_unread)) {
-					mm->clear<Message::Components::TagUnread>();
-				}
+			// TODO: expose line_height
+			if (renderContactBig(th, contact_tc, c, 2, has_unread, true, selected)) {
+				selected_c = c;
+				selection_changed = true;
 			}
 
-			if (c.all_of<Contact::Components::ContactModel>()) {
-				const auto& cm = c.get<Contact::Components::ContactModel>();
-				// TODO: make hookable
-				if (ImGui::BeginMenu("invite to")) {
-					// big?
-					//for (const auto& c : cr.view<Contact::Components::TagBig>()) {
-					//    // filter
-					//    if (cr.any_of<Contact::Components::RequestIncoming, Contact::Components::TagRequestOutgoing>(c)) {
-					//        continue;
-					//    }
-					for (auto [tov] : cr.storage<Contact4>().each()) {
-						if (cm->canInvite(c, tov)) {
-							ContactHandle4 to{cr, tov};
-
-							if (renderContactBig(th, contact_tc, to, 1, false, true, false)) {
-								// TODO: error check
-								cm->invite(c, tov);
+			// TODO: move to own function
+			if (ImGui::BeginPopupContextItem("contact_context")) {
+				if (auto* mm = rmm.get(c); mm != nullptr) {
+					if (ImGui::MenuItem("mark all read", nullptr, false, has_unread)) {
+						mm->clear<Message::Components::TagUnread>();
+					}
+				}
+
+				if (c.all_of<Contact::Components::ContactModel>()) {
+					const auto& cm = c.get<Contact::Components::ContactModel>();
+					// TODO: make hookable
+					if (ImGui::BeginMenu("invite to")) {
+						// big?
+						//for (const auto& c : cr.view<Contact::Components::TagBig>()) {
+						//    // filter
+						//    if (cr.any_of<Contact::Components::RequestIncoming, Contact::Components::TagRequestOutgoing>(c)) {
+						//        continue;
+						//    }
+						if (ImGui::IsWindowAppearing() || cache.invite_for != c) {
+							cache.invite_for = c;
+							cache.invite_targets.clear();
+							for (auto [tov] : cr.storage<Contact4>().each()) {
+								if (cm->canInvite(c, tov)) {
+									cache.invite_targets.push_back(tov);
+								}
 							}
 						}
+
+						ImGuiListClipper invite_clipper;
+						invite_clipper.Begin(cache.invite_targets.size());
+						while (invite_clipper.Step()) {
+							for (int i = invite_clipper.DisplayStart; i < invite_clipper.DisplayEnd; i++) {
+								const auto tov = cache.invite_targets.at(i);
+								if (!cr.valid(tov)) {
+									continue;
+								}
+
+								ContactHandle4 to{cr, tov};
+
+								if (renderContactBig(th, contact_tc, to, 1, false, true, false)) {
+									// TODO: error check
+									cm->invite(c, tov);
+								}
+							}
+						}
+						ImGui::EndMenu();
 					}
-					ImGui::EndMenu();
 				}
-			}
 
-			if (ImGui::MenuItem("open contact info")) {
-				ciw.open(c);
-			}
+				if (ImGui::MenuItem("open contact info")) {
+					ciw.open(c);
+				}
 
-			const auto ctx_list = cs.getImGuiContext(c);
+				const auto ctx_list = cs.getImGuiContext(c);
 
-			if (!ctx_list.empty()) {
-				ImGui::Separator();
+				if (!ctx_list.empty()) {
+					ImGui::Separator();
 
-				for (const auto it : ctx_list) {
-					it.fn(c);
+					for (const auto it : ctx_list) {
+						it.fn(c);
+					}
 				}
-			}
 
-			ImGui::EndPopup();
+				ImGui::EndPopup();
+			}
+			ImGui::PopID();
 		}
-		ImGui::PopID();
 	}
+	// all rows have the same height
+	const float row_height = clipper.ItemsHeight;
 
 	if (!selection_changed) {
 		if (
 			ImGui::Shortcut(ImGuiKey_J | ImGuiMod_Shift, ImGuiInputFlags_Repeat | ImGuiInputFlags_RouteGlobal) ||
 			ImGui::Shortcut(ImGuiKey_PageDown | ImGuiMod_Shift, ImGuiInputFlags_Repeat | ImGuiInputFlags_RouteGlobal)
 		) {
-			if (selected_c && post_sel) {
+			if (selected_row >= 0 && size_t(selected_row + 1) < rows.size()) {
 				// down
-				selected_c = post_sel;
+				selected_c = {cr, rows[selected_row + 1]};
 				selection_changed = true;
-				ImGui::SetScrollFromPosY(post_pos);
-			} else if (view.begin() != view.end()) {
+				ImGui::SetScrollFromPosY(list_start_pos + (selected_row + 1) * row_height - ImGui::GetScrollY());
+			} else if (!rows.empty()) {
 				// from top
-				selected_c = {cr, *view.begin()};
+				selected_c = {cr, rows.front()};
 				selection_changed = true;
 				ImGui::SetScrollY(0.f);
 			}
@@ -453,14 +488,14 @@ bool renderContactList(
 			ImGui::Shortcut(ImGuiKey_K | ImGuiMod_Shift, ImGuiInputFlags_Repeat | ImGuiInputFlags_RouteGlobal) ||
 			ImGui::Shortcut(ImGuiKey_PageUp | ImGuiMod_Shift, ImGuiInputFlags_Repeat | ImGuiInputFlags_RouteGlobal)
 		) {
-			if (selected_c && pre_sel) {
+			if (selected_row > 0) {
 				// up
-				selected_c = pre_sel;
+				selected_c = {cr, rows[selected_row - 1]};
 				selection_changed = true;
-				ImGui::SetScrollFromPosY(pre_pos);
-			} else if (view.begin() != view.end()) {
+				ImGui::SetScrollFromPosY(list_start_pos + (selected_row - 1) * row_height - ImGui::GetScrollY());
+			} else if (!rows.empty()) {
 				// from bottom
-				selected_c = {cr, *(--view.end())};
+				selected_c = {cr, rows.back()};
 				selection_changed = true;
 				ImGui::SetScrollHereY(1.f);
 			}
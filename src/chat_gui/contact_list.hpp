@@ -7,6 +7,12 @@
 
 #include <solanaceae/contact/fwd.hpp>
 
+#include <vector>
+#include <cstdint>
+
+// fwd
+class UnreadIndex;
+
 void renderAvatar(
 	const Theme& th,
 	ContactTextureCache& contact_tc,
@@ -35,14 +41,38 @@ using contact_sparse_set = entt::basic_sparse_set<Contact4>;
 using contact_runtime_view = entt::basic_runtime_view<contact_sparse_set>;
 using contact_const_runtime_view = entt::basic_runtime_view<const contact_sparse_set>;
 
+// the rows of a contact list in display order, kept across frames,
+// so a frame only touches the rows that are actually visible.
+struct ContactListCache {
+	std::vector<Contact4> rows;
+
+	// generation of the order the rows got copied from
+	uint64_t generation {0};
+	bool valid {false};
+
+	// index into rows, -1 if not in the list
+	int64_t selected_row {-1};
+
+	// "invite to" targets, filled when the menu opens
+	Contact4 invite_for {entt::null};
+	std::vector<Contact4> invite_targets;
+
+	// copies the view, if the generation (sort or any contact event) or the number of contacts changed
+	void update(const contact_const_runtime_view& view, uint64_t new_generation);
+
+	// returns the row of c or -1, remembers the result in selected_row
+	int64_t findSelected(Contact4 c);
+};
+
 // returns true if contact was selected
 bool renderContactList(
 	ContactStore4Impl& cs,
 	ContactRegistry4& cr,
 	RegistryMessageModelI& rmm,
+	UnreadIndex& unread,
 	const Theme& th,
 	ContactTextureCache& contact_tc,
-	const contact_const_runtime_view& view,
+	ContactListCache& cache,
 	ContactInfoWindows& ciw,
 
 	// in/out
@@ -123,19 +123,23 @@ void ContactListSorter::sort(void) {
 
 	_last_sort = now;
 	_dirty = false;
+	_generation++;
 }
 
 bool ContactListSorter::onEvent(const ContactStore::Events::Contact4Construct&) {
 	_dirty = true;
+	_generation++;
 	return false;
 }
 
 bool ContactListSorter::onEvent(const ContactStore::Events::Contact4Update&) {
 	_dirty = true;
+	_generation++;
 	return false;
 }
 
 bool ContactListSorter::onEvent(const ContactStore::Events::Contact4Destory&) {
 	_dirty = true;
+	_generation++;
 	return false;
 }
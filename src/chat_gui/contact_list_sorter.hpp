@@ -32,6 +32,7 @@ class ContactListSorter : public ContactStore4EventI {
 
 		uint64_t _last_sort {0};
 		bool _dirty {true};
+		uint64_t _generation {0}; // bumped on every sort and contact event, cached rows might be stale
 		// TODO: timer, to guarantie a sort ever X seconds?
 		// (turns out we dont throw on new messages <.<)
 
@@ -46,6 +47,9 @@ class ContactListSorter : public ContactStore4EventI {
 		// optionally perform the sort
 		void sort(void);
 
+		// changes whenever the sorted set might have changed
+		uint64_t generation(void) const { return _generation; }
+
 	protected:
 		bool onEvent(const ContactStore::Events::Contact4Construct&) override;
 		bool onEvent(const ContactStore::Events::Contact4Update&) override;
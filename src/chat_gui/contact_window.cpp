@@ -13,6 +13,7 @@
 #include "./file_selector.hpp"
 
 #include "../sdl_clipboard_utils.hpp"
+#include "../message_search_index.hpp"
 
 #include <imgui.h>
 #include <misc/cpp/imgui_stdlib.h>
@@ -20,6 +21,9 @@
 
 #include <SDL3/SDL.h>
 
+#include <algorithm>
+#include <chrono>
+#include <ctime>
 #include <deque>
 #include <filesystem>
 #include <sstream>
@@ -36,6 +40,7 @@ ContactWindow::ContactWindow(
 	BitsetTextureCache& b_tc,
 	ContactInfoWindows& ciw,
 	FileSelector& fss,
+	MessageSearchIndex& msi,
 	ImageViewerPopup& ivp,
 	Clipboard& cb,
 	TextureUploaderI& tu,
@@ -45,6 +50,7 @@ ContactWindow::ContactWindow(
 	_theme(theme), _contact_tc(contact_tc),
 	_ciw(ciw),
 	_fss(fss),
+	_msi(msi),
 	_open_chat(std::move(open_chat)),
 	_text_input_buffer(),
 	c(c_),
@@ -65,6 +71,7 @@ float ContactWindow::render(
 	_sip.render(time_delta);
 
 	const std::string chat_label = "chat " + std::to_string(entt::to_integral(c.entity()));
+	float ccl_interval {2000.f};
 
 	if (
 		(child && ImGui::BeginChild(chat_label.c_str(), {0, 0}, child_flags, ImGuiWindowFlags_MenuBar)) ||
@@ -85,6 +92,10 @@ float ContactWindow::render(
 
 				ImGui::EndMenu();
 			}
+			if (ImGui::MenuItem("search", "Ctrl+F", _search_open)) {
+				_search_open = !_search_open;
+				_search_focus = _search_open;
+			}
 			if (ImGui::BeginMenu("debug")) {
 				ImGui::Checkbox("show extra info", &_ccl._show_chat_extra_info);
 				ImGui::Checkbox("show avatar transfers", &_ccl._show_chat_avatar_tf);
@@ -120,6 +131,17 @@ float ContactWindow::render(
 
 		renderRequest();
 
+		if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_F, ImGuiInputFlags_RouteGlobal)) {
+			_search_open = true;
+			_search_focus = true;
+		}
+
+		// stacks the search above the chat, both next to the sub contact list
+		ImGui::BeginGroup();
+		if (_search_open) {
+			renderSearch();
+		}
+
 		if (ImGui::BeginChild("chat_main", {0, -TEXT_BASE_HEIGHT*4.5f}, ImGuiChildFlags_None)) {
 			const auto tab_cb_list = _cs.getImGuiChatTab(c);
 			const bool show_sub_contacts =
@@ -144,7 +166,7 @@ float ContactWindow::render(
 
 					if (ImGui::BeginTabItem("MessageLog", nullptr, (has_unread ? ImGuiTabItemFlags_UnsavedDocument : ImGuiTabItemFlags_None))) {
 						if (ImGui::BeginChild("tab_content")) {
-							_ccl.render(window_focused, time_delta, sub_contacts);
+							ccl_interval = _ccl.render(window_focused, time_delta, sub_contacts);
 						}
 						ImGui::EndChild();
 						ImGui::EndTabItem();
@@ -206,10 +228,11 @@ float ContactWindow::render(
 					ImGui::EndTabBar();
 				}
 			} else {
-				_ccl.render(window_focused, time_delta, sub_contacts);
+				ccl_interval = _ccl.render(window_focused, time_delta, sub_contacts);
 			}
 		}
 		ImGui::EndChild();
+		ImGui::EndGroup();
 
 		if (ImGui::BeginChild("text_input", {-150, 0})) {
 			ImGui::SetNextItemShortcut(ImGuiKey_I, ImGuiInputFlags_RouteGlobal);
@@ -346,7 +369,12 @@ float ContactWindow::render(
 
 	ImGui::PopID();
 
-	return 2000.f;
+	if (_search_open && _search_pending) {
+		// poll the index
+		ccl_interval = std::min(ccl_interval, 1.f/10.f);
+	}
+
+	return std::min(2000.f, ccl_interval);
 }
 
 struct ContactWRole {
@@ -472,6 +500,99 @@ void ContactWindow::renderSubContactContext(ContactHandle4 sub_c, const Contact4
 	}
 }
 
+void ContactWindow::renderSearch(void) {
+	if (_search_focus) {
+		ImGui::SetKeyboardFocusHere();
+		_search_focus = false;
+	}
+
+	ImGui::SetNextItemWidth(-TEXT_BASE_WIDTH * 42.f);
+	const bool enter = ImGui::InputTextWithHint("##search", "search messages (enter: older, shift+enter: newer)", &_search_text, ImGuiInputTextFlags_EnterReturnsTrue);
+	const bool search_focused = ImGui::IsItemFocused();
+	if (ImGui::IsItemEdited()) {
+		_search_pending = true;
+	}
+	if (_search_pending) {
+		// retried every frame until the index is loaded
+		if (auto res = _msi.query(c, _search_text); res.has_value()) {
+			_search_pending = false;
+			_search_result = std::move(*res);
+			_search_current = 0;
+			if (!_search_result.hits.empty()) {
+				jumpToSearchHit(0);
+			}
+		}
+	}
+	if (enter) {
+		if (!_search_result.hits.empty()) {
+			if (ImGui::GetIO().KeyShift) {
+				jumpToSearchHit(_search_current > 0 ? _search_current - 1 : _search_result.hits.size() - 1);
+			} else {
+				jumpToSearchHit((_search_current + 1) % _search_result.hits.size());
+			}
+		}
+		// keep typing
+		ImGui::SetKeyboardFocusHere(-1);
+	}
+	if (search_focused && ImGui::IsKeyPressed(ImGuiKey_Escape)) {
+		_search_open = false;
+	}
+
+	ImGui::SameLine();
+	if (_search_pending || !_msi.ready(c)) {
+		ImGui::TextDisabled("loading index...");
+	} else if (_search_result.hits.empty()) {
+		if (_search_text.empty()) {
+			ImGui::TextDisabled("%zu messages indexed", _msi.docCount(c));
+		} else {
+			ImGui::TextDisabled("no hits in %zu messages", _msi.docCount(c));
+		}
+	} else {
+		// hit list, newest first
+		ImGui::SetNextItemWidth(TEXT_BASE_WIDTH * 24.f);
+		const auto time_label = [](uint64_t ts) -> std::string {
+			const auto time = std::chrono::system_clock::to_time_t(
+				std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>{std::chrono::milliseconds{ts}}
+			);
+			char buf[32] {};
+			std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M", std::localtime(&time));
+			return buf;
+		};
+		if (ImGui::BeginCombo("##hits", time_label(_search_result.hits.at(_search_current).ts).c_str(), ImGuiComboFlags_HeightLarge)) {
+			ImGuiListClipper clipper;
+			clipper.Begin(int(_search_result.hits.size()));
+			while (clipper.Step()) {
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+					ImGui::PushID(i);
+					if (ImGui::Selectable(time_label(_search_result.hits[i].ts).c_str(), size_t(i) == _search_current)) {
+						jumpToSearchHit(i);
+					}
+					ImGui::PopID();
+				}
+			}
+			ImGui::EndCombo();
+		}
+
+		ImGui::SameLine();
+		if (_search_result.total > _search_result.hits.size()) {
+			ImGui::Text("%zu/%zu (of %zu)", _search_current + 1, _search_result.hits.size(), _search_result.total);
+		} else {
+			ImGui::Text("%zu/%zu", _search_current + 1, _search_result.hits.size());
+		}
+	}
+
+	ImGui::SameLine();
+	if (ImGui::SmallButton("x")) {
+		_search_open = false;
+	}
+}
+
+void ContactWindow::jumpToSearchHit(size_t i) {
+	_search_current = i;
+	const auto& hit = _search_result.hits.at(i);
+	_ccl.jumpTo(hit.ts, hit.text_hash);
+}
+
 bool ContactWindow::renderRequest(void) {
 	const bool request_incoming = c.all_of<Contact::Components::RequestIncoming>();
 	const bool request_outgoing = c.all_of<Contact::Components::TagRequestOutgoing>();
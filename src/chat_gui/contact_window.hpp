@@ -1,6 +1,7 @@
 #pragma once
 
 #include "./texture_cache_defs.hpp"
+#include "../search_index.hpp"
 
 #include "./contact_chat_log.hpp"
 #include "./send_image_popup.hpp"
@@ -12,6 +13,7 @@ struct ContactStore4Impl;
 struct ContactInfoWindows;
 struct Theme;
 struct FileSelector;
+class MessageSearchIndex;
 
 // there can be multiple at the same time
 struct ContactWindow {
@@ -22,6 +24,7 @@ struct ContactWindow {
 	ContactTextureCache& _contact_tc;
 	ContactInfoWindows& _ciw;
 	FileSelector& _fss;
+	MessageSearchIndex& _msi;
 	std::function<void(ContactHandle4)> _open_chat;
 
 	std::string _text_input_buffer;
@@ -29,6 +32,12 @@ struct ContactWindow {
 	ContactChatLog _ccl/*{_cs, _rmm, c}*/;
 	SendImagePopup _sip;
 
+	bool _search_open {false};
+	bool _search_focus {false};
+	std::string _search_text;
+	bool _search_pending {false}; // query waits for the index
+	SearchIndex::Result _search_result;
+	size_t _search_current {0};
 
 	float TEXT_BASE_WIDTH {1};
 	float TEXT_BASE_HEIGHT {1};
@@ -43,6 +52,7 @@ struct ContactWindow {
 		BitsetTextureCache& b_tc,
 		ContactInfoWindows& ciw,
 		FileSelector& fss,
+		MessageSearchIndex& msi,
 		ImageViewerPopup& ivp,
 		Clipboard& cb,
 		TextureUploaderI& tu,
@@ -69,6 +79,8 @@ struct ContactWindow {
 		// true if shown
 		bool renderSubListChild(const std::vector<Contact4>* sub_contacts);
 		bool renderRequest(void);
+		void renderSearch(void);
+		void jumpToSearchHit(size_t i);
 		void renderSubContactContext(ContactHandle4 sub_c, const Contact4 sub_cv);
 
 		void pasteFile(const char* mime_type);
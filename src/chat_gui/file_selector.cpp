@@ -2,11 +2,23 @@
 
 #include <imgui.h>
 
+#include <solanaceae/util/time.hpp>
+
 #include <chrono>
 #include <string>
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <iterator>
+#include <cassert>
+
+namespace {
+	enum class SortID : ImGuiID {
+		name = 1,
+		size,
+		date
+	};
+} // namespace
 
 void FileSelector::reset(void) {
 	_is_valid = [](auto){ return true; };
@@ -25,8 +37,180 @@ FileSelector::FileSelector(Theme& theme) : _theme(theme) {
 }
 
 FileSelector::~FileSelector(void) {
-	if (_future_cache.valid()) {
-		_future_cache.get();
+	stopScan();
+}
+
+void FileSelector::startScan(const std::filesystem::path& path, bool streaming) {
+	assert(!_scan_state);
+
+	_scan_state = std::make_shared<ScanState>();
+	_scan_state->file_path = path;
+	_scan_streaming = streaming;
+
+	_scan_future = std::async(std::launch::async, [state = _scan_state](void) {
+		// hand over in batches, to not contend the lock for every entry
+		constexpr size_t batch_size {512};
+		std::vector<Entry> dirs;
+		std::vector<Entry> files;
+
+		const auto flush = [&](void) {
+			if (dirs.empty() && files.empty()) {
+				return;
+			}
+
+			std::lock_guard lg{state->mutex};
+			state->dirs.insert(state->dirs.end(), std::make_move_iterator(dirs.begin()), std::make_move_iterator(dirs.end()));
+			state->files.insert(state->files.end(), std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()));
+			dirs.clear();
+			files.clear();
+		};
+
+		try {
+			for (auto&& dir_entry : std::filesystem::directory_iterator(state->file_path)) {
+				if (state->stop) {
+					break;
+				}
+
+				// stat once, errors result in default values
+				std::error_code ec;
+				Entry e;
+
+				if (dir_entry.is_directory(ec)) {
+					e.last_write_time = dir_entry.last_write_time(ec);
+					e.path = dir_entry.path();
+					const auto filename_u8 = e.path.filename().generic_u8string();
+					e.name = std::string{filename_u8.cbegin(), filename_u8.cend()};
+					dirs.push_back(std::move(e));
+				} else if (dir_entry.is_regular_file(ec)) {
+					e.file_size = dir_entry.file_size(ec);
+					if (ec) {
+						e.file_size = 0;
+					}
+					e.last_write_time = dir_entry.last_write_time(ec);
+					e.path = dir_entry.path();
+					const auto filename_u8 = e.path.filename().generic_u8string();
+					e.name = std::string{filename_u8.cbegin(), filename_u8.cend()};
+					files.push_back(std::move(e));
+				}
+
+				if (dirs.size() + files.size() >= batch_size) {
+					flush();
+				}
+			}
+		} catch (std::filesystem::filesystem_error const& ex) {
+			// we likely saw a file disappear
+			std::cerr << "FS thread exception: " << ex.what() << "\n";
+		}
+
+		flush();
+		state->done = true;
+	});
+}
+
+void FileSelector::stopScan(void) {
+	if (_scan_state) {
+		_scan_state->stop = true;
+	}
+	if (_scan_future.valid()) {
+		_scan_future.get();
+	}
+	_scan_state.reset();
+}
+
+bool FileSelector::pullScan(void) {
+	if (!_scan_state || !_current_cache.has_value()) {
+		return false;
+	}
+
+	// read before taking the entries, the thread only sets done after the last flush
+	const bool done = _scan_state->done;
+
+	bool changed {false};
+	if (_scan_streaming) {
+		std::lock_guard lg{_scan_state->mutex};
+		auto& cache = _current_cache.value();
+		if (!_scan_state->dirs.empty()) {
+			cache.dirs.insert(cache.dirs.end(), std::make_move_iterator(_scan_state->dirs.begin()), std::make_move_iterator(_scan_state->dirs.end()));
+			_scan_state->dirs.clear();
+			changed = true;
+		}
+		if (!_scan_state->files.empty()) {
+			cache.files.insert(cache.files.end(), std::make_move_iterator(_scan_state->files.begin()), std::make_move_iterator(_scan_state->files.end()));
+			_scan_state->files.clear();
+			changed = true;
+		}
+	} else if (done) {
+		// swap in the refreshed listing
+		std::lock_guard lg{_scan_state->mutex};
+		auto& cache = _current_cache.value();
+		cache.dirs = std::move(_scan_state->dirs);
+		cache.files = std::move(_scan_state->files);
+		changed = true;
+	}
+
+	if (done) {
+		_scan_future.get();
+		_scan_state.reset();
+		_last_scan_done_ts = getTimeMS();
+	}
+
+	return changed;
+}
+
+void FileSelector::sortCache(int sort_id, bool descending) {
+	if (!_current_cache.has_value()) {
+		return;
+	}
+
+	auto& dirs = _current_cache.value().dirs;
+	auto& files = _current_cache.value().files;
+
+	switch (static_cast<SortID>(sort_id)) {
+		break; case SortID::name:
+			if (descending) {
+				std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
+					return a.name < b.name;
+				});
+				std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
+					return a.name < b.name;
+				});
+			} else {
+				std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
+					return a.name > b.name;
+				});
+				std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
+					return a.name > b.name;
+				});
+			}
+		break; case SortID::size:
+			if (descending) {
+				// TODO: sort dirs?
+				std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
+					return a.file_size < b.file_size;
+				});
+			} else {
+				// TODO: sort dirs?
+				std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
+					return a.file_size > b.file_size;
+				});
+			}
+		break; case SortID::date:
+			if (descending) {
+				std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
+					return a.last_write_time < b.last_write_time;
+				});
+				std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
+					return a.last_write_time < b.last_write_time;
+				});
+			} else {
+				std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
+					return a.last_write_time > b.last_write_time;
+				});
+				std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
+					return a.last_write_time > b.last_write_time;
+				});
+			}
+		break; default: ;
 	}
 }
 
@@ -76,11 +260,6 @@ void FileSelector::render(void) {
 			ImGuiTableFlags_Sortable
 		;
 		if (ImGui::BeginTable("dir listing", 4, table_flags, {0, -TEXT_BASE_HEIGHT * 2.5f})) {
-			enum class SortID : ImGuiID {
-				name = 1,
-				size,
-				date
-			};
 			ImGui::TableSetupColumn("type", 0, TEXT_BASE_WIDTH);
 			ImGui::TableSetupColumn("name", ImGuiTableColumnFlags_WidthStretch | ImGuiTableColumnFlags_DefaultSort, 0.f, static_cast<ImGuiID>(SortID::name));
 			ImGui::TableSetupColumn("size", 0, 0.f, static_cast<ImGuiID>(SortID::size));
@@ -118,97 +297,40 @@ void FileSelector::render(void) {
 			const ImU32 dir_bg0_color = ImGui::GetColorU32(_theme.getColor<ThemeCol_Contact::directory_background_even>());
 			const ImU32 dir_bg1_color = ImGui::GetColorU32(_theme.getColor<ThemeCol_Contact::directory_background_odd>());
 
-			bool start_new_collection_task {false};
-			if (_future_cache.valid()) {
-				if (_future_cache.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-					// data is ready
-					_current_cache = _future_cache.get();
-
-					// also queue a new one
-					start_new_collection_task = true;
-				}
-			} else {
-				start_new_collection_task = true;
+			const uint64_t ts_now = getTimeMS();
+
+			// (re)start scanning
+			if (!_current_cache.has_value() || _current_cache.value().file_path != current_path) {
+				// new dir, drop everything and stream the results in
+				stopScan();
+				_current_cache = CachedData{current_path, {}, {}};
+				_sort_dirty = true;
+				startScan(current_path, true);
+			} else if (!_scan_state && ts_now - _last_scan_done_ts >= 2000) {
+				// refresh, swapped in once done
+				startScan(current_path, false);
 			}
 
-			// check if cache still current
-			if (_current_cache.has_value() && _current_cache.value().file_path != current_path) {
-				// and drop it if not
-				_current_cache.reset();
+			if (pullScan()) {
+				_sort_dirty = true;
 			}
 
-			if (start_new_collection_task) {
-				_future_cache = std::async(std::launch::async, [path = current_path, sorts_specs = ImGui::TableGetSortSpecs()](void) -> CachedData {
-					CachedData cd;
-					cd.file_path = path;
-					auto& dirs = cd.dirs;
-					auto& files = cd.files;
-					try {
-						for (auto&& dir_entry : std::filesystem::directory_iterator(path)) {
-							if (dir_entry.is_directory()) {
-								dirs.push_back(std::move(dir_entry));
-							} else if (dir_entry.is_regular_file()) {
-								files.push_back(std::move(dir_entry));
-							}
-						}
-
-						// do sorting here
-						if (sorts_specs != nullptr && sorts_specs->SpecsCount >= 1) {
-							switch (static_cast<SortID>(sorts_specs->Specs->ColumnUserID)) {
-								break; case SortID::name:
-									if (sorts_specs->Specs->SortDirection == ImGuiSortDirection_Descending) {
-										std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
-											return a.path() < b.path();
-										});
-										std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
-											return a.path().filename() < b.path().filename();
-										});
-									} else {
-										std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
-											return a.path() > b.path();
-										});
-										std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
-											return a.path().filename() > b.path().filename();
-										});
-									}
-								break; case SortID::size:
-									if (sorts_specs->Specs->SortDirection == ImGuiSortDirection_Descending) {
-										// TODO: sort dirs?
-										std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
-											return a.file_size() < b.file_size();
-										});
-									} else {
-										// TODO: sort dirs?
-										std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
-											return a.file_size() > b.file_size();
-										});
-									}
-								break; case SortID::date:
-									if (sorts_specs->Specs->SortDirection == ImGuiSortDirection_Descending) {
-										std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
-											return a.last_write_time() < b.last_write_time();
-										});
-										std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
-											return a.last_write_time() < b.last_write_time();
-										});
-									} else {
-										std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) -> bool {
-											return a.last_write_time() > b.last_write_time();
-										});
-										std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) -> bool {
-											return a.last_write_time() > b.last_write_time();
-										});
-									}
-								break; default: ;
-							}
-						}
-					} catch (std::filesystem::filesystem_error const& ex) {
-						// we likely saw a file disappear
-						std::cerr << "FS thread exception: " << ex.what() << "\n";
-					}
+			if (auto* sorts_specs = ImGui::TableGetSortSpecs(); sorts_specs != nullptr) {
+				if (sorts_specs->SpecsDirty) {
+					_sort_dirty = true;
+					sorts_specs->SpecsDirty = false;
+				}
 
-					return cd;
-				});
+				// while streaming, throttle resorting the growing list
+				const bool streaming = _scan_state && _scan_streaming;
+				if (_sort_dirty && sorts_specs->SpecsCount >= 1 && (!streaming || ts_now - _last_sort_ts >= 250)) {
+					sortCache(
+						static_cast<int>(sorts_specs->Specs->ColumnUserID),
+						sorts_specs->Specs->SortDirection == ImGuiSortDirection_Descending
+					);
+					_sort_dirty = false;
+					_last_sort_ts = ts_now;
+				}
 			}
 
 			if (_current_cache.has_value()) {
@@ -230,18 +352,16 @@ void FileSelector::render(void) {
 							ImGui::PushID(tmp_id++);
 							if (ImGui::Selectable("D", false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap)) {
 								try {
-									_current_file_path = dir_entry.path() / "";
+									_current_file_path = dir_entry.path / "";
 								} catch (...) {}
 							}
 							ImGui::PopID();
 						}
 
 						if (ImGui::TableNextColumn()) {
-							try {
-								const auto filename_u8 = dir_entry.path().filename().generic_u8string();
-								const auto path_name = std::string{filename_u8.cbegin(), filename_u8.cend()} + "/";
-								ImGui::TextUnformatted(path_name.c_str());
-							} catch (...) {}
+							ImGui::TextUnformatted(dir_entry.name.c_str());
+							ImGui::SameLine(0.f, 0.f);
+							ImGui::TextUnformatted("/");
 						}
 
 						if (ImGui::TableNextColumn()) {
@@ -251,8 +371,8 @@ void FileSelector::render(void) {
 						if (ImGui::TableNextColumn()) {
 							try {
 								const auto file_time_converted = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-									dir_entry.last_write_time()
-									- decltype(dir_entry.last_write_time())::clock::now()
+									dir_entry.last_write_time
+									- std::filesystem::file_time_type::clock::now()
 									+ std::chrono::system_clock::now()
 								);
 								const auto ctime = std::chrono::system_clock::to_time_t(file_time_converted);
@@ -274,30 +394,25 @@ void FileSelector::render(void) {
 							ImGui::PushID(tmp_id++);
 							if (ImGui::Selectable("F", false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowOverlap)) {
 								try {
-									_current_file_path = file_entry.path();
+									_current_file_path = file_entry.path;
 								} catch(...) {}
 							}
 							ImGui::PopID();
 						}
 
 						if (ImGui::TableNextColumn()) {
-							try {
-								const auto filename_u8 = file_entry.path().filename().generic_u8string();
-								ImGui::TextUnformatted(reinterpret_cast<const char*>(filename_u8.c_str()));
-							} catch(...) {}
+							ImGui::TextUnformatted(file_entry.name.c_str());
 						}
 
 						if (ImGui::TableNextColumn()) {
-							try {
-								ImGui::TextDisabled("%s", std::to_string(file_entry.file_size()).c_str());
-							} catch(...) {}
+							ImGui::TextDisabled("%s", std::to_string(file_entry.file_size).c_str());
 						}
 
 						if (ImGui::TableNextColumn()) {
 							try {
 								const auto file_time_converted = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-									file_entry.last_write_time()
-									- decltype(file_entry.last_write_time())::clock::now()
+									file_entry.last_write_time
+									- std::filesystem::file_time_type::clock::now()
 									+ std::chrono::system_clock::now()
 								);
 								const auto ctime = std::chrono::system_clock::to_time_t(file_time_converted);
@@ -308,8 +423,10 @@ void FileSelector::render(void) {
 						}
 					}
 				}
-			} else {
-				// render loading placeholder
+			}
+
+			if (_scan_state && _scan_streaming) {
+				// render loading placeholder, entries keep streaming in above
 				if (ImGui::TableNextColumn()) {
 					ImGui::TextUnformatted("-");
 				}
@@ -4,6 +4,12 @@
 #include <functional>
 #include <optional>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
 
 #include "./theme.hpp"
 
@@ -11,13 +17,42 @@ struct FileSelector {
 	Theme& _theme;
 	std::filesystem::path _current_file_path;
 
+	// everything we need to display and sort, stat'd once by the scan thread
+	struct Entry {
+		std::filesystem::path path;
+		std::string name; // filename, utf8
+		uint64_t file_size {0}; // 0 for dirs
+		std::filesystem::file_time_type last_write_time {};
+	};
+
 	struct CachedData {
 		std::filesystem::path file_path; // can be used to check against current
-		std::vector<std::filesystem::directory_entry> dirs;
-		std::vector<std::filesystem::directory_entry> files;
+		std::vector<Entry> dirs;
+		std::vector<Entry> files;
 	};
 	std::optional<CachedData> _current_cache;
-	std::future<CachedData> _future_cache;
+
+	// shared between the ui and the scan thread
+	struct ScanState {
+		std::filesystem::path file_path;
+
+		std::mutex mutex;
+		// entries found since the last pull, protected by mutex
+		std::vector<Entry> dirs;
+		std::vector<Entry> files;
+
+		std::atomic_bool done {false};
+		std::atomic_bool stop {false};
+	};
+	std::shared_ptr<ScanState> _scan_state;
+	std::future<void> _scan_future;
+	// true, if the scan results get appended to _current_cache as they come in.
+	// false for rescans of the current dir, those get swapped in once done
+	bool _scan_streaming {false};
+	uint64_t _last_scan_done_ts {0}; // ms
+
+	bool _sort_dirty {true};
+	uint64_t _last_sort_ts {0}; // ms
 
 	bool _open_popup {false};
 
@@ -27,6 +62,15 @@ struct FileSelector {
 
 	void reset(void);
 
+	void startScan(const std::filesystem::path& path, bool streaming);
+	void stopScan(void);
+	// moves new entries from the scan thread into the cache
+	// returns true if the cache changed
+	bool pullScan(void);
+
+	// no filesystem access
+	void sortCache(int sort_id, bool descending);
+
 	public:
 		FileSelector(Theme& theme);
 		~FileSelector(void);
@@ -1,10 +1,290 @@
 #include "./image_viewer_popup.hpp"
 
+#include "../os_comps.hpp"
+
+#include <solanaceae/message3/components.hpp>
+#include <solanaceae/object_store/object_store.hpp>
+#include <solanaceae/object_store/meta_components_file.hpp>
+#include <solanaceae/file/file2.hpp>
+
 #include <imgui.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+#include <cmath>
 #include <iostream>
 
-ImageViewerPopup::ImageViewerPopup(MessageTextureCache& mtc) : _mtc(mtc) {
+// only opens the file, the build job reads it, so it does not depend on the object store
+static std::unique_ptr<File2I> openMessageFile(Message3Handle m, uint64_t& file_size) {
+	if (!m.all_of<Message::Components::MessageFileObject>()) {
+		return {};
+	}
+	const auto& o = m.get<Message::Components::MessageFileObject>().o;
+
+	if (!static_cast<bool>(o) || !o.all_of<ObjComp::Ephemeral::BackendFile2, ObjComp::F::SingleInfo, ObjComp::F::TagLocalHaveAll>()) {
+		return {};
+	}
+
+	// same limit as the message image loader
+	file_size = o.get<ObjComp::F::SingleInfo>().file_size;
+	if (file_size == 0 || file_size > 50*1024*1024) {
+		return {};
+	}
+
+	auto* file_backend = o.get<ObjComp::Ephemeral::BackendFile2>().ptr;
+	if (file_backend == nullptr) {
+		return {};
+	}
+
+	auto file2 = file_backend->file2(o, StorageBackendIFile2::FILE2_READ);
+	if (!file2 || !file2->isGood() || !file2->can_read) {
+		std::cerr << "IVP error: creating file2 from object via backendI\n";
+		return {};
+	}
+
+	return file2;
+}
+
+ImageViewerPopup::ImageViewerPopup(MessageTextureCache& mtc, ImageCodecRegistry& icr, TextureUploaderI& tu) : _mtc(mtc), _icr(icr), _tu(tu) {
+}
+
+ImageViewerPopup::~ImageViewerPopup(void) {
+	reset();
+
+	for (auto& f : _abandoned_futures) {
+		f.wait();
+	}
+	_abandoned_futures.clear();
+}
+
+void ImageViewerPopup::reset(void) {
+	stopBuild();
+	destroyTiles();
+	_pyramid = {};
+
+	_m = {};
+	_img_width = 0;
+	_img_height = 0;
+	_zoom = 1.f;
+	_center_x = 0.f;
+	_center_y = 0.f;
+	_fit = true;
+}
+
+void ImageViewerPopup::startBuild(std::unique_ptr<File2I>&& file, uint64_t file_size) {
+	assert(!_build_state);
+
+	_build_state = std::make_shared<BuildState>();
+	_build_state->file = std::move(file);
+	_build_state->file_size = file_size;
+
+	_build_future = std::async(std::launch::async, [state = _build_state, &icr = _icr](void) {
+		ImageLoaderI::ImageResult res;
+		{ // up to 50MiB, too slow for the main thread
+			auto read_data = state->file->read(state->file_size, 0);
+			if (read_data.ptr == nullptr || read_data.size != state->file_size) {
+				std::cerr << "IVP error: reading from file2 failed\n";
+			} else if (!state->stop) {
+				auto format = ImageCodecRegistry::Format::unknown;
+				res = icr.loadFromMemoryRGBA(read_data.ptr, read_data.size, format);
+			}
+		}
+		state->file.reset();
+
+		// animations stay with the message texture
+		if (!state->stop && res.frames.size() == 1) {
+			state->ok = state->pyramid.build(res.width, res.height, std::move(res.frames.front().data), state->stop);
+		}
+
+		state->done = true;
+	});
+}
+
+void ImageViewerPopup::stopBuild(void) {
+	if (_build_state) {
+		_build_state->stop = true;
+	}
+	if (_build_future.valid()) {
+		// decoding cant be interrupted, dont wait for it
+		_abandoned_futures.push_back(std::move(_build_future));
+	}
+	_build_state.reset();
+}
+
+void ImageViewerPopup::collectAbandoned(void) {
+	for (auto it = _abandoned_futures.begin(); it != _abandoned_futures.end();) {
+		if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			it = _abandoned_futures.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+const ImageViewerPopup::Tile* ImageViewerPopup::getTile(size_t level, uint32_t tile_x, uint32_t tile_y, int& uploads_left) {
+	const uint64_t key = (uint64_t(level) << 48) | (uint64_t(tile_y) << 24) | tile_x;
+	if (auto it = _tiles.find(key); it != _tiles.end()) {
+		it->second.last_used = _frame;
+		return &it->second;
+	}
+
+	if (uploads_left <= 0) {
+		return nullptr;
+	}
+
+	uint32_t width {0};
+	uint32_t height {0};
+	if (!_pyramid.levels.at(level).copyTile(tile_x, tile_y, _tile_buffer, width, height)) {
+		return nullptr;
+	}
+
+	uploads_left--;
+	const auto tex_id = _tu.upload(_tile_buffer.data(), width, height);
+	if (tex_id == 0) {
+		return nullptr;
+	}
+
+	auto& tile = _tiles[key];
+	tile.tex_id = tex_id;
+	tile.width = width;
+	tile.height = height;
+	tile.last_used = _frame;
+	_tiles_bytes += uint64_t(width) * height * 4;
+
+	return &tile;
+}
+
+void ImageViewerPopup::destroyTiles(void) {
+	for (const auto& [key, tile] : _tiles) {
+		_tu.destroy(tile.tex_id);
+	}
+	_tiles.clear();
+	_tiles_bytes = 0;
+}
+
+void ImageViewerPopup::evictTiles(void) {
+	while (_tiles_bytes > tile_memory_budget) {
+		auto lru_it = _tiles.end();
+		for (auto it = _tiles.begin(); it != _tiles.end(); it++) {
+			if (it->second.last_used < _frame && (lru_it == _tiles.end() || it->second.last_used < lru_it->second.last_used)) {
+				lru_it = it;
+			}
+		}
+
+		if (lru_it == _tiles.end()) {
+			// all on screen
+			break;
+		}
+
+		_tu.destroy(lru_it->second.tex_id);
+		_tiles_bytes -= uint64_t(lru_it->second.width) * lru_it->second.height * 4;
+		_tiles.erase(lru_it);
+	}
+}
+
+void ImageViewerPopup::renderTiles(const ImVec2& img_min, const ImVec2& canvas_min, const ImVec2& canvas_max) {
+	const auto& levels = _pyramid.levels;
+	const size_t top = levels.size() - 1;
+	constexpr float tile_size = ImageTilePyramid::tile_size;
+
+	// coarsest level that still has a pixel per screen pixel
+	size_t level = 0;
+	if (_zoom < 1.f) {
+		level = std::min<size_t>(top, static_cast<size_t>(std::floor(std::log2(1.f / _zoom))));
+	}
+
+	{ // the single tile of the top level is the fallback of last resort
+		int top_uploads {1};
+		getTile(top, 0, 0, top_uploads);
+	}
+
+	const auto& lvl = levels.at(level);
+	// level pixels per full size pixel
+	const float scale_x = float(lvl.width) / _img_width;
+	const float scale_y = float(lvl.height) / _img_height;
+
+	// visible part, in level pixels
+	const float vis_min_x = (canvas_min.x - img_min.x) / _zoom * scale_x;
+	const float vis_min_y = (canvas_min.y - img_min.y) / _zoom * scale_y;
+	const float vis_max_x = (canvas_max.x - img_min.x) / _zoom * scale_x;
+	const float vis_max_y = (canvas_max.y - img_min.y) / _zoom * scale_y;
+	if (vis_max_x <= 0.f || vis_max_y <= 0.f || vis_min_x >= lvl.width || vis_min_y >= lvl.height) {
+		return;
+	}
+
+	const uint32_t tx_begin = static_cast<uint32_t>(std::max(0.f, vis_min_x) / tile_size);
+	const uint32_t ty_begin = static_cast<uint32_t>(std::max(0.f, vis_min_y) / tile_size);
+	const uint32_t tx_end = std::min(lvl.tilesX(), static_cast<uint32_t>(vis_max_x / tile_size) + 1);
+	const uint32_t ty_end = std::min(lvl.tilesY(), static_cast<uint32_t>(vis_max_y / tile_size) + 1);
+
+	auto* draw_list = ImGui::GetWindowDrawList();
+	int uploads_left = max_tile_uploads_per_frame;
+
+	for (uint32_t ty = ty_begin; ty < ty_end; ty++) {
+		for (uint32_t tx = tx_begin; tx < tx_end; tx++) {
+			// tile in full size pixels
+			const float px0 = tx * tile_size / scale_x;
+			const float py0 = ty * tile_size / scale_y;
+			const float px1 = std::min<float>((tx + 1) * tile_size, lvl.width) / scale_x;
+			const float py1 = std::min<float>((ty + 1) * tile_size, lvl.height) / scale_y;
+
+			const ImVec2 p_min{img_min.x + px0 * _zoom, img_min.y + py0 * _zoom};
+			const ImVec2 p_max{img_min.x + px1 * _zoom, img_min.y + py1 * _zoom};
+
+			if (const auto* tile = getTile(level, tx, ty, uploads_left); tile != nullptr) {
+				draw_list->AddImage(tile->tex_id, p_min, p_max);
+				continue;
+			}
+
+			// not uploaded yet, stretch the part of a coarser tile
+			for (size_t fl = level + 1; fl <= top; fl++) {
+				const auto& f_lvl = levels.at(fl);
+				const float f_scale_x = float(f_lvl.width) / _img_width;
+				const float f_scale_y = float(f_lvl.height) / _img_height;
+
+				const uint32_t ftx = static_cast<uint32_t>(px0 * f_scale_x / tile_size);
+				const uint32_t fty = static_cast<uint32_t>(py0 * f_scale_y / tile_size);
+
+				int no_uploads {0};
+				const auto* f_tile = getTile(fl, ftx, fty, no_uploads);
+				if (f_tile == nullptr) {
+					continue;
+				}
+
+				const ImVec2 uv_min{
+					(px0 * f_scale_x - ftx * tile_size) / f_tile->width,
+					(py0 * f_scale_y - fty * tile_size) / f_tile->height,
+				};
+				const ImVec2 uv_max{
+					std::min(1.f, (px1 * f_scale_x - ftx * tile_size) / f_tile->width),
+					std::min(1.f, (py1 * f_scale_y - fty * tile_size) / f_tile->height),
+				};
+				draw_list->AddImage(f_tile->tex_id, p_min, p_max, uv_min, uv_max);
+				break;
+			}
+		}
+	}
+}
+
+void ImageViewerPopup::setImageSize(uint32_t width, uint32_t height) {
+	if (width == 0 || height == 0 || (width == _img_width && height == _img_height)) {
+		return;
+	}
+
+	if (_img_width != 0 && _img_height != 0) {
+		// same view, different pixels
+		const float factor_x = float(width) / _img_width;
+		_zoom /= factor_x;
+		_center_x *= factor_x;
+		_center_y *= float(height) / _img_height;
+	} else {
+		_center_x = width * 0.5f;
+		_center_y = height * 0.5f;
+	}
+
+	_img_width = width;
+	_img_height = height;
 }
 
 // open popup with (image) file
@@ -13,60 +293,144 @@ void ImageViewerPopup::view(Message3Handle m) {
 		std::cout << "IVP warning: overriding open image\n";
 	}
 
+	reset();
 	_m = m;
-	_width = 0;
-	_height = 0;
+
+	uint64_t file_size {0};
+	if (auto file = openMessageFile(m, file_size); file) {
+		startBuild(std::move(file), file_size);
+	}
 
 	_open_popup = true;
 }
 
 // call this each frame
 void ImageViewerPopup::render(float) {
+	collectAbandoned();
+	_frame++;
+
 	if (_open_popup) {
 		_open_popup = false;
 		ImGui::OpenPopup("Image##ImageViewerPopup");
 		ImGui::GetIO().ClearInputMouse(); // https://github.com/ocornut/imgui/issues/9334
 	}
 
-	// TODO: remplace with modal(?), pop up is limited to viewport in size
-	// or replace with fixed window where the image can be moved
-	if (!ImGui::BeginPopup("Image##ImageViewerPopup", ImGuiWindowFlags_NoDecoration)) {
-		_m = {}; // meh, event on close would be nice, but the reset is cheap
-		_scale = 1.f;
+	const auto* viewport = ImGui::GetMainViewport();
+	ImGui::SetNextWindowPos(viewport->GetCenter(), ImGuiCond_Always, {0.5f, 0.5f});
+	ImGui::SetNextWindowSize({viewport->WorkSize.x * 0.9f, viewport->WorkSize.y * 0.9f}, ImGuiCond_Always);
+
+	if (!ImGui::BeginPopup("Image##ImageViewerPopup", ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove)) {
+		if (static_cast<bool>(_m)) {
+			reset(); // meh, event on close would be nice, but the reset is cheap
+		}
 		return;
 	}
 
-	ImGui::SliderFloat("scale", &_scale, 0.05f, 2.f);
+	if (_build_state && _build_state->done) {
+		_build_future.get();
+		if (_build_state->ok) {
+			_pyramid = std::move(_build_state->pyramid);
+			setImageSize(_pyramid.levels.front().width, _pyramid.levels.front().height);
+		}
+		_build_state.reset();
+	}
 
-	auto [id, img_width, img_height] = _mtc.get(_m, _width, _height);
+	if (ImGui::Button("fit")) {
+		_fit = true;
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("1:1")) {
+		_fit = false;
+		_zoom = 1.f;
+	}
+	ImGui::SameLine();
+	ImGui::Text("%ux%u %.0f%%", _img_width, _img_height, _zoom * 100.f);
+	if (_build_state) {
+		ImGui::SameLine();
+		ImGui::ProgressBar(
+			-0.333f * ImGui::GetTime(),
+			{-FLT_MIN, 0.f},
+			"loading full size"
+		);
+	}
 
-	img_width = std::max<uint32_t>(5, _scale * img_width);
-	img_height = std::max<uint32_t>(5, _scale * img_height);
+	const ImVec2 canvas_min = ImGui::GetCursorScreenPos();
+	const ImVec2 canvas_size{
+		std::max(16.f, ImGui::GetContentRegionAvail().x),
+		std::max(16.f, ImGui::GetContentRegionAvail().y),
+	};
+	const ImVec2 canvas_max{canvas_min.x + canvas_size.x, canvas_min.y + canvas_size.y};
+	const ImVec2 canvas_center{canvas_min.x + canvas_size.x * 0.5f, canvas_min.y + canvas_size.y * 0.5f};
 
-	_width = img_width;
-	_height = img_height;
+	ImGui::InvisibleButton("canvas", canvas_size);
+	ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY);
+	const bool canvas_hovered = ImGui::IsItemHovered();
+	const bool canvas_active = ImGui::IsItemActive();
 
-	ImGui::Image(
-		id,
-		ImVec2{
-			static_cast<float>(img_width),
-			static_cast<float>(img_height)
-		}
-	);
+	uint64_t thumb_id {0};
+	if (_pyramid.levels.empty()) {
+		// request what we show, the cache reloads larger if it was scaled down
+		const auto req_width = static_cast<uint32_t>(_img_width * std::max(1.f, _zoom));
+		const auto req_height = static_cast<uint32_t>(_img_height * std::max(1.f, _zoom));
+		const auto [id, width, height] = _mtc.get(_m, req_width, req_height);
+		thumb_id = id;
+		setImageSize(width, height);
+	}
 
-	// TODO: figure out nice scroll zooming
-	//ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY);
-	//const auto prev_scale = _scale;
-	//_scale += ImGui::GetIO().MouseWheel * 0.05f;
-	//_scale = std::clamp(_scale, 0.05f, 3.f);
+	if (_img_width == 0 || _img_height == 0) {
+		ImGui::EndPopup();
+		return;
+	}
+
+	const float fit_zoom = std::min(canvas_size.x / _img_width, canvas_size.y / _img_height);
+
+	const auto& io = ImGui::GetIO();
+	if (canvas_active && ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.f)) {
+		_fit = false;
+		_center_x -= io.MouseDelta.x / _zoom;
+		_center_y -= io.MouseDelta.y / _zoom;
+	}
+	if (canvas_hovered && io.MouseWheel != 0.f) {
+		_fit = false;
+
+		// keep the pixel under the cursor in place
+		const float cursor_x = io.MousePos.x - canvas_center.x;
+		const float cursor_y = io.MousePos.y - canvas_center.y;
+		const float pixel_x = _center_x + cursor_x / _zoom;
+		const float pixel_y = _center_y + cursor_y / _zoom;
+
+		_zoom = std::clamp(_zoom * std::pow(1.25f, io.MouseWheel), std::min(1.f, fit_zoom * 0.5f), 32.f);
+
+		_center_x = pixel_x - cursor_x / _zoom;
+		_center_y = pixel_y - cursor_y / _zoom;
+	}
+
+	if (_fit) {
+		_zoom = fit_zoom;
+		_center_x = _img_width * 0.5f;
+		_center_y = _img_height * 0.5f;
+	} else {
+		_center_x = std::clamp(_center_x, 0.f, float(_img_width));
+		_center_y = std::clamp(_center_y, 0.f, float(_img_height));
+	}
+
+	const ImVec2 img_min{canvas_center.x - _center_x * _zoom, canvas_center.y - _center_y * _zoom};
+	const ImVec2 img_max{img_min.x + _img_width * _zoom, img_min.y + _img_height * _zoom};
+
+	auto* draw_list = ImGui::GetWindowDrawList();
+	draw_list->PushClipRect(canvas_min, canvas_max, true);
+	if (!_pyramid.levels.empty()) {
+		renderTiles(img_min, canvas_min, canvas_max);
+	} else {
+		draw_list->AddImage(thumb_id, img_min, img_max);
+	}
+	draw_list->PopClipRect();
 
-	//if (std::abs(prev_scale - _scale) > 0.001f) {
-	//}
+	evictTiles();
 
 	if (ImGui::Shortcut(ImGuiKey_Escape)) {
 		ImGui::CloseCurrentPopup();
-		_m = {};
-		_scale = 1.f;
+		reset();
 	}
 
 	ImGui::EndPopup();
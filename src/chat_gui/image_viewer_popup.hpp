@@ -1,27 +1,103 @@
 #pragma once
 
 #include <solanaceae/message3/registry_message_model.hpp>
+#include <solanaceae/file/file2.hpp>
 
 #include "./texture_cache_defs.hpp"
+#include "../image_codec_registry.hpp"
+#include "../image_tile_pyramid.hpp"
+#include "../texture_uploader.hpp"
 
 #include <entt/entity/registry.hpp>
 #include <entt/entity/handle.hpp>
+#include <entt/container/dense_map.hpp>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// fwd
+struct ImVec2;
 
 struct ImageViewerPopup {
 	MessageTextureCache& _mtc;
+	ImageCodecRegistry& _icr;
+	TextureUploaderI& _tu;
 
 	Message3Handle _m{};
-	float _scale {1.f};
-	// keep track of full size from last frame
-	uint32_t _width {0};
-	uint32_t _height {0};
+
+	// the full size image is read, decoded and cut into tiles in the background.
+	// until then (or for animations) the message texture is shown
+	struct BuildState {
+		std::atomic_bool done {false};
+		std::atomic_bool stop {false};
+
+		// opened on the main thread, only read by the job
+		std::unique_ptr<File2I> file;
+		uint64_t file_size {0};
+
+		// only touch once done
+		bool ok {false};
+		ImageTilePyramid pyramid;
+	};
+	std::shared_ptr<BuildState> _build_state;
+	std::future<void> _build_future;
+	// stopped jobs we dont wait on, to not block the ui
+	std::vector<std::future<void>> _abandoned_futures;
+
+	ImageTilePyramid _pyramid;
+
+	struct Tile {
+		uint64_t tex_id {0};
+		uint32_t width {0};
+		uint32_t height {0};
+		uint64_t last_used {0}; // frame
+	};
+	// level, y, x packed
+	entt::dense_map<uint64_t, Tile> _tiles;
+	uint64_t _tiles_bytes {0};
+	uint64_t _frame {0};
+	std::vector<uint8_t> _tile_buffer;
+
+	// view, in full size image pixels
+	uint32_t _img_width {0};
+	uint32_t _img_height {0};
+	float _zoom {1.f}; // screen pixels per image pixel
+	float _center_x {0.f};
+	float _center_y {0.f};
+	bool _fit {true}; // keep fitting to the view, until the user zooms or pans
 
 	bool _open_popup {false};
 
-	//void reset(void);
+	void reset(void);
+
+	void startBuild(std::unique_ptr<File2I>&& file, uint64_t file_size);
+	void stopBuild(void);
+	void collectAbandoned(void);
+
+	// uploads missing tiles while uploads_left > 0, otherwise returns nullptr.
+	// the pointer is only valid until the next call
+	const Tile* getTile(size_t level, uint32_t tile_x, uint32_t tile_y, int& uploads_left);
+	void destroyTiles(void);
+	// least recently used first, never the ones used this frame
+	void evictTiles(void);
+
+	// draws the level matching the zoom, falls back to coarser tiles that are uploaded
+	void renderTiles(const ImVec2& img_min, const ImVec2& canvas_min, const ImVec2& canvas_max);
+
+	// changes the image size the view is in, eg when the tiles replace the thumbnail
+	void setImageSize(uint32_t width, uint32_t height);
 
 	public:
-		ImageViewerPopup(MessageTextureCache& mtc);
+		// texture memory for tiles, the view can go over for a frame if needed
+		static constexpr uint64_t tile_memory_budget {64*1024*1024};
+		// limits the stall when jumping to a new region
+		static constexpr int max_tile_uploads_per_frame {8};
+
+		ImageViewerPopup(MessageTextureCache& mtc, ImageCodecRegistry& icr, TextureUploaderI& tu);
+		~ImageViewerPopup(void);
 
 		// open popup with (image) message
 		//void view(ObjectHandle o);
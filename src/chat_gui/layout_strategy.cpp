@@ -4,7 +4,7 @@
 
 #include <imgui.h>
 
-void DesktopLayout::render(ChatGui4& gui, const float time_delta, const bool window_focused) {
+float DesktopLayout::render(ChatGui4& gui, const float time_delta, const bool window_focused) {
 	if (gui._contact_stack.empty()) {
 		gui.renderContactList(gui.TEXT_BASE_WIDTH*60);
 	} else {
@@ -20,12 +20,14 @@ void DesktopLayout::render(ChatGui4& gui, const float time_delta, const bool win
 			gui._contact_stack.pop();
 		} else {
 			ImGui::SameLine();
-			gui._contact_stack.top()->render(window_focused, time_delta, true, ImGuiChildFlags_Borders);
+			return gui._contact_stack.top()->render(window_focused, time_delta, true, ImGuiChildFlags_Borders);
 		}
 	}
+
+	return 1000.f;
 }
 
-void SinglePlaneLayout::render(ChatGui4& gui, const float time_delta, const bool window_focused) {
+float SinglePlaneLayout::render(ChatGui4& gui, const float time_delta, const bool window_focused) {
 	if (gui._contact_stack.empty()) {
 		gui.renderContactList();
 		if (gui._contact_list_sortable) {
@@ -34,9 +36,11 @@ void SinglePlaneLayout::render(ChatGui4& gui, const float time_delta, const bool
 	} else {
 		if (ImGui::Shortcut(ImGuiKey_Escape, ImGuiInputFlags_RouteFocused)) {
 			gui._contact_stack.pop();
-			return;
+			return 1000.f;
 		}
 
-		gui._contact_stack.top()->render(window_focused, time_delta, true, ImGuiChildFlags_None, true);
+		return gui._contact_stack.top()->render(window_focused, time_delta, true, ImGuiChildFlags_None, true);
 	}
+
+	return 1000.f;
 }
@@ -5,6 +5,7 @@
 #include "../image_loader_webp.hpp"
 #include "../image_loader_qoi.hpp"
 #include "../image_loader_sdl_image.hpp"
+#include "../string_formatter_utils.hpp"
 
 #include <solanaceae/util/time.hpp>
 
@@ -14,27 +15,45 @@
 #include <imgui.h>
 
 #include <cstdint>
+#include <cstring>
 #include <cmath>
+#include <chrono>
+#include <utility>
 #include <iostream>
 
 SendImagePopup::SendImagePopup(TextureUploaderI& tu, Theme& theme) : _tu(tu), _theme(theme) {
+	original_image = std::make_shared<const ImageLoaderI::ImageResult>();
+
 	_image_loaders.push_back(std::make_unique<ImageLoaderQOI>());
 	_image_loaders.push_back(std::make_unique<ImageLoaderSDLBMP>());
 	_image_loaders.push_back(std::make_unique<ImageLoaderWebP>());
 	_image_loaders.push_back(std::make_unique<ImageLoaderSDLImage>());
 }
 
+SendImagePopup::~SendImagePopup(void) {
+	stopEncode();
+	stopEstimate();
+
+	// blocks until the jobs are done
+	for (auto& f : _abandoned_futures) {
+		f.wait();
+	}
+	_abandoned_futures.clear();
+}
+
 void SendImagePopup::reset(void) {
 	_on_send = [](const auto&, auto){};
 	_on_cancel = [](){};
 
+	stopEncode();
+	stopEstimate();
+	_estimated_sizes = {};
+	_estimate_dirty = true;
+	_last_params = {};
+
 	// hm
 	original_data.clear();
-	{
-		original_image.width = 0;
-		original_image.height = 0;
-		original_image.frames.clear();
-	}
+	original_image = std::make_shared<const ImageLoaderI::ImageResult>();
 
 	// clear preview img
 	for (const auto& tex_id : preview_image.textures) {
@@ -50,29 +69,30 @@ void SendImagePopup::reset(void) {
 bool SendImagePopup::load(void) {
 	// try all loaders after another
 	for (auto& il : _image_loaders) {
-		original_image = il->loadFromMemoryRGBA(original_data.data(), original_data.size());
-		if (original_image.frames.empty() || original_image.height == 0 || original_image.width == 0) {
+		auto new_image = il->loadFromMemoryRGBA(original_data.data(), original_data.size());
+		if (new_image.frames.empty() || new_image.height == 0 || new_image.width == 0) {
 			continue;
 		}
+		original_image = std::make_shared<const ImageLoaderI::ImageResult>(std::move(new_image));
 
 #if 1
 		crop_rect.x = 0;
 		crop_rect.y = 0;
-		crop_rect.w = original_image.width;
-		crop_rect.h = original_image.height;
+		crop_rect.w = original_image->width;
+		crop_rect.h = original_image->height;
 #else
-		crop_rect.x = original_image.width * 0.05f;
-		crop_rect.y = original_image.height * 0.05f;
-		crop_rect.w = original_image.width * 0.9f;
-		crop_rect.h = original_image.height * 0.9f;
+		crop_rect.x = original_image->width * 0.05f;
+		crop_rect.y = original_image->height * 0.05f;
+		crop_rect.w = original_image->width * 0.9f;
+		crop_rect.h = original_image->height * 0.9f;
 #endif
 
-		crop_rect = sanitizeCrop(crop_rect, original_image.width, original_image.height);
+		crop_rect = sanitizeCrop(crop_rect, original_image->width, original_image->height);
 		crop_before_drag = crop_rect;
 
 		original_file_ext = ".";
-		if (original_image.file_ext != nullptr) {
-			original_file_ext += original_image.file_ext;
+		if (original_image->file_ext != nullptr) {
+			original_file_ext += original_image->file_ext;
 		} else {
 			// HACK: manually probe for png
 			if (!original_raw
@@ -91,17 +111,17 @@ bool SendImagePopup::load(void) {
 		assert(preview_image.textures.empty());
 		preview_image.timestamp_last_rendered = getTimeMS();
 		preview_image.current_texture = 0;
-		for (const auto& [ms, data] : original_image.frames) {
-			const auto n_t = _tu.upload(data.data(), original_image.width, original_image.height);
+		for (const auto& [ms, data] : original_image->frames) {
+			const auto n_t = _tu.upload(data.data(), original_image->width, original_image->height);
 			preview_image.textures.push_back(n_t);
 			preview_image.frame_duration.push_back(ms);
 		}
 
 		// redundant
-		preview_image.width = original_image.width;
-		preview_image.height = original_image.height;
+		preview_image.width = original_image->width;
+		preview_image.height = original_image->height;
 
-		if (original_image.frames.size() > 1) {
+		if (original_image->frames.size() > 1) {
 			std::cout << "SIP: loaded animation\n";
 		} else {
 			std::cout << "SIP: loaded image\n";
@@ -144,6 +164,190 @@ SendImagePopup::Rect SendImagePopup::sanitizeCrop(Rect crop_rect, int32_t image_
 	return crop_rect;
 }
 
+bool SendImagePopup::EncodeParams::operator==(const EncodeParams& other) const {
+	return
+		crop.x == other.crop.x && crop.y == other.crop.y &&
+		crop.w == other.crop.w && crop.h == other.crop.h &&
+		cropped == other.cropped &&
+		width == other.width && height == other.height &&
+		compressor == other.compressor &&
+		quality == other.quality &&
+		compression_level == other.compression_level
+	;
+}
+
+SendImagePopup::EncodeParams SendImagePopup::currentParams(void) const {
+	EncodeParams params;
+	params.crop = crop_rect;
+	params.cropped = crop_rect.x != 0 || crop_rect.y != 0 || crop_rect.w != int64_t(original_image->width) || crop_rect.h != int64_t(original_image->height);
+	params.width = std::ceil(crop_rect.w*scale_x);
+	params.height = std::ceil(crop_rect.h*scale_y);
+	params.compressor = current_compressor;
+	params.quality = quality;
+	params.compression_level = compression_level;
+	return params;
+}
+
+std::vector<uint8_t> SendImagePopup::encode(const ImageLoaderI::ImageResult& image, int compressor, uint32_t quality, uint32_t compression_level, const char*& file_ext) {
+	// HACK: generic list
+	if (compressor == 0) {
+		file_ext = ".webp";
+		return ImageEncoderWebP{}.encodeToMemoryRGBA(image, {{"quality", quality}});
+	} else if (compressor == 1) {
+		file_ext = ".webp";
+		return ImageEncoderWebP{}.encodeToMemoryRGBA(image, {{"compression_level", compression_level}});
+	} else if (compressor == 2) {
+		file_ext = ".jpg";
+		return ImageEncoderSTBJpeg{}.encodeToMemoryRGBA(image, {{"quality", quality}});
+	} else if (compressor == 3) {
+		file_ext = ".png";
+		return ImageEncoderSTBPNG{}.encodeToMemoryRGBA(image, {{"png_compression_level", compression_level}});
+	} else if (compressor == 4) {
+		file_ext = ".qoi";
+		return ImageEncoderQOI{}.encodeToMemoryRGBA(image, {});
+	} else if (compressor == 5) {
+		file_ext = ".qoi";
+		return ImageEncoderQOI{}.encodeToMemoryRGBA(image, {{"quality", quality}});
+	}
+
+	file_ext = nullptr;
+	return {};
+}
+
+void SendImagePopup::startEncode(void) {
+	assert(!_encode_state);
+
+	_encode_state = std::make_shared<EncodeState>();
+	_encode_start_ts = getTimeMS();
+
+	_encode_future = std::async(std::launch::async, [state = _encode_state, image = original_image, params = currentParams()](void) {
+		ImageLoaderI::ImageResult tmp_img;
+		const ImageLoaderI::ImageResult* img = image.get();
+
+		if (params.cropped) {
+			tmp_img = img->crop(
+				params.crop.x,
+				params.crop.y,
+				params.crop.w,
+				params.crop.h
+			);
+			img = &tmp_img;
+		}
+
+		if (!state->stop && (params.width != params.crop.w || params.height != params.crop.h)) {
+			state->stage = EncodeState::Stage::scale;
+			tmp_img = img->scale(params.width, params.height);
+			img = &tmp_img;
+		}
+
+		if (!state->stop) {
+			state->stage = EncodeState::Stage::encode;
+			// cant be interrupted
+			state->data = encode(*img, params.compressor, params.quality, params.compression_level, state->file_ext);
+		}
+
+		if (state->stop) {
+			state->data.clear();
+		}
+
+		state->done = true;
+	});
+}
+
+void SendImagePopup::stopEncode(void) {
+	if (!_encode_state) {
+		return;
+	}
+
+	_encode_state->stop = true;
+	if (_encode_future.valid()) {
+		_abandoned_futures.push_back(std::move(_encode_future));
+	}
+	_encode_state.reset();
+}
+
+void SendImagePopup::startEstimate(void) {
+	assert(!_estimate_state);
+
+	_estimate_state = std::make_shared<EstimateState>();
+	_estimate_state->params = currentParams();
+
+	_estimate_future = std::async(std::launch::async, [state = _estimate_state, image = original_image](void) {
+		const auto& params = state->params;
+
+		// cut the crop out of the first frame, animations get extrapolated
+		ImageLoaderI::ImageResult preview;
+		preview.width = params.crop.w;
+		preview.height = params.crop.h;
+		{
+			auto& frame = preview.frames.emplace_back();
+			frame.data.resize(size_t(params.crop.w) * params.crop.h * 4);
+			const auto& src = image->frames.front().data;
+			for (int64_t y = 0; y < params.crop.h; y++) {
+				std::memcpy(
+					frame.data.data() + y * params.crop.w * 4,
+					src.data() + ((params.crop.y + y) * image->width + params.crop.x) * 4,
+					size_t(params.crop.w) * 4
+				);
+			}
+		}
+
+		// the encoded size scales roughly with the pixel count,
+		// so we can get away with encoding something tiny
+		static constexpr int32_t max_preview_dim {256};
+		int32_t preview_width = params.width;
+		int32_t preview_height = params.height;
+		if (std::max(preview_width, preview_height) > max_preview_dim) {
+			const float factor = float(max_preview_dim) / std::max(preview_width, preview_height);
+			preview_width = std::max<int32_t>(1, preview_width * factor);
+			preview_height = std::max<int32_t>(1, preview_height * factor);
+		}
+		if (preview_width != int32_t(preview.width) || preview_height != int32_t(preview.height)) {
+			preview = preview.scale(preview_width, preview_height);
+		}
+
+		const double size_factor =
+			(double(params.width) * params.height) / (double(preview_width) * preview_height)
+			* image->frames.size()
+		;
+
+		for (int i = 0; i < compressor_count && !state->stop; i++) {
+			// jpeg and png only do single frames
+			if (image->frames.size() > 1 && (i == 2 || i == 3)) {
+				continue;
+			}
+
+			const char* file_ext {nullptr};
+			const auto data = encode(preview, i, params.quality, params.compression_level, file_ext);
+			state->sizes.at(i) = data.size() * size_factor;
+		}
+
+		state->done = true;
+	});
+}
+
+void SendImagePopup::stopEstimate(void) {
+	if (!_estimate_state) {
+		return;
+	}
+
+	_estimate_state->stop = true;
+	if (_estimate_future.valid()) {
+		_abandoned_futures.push_back(std::move(_estimate_future));
+	}
+	_estimate_state.reset();
+}
+
+void SendImagePopup::collectAbandoned(void) {
+	for (auto it = _abandoned_futures.begin(); it != _abandoned_futures.end();) {
+		if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			it = _abandoned_futures.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
 void SendImagePopup::sendMemory(
 	const uint8_t* data, size_t data_size,
 	std::function<void(const std::vector<uint8_t>&, std::string_view)>&& on_send,
@@ -217,6 +421,8 @@ bool SendImagePopup::sendFilePath( // file2 instead?
 }
 
 void SendImagePopup::render(float time_delta) {
+	collectAbandoned();
+
 	if (_open_popup) {
 		_open_popup = false;
 		ImGui::OpenPopup("send image##SendImagePopup");
@@ -230,6 +436,30 @@ void SendImagePopup::render(float time_delta) {
 		return;
 	}
 
+	if (_encode_state && _encode_state->done) {
+		_encode_future.get();
+		const auto state = std::exchange(_encode_state, nullptr);
+
+		if (!state->data.empty()) {
+			std::cout << "SIP: encoded image in " << getTimeMS() - _encode_start_ts << "ms\n";
+			_on_send(state->data, state->file_ext);
+			ImGui::CloseCurrentPopup();
+			reset();
+			ImGui::EndPopup();
+			return;
+		}
+
+		// stay open, so a different setting can be tried
+		std::cerr << "SIP: failed to encode image\n";
+	}
+	const bool encoding = static_cast<bool>(_encode_state);
+
+	if (_estimate_state && _estimate_state->done) {
+		_estimate_future.get();
+		_estimated_sizes = _estimate_state->sizes;
+		_estimate_state.reset();
+	}
+
 	//const auto TEXT_BASE_WIDTH = ImGui::CalcTextSize("A").x;
 	const auto TEXT_BASE_HEIGHT = ImGui::GetTextLineHeightWithSpacing();
 
@@ -240,11 +470,14 @@ void SendImagePopup::render(float time_delta) {
 
 	//ImGui::Text("send file....\n......");
 
+	// no changes while the encoder works on them
+	ImGui::BeginDisabled(encoding);
+
 	{
 		float width = ImGui::GetWindowContentRegionMax().x - ImGui::GetWindowContentRegionMin().x;
 		float height = crop_rect.h * (width / crop_rect.w);
 		if (cropping) {
-			height = original_image.height * (width / original_image.width);
+			height = original_image->height * (width / original_image->width);
 		}
 
 		const float max_height =
@@ -278,7 +511,7 @@ void SendImagePopup::render(float time_delta) {
 			ImGui::PushStyleColor(ImGuiCol_Button, _theme.getColor<ThemeCol_Contact::crop_button>());
 			ImGui::PushStyleColor(ImGuiCol_ButtonActive, _theme.getColor<ThemeCol_Contact::crop_button_active>());
 
-			auto ul_clipper_pos = ImVec2{float(crop_rect.x)/original_image.width, float(crop_rect.y)/original_image.height};
+			auto ul_clipper_pos = ImVec2{float(crop_rect.x)/original_image->width, float(crop_rect.y)/original_image->height};
 			{ // crop upper left clipper
 
 				ImGui::SetCursorPos({
@@ -290,14 +523,14 @@ void SendImagePopup::render(float time_delta) {
 				if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
 					if (dragging_last_frame_ul) {
 						auto drag_total = ImGui::GetMouseDragDelta();
-						drag_total.x = (drag_total.x / width) * original_image.width;
-						drag_total.y = (drag_total.y / height) * original_image.height;
+						drag_total.x = (drag_total.x / width) * original_image->width;
+						drag_total.y = (drag_total.y / height) * original_image->height;
 
 						crop_rect.x = std::max<float>(crop_before_drag.x + drag_total.x, 0.01f);
 						crop_rect.y = std::max<float>(crop_before_drag.y + drag_total.y, 0.01f);
 
-						crop_rect.x = std::min<int32_t>(crop_rect.x, original_image.width-2);
-						crop_rect.y = std::min<int32_t>(crop_rect.y, original_image.height-2);
+						crop_rect.x = std::min<int32_t>(crop_rect.x, original_image->width-2);
+						crop_rect.y = std::min<int32_t>(crop_rect.y, original_image->height-2);
 
 						crop_rect.w = crop_before_drag.w - (crop_rect.x - crop_before_drag.x);
 						crop_rect.h = crop_before_drag.h - (crop_rect.y - crop_before_drag.y);
@@ -313,7 +546,7 @@ void SendImagePopup::render(float time_delta) {
 				}
 			}
 
-			auto lr_clipper_pos = ImVec2{float(crop_rect.x+crop_rect.w)/original_image.width, float(crop_rect.y+crop_rect.h)/original_image.height};
+			auto lr_clipper_pos = ImVec2{float(crop_rect.x+crop_rect.w)/original_image->width, float(crop_rect.y+crop_rect.h)/original_image->height};
 			{ // crop lower right clipper
 				ImGui::SetCursorPos({
 					pre_img_curser.x + lr_clipper_pos.x * width - TEXT_BASE_HEIGHT,
@@ -324,11 +557,11 @@ void SendImagePopup::render(float time_delta) {
 				if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
 					if (dragging_last_frame_lr) {
 						auto drag_total = ImGui::GetMouseDragDelta();
-						drag_total.x = (drag_total.x / width) * original_image.width;
-						drag_total.y = (drag_total.y / height) * original_image.height;
+						drag_total.x = (drag_total.x / width) * original_image->width;
+						drag_total.y = (drag_total.y / height) * original_image->height;
 
-						crop_rect.w = std::min<float>(crop_before_drag.w + drag_total.x, original_image.width);
-						crop_rect.h = std::min<float>(crop_before_drag.h + drag_total.y, original_image.height);
+						crop_rect.w = std::min<float>(crop_before_drag.w + drag_total.x, original_image->width);
+						crop_rect.h = std::min<float>(crop_before_drag.h + drag_total.y, original_image->height);
 					} else {
 						if (ImGui::IsItemActive()) {
 							dragging_last_frame_lr = true;
@@ -342,7 +575,7 @@ void SendImagePopup::render(float time_delta) {
 			}
 
 			// sanitzie after tool
-			crop_rect = sanitizeCrop(crop_rect, original_image.width, original_image.height);
+			crop_rect = sanitizeCrop(crop_rect, original_image->width, original_image->height);
 
 			{ // 4 lines delimiting the crop result
 				ImU32 line_color = 0xffffffff;
@@ -412,14 +645,14 @@ void SendImagePopup::render(float time_delta) {
 
 			ImGui::SetCursorPos(post_img_curser);
 		} else {
-			crop_rect = sanitizeCrop(crop_rect, original_image.width, original_image.height);
+			crop_rect = sanitizeCrop(crop_rect, original_image->width, original_image->height);
 
 			// display cropped area
 			ImGui::Image(
 				preview_image.getID<ImTextureID>(),
 				ImVec2{static_cast<float>(width), static_cast<float>(height)},
-				ImVec2{float(crop_rect.x)/original_image.width, float(crop_rect.y)/original_image.height},
-				ImVec2{float(crop_rect.x+crop_rect.w)/original_image.width, float(crop_rect.y+crop_rect.h)/original_image.height}
+				ImVec2{float(crop_rect.x)/original_image->width, float(crop_rect.y)/original_image->height},
+				ImVec2{float(crop_rect.x+crop_rect.w)/original_image->width, float(crop_rect.y+crop_rect.h)/original_image->height}
 			);
 
 			// transparent crop button on image
@@ -440,7 +673,7 @@ void SendImagePopup::render(float time_delta) {
 		}
 	}
 
-	const bool cropped = crop_rect.x != 0 || crop_rect.y != 0 || crop_rect.w != int64_t(original_image.width) || crop_rect.h != int64_t(original_image.height);
+	const bool cropped = crop_rect.x != 0 || crop_rect.y != 0 || crop_rect.w != int64_t(original_image->width) || crop_rect.h != int64_t(original_image->height);
 	if (cropping) {
 		if (ImGui::Button("done")) {
 			cropping = false;
@@ -454,8 +687,8 @@ void SendImagePopup::render(float time_delta) {
 	if (ImGui::Button("reset##crop")) {
 		crop_rect.x = 0;
 		crop_rect.y = 0;
-		crop_rect.w = original_image.width;
-		crop_rect.h = original_image.height;
+		crop_rect.w = original_image->width;
+		crop_rect.h = original_image->height;
 		crop_before_drag = crop_rect;
 	}
 	ImGui::SameLine();
@@ -520,11 +753,33 @@ void SendImagePopup::render(float time_delta) {
 		ImGui::SetTooltip("required since cropped!");
 	}
 
-	static int current_compressor = 0;
-
 	if (compress) {
+		static constexpr const char* compressor_names[compressor_count] {
+			"webp",
+			"webp lossless",
+			"jpeg",
+			"png",
+			"qoi",
+			"qoi lossy",
+		};
+
+		// append the estimated size
+		std::array<std::string, compressor_count> compressor_labels;
+		std::array<const char*, compressor_count> compressor_items;
+		for (int i = 0; i < compressor_count; i++) {
+			compressor_labels[i] = compressor_names[i];
+			if (_estimated_sizes[i] != 0) {
+				const char* size_suffix {nullptr};
+				const int64_t size_divider = sizeToHumanReadable(_estimated_sizes[i], size_suffix);
+				char size_buf[32];
+				snprintf(size_buf, sizeof(size_buf), " (~%.1f %s)", double(_estimated_sizes[i]) / size_divider, size_suffix);
+				compressor_labels[i] += size_buf;
+			}
+			compressor_items[i] = compressor_labels[i].c_str();
+		}
+
 		ImGui::SameLine();
-		ImGui::Combo("##compression_type", &current_compressor, "webp\0webp lossless\0jpeg\0png\0qoi\0qoi lossy\0");
+		ImGui::Combo("##compression_type", &current_compressor, compressor_items.data(), compressor_count);
 
 		ImGui::Indent();
 		// combo "webp""webp-lossless""png""jpg?"
@@ -540,85 +795,70 @@ void SendImagePopup::render(float time_delta) {
 			recalc_size |= ImGui::SliderScalar("compression_level", ImGuiDataType_U32, &compression_level, &qmin, &qmax);
 		}
 
-		if (recalc_size) {
-			// compress and save temp? cooldown? async? save size only?
-			// print size where?
-		}
-
 		ImGui::Unindent();
-	}
 
-	//if (ImGui::Button("X cancel", {ImGui::GetWindowContentRegionWidth()/2.f, TEXT_BASE_HEIGHT*2})) {
-	if (ImGui::Button("X cancel", {ImGui::GetContentRegionAvail().x/2.f, TEXT_BASE_HEIGHT*2})) {
-		_on_cancel();
-		ImGui::CloseCurrentPopup();
-		reset();
+		// the estimate covers all compressors at the current settings,
+		// restart it once the settings stop changing
+		auto params = currentParams();
+		params.compressor = 0;
+		if (!(params == _last_params)) {
+			_last_params = params;
+			_last_params_change_ts = getTimeMS();
+			recalc_size = true;
+		}
+		_estimate_dirty |= recalc_size;
+
+		if (_estimate_dirty && !encoding && getTimeMS() - _last_params_change_ts >= 150) {
+			_estimate_dirty = false;
+			stopEstimate();
+			startEstimate();
+		}
 	}
-	ImGui::SameLine();
-	if (ImGui::Button("send ->", {-FLT_MIN, TEXT_BASE_HEIGHT*2})) {
-		if (compress || cropped || scale_x != 1.f || scale_y != 1.f) {
-			// TODO: copy bad
-			ImageLoaderI::ImageResult tmp_img;
-			if (cropped) {
-				tmp_img = original_image.crop(
-					crop_rect.x,
-					crop_rect.y,
-					crop_rect.w,
-					crop_rect.h
-				);
-			} else {
-				tmp_img = original_image;
-			}
 
-			if (scale_x != 1.f || scale_y != 1.f) {
-				tmp_img = tmp_img.scale(
-					(int)std::ceil(crop_rect.w*scale_x),
-					(int)std::ceil(crop_rect.h*scale_y)
-				);
-			}
+	ImGui::EndDisabled();
 
-			std::vector<uint8_t> new_data;
+	if (encoding) {
+		// aborts the encode, not the popup
+		if (ImGui::Button("X cancel", {ImGui::GetContentRegionAvail().x/2.f, TEXT_BASE_HEIGHT*2})) {
+			stopEncode();
+		}
+		ImGui::SameLine();
 
-			// HACK: generic list
-			if (current_compressor == 0) {
-				new_data = ImageEncoderWebP{}.encodeToMemoryRGBA(tmp_img, {{"quality", quality}});
-				if (!new_data.empty()) {
-					_on_send(new_data, ".webp");
-				}
-			} else if (current_compressor == 1) {
-				new_data = ImageEncoderWebP{}.encodeToMemoryRGBA(tmp_img, {{"compression_level", compression_level}});
-				if (!new_data.empty()) {
-					_on_send(new_data, ".webp");
-				}
-			} else if (current_compressor == 2) {
-				new_data = ImageEncoderSTBJpeg{}.encodeToMemoryRGBA(tmp_img, {{"quality", quality}});
-				if (!new_data.empty()) {
-					_on_send(new_data, ".jpg");
-				}
-			} else if (current_compressor == 3) {
-				new_data = ImageEncoderSTBPNG{}.encodeToMemoryRGBA(tmp_img, {{"png_compression_level", compression_level}});
-				if (!new_data.empty()) {
-					_on_send(new_data, ".png");
-				}
-			} else if (current_compressor == 4) {
-				new_data = ImageEncoderQOI{}.encodeToMemoryRGBA(tmp_img, {});
-				if (!new_data.empty()) {
-					_on_send(new_data, ".qoi");
-				}
-			} else if (current_compressor == 5) {
-				new_data = ImageEncoderQOI{}.encodeToMemoryRGBA(tmp_img, {{"quality", quality}});
-				if (!new_data.empty()) {
-					_on_send(new_data, ".qoi");
-				}
+		const char* stage_str = "encoding";
+		if (_encode_state->stage == EncodeState::Stage::crop) {
+			stage_str = "cropping";
+		} else if (_encode_state->stage == EncodeState::Stage::scale) {
+			stage_str = "scaling";
+		}
+		char overlay_buf[64];
+		snprintf(overlay_buf, sizeof(overlay_buf), "%s %.1fs", stage_str, (getTimeMS() - _encode_start_ts) / 1000.f);
+
+		// the encoders dont report progress
+		ImGui::ProgressBar(
+			-0.333f * ImGui::GetTime(),
+			{-FLT_MIN, TEXT_BASE_HEIGHT*2},
+			overlay_buf
+		);
+	} else {
+		//if (ImGui::Button("X cancel", {ImGui::GetWindowContentRegionWidth()/2.f, TEXT_BASE_HEIGHT*2})) {
+		if (ImGui::Button("X cancel", {ImGui::GetContentRegionAvail().x/2.f, TEXT_BASE_HEIGHT*2})) {
+			_on_cancel();
+			ImGui::CloseCurrentPopup();
+			reset();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("send ->", {-FLT_MIN, TEXT_BASE_HEIGHT*2})) {
+			if (compress || cropped || scale_x != 1.f || scale_y != 1.f) {
+				// result gets picked up in a later frame
+				stopEstimate();
+				_estimate_dirty = true;
+				startEncode();
+			} else {
+				_on_send(original_data, original_file_ext);
+				ImGui::CloseCurrentPopup();
+				reset();
 			}
-			// error
-
-		} else {
-			_on_send(original_data, original_file_ext);
 		}
-
-		ImGui::CloseCurrentPopup();
-		reset();
 	}
 
 	ImGui::EndPopup();
@@ -3,7 +3,11 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <future>
+#include <atomic>
+#include <array>
 #include <vector>
+#include <string>
 
 #include "../image_loader.hpp"
 #include "../texture_cache.hpp"
@@ -23,7 +27,8 @@ struct SendImagePopup {
 	bool original_raw {false};
 	std::string original_file_ext; // if !original_raw
 
-	ImageLoaderI::ImageResult original_image;
+	// shared with the encode and estimate jobs, never modified once loaded
+	std::shared_ptr<const ImageLoaderI::ImageResult> original_image;
 
 	struct Rect {
 		int32_t x {0};
@@ -47,9 +52,67 @@ struct SendImagePopup {
 	TextureEntry preview_image;
 
 	bool compress {false};
+	int current_compressor {0};
 	uint32_t quality {80u};
 	uint32_t compression_level {8u};
 
+	// what to do with original_image, snapshotted for the jobs
+	struct EncodeParams {
+		Rect crop;
+		bool cropped {false};
+		int32_t width {0}; // final size
+		int32_t height {0};
+		int compressor {0};
+		uint32_t quality {80u};
+		uint32_t compression_level {8u};
+
+		bool operator==(const EncodeParams& other) const;
+	};
+
+	// webp, webp lossless, jpeg, png, qoi, qoi lossy
+	static constexpr int compressor_count {6};
+
+	// send job, shared between the ui and the encode thread
+	struct EncodeState {
+		enum class Stage {
+			crop,
+			scale,
+			encode,
+		};
+		std::atomic<Stage> stage {Stage::crop};
+
+		std::atomic_bool done {false};
+		std::atomic_bool stop {false};
+
+		// only touch once done
+		std::vector<uint8_t> data; // empty on error or stop
+		const char* file_ext {nullptr};
+	};
+	std::shared_ptr<EncodeState> _encode_state;
+	std::future<void> _encode_future;
+	uint64_t _encode_start_ts {0}; // ms
+
+	// size estimate, done on a downscaled version of the first frame
+	struct EstimateState {
+		EncodeParams params;
+
+		std::atomic_bool done {false};
+		std::atomic_bool stop {false};
+
+		// only touch once done, 0 means failed
+		std::array<uint64_t, compressor_count> sizes {};
+	};
+	std::shared_ptr<EstimateState> _estimate_state;
+	std::future<void> _estimate_future;
+	std::array<uint64_t, compressor_count> _estimated_sizes {}; // last finished estimate, 0 means unknown
+	bool _estimate_dirty {true};
+	uint64_t _last_params_change_ts {0}; // ms
+	EncodeParams _last_params;
+
+	// jobs we stopped caring about, since we cant interrupt the encoders.
+	// they only hold on to their own state and get collected once done.
+	std::vector<std::future<void>> _abandoned_futures;
+
 	float time {0.f}; // cycling form 0 to 1 over time
 
 	bool _open_popup {false};
@@ -66,8 +129,20 @@ struct SendImagePopup {
 
 	static Rect sanitizeCrop(Rect crop_rect, int32_t image_width, int32_t image_height);
 
+	EncodeParams currentParams(void) const;
+
+	// returns empty on error, sets file_ext to eg ".webp"
+	static std::vector<uint8_t> encode(const ImageLoaderI::ImageResult& image, int compressor, uint32_t quality, uint32_t compression_level, const char*& file_ext);
+
+	void startEncode(void);
+	void stopEncode(void); // does not block
+	void startEstimate(void);
+	void stopEstimate(void); // does not block
+	void collectAbandoned(void);
+
 	public:
 		SendImagePopup(TextureUploaderI& tu, Theme& theme);
+		~SendImagePopup(void);
 
 		void sendMemory(
 			const uint8_t* data, size_t data_size,
@@ -30,22 +30,28 @@
 #include "./chat_gui/contact_info.hpp"
 #include "./chat_gui/contact_window.hpp"
 
+#include <algorithm>
 #include <string>
 
 ChatGui4::ChatGui4(
 	ConfigModelI& conf,
 	ObjectStore2& os,
 	RegistryMessageModelI& rmm,
+	UnreadIndex& unread,
+	MessageSearchIndex& msi,
 	ContactStore4Impl& cs,
 	TextureUploaderI& tu,
 	ContactTextureCache& contact_tc,
 	MessageTextureCache& msg_tc,
+	ImageCodecRegistry& icr,
 	Theme& theme
 ) :
 	_conf(conf),
 	_os(os),
 	_os_sr(_os.newSubRef(this)),
 	_rmm(rmm),
+	_unread(unread),
+	_msi(msi),
 	_cs(cs),
 	_tu(tu),
 	_contact_tc(contact_tc),
@@ -53,7 +59,7 @@ ChatGui4::ChatGui4(
 	_b_tc(_bil, tu),
 	_theme(theme),
 	_fss(theme),
-	_ivp(_msg_tc),
+	_ivp(_msg_tc, icr, tu),
 	_ciw(cs),
 	_cls(cs)
 {
@@ -75,6 +81,8 @@ float ChatGui4::render(float time_delta, bool window_hidden, bool window_focused
 		return 1000.f;
 	}
 
+	float interval {1000.f}; // TODO: higher min fps?
+
 	const ImGuiViewport* viewport = ImGui::GetMainViewport();
 	ImGui::SetNextWindowPos(viewport->WorkPos);
 	ImGui::SetNextWindowSize(viewport->WorkSize);
@@ -104,7 +112,7 @@ float ChatGui4::render(float time_delta, bool window_hidden, bool window_focused
 			_contact_stack.push(std::make_unique<ContactWindow>(
 				_cs, _rmm, _os,
 				_theme, _contact_tc, _msg_tc, _b_tc,
-				_ciw, _fss, _ivp, _cb, _tu,
+				_ciw, _fss, _msi, _ivp, _cb, _tu,
 				[this](ContactHandle4 new_c) {
 					_next_contact = new_c;
 				},
@@ -114,12 +122,16 @@ float ChatGui4::render(float time_delta, bool window_hidden, bool window_focused
 		}
 
 		if (_layout_strategy) {
-			_layout_strategy->render(*this, time_delta, window_focused);
+			interval = std::min(interval, _layout_strategy->render(*this, time_delta, window_focused));
 		}
 	}
 	ImGui::End();
 
-	return 1000.f; // TODO: higher min fps?
+	return interval;
+}
+
+void ChatGui4::openContact(Contact4 c) {
+	_next_contact = _cs.contactHandle(c);
 }
 
 void ChatGui4::sendFilePath(std::string_view file_path) {
@@ -160,13 +172,19 @@ void ChatGui4::renderContactList(float width) {
 
 		auto& cr = _cs.registry();
 
+		_contact_list_cache.update(
+			contact_const_runtime_view{}.iterate(cr.storage<Contact::Components::ContactSortTag>()),
+			_cls.generation()
+		);
+
 		if (::renderContactList(
 			_cs,
 			cr,
 			_rmm,
+			_unread,
 			_theme,
 			_contact_tc,
-			contact_const_runtime_view{}.iterate(cr.storage<Contact::Components::ContactSortTag>()),
+			_contact_list_cache,
 			_ciw,
 			selected_contact
 		)) {
@@ -176,7 +194,7 @@ void ChatGui4::renderContactList(float width) {
 			_contact_stack.push(std::make_unique<ContactWindow>(
 				_cs, _rmm, _os,
 				_theme, _contact_tc, _msg_tc, _b_tc,
-				_ciw, _fss, _ivp, _cb, _tu,
+				_ciw, _fss, _msi, _ivp, _cb, _tu,
 				[this](ContactHandle4 new_c) {
 					_next_contact = new_c;
 				},
@@ -9,6 +9,8 @@
 #include "./chat_gui/texture_cache_defs.hpp"
 #include "./chat_gui/layout_strategy.hpp"
 
+#include "./unread_index.hpp"
+#include "./message_search_index.hpp"
 #include "./texture_uploader.hpp"
 #include "./bitset_image_loader.hpp"
 #include "./sdl_clipboard_utils.hpp"
@@ -31,6 +33,8 @@ class ChatGui4 : public ObjectStoreEventI {
 	ObjectStore2& _os;
 	ObjectStoreEventProviderI::SubscriptionReference _os_sr;
 	RegistryMessageModelI& _rmm;
+	UnreadIndex& _unread;
+	MessageSearchIndex& _msi;
 	ContactStore4Impl& _cs;
 
 	TextureUploaderI& _tu;
@@ -45,6 +49,7 @@ class ChatGui4 : public ObjectStoreEventI {
 	ImageViewerPopup _ivp;
 	ContactInfoWindows _ciw;
 	ContactListSorter _cls;
+	ContactListCache _contact_list_cache;
 	Clipboard _cb;
 
 	// set to true if not hovered
@@ -65,10 +70,13 @@ class ChatGui4 : public ObjectStoreEventI {
 			ConfigModelI& conf,
 			ObjectStore2& os,
 			RegistryMessageModelI& rmm,
+			UnreadIndex& unread,
+			MessageSearchIndex& msi,
 			ContactStore4Impl& cs,
 			TextureUploaderI& tu,
 			ContactTextureCache& contact_tc,
 			MessageTextureCache& msg_tc,
+			ImageCodecRegistry& icr,
 			Theme& theme
 		);
 		~ChatGui4(void);
@@ -77,6 +85,9 @@ class ChatGui4 : public ObjectStoreEventI {
 		float render(float time_delta, bool window_hidden, bool window_focused);
 
 	public:
+		// opens the chat, as if it was selected in the contact list
+		void openContact(Contact4 c);
+
 		void sendFilePath(std::string_view file_path);
 		void sendFileList(const std::vector<std::string_view>& list);
 
@@ -183,8 +183,9 @@ DebugVideoTap::~DebugVideoTap(void) {
 }
 
 float DebugVideoTap::render(void) {
-	float min_interval {2.f};
 	auto& dvtsw = _tap.get<DebugVideoTapSink*>()->_writers;
+	// polls at the frame interval, frames get pushed from other threads
+	float min_interval {dvtsw.empty() ? 1000.f : 2.f};
 	for (auto& [view, stream] : dvtsw) {
 		std::string window_title {"DebugVideoTap #"};
 		window_title += std::to_string(view._id);
@@ -0,0 +1,266 @@
+#include "./audio_mixer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+AudioMixer::Input::Input(const Config& config) :
+	_out_sample_rate(config.sample_rate),
+	_out_channels(config.channels),
+	// 1s, if the mixer is not running
+	_max_buffer_samples(std::max<size_t>(
+		size_t(config.sample_rate) * config.channels,
+		size_t(config.sample_rate) * config.channels * config.block_ms * (config.latency_blocks + 2) / 1000
+	))
+{
+}
+
+int32_t AudioMixer::Input::size(void) {
+	return -1;
+}
+
+std::optional<AudioFrame2> AudioMixer::Input::pop(void) {
+	assert(false && "write only, the mixer reads directly");
+	return std::nullopt;
+}
+
+bool AudioMixer::Input::push(const AudioFrame2& value) {
+	const auto in = value.getSpan();
+	if (value.channels == 0 || value.sample_rate == 0 || in.size < value.channels) {
+		return true; // nothing to do
+	}
+
+	const size_t in_frames = in.size / value.channels;
+
+	std::lock_guard lg{_mutex};
+
+	if (_in_sample_rate != value.sample_rate || _in_channels != value.channels) {
+		_in_sample_rate = value.sample_rate;
+		_in_channels = value.channels;
+		_resample_pos = 1.0;
+		_resample_prev.assign(_out_channels, 0.f);
+	}
+
+	// channels first, so the resampler only sees output channels
+	_converted.resize(in_frames * _out_channels);
+	for (size_t f = 0; f < in_frames; f++) {
+		const int16_t* in_frame = in.ptr + f * _in_channels;
+		float* out_frame = _converted.data() + f * _out_channels;
+
+		if (_in_channels == _out_channels) {
+			for (size_t c = 0; c < _out_channels; c++) {
+				out_frame[c] = in_frame[c] / 32768.f;
+			}
+		} else if (_out_channels == 1) {
+			// downmix
+			float sum {0.f};
+			for (size_t c = 0; c < _in_channels; c++) {
+				sum += in_frame[c];
+			}
+			out_frame[0] = sum / (32768.f * _in_channels);
+		} else {
+			// mono gets duplicated, otherwise channels wrap around
+			for (size_t c = 0; c < _out_channels; c++) {
+				out_frame[c] = in_frame[c % _in_channels] / 32768.f;
+			}
+		}
+	}
+
+	if (_in_sample_rate == _out_sample_rate) {
+		_buffer.insert(_buffer.cend(), _converted.cbegin(), _converted.cend());
+	} else {
+		// linear interpolation
+		// position 0 is the last frame of the previous push, position k is _converted frame k-1
+		const double step = double(_in_sample_rate) / double(_out_sample_rate);
+		_buffer.reserve(_buffer.size() + size_t(in_frames / step + 2) * _out_channels);
+		while (_resample_pos < in_frames) {
+			const size_t i = size_t(_resample_pos);
+			const float t = float(_resample_pos - i);
+			const float* a = i == 0 ? _resample_prev.data() : _converted.data() + (i-1) * _out_channels;
+			const float* b = _converted.data() + i * _out_channels;
+			for (size_t c = 0; c < _out_channels; c++) {
+				_buffer.push_back(a[c] + (b[c] - a[c]) * t);
+			}
+			_resample_pos += step;
+		}
+		_resample_pos -= in_frames;
+		std::copy_n(_converted.cend() - _out_channels, _out_channels, _resample_prev.begin());
+	}
+
+	// the mixer stopped pulling, keep the newest
+	if (bufferedSamples() > _max_buffer_samples) {
+		const size_t excess = bufferedSamples() - _max_buffer_samples;
+		dropped_samples += excess;
+		consume(excess);
+		return false;
+	}
+
+	return true;
+}
+
+void AudioMixer::Input::consume(size_t samples) {
+	_buffer_read += samples;
+	assert(_buffer_read <= _buffer.size());
+
+	if (_buffer_read == _buffer.size()) {
+		_buffer.clear();
+		_buffer_read = 0;
+	} else if (_buffer_read >= 4096 && _buffer_read*2 >= _buffer.size()) {
+		// move the rest to the front once in a while
+		_buffer.erase(_buffer.cbegin(), _buffer.cbegin() + _buffer_read);
+		_buffer_read = 0;
+	}
+}
+
+AudioMixer::AudioMixer(void) : AudioMixer(Config{}) {
+}
+
+AudioMixer::AudioMixer(const Config& config) :
+	_config(config),
+	_block_frames(size_t(config.sample_rate) * config.block_ms / 1000)
+{
+	assert(_config.channels > 0);
+	assert(_block_frames > 0);
+	_mix.resize(_block_frames * _config.channels);
+}
+
+AudioMixer::~AudioMixer(void) {
+}
+
+std::shared_ptr<FrameStream2I<AudioFrame2>> AudioMixer::subscribeInput(void) {
+	std::lock_guard lg{_inputs_mutex};
+	return _inputs.emplace_back(std::make_shared<Input>(_config));
+}
+
+bool AudioMixer::unsubscribeInput(const std::shared_ptr<FrameStream2I<AudioFrame2>>& sub) {
+	std::lock_guard lg{_inputs_mutex};
+	for (auto it = _inputs.cbegin(); it != _inputs.cend(); it++) {
+		if (*it == sub) {
+			_inputs.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+std::shared_ptr<FrameStream2I<AudioFrame2>> AudioMixer::subscribeOutput(void) {
+	return _outputs.subscribe();
+}
+
+bool AudioMixer::unsubscribeOutput(const std::shared_ptr<FrameStream2I<AudioFrame2>>& sub) {
+	return _outputs.unsubscribe(sub);
+}
+
+std::vector<std::shared_ptr<AudioMixer::Input>> AudioMixer::inputs(void) {
+	std::lock_guard lg{_inputs_mutex};
+	return _inputs;
+}
+
+bool AudioMixer::mixBlock(void) {
+	const size_t block_samples = _block_frames * _config.channels;
+	const size_t latency_samples = block_samples * std::max<uint32_t>(1, _config.latency_blocks);
+
+	std::fill(_mix.begin(), _mix.end(), 0.f);
+
+	{
+		std::lock_guard lg{_inputs_mutex};
+		for (const auto& input : _inputs) {
+			std::lock_guard lg_input{input->_mutex};
+
+			const size_t available = input->bufferedSamples();
+
+			if (input->_buffering) {
+				if (available < latency_samples) {
+					input->peak = 0.f;
+					input->rms = 0.f;
+					continue;
+				}
+				input->_buffering = false;
+			}
+
+			if (available < block_samples) {
+				// ran dry, fill up to the latency again
+				input->underruns++;
+				input->_buffering = true;
+				input->peak = 0.f;
+				input->rms = 0.f;
+				continue;
+			}
+
+			// the sender runs faster than we do (or sent a burst), cut back to the latency.
+			// one block of slack for jitter
+			if (available > latency_samples + block_samples) {
+				const size_t excess = available - latency_samples;
+				input->dropped_samples += excess;
+				input->consume(excess);
+			}
+
+			const float input_gain = input->gain;
+			const float* samples = input->_buffer.data() + input->_buffer_read;
+
+			float input_peak {0.f};
+			float input_square_sum {0.f};
+			if (input->mute) {
+				for (size_t i = 0; i < block_samples; i++) {
+					const float v = samples[i] * input_gain;
+					input_peak = std::max(input_peak, std::abs(v));
+					input_square_sum += v * v;
+				}
+			} else {
+				for (size_t i = 0; i < block_samples; i++) {
+					const float v = samples[i] * input_gain;
+					input_peak = std::max(input_peak, std::abs(v));
+					input_square_sum += v * v;
+					_mix[i] += v;
+				}
+			}
+
+			input->consume(block_samples);
+
+			input->peak = input_peak;
+			input->rms = std::sqrt(input_square_sum / block_samples);
+		}
+	}
+
+	const float master_gain = gain;
+	const float threshold = _config.soft_clip_threshold;
+
+	std::vector<int16_t> out(block_samples);
+	float out_peak {0.f};
+	uint64_t clipped {0};
+	for (size_t i = 0; i < block_samples; i++) {
+		float v = _mix[i] * master_gain;
+		if (std::abs(v) > threshold) {
+			clipped++;
+			v = softClip(v, threshold);
+		}
+		out_peak = std::max(out_peak, std::abs(v));
+		out[i] = int16_t(std::lrint(v * 32767.f));
+	}
+
+	peak = out_peak;
+	clipped_samples += clipped;
+	blocks_mixed++;
+
+	return _outputs.push(AudioFrame2{
+		_config.sample_rate,
+		_config.channels,
+		std::move(out),
+	});
+}
+
+float AudioMixer::softClip(float x, float threshold) {
+	const float knee = 1.f - threshold;
+	if (knee <= 0.f) {
+		return std::clamp(x, -1.f, 1.f);
+	}
+
+	const float a = std::abs(x);
+	if (a <= threshold) {
+		return x;
+	}
+
+	// tanh above the threshold, continuous in value and slope, never reaches 1
+	return std::copysign(threshold + knee * std::tanh((a - threshold) / knee), x);
+}
+
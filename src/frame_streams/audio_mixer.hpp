@@ -0,0 +1,142 @@
+#pragma once
+
+#include "./audio_stream2.hpp"
+#include "./multi_source.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// mixes N audio inputs into one output stream
+// inputs get converted to the output rate and channel count on push
+// (so on the pushing thread), mixing happens in fixed size blocks
+// with a fixed latency of latency_blocks blocks per input.
+// mixBlock() has to be called once per block interval by the owner.
+struct AudioMixer {
+	struct Config {
+		uint32_t sample_rate {48'000};
+		size_t channels {1};
+		uint32_t block_ms {20};
+
+		// each input buffers this many blocks before it plays,
+		// and gets cut back to it if it runs ahead (clock drift)
+		uint32_t latency_blocks {2};
+
+		// above this (linear), samples get bent towards 1.0 instead of hard clipping
+		float soft_clip_threshold {0.7f};
+	};
+
+	struct Input : public FrameStream2I<AudioFrame2> {
+		// controls, can be set from any thread
+		std::atomic<float> gain {1.f}; // linear
+		std::atomic_bool mute {false};
+
+		// meters, written by mixBlock()
+		// levels are after gain, but before mute, so a muted input still shows activity
+		std::atomic<float> peak {0.f}; // linear, of the last block
+		std::atomic<float> rms {0.f}; // linear, of the last block
+		std::atomic_uint64_t underruns {0};
+		std::atomic_uint64_t dropped_samples {0}; // by latency correction or overflow
+
+		Input(const Config& config);
+		~Input(void) {}
+
+		int32_t size(void) override;
+
+		// the mixer reads from the buffer directly
+		std::optional<AudioFrame2> pop(void) override;
+
+		// converts and appends, returns false if the buffer overflowed
+		bool push(const AudioFrame2& value) override;
+
+		protected:
+			friend struct AudioMixer;
+
+			const uint32_t _out_sample_rate;
+			const size_t _out_channels;
+			const size_t _max_buffer_samples;
+
+			std::mutex _mutex;
+
+			// output rate and channels, interleaved, [_buffer_read, size()) is valid
+			std::vector<float> _buffer;
+			size_t _buffer_read {0};
+
+			// waiting for latency_blocks of samples before playing (again)
+			bool _buffering {true};
+
+			// linear resampler state, reset on input format change
+			uint32_t _in_sample_rate {0};
+			size_t _in_channels {0};
+			double _resample_pos {1.0}; // in input frames, 0 is _resample_prev
+			std::vector<float> _resample_prev; // last input frame, output channels
+			std::vector<float> _converted; // reused
+
+			size_t bufferedSamples(void) const { return _buffer.size() - _buffer_read; }
+			void consume(size_t samples);
+	};
+
+	const Config _config;
+	const size_t _block_frames;
+
+	std::mutex _inputs_mutex;
+	std::vector<std::shared_ptr<Input>> _inputs;
+
+	FrameStream2MultiSource<AudioFrame2> _outputs;
+
+	// master controls and meters
+	std::atomic<float> gain {1.f};
+	std::atomic<float> peak {0.f}; // after soft clipping
+	std::atomic_uint64_t clipped_samples {0}; // hit the soft clipper
+	std::atomic_uint64_t blocks_mixed {0};
+
+	// reused by mixBlock()
+	std::vector<float> _mix;
+
+	AudioMixer(void);
+	AudioMixer(const Config& config);
+	~AudioMixer(void);
+
+	const Config& config(void) const { return _config; }
+
+	std::shared_ptr<FrameStream2I<AudioFrame2>> subscribeInput(void);
+	bool unsubscribeInput(const std::shared_ptr<FrameStream2I<AudioFrame2>>& sub);
+
+	std::shared_ptr<FrameStream2I<AudioFrame2>> subscribeOutput(void);
+	bool unsubscribeOutput(const std::shared_ptr<FrameStream2I<AudioFrame2>>& sub);
+
+	// copy of the current inputs, eg for ui
+	std::vector<std::shared_ptr<Input>> inputs(void);
+
+	// mixes one block from all inputs and pushes it to all outputs
+	// returns false if there was nothing to push to
+	bool mixBlock(void);
+
+	static float softClip(float x, float threshold);
+};
+
+// stream graph adapters, both refer to the same mixer
+// (sink and source interfaces cant be implemented by the same type)
+
+struct AudioMixerSink : public FrameStream2SinkI<AudioFrame2> {
+	AudioMixer& _mixer;
+
+	AudioMixerSink(AudioMixer& mixer) : _mixer(mixer) {}
+	~AudioMixerSink(void) {}
+
+	std::shared_ptr<FrameStream2I<AudioFrame2>> subscribe(void) override { return _mixer.subscribeInput(); }
+	bool unsubscribe(const std::shared_ptr<FrameStream2I<AudioFrame2>>& sub) override { return _mixer.unsubscribeInput(sub); }
+};
+
+struct AudioMixerSource : public FrameStream2SourceI<AudioFrame2> {
+	AudioMixer& _mixer;
+
+	AudioMixerSource(AudioMixer& mixer) : _mixer(mixer) {}
+	~AudioMixerSource(void) {}
+
+	std::shared_ptr<FrameStream2I<AudioFrame2>> subscribe(void) override { return _mixer.subscribeOutput(); }
+	bool unsubscribe(const std::shared_ptr<FrameStream2I<AudioFrame2>>& sub) override { return _mixer.unsubscribeOutput(sub); }
+};
+
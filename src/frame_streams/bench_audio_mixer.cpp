@@ -0,0 +1,143 @@
+// mixes synthetic inputs and prints cpu time per 20ms block.
+// inputs cycle through 48k mono, 44.1k stereo and 16k mono,
+// so conversion and resampling are part of the numbers.
+// usage: bench_audio_mixer [blocks] [output channels]
+
+#include "./audio_mixer.hpp"
+#include "../bench_support.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+struct InputSignal {
+	uint32_t sample_rate;
+	size_t channels;
+	float frequency; // hz
+	double phase {0.0};
+
+	AudioFrame2 next(uint32_t ms) {
+		std::vector<int16_t> samples(size_t(sample_rate) * ms / 1000 * channels);
+		for (size_t f = 0; f < samples.size() / channels; f++) {
+			const auto v = int16_t(std::sin(phase) * 12'000.0);
+			for (size_t c = 0; c < channels; c++) {
+				samples[f * channels + c] = v;
+			}
+			phase += 2.0 * 3.14159265358979 * frequency / sample_rate;
+		}
+		return AudioFrame2{sample_rate, channels, std::move(samples)};
+	}
+};
+
+static void benchMixer(size_t input_count, int blocks, size_t out_channels) {
+	AudioMixer::Config config;
+	config.channels = out_channels;
+	AudioMixer mixer{config};
+
+	std::vector<InputSignal> signals;
+	std::vector<std::shared_ptr<FrameStream2I<AudioFrame2>>> inputs;
+	for (size_t i = 0; i < input_count; i++) {
+		switch (i % 3) {
+			case 0: signals.push_back({48'000, 1, 220.f + i * 10.f}); break;
+			case 1: signals.push_back({44'100, 2, 330.f + i * 10.f}); break;
+			default: signals.push_back({16'000, 1, 440.f + i * 10.f}); break;
+		}
+		inputs.push_back(mixer.subscribeInput());
+		std::static_pointer_cast<AudioMixer::Input>(inputs.back())->gain = 1.f / input_count * 2.f;
+	}
+	auto output = mixer.subscribeOutput();
+
+	// fill up to the latency, so every block mixes all inputs
+	for (uint32_t i = 0; i < config.latency_blocks; i++) {
+		for (size_t j = 0; j < input_count; j++) {
+			inputs[j]->push(signals[j].next(config.block_ms));
+		}
+	}
+
+	std::vector<double> push_times; // us
+	std::vector<double> mix_times; // us
+	push_times.reserve(blocks);
+	mix_times.reserve(blocks);
+
+	size_t out_samples {0};
+	for (int i = 0; i < blocks; i++) {
+		// generating the input is not part of the measurement
+		std::vector<AudioFrame2> frames;
+		frames.reserve(input_count);
+		for (auto& signal : signals) {
+			frames.push_back(signal.next(config.block_ms));
+		}
+
+		const auto push_start = std::chrono::steady_clock::now();
+		for (size_t j = 0; j < input_count; j++) {
+			inputs[j]->push(frames[j]);
+		}
+		const auto mix_start = std::chrono::steady_clock::now();
+		mixer.mixBlock();
+		const auto mix_end = std::chrono::steady_clock::now();
+
+		while (auto frame_opt = output->pop()) {
+			out_samples += frame_opt.value().getSpan().size;
+		}
+
+		push_times.push_back(std::chrono::duration<double, std::micro>(mix_start - push_start).count());
+		mix_times.push_back(std::chrono::duration<double, std::micro>(mix_end - mix_start).count());
+	}
+
+	uint64_t underruns {0};
+	uint64_t dropped {0};
+	for (const auto& input : mixer.inputs()) {
+		underruns += input->underruns;
+		dropped += input->dropped_samples;
+	}
+
+	double push_sum {0.0};
+	double mix_sum {0.0};
+	for (int i = 0; i < blocks; i++) {
+		push_sum += push_times[i];
+		mix_sum += mix_times[i];
+	}
+
+	std::sort(push_times.begin(), push_times.end());
+	std::sort(mix_times.begin(), mix_times.end());
+
+	const double block_us = config.block_ms * 1000.0;
+	const double total_mean = (push_sum + mix_sum) / blocks;
+	std::cout
+		<< "inputs: " << input_count
+		<< " convert mean: " << push_sum / blocks << "us"
+		<< " p99: " << percentile(push_times, 99) << "us"
+		<< " mix mean: " << mix_sum / blocks << "us"
+		<< " p99: " << percentile(mix_times, 99) << "us"
+		<< " total: " << total_mean << "us"
+		<< " (" << total_mean / block_us * 100.0 << "% of a " << config.block_ms << "ms block)"
+		<< " out: " << out_samples / out_channels / (config.sample_rate / 1000) << "ms"
+		<< " underruns: " << underruns
+		<< " dropped: " << dropped
+		<< " clipped: " << mixer.clipped_samples
+		<< "\n"
+	;
+}
+
+int main(int argc, char** argv) {
+	int blocks = 2000;
+	if (argc > 1) {
+		blocks = std::max(1, std::atoi(argv[1]));
+	}
+
+	size_t out_channels = 1;
+	if (argc > 2) {
+		out_channels = std::clamp(std::atoi(argv[2]), 1, 8);
+	}
+
+	for (const size_t count : {2, 8, 32}) {
+		benchMixer(count, blocks, out_channels);
+	}
+
+	return 0;
+}
+
@@ -1,5 +1,7 @@
 #include "./sdl_video_frame_stream2.hpp"
 
+#include "../../trace.hpp"
+
 #include <chrono>
 #include <algorithm>
 
@@ -130,6 +132,8 @@ std::shared_ptr<FrameStream2I<SDLVideoFrame>> SDLVideo2InputDevice::subscribe(vo
 		}
 
 		_thread = std::thread([this, camera = std::move(camera)](void) {
+			Trace::setThreadName("camera");
+
 			bool use_chrono_fallback = false;
 			Uint64 last_timestampUS = 0;
 
@@ -169,8 +173,11 @@ std::shared_ptr<FrameStream2I<SDLVideoFrame>> SDLVideo2InputDevice::subscribe(vo
 						sdl_frame_next
 					};
 
-					// creates surface copies
-					push(new_frame_non_owning);
+					{
+						TRACE_ZONE("camera push");
+						// creates surface copies
+						push(new_frame_non_owning);
+					}
 
 
 					last_timestampUS = timestampUS_correct;
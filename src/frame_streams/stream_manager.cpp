@@ -1,5 +1,7 @@
 #include "./stream_manager.hpp"
 
+#include "../trace.hpp"
+
 StreamManager::Connection::Connection(
 	ObjectHandle src_,
 	ObjectHandle sink_,
@@ -18,8 +20,12 @@ StreamManager::Connection::Connection(
 	if (!on_main_thread) {
 		// start thread
 		pump_thread = std::thread([this](void) {
+			Trace::setThreadName("frame pump");
 			while (!stop) {
-				pump_fn(*this);
+				{
+					TRACE_ZONE("frame pump");
+					pump_fn(*this);
+				}
 				std::this_thread::sleep_for(std::chrono::milliseconds(5));
 			}
 			finished = true;
@@ -126,7 +132,10 @@ float StreamManager::tick(float) {
 		}
 
 		if (con.on_main_thread) {
-			con.pump_fn(con);
+			{
+				TRACE_ZONE("frame pump");
+				con.pump_fn(con);
+			}
 			const float con_interval = con.interval_avg;
 			if (con_interval > 0.f) {
 				interval_min = std::min(interval_min, con_interval);
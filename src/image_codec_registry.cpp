@@ -0,0 +1,192 @@
+#include "./image_codec_registry.hpp"
+
+#include "./image_loader_qoi.hpp"
+#include "./image_loader_sdl_bmp.hpp"
+#include "./image_loader_webp.hpp"
+#include "./image_loader_sdl_image.hpp"
+
+#include <chrono>
+#include <cstring>
+
+ImageCodecRegistry::Format ImageCodecRegistry::sniff(const uint8_t* data, uint64_t data_size) {
+	if (data == nullptr) {
+		return Format::unknown;
+	}
+
+	if (data_size >= 4 && std::memcmp(data, "qoif", 4) == 0) {
+		return Format::qoi;
+	}
+
+	if (data_size >= 12 && std::memcmp(data, "RIFF", 4) == 0 && std::memcmp(data+8, "WEBP", 4) == 0) {
+		return Format::webp;
+	}
+
+	static constexpr uint8_t png_sig[8] {0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a};
+	if (data_size >= 8 && std::memcmp(data, png_sig, 8) == 0) {
+		return Format::png;
+	}
+
+	if (data_size >= 3 && data[0] == 0xff && data[1] == 0xd8 && data[2] == 0xff) {
+		return Format::jpg;
+	}
+
+	if (data_size >= 6 && (std::memcmp(data, "GIF87a", 6) == 0 || std::memcmp(data, "GIF89a", 6) == 0)) {
+		return Format::gif;
+	}
+
+	// 2 bytes is a weak magic, so check the file header is plausible
+	if (data_size >= 14+4 && data[0] == 'B' && data[1] == 'M' && data[6] == 0 && data[7] == 0 && data[8] == 0 && data[9] == 0) {
+		return Format::bmp;
+	}
+
+	return Format::other;
+}
+
+const char* ImageCodecRegistry::formatName(Format format) {
+	switch (format) {
+		case Format::unknown: return "unknown";
+		case Format::qoi: return "qoi";
+		case Format::bmp: return "bmp";
+		case Format::webp: return "webp";
+		case Format::png: return "png";
+		case Format::jpg: return "jpg";
+		case Format::gif: return "gif";
+		case Format::other: return "other";
+		case Format::MAX: break;
+	}
+	return "invalid";
+}
+
+ImageCodecRegistry::ImageCodecRegistry(void) {
+	auto& il_qoi = _image_loaders.emplace_back(std::make_unique<ImageLoaderQOI>());
+	auto& il_bmp = _image_loaders.emplace_back(std::make_unique<ImageLoaderSDLBMP>());
+	auto& il_webp = _image_loaders.emplace_back(std::make_unique<ImageLoaderWebP>());
+	auto& il_sdl_image = _image_loaders.emplace_back(std::make_unique<ImageLoaderSDLImage>());
+
+	_format_loaders[static_cast<size_t>(Format::qoi)] = il_qoi.get();
+	_format_loaders[static_cast<size_t>(Format::bmp)] = il_bmp.get();
+	_format_loaders[static_cast<size_t>(Format::webp)] = il_webp.get();
+	_format_loaders[static_cast<size_t>(Format::png)] = il_sdl_image.get();
+	_format_loaders[static_cast<size_t>(Format::jpg)] = il_sdl_image.get();
+	_format_loaders[static_cast<size_t>(Format::gif)] = il_sdl_image.get();
+}
+
+ImageLoaderI::ImageInfo ImageCodecRegistry::loadInfoFromHeader(const uint8_t* data, uint64_t data_size, Format& format) {
+	if (format == Format::unknown) {
+		format = sniff(data, data_size);
+	}
+
+	// no trial and error here, the caller falls back to loadInfoFromMemory()
+	auto* il = _format_loaders.at(static_cast<size_t>(format));
+	if (il == nullptr) {
+		return {};
+	}
+
+	auto res = il->loadInfoFromHeader(data, data_size);
+	if (res.width != 0 && res.height != 0) {
+		stats(format).info++;
+	}
+	return res;
+}
+
+ImageLoaderI::ImageInfo ImageCodecRegistry::loadInfoFromMemory(const uint8_t* data, uint64_t data_size, Format& format) {
+	if (format == Format::unknown) {
+		format = sniff(data, data_size);
+	}
+
+	auto* il = _format_loaders.at(static_cast<size_t>(format));
+	if (il != nullptr) {
+		auto res = il->loadInfoFromMemory(data, data_size);
+		if (res.width != 0 && res.height != 0) {
+			stats(format).info++;
+			return res;
+		}
+		stats(format).info_failed++;
+	}
+
+	// sniffed wrong or not sniffable, try the rest
+	for (auto& il_it : _image_loaders) {
+		if (il_it.get() == il) {
+			continue;
+		}
+
+		auto res = il_it->loadInfoFromMemory(data, data_size);
+		if (res.width == 0 || res.height == 0) {
+			continue;
+		}
+
+		format = Format::other;
+		stats(format).info++;
+		return res;
+	}
+
+	stats(Format::other).info_failed++;
+	return {};
+}
+
+ImageLoaderI::ImageResult ImageCodecRegistry::loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size, Format& format) {
+	if (format == Format::unknown) {
+		format = sniff(data, data_size);
+	}
+
+	const auto timed_decode = [data, data_size](ImageLoaderI& il, Stats& s) -> ImageLoaderI::ImageResult {
+		const auto start = std::chrono::steady_clock::now();
+		auto res = il.loadFromMemoryRGBA(data, data_size);
+		const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+		if (res.frames.empty() || res.width == 0 || res.height == 0) {
+			s.decodes_failed++;
+			return {};
+		}
+
+		s.decodes++;
+		s.decode_time_us += duration.count();
+		s.bytes_in += data_size;
+		s.bytes_out += uint64_t(res.width) * res.height * 4 * res.frames.size();
+		return res;
+	};
+
+	auto* il = _format_loaders.at(static_cast<size_t>(format));
+	if (il != nullptr) {
+		auto res = timed_decode(*il, stats(format));
+		if (!res.frames.empty()) {
+			return res;
+		}
+	}
+
+	// sniffed wrong or not sniffable, try the rest
+	for (auto& il_it : _image_loaders) {
+		if (il_it.get() == il) {
+			continue;
+		}
+
+		auto res = timed_decode(*il_it, stats(Format::other));
+		if (res.frames.empty()) {
+			continue;
+		}
+
+		format = Format::other;
+		return res;
+	}
+
+	return {};
+}
+
+std::unique_ptr<ImageLoaderI::FrameDecoderI> ImageCodecRegistry::newFrameDecoder(const uint8_t* data, uint64_t data_size, Format& format) {
+	if (format == Format::unknown) {
+		format = sniff(data, data_size);
+	}
+
+	auto* il = _format_loaders.at(static_cast<size_t>(format));
+	if (il == nullptr) {
+		return nullptr;
+	}
+
+	auto dec = il->newFrameDecoder(data, data_size);
+	if (dec) {
+		// frames are not counted, they get decoded over time
+		stats(format).decodes++;
+		stats(format).bytes_in += data_size;
+	}
+	return dec;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "./image_loader.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// shared set of image loaders.
+// the format is sniffed from the magic bytes and the data is handed straight
+// to the matching loader, instead of trying each loader in turn.
+// only formats we cant sniff go through all loaders.
+class ImageCodecRegistry {
+	public:
+		enum class Format : uint8_t {
+			unknown = 0, // not sniffed yet
+			qoi,
+			bmp,
+			webp,
+			png,
+			jpg,
+			gif,
+			other, // not sniffable, found by trying all loaders
+
+			MAX
+		};
+
+		// only looks at the first few bytes
+		static Format sniff(const uint8_t* data, uint64_t data_size);
+		static const char* formatName(Format format);
+
+		// can be read from any thread
+		struct Stats {
+			std::atomic_uint64_t info {0};
+			std::atomic_uint64_t info_failed {0};
+			std::atomic_uint64_t decodes {0};
+			std::atomic_uint64_t decodes_failed {0};
+			std::atomic_uint64_t bytes_in {0};
+			std::atomic_uint64_t bytes_out {0}; // decoded rgba
+			std::atomic_uint64_t decode_time_us {0};
+		};
+
+	private:
+		// in fallback order
+		std::vector<std::unique_ptr<ImageLoaderI>> _image_loaders;
+		std::array<ImageLoaderI*, static_cast<size_t>(Format::MAX)> _format_loaders {};
+		std::array<Stats, static_cast<size_t>(Format::MAX)> _stats;
+
+		Stats& stats(Format format) { return _stats.at(static_cast<size_t>(format)); }
+
+	public:
+		ImageCodecRegistry(void);
+
+		// format is in/out, pass the cached format or unknown.
+		// unknown gets sniffed, and is set to the format that succeeded.
+		ImageLoaderI::ImageInfo loadInfoFromHeader(const uint8_t* data, uint64_t data_size, Format& format);
+		ImageLoaderI::ImageInfo loadInfoFromMemory(const uint8_t* data, uint64_t data_size, Format& format);
+		ImageLoaderI::ImageResult loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size, Format& format);
+
+		// only the sniffed loader is asked, returns nullptr if it cant stream the data.
+		// callers fall back to loadFromMemoryRGBA()
+		std::unique_ptr<ImageLoaderI::FrameDecoderI> newFrameDecoder(const uint8_t* data, uint64_t data_size, Format& format);
+
+		const Stats& getStats(Format format) const { return _stats.at(static_cast<size_t>(format)); }
+};
+
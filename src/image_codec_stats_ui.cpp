@@ -0,0 +1,99 @@
+#include "./image_codec_stats_ui.hpp"
+
+#include "./string_formatter_utils.hpp"
+
+#include <imgui.h>
+
+#include <cinttypes>
+
+ImageCodecStatsUI::ImageCodecStatsUI(const ImageCodecRegistry& icr) : _icr(icr) {
+}
+
+void ImageCodecStatsUI::render(void) {
+	{ // main window menubar injection
+		// assumes the window "tomato" was rendered already by cg
+		if (ImGui::Begin("tomato")) {
+			if (ImGui::BeginMenuBar()) {
+				if (ImGui::BeginMenu("Performance")) {
+					ImGui::SeparatorText("Images");
+					if (ImGui::MenuItem("Image codec stats", nullptr, _show_window)) {
+						_show_window = !_show_window;
+					}
+					ImGui::EndMenu();
+				}
+				ImGui::EndMenuBar();
+			}
+		}
+		ImGui::End();
+	}
+
+	if (!_show_window) {
+		return;
+	}
+
+	if (ImGui::Begin("Image codec stats", &_show_window)) {
+		constexpr ImGuiTableFlags table_flags =
+			ImGuiTableFlags_SizingFixedFit |
+			ImGuiTableFlags_BordersInnerV |
+			ImGuiTableFlags_RowBg
+		;
+		if (ImGui::BeginTable("codec_stats", 7, table_flags)) {
+			ImGui::TableSetupColumn("format");
+			ImGui::TableSetupColumn("info");
+			ImGui::TableSetupColumn("decodes");
+			ImGui::TableSetupColumn("failed");
+			ImGui::TableSetupColumn("in");
+			ImGui::TableSetupColumn("out (rgba)");
+			ImGui::TableSetupColumn("avg time");
+
+			ImGui::TableHeadersRow();
+
+			for (size_t i = 1; i < static_cast<size_t>(ImageCodecRegistry::Format::MAX); i++) {
+				const auto format = static_cast<ImageCodecRegistry::Format>(i);
+				const auto& stats = _icr.getStats(format);
+
+				const uint64_t decodes = stats.decodes;
+				const uint64_t bytes_in = stats.bytes_in;
+				const uint64_t bytes_out = stats.bytes_out;
+				const uint64_t decode_time_us = stats.decode_time_us;
+
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(ImageCodecRegistry::formatName(format));
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%" PRIu64 " (%" PRIu64 " failed)", stats.info.load(), stats.info_failed.load());
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%" PRIu64, decodes);
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%" PRIu64, stats.decodes_failed.load());
+
+				ImGui::TableNextColumn();
+				{
+					const char* byte_suffix = "???";
+					int64_t byte_divider = sizeToHumanReadable(bytes_in, byte_suffix);
+					ImGui::Text("%.2f %s", double(bytes_in)/byte_divider, byte_suffix);
+				}
+
+				ImGui::TableNextColumn();
+				{
+					const char* byte_suffix = "???";
+					int64_t byte_divider = sizeToHumanReadable(bytes_out, byte_suffix);
+					ImGui::Text("%.2f %s", double(bytes_out)/byte_divider, byte_suffix);
+				}
+
+				ImGui::TableNextColumn();
+				if (decodes > 0) {
+					ImGui::Text("%.2f ms", double(decode_time_us)/decodes/1000.);
+				} else {
+					ImGui::TextDisabled("---");
+				}
+			}
+
+			ImGui::EndTable();
+		}
+	}
+	ImGui::End();
+}
+
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "./image_codec_registry.hpp"
+
+class ImageCodecStatsUI {
+	const ImageCodecRegistry& _icr;
+
+	bool _show_window {false};
+
+	public:
+		ImageCodecStatsUI(const ImageCodecRegistry& icr);
+
+		void render(void);
+};
+
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -15,6 +16,16 @@ struct ImageLoaderI {
 	};
 	virtual ImageInfo loadInfoFromMemory(const uint8_t* data, uint64_t data_size) = 0;
 
+	// how much of the start of a file to hand to loadInfoFromHeader()
+	static constexpr uint64_t header_probe_size {16*1024};
+	// like loadInfoFromMemory(), but only gets the first (up to header_probe_size) bytes of the file.
+	// returns 0 dims if the info can not be determined from that alone,
+	// in which case callers should fall back to loadInfoFromMemory() with all the data.
+	virtual ImageInfo loadInfoFromHeader(const uint8_t* data, uint64_t data_size) {
+		(void)data; (void)data_size;
+		return {};
+	}
+
 	struct ImageResult final {
 		uint32_t width {0};
 		uint32_t height {0};
@@ -32,6 +43,27 @@ struct ImageLoaderI {
 		ImageResult scale(int32_t w, int32_t h) const;
 	};
 	virtual ImageResult loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) = 0;
+
+	// decodes an animation one frame at a time, instead of all at once.
+	// keeps its own copy of the (compressed) data.
+	struct FrameDecoderI {
+		virtual ~FrameDecoderI(void) {}
+
+		uint32_t width {0};
+		uint32_t height {0};
+
+		// decodes the next frame, rgba.
+		// returns false after the last frame or on error
+		virtual bool next(ImageResult::Frame& frame_out) = 0;
+
+		// back to the first frame
+		virtual bool rewind(void) = 0;
+	};
+	// returns nullptr if this loader can not stream the data (eg not an animation)
+	virtual std::unique_ptr<FrameDecoderI> newFrameDecoder(const uint8_t* data, uint64_t data_size) {
+		(void)data; (void)data_size;
+		return nullptr;
+	}
 };
 
 struct ImageEncoderI {
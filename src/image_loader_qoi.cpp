@@ -87,6 +87,39 @@ ImageLoaderQOI::ImageInfo ImageLoaderQOI::loadInfoFromMemory(const uint8_t* data
 	return res;
 }
 
+ImageLoaderQOI::ImageInfo ImageLoaderQOI::loadInfoFromHeader(const uint8_t* data, uint64_t data_size) {
+	ImageInfo res;
+
+	// magic, width (be32), height (be32), channels, colorspace
+	if (data_size < QOI_HEADER_SIZE) {
+		return res;
+	}
+
+	if (
+		data[0] != 'q' ||
+		data[1] != 'o' ||
+		data[2] != 'i' ||
+		data[3] != 'f'
+	) {
+		return res;
+	}
+
+	const uint32_t width = uint32_t(data[4]) << 24 | uint32_t(data[5]) << 16 | uint32_t(data[6]) << 8 | uint32_t(data[7]);
+	const uint32_t height = uint32_t(data[8]) << 24 | uint32_t(data[9]) << 16 | uint32_t(data[10]) << 8 | uint32_t(data[11]);
+	const uint8_t channels = data[12];
+	const uint8_t colorspace = data[13];
+
+	if (width == 0 || height == 0 || (channels != 3 && channels != 4) || colorspace > 1) {
+		return res;
+	}
+
+	res.width = width;
+	res.height = height;
+	res.file_ext = "qoi";
+
+	return res;
+}
+
 ImageLoaderQOI::ImageResult ImageLoaderQOI::loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) {
 	ImageResult res;
 
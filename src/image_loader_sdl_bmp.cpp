@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstdint>
 
 ImageLoaderSDLBMP::ImageInfo ImageLoaderSDLBMP::loadInfoFromMemory(const uint8_t* data, uint64_t data_size) {
 	ImageInfo res;
@@ -28,6 +29,44 @@ ImageLoaderSDLBMP::ImageInfo ImageLoaderSDLBMP::loadInfoFromMemory(const uint8_t
 	return res;
 }
 
+ImageLoaderSDLBMP::ImageInfo ImageLoaderSDLBMP::loadInfoFromHeader(const uint8_t* data, uint64_t data_size) {
+	ImageInfo res;
+
+	// file header (14) + dib header size (4) + core dims
+	if (data_size < 14+4+4 || data[0] != 'B' || data[1] != 'M') {
+		return res;
+	}
+
+	const auto le16 = [data](size_t pos) -> uint32_t {
+		return uint32_t(data[pos]) | uint32_t(data[pos+1]) << 8;
+	};
+	const auto le32 = [data](size_t pos) -> uint32_t {
+		return uint32_t(data[pos]) | uint32_t(data[pos+1]) << 8 | uint32_t(data[pos+2]) << 16 | uint32_t(data[pos+3]) << 24;
+	};
+
+	const uint32_t dib_size = le32(14);
+	if (dib_size == 12) {
+		// os/2 BITMAPCOREHEADER, 16bit unsigned dims
+		res.width = le16(18);
+		res.height = le16(20);
+	} else if (dib_size >= 40 && data_size >= 14+4+8) {
+		// BITMAPINFOHEADER and later, negative height means top-down
+		const int32_t w = static_cast<int32_t>(le32(18));
+		const int32_t h = static_cast<int32_t>(le32(22));
+		if (w <= 0 || h == 0 || h == INT32_MIN) {
+			return res;
+		}
+		res.width = w;
+		res.height = h < 0 ? -h : h;
+	} else {
+		return res;
+	}
+
+	res.file_ext = "bmp";
+
+	return res;
+}
+
 ImageLoaderSDLBMP::ImageResult ImageLoaderSDLBMP::loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) {
 
 	auto* ios = SDL_IOFromConstMem(data, data_size);
@@ -4,6 +4,7 @@
 
 struct ImageLoaderSDLBMP : public ImageLoaderI {
 	ImageInfo loadInfoFromMemory(const uint8_t* data, uint64_t data_size) override;
+	ImageInfo loadInfoFromHeader(const uint8_t* data, uint64_t data_size) override;
 	ImageResult loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) override;
 };
 
@@ -3,6 +3,11 @@
 #include <SDL3_image/SDL_image.h>
 
 #include <optional>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 static std::optional<const char*> getExt(SDL_IOStream* ios) {
@@ -72,6 +77,89 @@ ImageLoaderSDLImage::ImageInfo ImageLoaderSDLImage::loadInfoFromMemory(const uin
 	return res;
 }
 
+ImageLoaderSDLImage::ImageInfo ImageLoaderSDLImage::loadInfoFromHeader(const uint8_t* data, uint64_t data_size) {
+	ImageInfo res;
+
+	// parse the most common formats by hand, the rest needs to be loaded fully
+
+	const auto be16 = [data](uint64_t pos) -> uint32_t {
+		return uint32_t(data[pos]) << 8 | uint32_t(data[pos+1]);
+	};
+	const auto be32 = [data](uint64_t pos) -> uint32_t {
+		return uint32_t(data[pos]) << 24 | uint32_t(data[pos+1]) << 16 | uint32_t(data[pos+2]) << 8 | uint32_t(data[pos+3]);
+	};
+
+	// png: signature, then IHDR is always the first chunk
+	static constexpr uint8_t png_sig[8] {0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a};
+	if (data_size >= 8+8+8 && std::memcmp(data, png_sig, 8) == 0) {
+		if (std::memcmp(data+12, "IHDR", 4) != 0) {
+			return res;
+		}
+		res.width = be32(16);
+		res.height = be32(20);
+		res.file_ext = "png";
+		return res;
+	}
+
+	// gif: logical screen size
+	if (data_size >= 10 && (std::memcmp(data, "GIF87a", 6) == 0 || std::memcmp(data, "GIF89a", 6) == 0)) {
+		res.width = uint32_t(data[6]) | uint32_t(data[7]) << 8;
+		res.height = uint32_t(data[8]) | uint32_t(data[9]) << 8;
+		res.file_ext = "gif";
+		return res;
+	}
+
+	// jpg: walk the segments until we hit a start of frame
+	// (large exif blobs can push it past the prefix)
+	if (data_size >= 4 && data[0] == 0xff && data[1] == 0xd8) {
+		uint64_t pos = 2;
+		while (pos + 4 <= data_size) {
+			if (data[pos] != 0xff) {
+				return res; // lost sync
+			}
+			const uint8_t marker = data[pos+1];
+			if (marker == 0xff) {
+				pos += 1; // fill byte
+				continue;
+			}
+			if (marker == 0xd8 || marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7)) {
+				pos += 2; // no length
+				continue;
+			}
+
+			const uint32_t seg_size = be16(pos+2);
+			if (seg_size < 2) {
+				return res;
+			}
+
+			// SOF0-SOF15, except DHT(c4), JPG(c8) and DAC(cc)
+			if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+				// length, precision, height, width
+				if (pos + 2 + 7 > data_size) {
+					return res;
+				}
+				res.height = be16(pos+5);
+				res.width = be16(pos+7);
+				if (res.width == 0 || res.height == 0) {
+					// height can be defined later by DNL, not worth it
+					return {};
+				}
+				res.file_ext = "jpg";
+				return res;
+			}
+
+			if (marker == 0xda || marker == 0xd9) {
+				return res; // start of scan / end, no frame header seen
+			}
+
+			pos += 2 + seg_size;
+		}
+		return res;
+	}
+
+	return res;
+}
+
 ImageLoaderSDLImage::ImageResult ImageLoaderSDLImage::loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) {
 	ImageResult res;
 
@@ -117,3 +205,90 @@ ImageLoaderSDLImage::ImageResult ImageLoaderSDLImage::loadFromMemoryRGBA(const u
 	return res;
 }
 
+#if SDL_IMAGE_VERSION_ATLEAST(3, 4, 0)
+namespace {
+
+struct SDLImageFrameDecoder : public ImageLoaderI::FrameDecoderI {
+	std::vector<uint8_t> _data; // the decoder reads from this
+	IMG_AnimationDecoder* _dec {nullptr};
+
+	~SDLImageFrameDecoder(void) {
+		if (_dec != nullptr) {
+			IMG_CloseAnimationDecoder(_dec);
+		}
+	}
+
+	bool next(ImageLoaderI::ImageResult::Frame& frame_out) override {
+		SDL_Surface* surf {nullptr};
+		Uint64 duration {0}; // default timebase is ms
+		if (!IMG_GetAnimationDecoderFrame(_dec, &surf, &duration) || surf == nullptr) {
+			return false;
+		}
+
+		SDL_Surface* conv_surf = SDL_ConvertSurface(surf, SDL_PIXELFORMAT_RGBA32);
+		SDL_DestroySurface(surf);
+		if (conv_surf == nullptr) {
+			return false;
+		}
+
+		SDL_LockSurface(conv_surf);
+
+		frame_out.ms = duration;
+		frame_out.data.resize(size_t(width)*height*4);
+		for (uint32_t y = 0; y < height && y < uint32_t(conv_surf->h); y++) {
+			std::memcpy(
+				frame_out.data.data() + size_t(y)*width*4,
+				static_cast<const uint8_t*>(conv_surf->pixels) + size_t(y)*conv_surf->pitch,
+				size_t(std::min<int>(width, conv_surf->w))*4
+			);
+		}
+
+		SDL_UnlockSurface(conv_surf);
+		SDL_DestroySurface(conv_surf);
+
+		return true;
+	}
+
+	bool rewind(void) override {
+		return IMG_ResetAnimationDecoder(_dec);
+	}
+};
+
+} // namespace
+
+std::unique_ptr<ImageLoaderI::FrameDecoderI> ImageLoaderSDLImage::newFrameDecoder(const uint8_t* data, uint64_t data_size) {
+	// only gif is worth it for now
+	{
+		auto* ios = SDL_IOFromConstMem(data, data_size);
+		const auto ext_opt = getExt(ios);
+		SDL_CloseIO(ios);
+		if (!ext_opt.has_value() || std::strcmp(ext_opt.value(), "gif") != 0) {
+			return nullptr;
+		}
+	}
+
+	// we need the dims before the first frame
+	const auto info = loadInfoFromHeader(data, data_size);
+	if (info.width == 0 || info.height == 0) {
+		return nullptr;
+	}
+
+	auto dec = std::make_unique<SDLImageFrameDecoder>();
+	dec->_data = {data, data+data_size};
+	dec->width = info.width;
+	dec->height = info.height;
+
+	auto* ios = SDL_IOFromConstMem(dec->_data.data(), dec->_data.size());
+	dec->_dec = IMG_CreateAnimationDecoder_IO(ios, true, "gif");
+	if (dec->_dec == nullptr) {
+		return nullptr;
+	}
+
+	return dec;
+}
+#else
+std::unique_ptr<ImageLoaderI::FrameDecoderI> ImageLoaderSDLImage::newFrameDecoder(const uint8_t*, uint64_t) {
+	// SDL_image has no animation decoder before 3.4, everything gets decoded at once
+	return nullptr;
+}
+#endif
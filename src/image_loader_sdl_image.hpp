@@ -4,6 +4,8 @@
 
 struct ImageLoaderSDLImage : public ImageLoaderI {
 	ImageInfo loadInfoFromMemory(const uint8_t* data, uint64_t data_size) override;
+	ImageInfo loadInfoFromHeader(const uint8_t* data, uint64_t data_size) override;
 	ImageResult loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) override;
+	std::unique_ptr<FrameDecoderI> newFrameDecoder(const uint8_t* data, uint64_t data_size) override;
 };
 
@@ -5,6 +5,7 @@
 #include <stb/stb_image_write.h>
 
 #include <iostream>
+#include <mutex>
 
 ImageLoaderSTB::ImageInfo ImageLoaderSTB::loadInfoFromMemory(const uint8_t* data, uint64_t data_size) {
 	ImageInfo res;
@@ -95,6 +96,10 @@ std::vector<uint8_t> ImageEncoderSTBPNG::encodeToMemoryRGBA(const ImageResult& i
 		ctx->new_data.insert(ctx->new_data.cend(), d, d + size);
 	};
 
+	// the compression level is a global in stb, so encodes need to be serialized
+	static std::mutex png_mutex{};
+	std::lock_guard lg{png_mutex};
+
 	stbi_write_png_compression_level = png_compression_level;
 
 	if (!stbi_write_png_to_func(write_f, &context, input_image.width, input_image.height, 4, input_image.frames.front().data.data(), 4*input_image.width)) {
@@ -1,6 +1,7 @@
 #include "./image_loader_webp.hpp"
 
 #include <memory>
+#include <webp/decode.h>
 #include <webp/demux.h>
 #include <webp/mux.h>
 #include <webp/encode.h>
@@ -39,6 +40,23 @@ ImageLoaderWebP::ImageInfo ImageLoaderWebP::loadInfoFromMemory(const uint8_t* da
 	return res;
 }
 
+ImageLoaderWebP::ImageInfo ImageLoaderWebP::loadInfoFromHeader(const uint8_t* data, uint64_t data_size) {
+	ImageInfo res;
+
+	// only parses the riff headers, for animations (VP8X) this is the canvas size
+	int width {0};
+	int height {0};
+	if (!WebPGetInfo(data, data_size, &width, &height) || width <= 0 || height <= 0) {
+		return res;
+	}
+
+	res.width = width;
+	res.height = height;
+	res.file_ext = "webp";
+
+	return res;
+}
+
 ImageLoaderWebP::ImageResult ImageLoaderWebP::loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) {
 	ImageResult res;
 
@@ -89,6 +107,81 @@ ImageLoaderWebP::ImageResult ImageLoaderWebP::loadFromMemoryRGBA(const uint8_t*
 	return res;
 }
 
+namespace {
+
+struct WebPFrameDecoder : public ImageLoaderI::FrameDecoderI {
+	std::vector<uint8_t> _data; // the decoder points into this
+	std::unique_ptr<WebPAnimDecoder, decltype(&WebPAnimDecoderDelete)> _dec {nullptr, &WebPAnimDecoderDelete};
+	int _prev_timestamp {0};
+
+	bool next(ImageLoaderI::ImageResult::Frame& frame_out) override {
+		if (!WebPAnimDecoderHasMoreFrames(_dec.get())) {
+			return false;
+		}
+
+		uint8_t* buf;
+		int timestamp;
+		if (WebPAnimDecoderGetNext(_dec.get(), &buf, &timestamp) == 0 || buf == nullptr) {
+			return false;
+		}
+
+		frame_out.ms = timestamp-_prev_timestamp;
+		_prev_timestamp = timestamp;
+		frame_out.data.assign(buf, buf+(size_t(width)*height*4));
+		return true;
+	}
+
+	bool rewind(void) override {
+		WebPAnimDecoderReset(_dec.get());
+		_prev_timestamp = 0;
+		return true;
+	}
+};
+
+} // namespace
+
+std::unique_ptr<ImageLoaderI::FrameDecoderI> ImageLoaderWebP::newFrameDecoder(const uint8_t* data, uint64_t data_size) {
+	{ // cheap check first, so we dont copy still images
+		WebPData webp_data;
+		WebPDataInit(&webp_data);
+		webp_data.bytes = data;
+		webp_data.size = data_size;
+
+		std::unique_ptr<WebPDemuxer, decltype(&WebPDemuxDelete)> demux{
+			WebPDemux(&webp_data),
+			&WebPDemuxDelete
+		};
+		if (!static_cast<bool>(demux) || WebPDemuxGetI(demux.get(), WEBP_FF_FRAME_COUNT) <= 1) {
+			// nothing to stream
+			return nullptr;
+		}
+	}
+
+	auto dec = std::make_unique<WebPFrameDecoder>();
+	dec->_data = {data, data+data_size};
+
+	WebPData webp_data;
+	WebPDataInit(&webp_data);
+	webp_data.bytes = dec->_data.data();
+	webp_data.size = dec->_data.size();
+
+	WebPAnimDecoderOptions dec_options;
+	WebPAnimDecoderOptionsInit(&dec_options);
+	dec_options.color_mode = MODE_RGBA;
+
+	dec->_dec.reset(WebPAnimDecoderNew(&webp_data, &dec_options));
+	if (!static_cast<bool>(dec->_dec)) {
+		return nullptr;
+	}
+
+	WebPAnimInfo anim_info;
+	WebPAnimDecoderGetInfo(dec->_dec.get(), &anim_info);
+	dec->width = anim_info.canvas_width;
+	dec->height = anim_info.canvas_height;
+
+	return dec;
+}
+
 std::vector<uint8_t> ImageEncoderWebP::encodeToMemoryRGBA(const ImageResult& input_image, const std::map<std::string, float>& extra_options) {
 	// setup options
 	float quality = 80.f;
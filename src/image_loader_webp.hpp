@@ -4,7 +4,9 @@
 
 struct ImageLoaderWebP : public ImageLoaderI {
 	ImageInfo loadInfoFromMemory(const uint8_t* data, uint64_t data_size) override;
+	ImageInfo loadInfoFromHeader(const uint8_t* data, uint64_t data_size) override;
 	ImageResult loadFromMemoryRGBA(const uint8_t* data, uint64_t data_size) override;
+	std::unique_ptr<FrameDecoderI> newFrameDecoder(const uint8_t* data, uint64_t data_size) override;
 };
 
 struct ImageEncoderWebP : public ImageEncoderI {
@@ -0,0 +1,78 @@
+#include "./image_tile_pyramid.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// 2x2 box filter, odd edges reuse the last row/column
+static void halfSize(const ImageTilePyramid::Level& src, ImageTilePyramid::Level& dst) {
+	dst.width = std::max<uint32_t>(1, (src.width + 1) / 2);
+	dst.height = std::max<uint32_t>(1, (src.height + 1) / 2);
+	dst.data.resize(size_t(dst.width) * dst.height * 4);
+
+	for (uint32_t y = 0; y < dst.height; y++) {
+		const uint8_t* row0 = src.data.data() + size_t(std::min(y*2, src.height-1)) * src.width * 4;
+		const uint8_t* row1 = src.data.data() + size_t(std::min(y*2+1, src.height-1)) * src.width * 4;
+		uint8_t* dst_row = dst.data.data() + size_t(y) * dst.width * 4;
+
+		for (uint32_t x = 0; x < dst.width; x++) {
+			const size_t x0 = size_t(std::min(x*2, src.width-1)) * 4;
+			const size_t x1 = size_t(std::min(x*2+1, src.width-1)) * 4;
+			for (size_t c = 0; c < 4; c++) {
+				dst_row[x*4 + c] = static_cast<uint8_t>((
+					uint32_t(row0[x0 + c]) + row0[x1 + c] +
+					row1[x0 + c] + row1[x1 + c] +
+					2 // round
+				) / 4);
+			}
+		}
+	}
+}
+
+bool ImageTilePyramid::Level::copyTile(uint32_t tile_x, uint32_t tile_y, std::vector<uint8_t>& data_out, uint32_t& width_out, uint32_t& height_out) const {
+	if (tile_x >= tilesX() || tile_y >= tilesY()) {
+		return false;
+	}
+
+	const uint32_t x = tile_x * tile_size;
+	const uint32_t y = tile_y * tile_size;
+	width_out = std::min(tile_size, width - x);
+	height_out = std::min(tile_size, height - y);
+
+	data_out.resize(size_t(width_out) * height_out * 4);
+	for (uint32_t row = 0; row < height_out; row++) {
+		std::memcpy(
+			data_out.data() + size_t(row) * width_out * 4,
+			data.data() + (size_t(y + row) * width + x) * 4,
+			size_t(width_out) * 4
+		);
+	}
+
+	return true;
+}
+
+bool ImageTilePyramid::build(uint32_t width, uint32_t height, std::vector<uint8_t>&& data, const std::atomic_bool& stop) {
+	levels.clear();
+
+	if (width == 0 || height == 0 || data.size() < size_t(width) * height * 4) {
+		return false;
+	}
+
+	auto& first = levels.emplace_back();
+	first.width = width;
+	first.height = height;
+	first.data = std::move(data);
+
+	while (levels.back().width > tile_size || levels.back().height > tile_size) {
+		if (stop) {
+			levels.clear();
+			return false;
+		}
+
+		Level next;
+		halfSize(levels.back(), next);
+		levels.push_back(std::move(next));
+	}
+
+	return true;
+}
+
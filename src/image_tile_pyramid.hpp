@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+// an image and successive half size versions of it, down to a single tile.
+// viewers only upload the tiles of the level that matches their zoom.
+struct ImageTilePyramid {
+	static constexpr uint32_t tile_size {256};
+
+	struct Level {
+		uint32_t width {0};
+		uint32_t height {0};
+		std::vector<uint8_t> data; // rgba
+
+		uint32_t tilesX(void) const { return (width + tile_size - 1) / tile_size; }
+		uint32_t tilesY(void) const { return (height + tile_size - 1) / tile_size; }
+
+		// edge tiles are smaller than tile_size.
+		// returns false if the tile is out of range
+		bool copyTile(uint32_t tile_x, uint32_t tile_y, std::vector<uint8_t>& data_out, uint32_t& width_out, uint32_t& height_out) const;
+	};
+
+	// 0 is the full size image, the last one fits into a single tile
+	std::vector<Level> levels;
+
+	// takes the rgba data as level 0.
+	// returns false if stopped or the image is empty
+	bool build(uint32_t width, uint32_t height, std::vector<uint8_t>&& data, const std::atomic_bool& stop);
+};
+
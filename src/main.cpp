@@ -15,6 +15,8 @@
 
 #include "./start_screen.hpp"
 
+#include "./trace.hpp"
+
 #ifdef __ANDROID__
 #include <filesystem>
 #endif
@@ -23,6 +25,7 @@
 #include <iostream>
 #include <string_view>
 #include <chrono>
+#include <cstdlib>
 
 #ifdef TOMATO_BREAKPAD
 #	include "./breakpad_client.hpp"
@@ -46,6 +49,14 @@ int main(int argc, char** argv) {
 	std::cout << "Breakpad handler installed.\n";
 #endif
 
+	Trace::setThreadName("main");
+	// record from the start, eg for profiling startup and profile loading
+	const char* trace_path = std::getenv("TOMATO_TRACE");
+	if (trace_path != nullptr && *trace_path != '\0') {
+		Trace::setEnabled(true);
+		std::cout << "MAIN: recording trace to '" << trace_path << "'\n";
+	}
+
 	// better args
 	std::vector<std::string_view> args;
 	for (int i = 0; i < argc; i++) {
@@ -177,6 +188,7 @@ int main(int argc, char** argv) {
 		bool render = time_delta_render >= screen->nextRender();
 
 		if (tick) {
+			TRACE_ZONE("tick");
 			Screen* ret_screen = screen->tick(time_delta_tick, quit);
 			if (ret_screen != nullptr) {
 				screen.reset(ret_screen);
@@ -186,6 +198,7 @@ int main(int argc, char** argv) {
 
 		// do events outside of tick/render, so they can influence reported intervals
 		if (render || time_delta_sdl_events >= 1.f/60.f) {
+			TRACE_ZONE("events");
 			last_time_sdl_events = new_time;
 			SDL_Event event;
 			while (SDL_PollEvent(&event)) {
@@ -223,6 +236,7 @@ int main(int argc, char** argv) {
 
 		// can do both in the same loop
 		if (render) {
+			TRACE_ZONE("frame");
 			const auto render_start_time = std::chrono::steady_clock::now();
 
 			ImGui_ImplSDLRenderer3_NewFrame();
@@ -230,17 +244,24 @@ int main(int argc, char** argv) {
 			ImGui::NewFrame();
 
 			{ // render
+				TRACE_ZONE("render");
 				Screen* ret_screen = screen->render(time_delta_render, quit);
 				if (ret_screen != nullptr) {
 					screen.reset(ret_screen);
 				}
 			}
 
-			ImGui::Render();
-			ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(), renderer.get());
+			{
+				TRACE_ZONE("draw");
+				ImGui::Render();
+				ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(), renderer.get());
+			}
 
-			// TODO: time mesurements and dynamically reduce fps if present takes long
-			SDL_RenderPresent(renderer.get());
+			{
+				TRACE_ZONE("present");
+				// TODO: time mesurements and dynamically reduce fps if present takes long
+				SDL_RenderPresent(renderer.get());
+			}
 			// clearing after present is (should) more performant, but first frame is a mess
 			SDL_SetRenderDrawColor(renderer.get(), 0x10, 0x10, 0x10, SDL_ALPHA_OPAQUE);
 			SDL_RenderClear(renderer.get());
@@ -285,7 +306,19 @@ int main(int argc, char** argv) {
 
 	// TODO: use scope for the unique ptrs
 
-	screen.reset();
+	{
+		// includes the final profile save
+		TRACE_ZONE("shutdown");
+		screen.reset();
+	}
+
+	if (trace_path != nullptr && *trace_path != '\0') {
+		if (Trace::dump(trace_path)) {
+			std::cout << "MAIN: wrote trace to '" << trace_path << "'\n";
+		} else {
+			std::cerr << "MAIN error: failed to write trace to '" << trace_path << "'\n";
+		}
+	}
 
 	ImGui_ImplSDLRenderer3_Shutdown();
 	ImGui_ImplSDL3_Shutdown();
@@ -13,6 +13,8 @@
 
 #include "./frame_streams/sdl/sdl_audio2_frame_stream2.hpp"
 
+#include "./trace.hpp"
+
 #include <imgui.h>
 #include <implot.h>
 
@@ -20,8 +22,11 @@
 
 #include <memory>
 #include <cmath>
+#include <cinttypes>
 #include <string_view>
 #include <iostream>
+#include <chrono>
+#include <string>
 
 
 // temp
@@ -49,6 +54,9 @@ MainScreen::MainScreen(const SimpleConfigModel& conf_, SDL_Renderer* renderer_,
 	rmm(cs),
 	msnj{cs, os, {}, {}},
 	mts(rmm),
+	uidx(rmm),
+	msi(cs, rmm, conf),
+	damage(rmm, cs, os),
 	sdlvis(os),
 	sm(os),
 	tc(conf, save_path, save_password, new_username),
@@ -64,24 +72,28 @@ MainScreen::MainScreen(const SimpleConfigModel& conf_, SDL_Renderer* renderer_,
 	tavvoip(os, tav, cs, tcm),
 #endif
 	theme(theme_),
-	mmil(rmm),
+	mmil(rmm, icr),
 	tam(os, cs, conf, tc),
 	tas(os, cs, rmm),
 	sdlrtu(renderer_),
-	tal(cs, os),
+	avatar_atlas(sdlrtu),
+	tal(cs, os, icr, avatar_atlas),
 	contact_tc(tal, sdlrtu),
-	mil(),
+	mil(icr),
 	msg_tc(mil, sdlrtu),
 	st(constructSystemTray(conf, SDL_GetRenderWindow(renderer_))),
-	si(rmm, cs, SDL_GetRenderWindow(renderer_), st.get()),
-	cg(conf, os, rmm, cs, sdlrtu, contact_tc, msg_tc, theme),
+	si(uidx, SDL_GetRenderWindow(renderer_), st.get()),
+	cg(conf, os, rmm, uidx, msi, cs, sdlrtu, contact_tc, msg_tc, icr, theme),
 	sw(conf),
 	osui(os, theme),
 	tuiu(tc, cs, tcm, conf, &tpi),
 	tdch(tpi),
 	tnui(tpi),
 	smui(os, sm, theme),
-	dvt(os, sm, sdlrtu)
+	icsui(icr),
+	tasui(avatar_atlas, contact_tc),
+	dvt(os, sm, sdlrtu),
+	amn(os, sm)
 {
 	cs.registry().ctx().emplace<ObjectStore2&>(os); // HACK: remove
 	tel.subscribeAll();
@@ -222,6 +234,7 @@ bool MainScreen::handleEvent(SDL_Event& e) {
 	if (e.type == SDL_EVENT_DROP_FILE) {
 		std::cout << "DROP FILE: " << e.drop.data << "\n";
 		_dopped_files.emplace_back(e.drop.data);
+		damage.add(RenderDamage::INPUT);
 		_render_interval = 1.f/60.f; // TODO: magic
 		_time_since_event = 0.f;
 		return true;
@@ -248,6 +261,7 @@ bool MainScreen::handleEvent(SDL_Event& e) {
 				//std::cout << "TOMAT: window hidden " << e.type << " " << e.window.timestamp << "\n";
 			}
 		}
+		damage.add(RenderDamage::WINDOW);
 		if (st) {
 			st->update();
 		}
@@ -276,6 +290,7 @@ bool MainScreen::handleEvent(SDL_Event& e) {
 				//std::cout << "TOMAT: window shown " << e.type << " " << e.window.timestamp << "\n";
 			}
 		}
+		damage.add(RenderDamage::WINDOW);
 		_render_interval = 1.f/60.f; // TODO: magic
 		_time_since_event = 0.f;
 		if (st) {
@@ -293,26 +308,28 @@ bool MainScreen::handleEvent(SDL_Event& e) {
 	}
 
 	if (
-		_fps_perf_mode <= 1 && (
-			// those are all the events imgui polls
-			e.type == SDL_EVENT_MOUSE_MOTION ||
-			e.type == SDL_EVENT_MOUSE_WHEEL ||
-			e.type == SDL_EVENT_MOUSE_BUTTON_DOWN ||
-			e.type == SDL_EVENT_MOUSE_BUTTON_UP ||
-			e.type == SDL_EVENT_FINGER_DOWN ||
-			e.type == SDL_EVENT_FINGER_UP ||
-			e.type == SDL_EVENT_TEXT_INPUT ||
-			e.type == SDL_EVENT_TEXT_EDITING ||
-			e.type == SDL_EVENT_KEY_DOWN ||
-			e.type == SDL_EVENT_KEY_UP ||
-			e.type == SDL_EVENT_WINDOW_MOUSE_ENTER ||
-			e.type == SDL_EVENT_WINDOW_MOUSE_LEAVE ||
-			e.type == SDL_EVENT_WINDOW_FOCUS_GAINED ||
-			e.type == SDL_EVENT_WINDOW_FOCUS_LOST
-		)
+		// those are all the events imgui polls
+		e.type == SDL_EVENT_MOUSE_MOTION ||
+		e.type == SDL_EVENT_MOUSE_WHEEL ||
+		e.type == SDL_EVENT_MOUSE_BUTTON_DOWN ||
+		e.type == SDL_EVENT_MOUSE_BUTTON_UP ||
+		e.type == SDL_EVENT_FINGER_DOWN ||
+		e.type == SDL_EVENT_FINGER_UP ||
+		e.type == SDL_EVENT_TEXT_INPUT ||
+		e.type == SDL_EVENT_TEXT_EDITING ||
+		e.type == SDL_EVENT_KEY_DOWN ||
+		e.type == SDL_EVENT_KEY_UP ||
+		e.type == SDL_EVENT_WINDOW_MOUSE_ENTER ||
+		e.type == SDL_EVENT_WINDOW_MOUSE_LEAVE ||
+		e.type == SDL_EVENT_WINDOW_FOCUS_GAINED ||
+		e.type == SDL_EVENT_WINDOW_FOCUS_LOST
 	) {
-		_render_interval = 1.f/60.f; // TODO: magic
-		_time_since_event = 0.f;
+		// powersave still renders input, just not faster
+		damage.add(RenderDamage::INPUT);
+		if (_fps_perf_mode <= 1) {
+			_render_interval = 1.f/60.f; // TODO: magic
+			_time_since_event = 0.f;
+		}
 	}
 
 	if (sdlvis.handleEvent(e)) {
@@ -323,6 +340,8 @@ bool MainScreen::handleEvent(SDL_Event& e) {
 }
 
 Screen* MainScreen::render(float time_delta, bool&) {
+	damage.beginFrame(time_delta);
+
 	// HACK: render the tomato main window first, with proper flags set.
 	// flags need to be set the first time begin() is called.
 	// and plugins are run before the main cg is run.
@@ -371,7 +390,10 @@ Screen* MainScreen::render(float time_delta, bool&) {
 	tdch.render(); // render
 	const float tnui_interval = tnui.render(time_delta);
 	smui.render();
+	icsui.render();
+	tasui.render(); // after icsui
 	const float dvt_interval = dvt.render();
+	const float amn_interval = amn.render();
 
 	{ // main window menubar injection
 		if (ImGui::Begin("tomato")) {
@@ -402,6 +424,18 @@ Screen* MainScreen::render(float time_delta, bool&) {
 
 					ImGui::Text("render interval: %.0fms (%.2ffps)", _render_interval*1000.f, 1.f/_render_interval);
 
+					ImGui::MenuItem("skip unchanged frames", nullptr, &_render_on_damage);
+					ImGui::SetItemTooltip("Renders only on input, new messages, loaded textures, animations and the like,\nand otherwise every %.0fs.", _heartbeat_interval);
+					if (ImGui::TreeNode("frames by damage")) {
+						ImGui::Text("total: %" PRIu64, damage.frames());
+						for (uint8_t r = 0; r < RenderDamage::MAX; r++) {
+							const auto reason = RenderDamage::Reason(r);
+							// mark the ones causing this frame
+							ImGui::Text("%s %-9s %" PRIu64, damage.lastFrameHad(reason) ? ">" : " ", RenderDamage::reasonName(reason), damage.frames(reason));
+						}
+						ImGui::TreePop();
+					}
+
 					if (_compute_lower_limit_hit) {
 						ImGui::PushStyleColor(ImGuiCol_Text, theme.getColor<ThemeCol_Contact::message_warning_text>());
 					}
@@ -410,6 +444,22 @@ Screen* MainScreen::render(float time_delta, bool&) {
 						ImGui::PopStyleColor();
 					}
 
+					ImGui::Separator();
+
+					if (bool recording = Trace::enabled(); ImGui::MenuItem("record trace", nullptr, &recording)) {
+						Trace::setEnabled(recording);
+					}
+					ImGui::SetItemTooltip("Records main loop and worker thread zones.\nDumps can be opened in ui.perfetto.dev or chrome://tracing .");
+					if (ImGui::MenuItem("dump trace")) {
+						const auto ts = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+						const std::string trace_path = "tomato_trace_" + std::to_string(ts) + ".json";
+						if (Trace::dump(trace_path)) {
+							std::cout << "MS: wrote trace to '" << trace_path << "'\n";
+						} else {
+							std::cerr << "MS error: failed to write trace to '" << trace_path << "'\n";
+						}
+					}
+
 					ImGui::EndMenu();
 				}
 				if (ImGui::BeginMenu("Settings")) {
@@ -489,148 +539,65 @@ Screen* MainScreen::render(float time_delta, bool&) {
 
 	float tc_unfinished_queue_interval;
 	{ // load rendered but not loaded textures
+		const uint64_t loaded_before = contact_tc.loaded_count + msg_tc.loaded_count;
+
 		bool unfinished_work_queue = contact_tc.workLoadQueue();
 		unfinished_work_queue = unfinished_work_queue || msg_tc.workLoadQueue();
 
+		if (contact_tc.loaded_count + msg_tc.loaded_count != loaded_before) {
+			// the new texture is only visible next frame
+			damage.add(RenderDamage::TEXTURE);
+		}
+
 		if (unfinished_work_queue) {
 			tc_unfinished_queue_interval = 0.1f; // so we can get images loaded faster
 		} else {
-			tc_unfinished_queue_interval = 1.f; // TODO: higher min fps?
+			tc_unfinished_queue_interval = 1000.f; // nothing to load, loads get requested while rendering
 		}
 	}
 
-	// calculate interval for next frame
-	// normal:
-	//  - if < 1.5sec since last event
-	//    - min all and clamp(1/60, 1/1)
-	//  - if < 30sec since last event
-	//    - min all (anim + everything else) clamp(1/60, 1/1) (maybe less?)
-	//  - else
-	//    - min without anim and clamp(1/60, 1/1) (maybe more?)
-	// reduced:
-	//  - if < 1sec since last event
-	//    - min all and clamp(1/60, 1/1)
-	//  - if < 10sec since last event
-	//    - min all (anim + everything else) clamp(1/10, 1/1)
-	//  - else
-	//    - min without anim and max clamp(1/10, 1/1)
-	// powersave:
-	//  - if < 0sec since last event
-	//    - (ignored)
-	//  - if < 1sec since last event
-	//    - min all (anim + everything else) clamp(1/8, 1/1)
-	//  - else
-	//    - min without anim and clamp(1/1, 1/1)
-	struct PerfProfileRender {
-		float low_delay_window {1.5f};
-		float low_delay_min {1.f/60.f};
-		float low_delay_max {1.f/60.f};
-
-		float mid_delay_window {30.f};
-		float mid_delay_min {1.f/60.f};
-		float mid_delay_max {1.f/2.f};
-
-		// also when main window hidden
-		float else_delay_min {1.f/60.f};
-		float else_delay_max {1.f/2.f};
-	};
-
-	const static PerfProfileRender normalPerfProfile{
-		//1.5f,		// low_delay_window
-		//1.f/60.f,	// low_delay_min
-		//1.f/60.f,	// low_delay_max
-
-		//30.f,		// mid_delay_window
-		//1.f/60.f,	// mid_delay_min
-		//1.f/2.f,	// mid_delay_max
-
-		//1.f/60.f,	// else_delay_min
-		//1.f/2.f,	// else_delay_max
-	};
-	const static PerfProfileRender reducedPerfProfile{
-		1.f,		// low_delay_window
-		1.f/60.f,	// low_delay_min
-		1.f/30.f,	// low_delay_max
-
-		10.f,		// mid_delay_window
-		1.f/10.f,	// mid_delay_min
-		1.f/4.f,	// mid_delay_max
-
-		1.f/10.f,	// else_delay_min
-		1.f,		// else_delay_max
-	};
-	// TODO: fix powersave by adjusting it in the events handler (make ppr member)
-	const static PerfProfileRender powersavePerfProfile{
-		// no window -> ignore first case
-		0.f,		// low_delay_window
-		1.f,		// low_delay_min
-		1.f,		// low_delay_max
-
-		1.f,		// mid_delay_window
-		1.f/8.f,	// mid_delay_min
-		1.f/4.f,	// mid_delay_max
-
-		1.f,		// else_delay_min
-		1.f,		// else_delay_max
-	};
-
-	const PerfProfileRender& curr_profile =
-		// TODO: magic
-		_fps_perf_mode > 1
-		? powersavePerfProfile
-		: (
-			_fps_perf_mode == 1
-			? reducedPerfProfile
-			: normalPerfProfile
-		)
-	;
-
-	// min over non animations in all cases
-	_render_interval = std::min<float>(pm_interval, cg_interval);
-	_render_interval = std::min<float>(_render_interval, tc_unfinished_queue_interval);
-	_render_interval = std::min<float>(_render_interval, dvt_interval);
-
-	// low delay time window
-	if (!_window_hidden && _time_since_event < curr_profile.low_delay_window) {
-		_render_interval = std::min<float>(_render_interval, ctc_interval);
-		_render_interval = std::min<float>(_render_interval, msgtc_interval);
-		_render_interval = std::min<float>(_render_interval, tnui_interval);
-
-		_render_interval = std::clamp(
-			_render_interval,
-			curr_profile.low_delay_min,
-			curr_profile.low_delay_max
-		);
-	// mid delay time window
-	} else if (!_window_hidden && _time_since_event < curr_profile.mid_delay_window) {
-		_render_interval = std::min<float>(_render_interval, ctc_interval);
-		_render_interval = std::min<float>(_render_interval, msgtc_interval);
-		_render_interval = std::min<float>(_render_interval, tnui_interval);
-
-		_render_interval = std::clamp(
-			_render_interval,
-			curr_profile.mid_delay_min,
-			curr_profile.mid_delay_max
-		);
-	// timed out or window hidden
-	} else {
-		// no animation timing here
-		_render_interval = std::clamp(
-			_render_interval,
-			curr_profile.else_delay_min,
-			curr_profile.else_delay_max
-		);
-	}
+	// min over non animations, and over animations
+	float interval = std::min<float>(pm_interval, cg_interval);
+	interval = std::min<float>(interval, tc_unfinished_queue_interval);
+	interval = std::min<float>(interval, dvt_interval);
+	interval = std::min<float>(interval, amn_interval);
+
+	float anim_interval = std::min<float>(ctc_interval, msgtc_interval);
+	anim_interval = std::min<float>(anim_interval, tnui_interval);
+
+	const auto& curr_profile = RenderPerfProfile::get(_fps_perf_mode);
+	_render_interval = scheduleRender(
+		damage,
+		curr_profile,
+		interval,
+		anim_interval,
+		_time_since_event,
+		_window_hidden,
+		ImGui::GetIO().WantTextInput,
+		ImGui::GetIO().ConfigInputTextCursorBlink
+	);
+	_heartbeat_interval = curr_profile.heartbeat;
 
 	_time_since_event += time_delta;
 
 	return nullptr;
 }
 
+float MainScreen::nextRender(void) {
+	if (!_render_on_damage) {
+		return _render_interval;
+	}
+
+	return damage.nextFrame(_render_interval, _heartbeat_interval);
+}
+
 Screen* MainScreen::tick(float time_delta, bool& quit) {
 	const float sm_interval = sm.tick(time_delta);
 
-	quit = !tc.iterate(time_delta); // compute
+	{
+		TRACE_ZONE("tox iterate");
+		quit = !tc.iterate(time_delta); // compute
+	}
 
 #if TOMATO_TOX_AV
 	tav.toxavIterate();
@@ -647,6 +614,8 @@ Screen* MainScreen::tick(float time_delta, bool& quit) {
 	const float fo_interval = tffom.tick(time_delta);
 
 	tam.iterate(); // compute
+
+	msi.iterate(time_delta);
 	tas.iterate(time_delta);
 
 	const float pm_interval = pm.tick(time_delta); // compute
@@ -21,14 +21,19 @@
 #include "./tox_client.hpp"
 #include "./auto_dirty.hpp"
 
+#include "./image_codec_registry.hpp"
 #include "./media_meta_info_loader.hpp"
 #include "./tox_avatar_manager.hpp"
 #include "./tox_avatar_sender.hpp"
 
 #include "./sdlrenderer_texture_uploader.hpp"
 #include "./texture_cache.hpp"
+#include "./texture_atlas.hpp"
 #include "./chat_gui/texture_cache_defs.hpp"
 
+#include "./unread_index.hpp"
+#include "./message_search_index.hpp"
+#include "./render_damage.hpp"
 #include "./sys_tray.hpp"
 #include "./status_indicator.hpp"
 #include "./chat_gui4.hpp"
@@ -40,7 +45,10 @@
 #include "./tox_friend_faux_offline_messaging.hpp"
 #include "./frame_streams/sdl/sdl_video_input_service.hpp"
 #include "./stream_manager_ui.hpp"
+#include "./image_codec_stats_ui.hpp"
+#include "./texture_atlas_stats_ui.hpp"
 #include "./debug_video_tap.hpp"
+#include "./audio_mixer_node.hpp"
 
 #if TOMATO_TOX_AV
 #include "./tox_av.hpp"
@@ -68,6 +76,9 @@ struct MainScreen final : public Screen {
 	RegistryMessageModelImpl rmm;
 	MessageSerializerNJ msnj;
 	MessageTimeSort mts;
+	UnreadIndex uidx;
+	MessageSearchIndex msi;
+	RenderDamage damage;
 
 	SDLVideoInputService sdlvis; // sm ends the threads and closes the devices
 	StreamManager sm;
@@ -87,6 +98,7 @@ struct MainScreen final : public Screen {
 
 	Theme& theme;
 
+	ImageCodecRegistry icr;
 	MediaMetaInfoLoader mmil;
 	ToxAvatarManager tam;
 	ToxAvatarSender tas;
@@ -94,6 +106,7 @@ struct MainScreen final : public Screen {
 	SDLRendererTextureUploader sdlrtu;
 	//OpenGLTextureUploader ogltu;
 
+	TextureAtlas avatar_atlas; // outlives contact_tc
 	ToxAvatarLoader tal;
 	ContactTextureCache contact_tc;
 	MessageImageLoader mil;
@@ -108,7 +121,10 @@ struct MainScreen final : public Screen {
 	ToxDHTCapHisto tdch;
 	ToxNetprofUI tnui;
 	StreamManagerUI smui;
+	ImageCodecStatsUI icsui;
+	TextureAtlasStatsUI tasui;
 	DebugVideoTap dvt;
+	AudioMixerNode amn;
 
 
 	bool _show_imgui_about {false};
@@ -147,10 +163,14 @@ struct MainScreen final : public Screen {
 	float _render_interval {1.f/60.f};
 	float _min_tick_interval {0.f};
 
+	// only render if something changed, or the heartbeat ran out
+	bool _render_on_damage {true};
+	float _heartbeat_interval {5.f};
+
 	bool _compute_lower_limit_hit {false};
 	bool _compute_lower_limit_hit_rendered {false};
 
-	float nextRender(void) override { return _render_interval; }
+	float nextRender(void) override;
 	float nextTick(void) override { return _min_tick_interval; }
 };
 
@@ -1,10 +1,5 @@
 #include "./media_meta_info_loader.hpp"
 
-#include "./image_loader_webp.hpp"
-#include "./image_loader_sdl_bmp.hpp"
-#include "./image_loader_qoi.hpp"
-#include "./image_loader_sdl_image.hpp"
-
 #include <solanaceae/message3/components.hpp>
 
 #include "./os_comps.hpp"
@@ -14,6 +9,7 @@
 #include <solanaceae/file/file2.hpp>
 
 #include <limits>
+#include <algorithm>
 #include <iostream>
 
 void MediaMetaInfoLoader::handleMessage(const Message3Handle& m) {
@@ -83,6 +79,37 @@ void MediaMetaInfoLoader::handleMessage(const Message3Handle& m) {
 		return;
 	}
 
+	auto format = ImageCodecRegistry::Format::unknown;
+	if (const auto* icf = o.try_get<ObjComp::Ephemeral::ImageCodecFormat>(); icf != nullptr) {
+		format = static_cast<ImageCodecRegistry::Format>(icf->format);
+	}
+
+	const auto set_dims = [&](const ImageLoaderI::ImageInfo& res) {
+		o.emplace_or_replace<ObjComp::Ephemeral::ImageCodecFormat>(static_cast<uint8_t>(format));
+		o.emplace<ObjComp::F::FrameDims>(
+			static_cast<uint16_t>(std::min<uint32_t>(res.width, std::numeric_limits<uint16_t>::max())),
+			static_cast<uint16_t>(std::min<uint32_t>(res.height, std::numeric_limits<uint16_t>::max()))
+		);
+
+		std::cout << "MMIL: loaded image file o:" << /*file_path*/ entt::to_integral(o.entity()) << "\n";
+
+		_rmm.throwEventUpdate(m);
+	};
+
+	{ // most formats have their dims in the first few KiB, try that first
+		const uint64_t probe_size = std::min<uint64_t>(file_size, ImageLoaderI::header_probe_size);
+		auto probe_data = file2->read(probe_size, 0);
+		if (probe_data.ptr != nullptr && probe_data.size == probe_size) {
+			// only the sniffed format, no trial and error
+			auto res = _icr.loadInfoFromHeader(probe_data.ptr, probe_data.size, format);
+			if (res.height != 0 && res.width != 0) {
+				set_dims(res);
+				return;
+			}
+		}
+	}
+
+	// fall back to the whole file (no copy, if the backend maps it)
 	auto read_data = file2->read(file_size, 0);
 	if (read_data.ptr == nullptr) {
 		std::cerr << "MMIL error: reading from file2 returned nullptr\n";
@@ -94,22 +121,10 @@ void MediaMetaInfoLoader::handleMessage(const Message3Handle& m) {
 		return;
 	}
 
-	// try all loaders after another
-	for (auto& il : _image_loaders) {
-		// TODO: impl callback based load
-		auto res = il->loadInfoFromMemory(read_data.ptr, read_data.size);
-		if (res.height == 0 || res.width == 0) {
-			continue;
-		}
-
-		o.emplace<ObjComp::F::FrameDims>(
-			static_cast<uint16_t>(std::min<uint32_t>(res.width, std::numeric_limits<uint16_t>::max())),
-			static_cast<uint16_t>(std::min<uint32_t>(res.height, std::numeric_limits<uint16_t>::max()))
-		);
-
-		std::cout << "MMIL: loaded image file o:" << /*file_path*/ entt::to_integral(o.entity()) << "\n";
-
-		_rmm.throwEventUpdate(m);
+	// TODO: impl callback based load
+	auto res = _icr.loadInfoFromMemory(read_data.ptr, read_data.size, format);
+	if (res.height != 0 && res.width != 0) {
+		set_dims(res);
 		return;
 	}
 
@@ -122,13 +137,7 @@ void MediaMetaInfoLoader::handleMessage(const Message3Handle& m) {
 	_rmm.throwEventUpdate(m);
 }
 
-MediaMetaInfoLoader::MediaMetaInfoLoader(RegistryMessageModelI& rmm) : _rmm(rmm), _rmm_sr(_rmm.newSubRef(this)) {
-	// HACK: make them be added externally?
-	_image_loaders.push_back(std::make_unique<ImageLoaderQOI>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderSDLBMP>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderWebP>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderSDLImage>());
-
+MediaMetaInfoLoader::MediaMetaInfoLoader(RegistryMessageModelI& rmm, ImageCodecRegistry& icr) : _rmm(rmm), _rmm_sr(_rmm.newSubRef(this)), _icr(icr) {
 	_rmm_sr
 		.subscribe(RegistryMessageModel_Event::message_construct)
 		.subscribe(RegistryMessageModel_Event::message_updated)
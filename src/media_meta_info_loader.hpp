@@ -2,7 +2,7 @@
 
 #include <solanaceae/message3/registry_message_model.hpp>
 
-#include "./image_loader.hpp"
+#include "./image_codec_registry.hpp"
 
 namespace Message::Components {
 
@@ -16,12 +16,12 @@ class MediaMetaInfoLoader : public RegistryMessageModelEventI {
 		RegistryMessageModelI& _rmm;
 		RegistryMessageModelI::SubscriptionReference _rmm_sr;
 
-		std::vector<std::unique_ptr<ImageLoaderI>> _image_loaders;
+		ImageCodecRegistry& _icr;
 
 		void handleMessage(const Message3Handle& m);
 
 	public:
-		MediaMetaInfoLoader(RegistryMessageModelI& rmm);
+		MediaMetaInfoLoader(RegistryMessageModelI& rmm, ImageCodecRegistry& icr);
 		virtual ~MediaMetaInfoLoader(void);
 
 	protected: // rmm
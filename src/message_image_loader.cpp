@@ -1,10 +1,8 @@
 #include "./message_image_loader.hpp"
 
-#include "./image_loader_sdl_bmp.hpp"
-#include "./image_loader_qoi.hpp"
-#include "./image_loader_webp.hpp"
-#include "./image_loader_sdl_image.hpp"
 #include "./media_meta_info_loader.hpp"
+#include "./animated_image_stream.hpp"
+#include "./os_comps.hpp"
 
 #include <solanaceae/message3/components.hpp>
 
@@ -17,11 +15,7 @@
 
 #include <iostream>
 
-MessageImageLoader::MessageImageLoader(void) {
-	_image_loaders.push_back(std::make_unique<ImageLoaderQOI>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderSDLBMP>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderWebP>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderSDLImage>());
+MessageImageLoader::MessageImageLoader(ImageCodecRegistry& icr) : _icr(icr) {
 }
 
 TextureLoaderResult MessageImageLoader::load(TextureUploaderI& tu, Message3Handle m, uint32_t w, uint32_t h) {
@@ -79,6 +73,7 @@ TextureLoaderResult MessageImageLoader::load(TextureUploaderI& tu, Message3Handl
 		return {std::nullopt};
 	}
 
+	// zero copy if the backend maps the file
 	auto read_data = file2->read(file_size, 0);
 	if (read_data.ptr == nullptr) {
 		std::cerr << "MIL error: reading from file2 returned nullptr\n";
@@ -90,46 +85,60 @@ TextureLoaderResult MessageImageLoader::load(TextureUploaderI& tu, Message3Handl
 		return {std::nullopt};
 	}
 
-	// try all loaders after another
-	for (auto& il : _image_loaders) {
-		auto res = il->loadFromMemoryRGBA(read_data.ptr, read_data.size);
-		if (res.frames.empty() || res.height == 0 || res.width == 0) {
-			continue;
-		}
+	auto format = ImageCodecRegistry::Format::unknown;
+	if (const auto* icf = o.try_get<ObjComp::Ephemeral::ImageCodecFormat>(); icf != nullptr) {
+		format = static_cast<ImageCodecRegistry::Format>(icf->format);
+	}
 
-		TextureEntry new_entry;
-		new_entry.timestamp_last_rendered = getTimeMS();
-		new_entry.current_texture = 0;
+	// animations get decoded during playback, if they are too large to hold
+	if (auto dec = _icr.newFrameDecoder(read_data.ptr, read_data.size, format); dec) {
+		auto new_entry_opt = AnimatedImageStream::load(tu, std::move(dec), w, h);
+		if (new_entry_opt.has_value()) {
+			o.emplace_or_replace<ObjComp::Ephemeral::ImageCodecFormat>(static_cast<uint8_t>(format));
 
-		new_entry.src_width = res.width;
-		new_entry.src_height = res.height;
+			std::cout << "MIL: loaded " << ImageCodecRegistry::formatName(format) << " animation o:" << entt::to_integral(o.entity()) << "\n";
 
-		if (w != 0 && h != 0 && w < res.width && h < res.height) {
-			res = res.scale(w, h);
+			return {new_entry_opt};
 		}
+	}
 
-		new_entry.width = res.width;
-		new_entry.height = res.height;
+	auto res = _icr.loadFromMemoryRGBA(read_data.ptr, read_data.size, format);
+	if (res.frames.empty() || res.height == 0 || res.width == 0) {
+		std::cerr << "MIL error: failed to load message (unhandled format)\n";
+		return {std::nullopt};
+	}
 
-		for (const auto& [ms, data] : res.frames) {
-			const auto n_t = tu.upload(data.data(), res.width, res.height);
-			if (n_t == 0) {
-				continue;
-			}
-			new_entry.textures.push_back(n_t);
-			new_entry.frame_duration.push_back(ms);
-		}
+	o.emplace_or_replace<ObjComp::Ephemeral::ImageCodecFormat>(static_cast<uint8_t>(format));
+
+	TextureEntry new_entry;
+	new_entry.timestamp_last_rendered = getTimeMS();
+	new_entry.current_texture = 0;
+
+	new_entry.src_width = res.width;
+	new_entry.src_height = res.height;
 
-		if (new_entry.textures.empty()) {
+	if (w != 0 && h != 0 && w < res.width && h < res.height) {
+		res = res.scale(w, h);
+	}
+
+	new_entry.width = res.width;
+	new_entry.height = res.height;
+
+	for (const auto& [ms, data] : res.frames) {
+		const auto n_t = tu.upload(data.data(), res.width, res.height);
+		if (n_t == 0) {
 			continue;
 		}
+		new_entry.textures.push_back(n_t);
+		new_entry.frame_duration.push_back(ms);
+	}
 
-		std::cout << "MIL: loaded image file o:" << /*file_path*/ entt::to_integral(o.entity()) << "\n";
-
-		return {new_entry};
+	if (new_entry.textures.empty()) {
+		std::cerr << "MIL error: failed to upload textures\n";
+		return {std::nullopt};
 	}
 
-	std::cerr << "MIL error: failed to load message (unhandled format)\n";
-	return {std::nullopt};
-}
+	std::cout << "MIL: loaded " << ImageCodecRegistry::formatName(format) << " image file o:" << /*file_path*/ entt::to_integral(o.entity()) << "\n";
 
+	return {new_entry};
+}
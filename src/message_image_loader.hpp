@@ -2,14 +2,14 @@
 
 #include <solanaceae/message3/registry_message_model.hpp>
 
-#include "./image_loader.hpp"
+#include "./image_codec_registry.hpp"
 #include "./texture_cache.hpp"
 
 class MessageImageLoader {
-	std::vector<std::unique_ptr<ImageLoaderI>> _image_loaders;
+	ImageCodecRegistry& _icr;
 
 	public:
-		MessageImageLoader(void);
+		MessageImageLoader(ImageCodecRegistry& icr);
 		TextureLoaderResult load(TextureUploaderI& tu, Message3Handle m, uint32_t w, uint32_t h);
 };
 
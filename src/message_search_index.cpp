@@ -0,0 +1,253 @@
+#include "./message_search_index.hpp"
+
+#include <solanaceae/util/config_model.hpp>
+#include <solanaceae/util/utils.hpp>
+
+#include <solanaceae/contact/contact_store_i.hpp>
+#include <solanaceae/contact/components.hpp>
+#include <solanaceae/message3/components.hpp>
+
+#include "./trace.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+struct MessageSearchIndex::RegistryGuard {
+	MessageSearchIndex* msi {nullptr};
+	Message3Registry* reg {nullptr};
+
+	RegistryGuard(MessageSearchIndex* msi_, Message3Registry* reg_) : msi(msi_), reg(reg_) {}
+	RegistryGuard(RegistryGuard&& other) noexcept : msi(other.msi), reg(other.reg) { other.msi = nullptr; }
+	RegistryGuard(const RegistryGuard&) = delete;
+	RegistryGuard& operator=(const RegistryGuard&) = delete;
+	RegistryGuard& operator=(RegistryGuard&&) = delete;
+
+	~RegistryGuard(void) {
+		if (msi != nullptr) {
+			msi->unhook(reg);
+		}
+	}
+};
+
+MessageSearchIndex::Entry& MessageSearchIndex::hook(Message3Registry& reg, Contact4 c) {
+	if (auto it = _entries.find(&reg); it != _entries.end()) {
+		return it->second;
+	}
+
+	auto& entry = _entries[&reg];
+	entry.c = c;
+
+	std::string index_path;
+	if (!_save_path.empty()) {
+		if (const auto* id = _cs.registry().try_get<Contact::Components::ID>(c); id != nullptr && !id->data.empty()) {
+			index_path = (std::filesystem::u8path(_save_path) / bin2hex(id->data)).generic_u8string();
+		}
+	}
+	if (index_path.empty()) {
+		entry.index = std::make_unique<SearchIndex>();
+	} else {
+		// large indices take a while, so not on the main thread
+		entry.loading = std::async(std::launch::async, [index_path](void) {
+			TRACE_ZONE("search index load");
+			auto index = std::make_unique<SearchIndex>(index_path);
+			index->load();
+			return index;
+		});
+	}
+
+	// the address might get reused by a new registry
+	reg.ctx().emplace<RegistryGuard>(this, &reg);
+
+	return entry;
+}
+
+void MessageSearchIndex::unhook(Message3Registry* reg) {
+	// called while the registry is being destroyed, so dont touch it
+	auto it = _entries.find(reg);
+	if (it == _entries.end()) {
+		return;
+	}
+
+	finishLoad(it->second, true);
+	it->second.index->flush();
+	_entries.erase(it);
+}
+
+bool MessageSearchIndex::finishLoad(Entry& entry, bool wait) {
+	if (entry.index) {
+		return true;
+	}
+
+	assert(entry.loading.valid());
+	if (!wait && entry.loading.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		return false;
+	}
+
+	entry.index = entry.loading.get();
+
+	for (const auto& [ts, text] : entry.pending) {
+		entry.index->add(ts, text);
+	}
+	entry.pending.clear();
+	entry.pending.shrink_to_fit();
+
+	return true;
+}
+
+MessageSearchIndex::Entry* MessageSearchIndex::entryFor(const Message3Handle& m) {
+	auto* reg = m.registry();
+	if (reg == nullptr) {
+		return nullptr;
+	}
+
+	if (auto it = _entries.find(reg); it != _entries.end()) {
+		return &it->second;
+	}
+
+	// find the contact owning this registry, like UnreadIndex
+	if (const auto* c_to = m.try_get<Message::Components::ContactTo>(); c_to != nullptr && _rmm.get(c_to->c) == reg) {
+		return &hook(*reg, c_to->c);
+	} else if (const auto* c_from = m.try_get<Message::Components::ContactFrom>(); c_from != nullptr && _rmm.get(c_from->c) == reg) {
+		return &hook(*reg, c_from->c);
+	}
+
+	// unattributable, gets hooked on first query() instead
+	return nullptr;
+}
+
+void MessageSearchIndex::addMessage(const Message3Handle& m) {
+	const auto* text = m.try_get<Message::Components::MessageText>();
+	const auto* ts = m.try_get<Message::Components::Timestamp>();
+	if (text == nullptr || ts == nullptr) {
+		return;
+	}
+
+	auto* entry = entryFor(m);
+	if (entry == nullptr) {
+		return;
+	}
+
+	if (!finishLoad(*entry, false)) {
+		entry->pending.emplace_back(ts->ts, text->text);
+		return;
+	}
+
+	entry->index->add(ts->ts, text->text);
+}
+
+MessageSearchIndex::MessageSearchIndex(ContactStore4I& cs, RegistryMessageModelI& rmm, ConfigModelI& conf) :
+	_cs(cs), _rmm(rmm), _rmm_sr(_rmm.newSubRef(this))
+{
+	_rmm_sr
+		.subscribe(RegistryMessageModel_Event::message_construct)
+		.subscribe(RegistryMessageModel_Event::message_updated)
+	;
+
+	if (!conf.has_string("MessageSearchIndex", "save_path")) {
+		// should be next to the message store
+		conf.set("MessageSearchIndex", "save_path", std::string_view{"tmp_search_index"});
+	}
+
+	_save_path = conf.get_string("MessageSearchIndex", "save_path").value();
+	if (!_save_path.empty()) {
+		std::error_code ec;
+		std::filesystem::create_directories(std::filesystem::u8path(_save_path), ec);
+		if (ec) {
+			std::cerr << "MSI error: failed to create '" << _save_path << "', not persisting: " << ec.message() << "\n";
+			_save_path.clear();
+		}
+	}
+}
+
+MessageSearchIndex::~MessageSearchIndex(void) {
+	// entries only exist for live registries, the guard removes them
+	for (auto& [reg, entry] : _entries) {
+		finishLoad(entry, true);
+		entry.index->flush();
+
+		if (reg->ctx().contains<RegistryGuard>()) {
+			reg->ctx().get<RegistryGuard>().msi = nullptr;
+			reg->ctx().erase<RegistryGuard>();
+		}
+	}
+}
+
+void MessageSearchIndex::iterate(float time_delta) {
+	for (auto& [reg, entry] : _entries) {
+		finishLoad(entry, false);
+	}
+
+	_flush_timer += time_delta;
+	if (_flush_timer < 10.f) {
+		return;
+	}
+	_flush_timer = 0.f;
+
+	TRACE_ZONE("search index flush");
+	for (auto& [reg, entry] : _entries) {
+		if (!entry.index) {
+			continue;
+		}
+
+		entry.index->flushJournal();
+
+		if (entry.index->wantsCompact()) {
+			// rewrites the whole snapshot, so not on the main thread.
+			// new messages go to pending until finishLoad() takes it back
+			entry.loading = std::async(std::launch::async, [index = std::move(entry.index)](void) mutable {
+				TRACE_ZONE("search index compact");
+				index->compact();
+				return std::move(index);
+			});
+		}
+	}
+}
+
+bool MessageSearchIndex::ready(Contact4 c) {
+	auto* reg = _rmm.get(c);
+	if (reg == nullptr) {
+		return false;
+	}
+
+	return finishLoad(hook(*reg, c), false);
+}
+
+std::optional<SearchIndex::Result> MessageSearchIndex::query(Contact4 c, std::string_view q, size_t limit) {
+	auto* reg = _rmm.get(c);
+	if (reg == nullptr) {
+		return SearchIndex::Result{};
+	}
+
+	auto& entry = hook(*reg, c);
+	if (!finishLoad(entry, false)) {
+		return std::nullopt;
+	}
+	return entry.index->query(q, limit);
+}
+
+size_t MessageSearchIndex::docCount(Contact4 c) {
+	auto* reg = _rmm.get(c);
+	if (reg == nullptr) {
+		return 0;
+	}
+
+	auto& entry = hook(*reg, c);
+	if (!finishLoad(entry, false)) {
+		return 0;
+	}
+	return entry.index->docCount();
+}
+
+bool MessageSearchIndex::onEvent(const Message::Events::MessageConstruct& e) {
+	addMessage(e.e);
+	return false;
+}
+
+bool MessageSearchIndex::onEvent(const Message::Events::MessageUpdated& e) {
+	// an edit adds the new text, the old one stays findable
+	addMessage(e.e);
+	return false;
+}
+
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <solanaceae/message3/registry_message_model.hpp>
+
+#include "./search_index.hpp"
+
+#include <entt/container/dense_map.hpp>
+
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// fwd
+struct ConfigModelI;
+
+// keeps a SearchIndex over the MessageText of each contacts messages.
+// messages get added as they are constructed or updated, which includes
+// them being loaded from the message store, so the index fills up as history gets viewed.
+// indices are persisted per contact (by id) to the "MessageSearchIndex" "save_path",
+// and loaded on a worker when the contact first gets messages or searched.
+// compacting a large journal also happens on that worker, the index is unavailable meanwhile.
+class MessageSearchIndex : public RegistryMessageModelEventI {
+	ContactStore4I& _cs;
+	RegistryMessageModelI& _rmm;
+	RegistryMessageModelI::SubscriptionReference _rmm_sr;
+
+	std::string _save_path; // empty, if not persisting
+
+	struct Entry {
+		Contact4 c; // owner of the registry
+		std::unique_ptr<SearchIndex> index; // nullptr while loading or compacting
+		std::future<std::unique_ptr<SearchIndex>> loading; // also used for compacting
+		std::vector<std::pair<uint64_t, std::string>> pending; // (ts, text) added while loading
+	};
+	entt::dense_map<Message3Registry*, Entry> _entries;
+
+	// put into the registry context, drops the entry when the registry is destroyed
+	struct RegistryGuard;
+
+	float _flush_timer {0.f};
+
+	Entry& hook(Message3Registry& reg, Contact4 c);
+	void unhook(Message3Registry* reg);
+	Entry* entryFor(const Message3Handle& m);
+	void addMessage(const Message3Handle& m);
+
+	// takes the loaded (or compacted) index and adds what came in meanwhile.
+	// returns false if it is still loading and wait is false.
+	bool finishLoad(Entry& entry, bool wait);
+
+	public:
+		MessageSearchIndex(ContactStore4I& cs, RegistryMessageModelI& rmm, ConfigModelI& conf);
+		~MessageSearchIndex(void);
+
+		// writes new documents to disk once in a while, compacts on a worker
+		void iterate(float time_delta);
+
+		// starts loading the index if needed, false while it is loading or compacting
+		bool ready(Contact4 c);
+
+		// empty while the index is not ready, never waits
+		std::optional<SearchIndex::Result> query(Contact4 c, std::string_view q, size_t limit = 1000);
+
+		// documents in the contacts index, 0 while not ready
+		size_t docCount(Contact4 c);
+
+	protected: // rmm
+		bool onEvent(const Message::Events::MessageConstruct& e) override;
+		bool onEvent(const Message::Events::MessageUpdated& e) override;
+};
+
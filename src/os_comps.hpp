@@ -6,6 +6,8 @@
 
 #include <entt/container/dense_map.hpp>
 
+#include <cstdint>
+
 namespace ObjectStore::Components {
 
 	namespace Ephemeral {
@@ -18,6 +20,11 @@ namespace ObjectStore::Components {
 
 		} // File
 
+		// ImageCodecRegistry::Format, cached after the first successful load
+		struct ImageCodecFormat {
+			uint8_t format {0};
+		};
+
 	} // Ephemeral
 
 } // ObjectStore::Components
@@ -19,6 +19,7 @@ constexpr std::string_view entt::type_name<x>::value() noexcept { \
 // cross compile(r) stable ids
 
 DEFINE_COMP_ID(ObjComp::Ephemeral::File::TransferStatsSeparated)
+DEFINE_COMP_ID(ObjComp::Ephemeral::ImageCodecFormat)
 
 #undef DEFINE_COMP_ID
 
@@ -0,0 +1,253 @@
+#include "./render_damage.hpp"
+
+#include <algorithm>
+#include <limits>
+
+const char* RenderDamage::reasonName(Reason r) {
+	switch (r) {
+		case INPUT: return "input";
+		case WINDOW: return "window";
+		case MESSAGE: return "message";
+		case CONTACT: return "contact";
+		case OBJECT: return "object";
+		case TEXTURE: return "texture";
+		case SCHEDULED: return "scheduled";
+		case HEARTBEAT: return "heartbeat";
+		case MAX: break;
+	}
+	return "unknown";
+}
+
+RenderDamage::RenderDamage(RegistryMessageModelI& rmm, ContactStore4I& cs, ObjectStore2& os) :
+	_rmm_sr(rmm.newSubRef(this)),
+	_cs_sr(cs.newSubRef(this)),
+	_os_sr(os.newSubRef(this)),
+	_scheduled(std::numeric_limits<float>::infinity())
+{
+	_rmm_sr
+		.subscribe(RegistryMessageModel_Event::message_construct)
+		.subscribe(RegistryMessageModel_Event::message_updated)
+	;
+
+	_cs_sr
+		.subscribe(ContactStore4_Event::contact_construct)
+		.subscribe(ContactStore4_Event::contact_update)
+		.subscribe(ContactStore4_Event::contact_destroy)
+	;
+
+	_os_sr
+		.subscribe(ObjectStore_Event::object_construct)
+		.subscribe(ObjectStore_Event::object_update)
+		.subscribe(ObjectStore_Event::object_destroy)
+	;
+}
+
+void RenderDamage::schedule(float interval) {
+	_scheduled = std::min(_scheduled, std::max(interval, 0.f));
+}
+
+float RenderDamage::nextFrame(float render_interval, float heartbeat) const {
+	if (damaged()) {
+		return render_interval;
+	}
+
+	return std::max(render_interval, std::min(_scheduled, heartbeat));
+}
+
+void RenderDamage::beginFrame(float time_delta) {
+	uint32_t reasons = _pending;
+	if (reasons == 0) {
+		reasons = time_delta >= _scheduled ? 1u << SCHEDULED : 1u << HEARTBEAT;
+	}
+
+	_frames++;
+	for (size_t i = 0; i < _frames_by_reason.size(); i++) {
+		if (reasons & (1u << i)) {
+			_frames_by_reason[i]++;
+		}
+	}
+	_last_reasons = reasons;
+
+	if (_pending != 0) {
+		// imgui often needs a second frame to settle (sizes, scroll to bottom, popups)
+		_scheduled = 0.f;
+	} else {
+		_scheduled = std::numeric_limits<float>::infinity();
+	}
+	_pending = 0;
+}
+
+bool RenderDamage::onEvent(const Message::Events::MessageConstruct&) {
+	add(MESSAGE);
+	return false;
+}
+
+bool RenderDamage::onEvent(const Message::Events::MessageUpdated&) {
+	add(MESSAGE);
+	return false;
+}
+
+bool RenderDamage::onEvent(const ContactStore::Events::Contact4Construct&) {
+	add(CONTACT);
+	return false;
+}
+
+bool RenderDamage::onEvent(const ContactStore::Events::Contact4Update&) {
+	add(CONTACT);
+	return false;
+}
+
+bool RenderDamage::onEvent(const ContactStore::Events::Contact4Destory&) {
+	add(CONTACT);
+	return false;
+}
+
+bool RenderDamage::onEvent(const ObjectStore::Events::ObjectConstruct&) {
+	add(OBJECT);
+	return false;
+}
+
+bool RenderDamage::onEvent(const ObjectStore::Events::ObjectUpdate&) {
+	add(OBJECT);
+	return false;
+}
+
+bool RenderDamage::onEvent(const ObjectStore::Events::ObjectDestory&) {
+	add(OBJECT);
+	return false;
+}
+
+// calculate interval for next frame
+// (the interval only paces frames, if there is one at all is up to the damage)
+// normal:
+//  - if < 1.5sec since last event
+//    - min all and clamp(1/60, 1/1)
+//  - if < 30sec since last event
+//    - min all (anim + everything else) clamp(1/60, 1/1) (maybe less?)
+//  - else
+//    - min without anim and clamp(1/60, 1/1) (maybe more?)
+// reduced:
+//  - if < 1sec since last event
+//    - min all and clamp(1/60, 1/1)
+//  - if < 10sec since last event
+//    - min all (anim + everything else) clamp(1/10, 1/1)
+//  - else
+//    - min without anim and max clamp(1/10, 1/1)
+// powersave:
+//  - if < 0sec since last event
+//    - (ignored)
+//  - if < 1sec since last event
+//    - min all (anim + everything else) clamp(1/8, 1/1)
+//  - else
+//    - min without anim and clamp(1/1, 1/1)
+const RenderPerfProfile& RenderPerfProfile::get(int fps_perf_mode) {
+	const static RenderPerfProfile normalPerfProfile{
+		//1.5f,		// low_delay_window
+		//1.f/60.f,	// low_delay_min
+		//1.f/60.f,	// low_delay_max
+
+		//30.f,		// mid_delay_window
+		//1.f/60.f,	// mid_delay_min
+		//1.f/2.f,	// mid_delay_max
+
+		//1.f/60.f,	// else_delay_min
+		//1.f/2.f,	// else_delay_max
+
+		//5.f,		// heartbeat
+	};
+	const static RenderPerfProfile reducedPerfProfile{
+		1.f,		// low_delay_window
+		1.f/60.f,	// low_delay_min
+		1.f/30.f,	// low_delay_max
+
+		10.f,		// mid_delay_window
+		1.f/10.f,	// mid_delay_min
+		1.f/4.f,	// mid_delay_max
+
+		1.f/10.f,	// else_delay_min
+		1.f,		// else_delay_max
+
+		10.f,		// heartbeat
+	};
+	// TODO: fix powersave by adjusting it in the events handler (make ppr member)
+	const static RenderPerfProfile powersavePerfProfile{
+		// no window -> ignore first case
+		0.f,		// low_delay_window
+		1.f,		// low_delay_min
+		1.f,		// low_delay_max
+
+		1.f,		// mid_delay_window
+		1.f/8.f,	// mid_delay_min
+		1.f/4.f,	// mid_delay_max
+
+		1.f,		// else_delay_min
+		1.f,		// else_delay_max
+
+		10.f,		// heartbeat
+	};
+
+	// TODO: magic
+	return fps_perf_mode > 1
+		? powersavePerfProfile
+		: (
+			fps_perf_mode == 1
+			? reducedPerfProfile
+			: normalPerfProfile
+		)
+	;
+}
+
+float scheduleRender(
+	RenderDamage& damage,
+	const RenderPerfProfile& profile,
+	float interval,
+	float anim_interval,
+	float time_since_event,
+	bool window_hidden,
+	bool want_text_input,
+	bool& cursor_blink
+) {
+	// what reports an interval wants a frame after it, even without damage
+	damage.schedule(interval);
+
+	// low delay time window
+	if (!window_hidden && time_since_event < profile.low_delay_window) {
+		interval = std::min<float>(interval, anim_interval);
+
+		// hover delays, tooltips and imgui animations after input
+		damage.schedule(0.f);
+		cursor_blink = true;
+
+		return std::clamp(
+			interval,
+			profile.low_delay_min,
+			profile.low_delay_max
+		);
+	// mid delay time window
+	} else if (!window_hidden && time_since_event < profile.mid_delay_window) {
+		interval = std::min<float>(interval, anim_interval);
+
+		damage.schedule(interval);
+		if (want_text_input) {
+			damage.schedule(0.4f); // text cursor blink
+		}
+		cursor_blink = true;
+
+		return std::clamp(
+			interval,
+			profile.mid_delay_min,
+			profile.mid_delay_max
+		);
+	// timed out or window hidden
+	} else {
+		// no animation timing here
+		// and no blinking, so the cursor does not get stuck invisible
+		cursor_blink = false;
+
+		return std::clamp(
+			interval,
+			profile.else_delay_min,
+			profile.else_delay_max
+		);
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <solanaceae/object_store/object_store.hpp>
+#include <solanaceae/contact/contact_store_events.hpp>
+#include <solanaceae/contact/contact_store_i.hpp>
+#include <solanaceae/message3/registry_message_model.hpp>
+
+#include <array>
+#include <cstdint>
+
+// collects what changed since the last frame, so frames where nothing did can be skipped.
+// model events (messages, contacts, objects) damage by themselves,
+// the rest (input, window, textures) gets added by the owner.
+// things that change with time alone (animations, timers, video) schedule a frame instead,
+// and a heartbeat catches everything that neither damages nor schedules.
+class RenderDamage : public RegistryMessageModelEventI, public ContactStore4EventI, public ObjectStoreEventI {
+	public:
+		enum Reason : uint8_t {
+			INPUT,
+			WINDOW,
+			MESSAGE,
+			CONTACT,
+			OBJECT,
+			TEXTURE,
+			SCHEDULED, // animation or timer ran out
+			HEARTBEAT,
+
+			MAX
+		};
+
+		static const char* reasonName(Reason r);
+
+	private:
+		RegistryMessageModelI::SubscriptionReference _rmm_sr;
+		ContactStore4I::SubscriptionReference _cs_sr;
+		ObjectStore2::SubscriptionReference _os_sr;
+
+		uint32_t _pending {1u << WINDOW}; // the first frame
+		float _scheduled; // seconds after the last frame
+
+		// stats
+		std::array<uint64_t, MAX> _frames_by_reason {};
+		uint64_t _frames {0};
+		uint32_t _last_reasons {0};
+
+	public:
+		RenderDamage(RegistryMessageModelI& rmm, ContactStore4I& cs, ObjectStore2& os);
+
+		void add(Reason r) { _pending |= 1u << r; }
+		bool damaged(void) const { return _pending != 0; }
+
+		// want a frame this many seconds after the last one, even without damage.
+		// only holds until the next frame, so animations reschedule every frame.
+		void schedule(float interval);
+
+		// seconds after the last frame the next one is due.
+		// render_interval paces frames while damaged, heartbeat caps the wait while not.
+		float nextFrame(float render_interval, float heartbeat) const;
+
+		// call at the start of a frame, time_delta being the time since the last one.
+		// takes the damage, anything added while rendering goes to the next frame.
+		void beginFrame(float time_delta);
+
+		uint64_t frames(void) const { return _frames; }
+		uint64_t frames(Reason r) const { return _frames_by_reason.at(r); }
+		bool lastFrameHad(Reason r) const { return _last_reasons & (1u << r); }
+
+	protected: // rmm
+		bool onEvent(const Message::Events::MessageConstruct&) override;
+		bool onEvent(const Message::Events::MessageUpdated&) override;
+
+	protected: // cs
+		bool onEvent(const ContactStore::Events::Contact4Construct&) override;
+		bool onEvent(const ContactStore::Events::Contact4Update&) override;
+		bool onEvent(const ContactStore::Events::Contact4Destory&) override;
+
+	protected: // os
+		bool onEvent(const ObjectStore::Events::ObjectConstruct&) override;
+		bool onEvent(const ObjectStore::Events::ObjectUpdate&) override;
+		bool onEvent(const ObjectStore::Events::ObjectDestory&) override;
+};
+
+// how fast frames get paced, by how long the last input (event) was ago
+struct RenderPerfProfile {
+	float low_delay_window {1.5f};
+	float low_delay_min {1.f/60.f};
+	float low_delay_max {1.f/60.f};
+
+	float mid_delay_window {30.f};
+	float mid_delay_min {1.f/60.f};
+	float mid_delay_max {1.f/2.f};
+
+	// also when main window hidden
+	float else_delay_min {1.f/60.f};
+	float else_delay_max {1.f/2.f};
+
+	// max time without a frame, if nothing is damaged
+	float heartbeat {5.f};
+
+	// 0 normal, 1 reduced, 2+ powersave
+	static const RenderPerfProfile& get(int fps_perf_mode);
+};
+
+// returns the render interval for the next frame and schedules on damage what wants one.
+// interval is the min over everything but animations, anim_interval over animations,
+// which only count while the last input is recent.
+// this is MainScreen's frame pacing, shared so it can be benched.
+float scheduleRender(
+	RenderDamage& damage,
+	const RenderPerfProfile& profile,
+	float interval,
+	float anim_interval,
+	float time_since_event,
+	bool window_hidden,
+	bool want_text_input,
+	bool& cursor_blink
+);
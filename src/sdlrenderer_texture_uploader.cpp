@@ -126,6 +126,21 @@ bool SDLRendererTextureUploader::update(uint64_t tex_id, const uint8_t* data, si
 	return true;
 }
 
+bool SDLRendererTextureUploader::updateRect(uint64_t tex_id, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data) {
+	auto* texture = static_cast<SDL_Texture*>(reinterpret_cast<void*>(tex_id));
+	if (texture == nullptr) {
+		return false;
+	}
+
+	const SDL_Rect rect {int(x), int(y), int(width), int(height)};
+	if (!SDL_UpdateTexture(texture, &rect, data, int(width*4))) {
+		std::cerr << "SDLRTU error: tex rect update failed " << SDL_GetError() << "\n";
+		return false;
+	}
+
+	return true;
+}
+
 void SDLRendererTextureUploader::destroy(uint64_t tex_id) {
 	SDL_DestroyTexture(static_cast<SDL_Texture*>(reinterpret_cast<void*>(tex_id)));
 }
@@ -14,6 +14,7 @@ struct SDLRendererTextureUploader : public TextureUploaderI {
 	bool updateRGBA(uint64_t tex_id, const uint8_t* data, size_t size) override;
 	uint64_t upload(const uint8_t* data, uint32_t width, uint32_t height, Format format, Filter filter, Access access) override;
 	bool update(uint64_t tex_id, const uint8_t* data, size_t size) override;
+	bool updateRect(uint64_t tex_id, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data) override;
 	void destroy(uint64_t tex_id) override;
 };
 
@@ -0,0 +1,550 @@
+#include "./search_index.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include <iostream>
+
+// file formats, all integers are LEB128 varints
+// snapshot: "TSI\x01", doc count, per doc (ts, text hash),
+//           term count, per term (size, bytes, postings count, postings delta encoded)
+// journal:  per doc (ts, text hash, term count, per term (size, bytes)), no header
+static constexpr std::string_view g_snapshot_magic {"TSI\x01", 4};
+
+static void writeVarint(std::string& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back(char((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(char(value));
+}
+
+namespace {
+
+struct Reader {
+	const uint8_t* ptr {nullptr};
+	const uint8_t* end {nullptr};
+
+	bool empty(void) const { return ptr >= end; }
+
+	bool varint(uint64_t& value) {
+		value = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7) {
+			if (ptr >= end) {
+				return false;
+			}
+			const uint8_t byte = *ptr++;
+			value |= uint64_t(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool bytes(size_t size, std::string_view& out) {
+		if (size_t(end - ptr) < size) {
+			return false;
+		}
+		out = {reinterpret_cast<const char*>(ptr), size};
+		ptr += size;
+		return true;
+	}
+};
+
+} // namespace
+
+static bool readFile(const std::string& file_path, std::string& out) {
+	std::ifstream file(std::filesystem::u8path(file_path), std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !file.bad();
+}
+
+// a is the smaller list, gets replaced by the intersection
+static void intersectInto(std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+	size_t out {0};
+	if (b.size() / 16 > a.size()) {
+		// b is much larger, binary search forward through it
+		auto b_it = b.cbegin();
+		for (const uint32_t v : a) {
+			b_it = std::lower_bound(b_it, b.cend(), v);
+			if (b_it == b.cend()) {
+				break;
+			}
+			if (*b_it == v) {
+				a[out++] = v;
+			}
+		}
+	} else {
+		auto b_it = b.cbegin();
+		for (const uint32_t v : a) {
+			while (b_it != b.cend() && *b_it < v) {
+				b_it++;
+			}
+			if (b_it == b.cend()) {
+				break;
+			}
+			if (*b_it == v) {
+				a[out++] = v;
+			}
+		}
+	}
+	a.resize(out);
+}
+
+SearchIndex::SearchIndex(std::string path) : _path(std::move(path)) {
+}
+
+uint64_t SearchIndex::docKey(uint64_t ts, uint32_t text_hash) {
+	return ts ^ (uint64_t(text_hash) * 0x9e3779b97f4a7c15ull);
+}
+
+uint32_t SearchIndex::hashText(std::string_view text) {
+	// fnv-1a
+	uint32_t hash {2166136261u};
+	for (const char c : text) {
+		hash ^= uint8_t(c);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool SearchIndex::tokenize(std::string_view text, std::vector<std::string>& terms_out) {
+	// reuses the strings already in terms_out
+	size_t count {0};
+
+	bool in_term {false};
+	for (const char c : text) {
+		const auto ch = uint8_t(c);
+		const bool upper = ch >= 'A' && ch <= 'Z';
+		const bool letter = upper || (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch >= 0x80;
+		if (!letter) {
+			in_term = false;
+			continue;
+		}
+
+		if (!in_term) {
+			if (count == terms_out.size()) {
+				terms_out.emplace_back();
+			}
+			terms_out[count++].clear();
+			in_term = true;
+		}
+
+		auto& term = terms_out[count-1];
+		if (term.size() < max_term_size) {
+			term.push_back(upper ? char(ch - 'A' + 'a') : c);
+		}
+	}
+
+	terms_out.resize(count);
+
+	return in_term;
+}
+
+void SearchIndex::addDoc(const Doc& doc, std::vector<std::string>& terms) {
+	const auto doc_i = uint32_t(_docs.size());
+	_docs.push_back(doc);
+	_doc_lookup.emplace(docKey(doc.ts, doc.text_hash), doc_i);
+
+	std::sort(terms.begin(), terms.end());
+	terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+	for (const auto& term : terms) {
+		const auto [it, inserted] = _term_ids.try_emplace(term, uint32_t(_postings.size()));
+		if (inserted) {
+			_postings.emplace_back();
+		}
+		_postings[it->second].push_back(doc_i);
+	}
+	_postings_count += terms.size();
+}
+
+void SearchIndex::clear(void) {
+	_docs.clear();
+	_doc_lookup.clear();
+	_term_ids.clear();
+	_postings.clear();
+	_postings_count = 0;
+	_sorted_terms.clear();
+}
+
+const std::vector<std::pair<std::string_view, uint32_t>>& SearchIndex::sortedTerms(void) const {
+	if (_sorted_terms.size() != _term_ids.size()) {
+		_sorted_terms.clear();
+		_sorted_terms.reserve(_term_ids.size());
+		for (const auto& [term, term_id] : _term_ids) {
+			_sorted_terms.emplace_back(term, term_id);
+		}
+		std::sort(_sorted_terms.begin(), _sorted_terms.end());
+	}
+	return _sorted_terms;
+}
+
+bool SearchIndex::add(uint64_t ts, std::string_view text) {
+	const uint32_t text_hash = hashText(text);
+	if (contains(ts, text_hash)) {
+		return false;
+	}
+
+	tokenize(text, _tmp_terms);
+
+	if (!_path.empty()) {
+		writeVarint(_journal_pending, ts);
+		writeVarint(_journal_pending, text_hash);
+		writeVarint(_journal_pending, _tmp_terms.size());
+		for (const auto& term : _tmp_terms) {
+			writeVarint(_journal_pending, term.size());
+			_journal_pending += term;
+		}
+		_journal_docs++;
+	}
+
+	addDoc({ts, text_hash}, _tmp_terms);
+
+	return true;
+}
+
+bool SearchIndex::contains(uint64_t ts, uint32_t text_hash) const {
+	const auto it = _doc_lookup.find(docKey(ts, text_hash));
+	if (it == _doc_lookup.cend()) {
+		return false;
+	}
+	const auto& doc = _docs[it->second];
+	return doc.ts == ts && doc.text_hash == text_hash;
+}
+
+SearchIndex::Result SearchIndex::query(std::string_view q, size_t limit) const {
+	Result res;
+
+	std::vector<std::string> terms;
+	bool last_is_prefix = tokenize(q, terms);
+	if (last_is_prefix && terms.size() > 1 && terms.back().size() < min_prefix_size) {
+		// still typing, keep the results of the words before
+		terms.pop_back();
+		last_is_prefix = false;
+	}
+	if (terms.empty()) {
+		return res;
+	}
+
+	std::vector<const std::vector<uint32_t>*> lists;
+	std::vector<uint32_t> prefix_union;
+	for (size_t i = 0; i < terms.size(); i++) {
+		const auto& term = terms[i];
+
+		if (i+1 == terms.size() && last_is_prefix && term.size() >= min_prefix_size) {
+			const auto& sorted_terms = sortedTerms();
+			std::vector<const std::vector<uint32_t>*> matches;
+			for (
+				auto it = std::lower_bound(sorted_terms.cbegin(), sorted_terms.cend(), std::make_pair(std::string_view{term}, uint32_t(0)));
+				it != sorted_terms.cend() && it->first.substr(0, term.size()) == term;
+				it++
+			) {
+				matches.push_back(&_postings[it->second]);
+			}
+
+			if (matches.empty()) {
+				return res;
+			} else if (matches.size() == 1) {
+				lists.push_back(matches.front());
+			} else {
+				for (const auto* postings : matches) {
+					prefix_union.insert(prefix_union.cend(), postings->cbegin(), postings->cend());
+				}
+				std::sort(prefix_union.begin(), prefix_union.end());
+				prefix_union.erase(std::unique(prefix_union.begin(), prefix_union.end()), prefix_union.end());
+				lists.push_back(&prefix_union);
+			}
+		} else {
+			const auto it = _term_ids.find(term);
+			if (it == _term_ids.cend()) {
+				return res;
+			}
+			lists.push_back(&_postings[it->second]);
+		}
+	}
+
+	// smallest first, keeps the intermediate result small
+	std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+	std::vector<uint32_t> docs = *lists.front();
+	for (size_t i = 1; i < lists.size() && !docs.empty(); i++) {
+		intersectInto(docs, *lists[i]);
+	}
+
+	res.total = docs.size();
+
+	// docs are in insertion order, which is not time order (history gets loaded backwards)
+	const auto newer = [this](uint32_t a, uint32_t b) { return _docs[a].ts > _docs[b].ts; };
+	if (docs.size() > limit) {
+		std::nth_element(docs.begin(), docs.begin() + limit, docs.end(), newer);
+		docs.resize(limit);
+	}
+	std::sort(docs.begin(), docs.end(), newer);
+
+	res.hits.reserve(docs.size());
+	for (const uint32_t doc_i : docs) {
+		res.hits.push_back(_docs[doc_i]);
+	}
+
+	return res;
+}
+
+bool SearchIndex::loadSnapshot(const std::string& file_path) {
+	std::string data;
+	if (!readFile(file_path, data)) {
+		return false; // first start
+	}
+
+	if (std::string_view{data}.substr(0, g_snapshot_magic.size()) != g_snapshot_magic) {
+		std::cerr << "SI error: not a search index snapshot '" << file_path << "'\n";
+		return false;
+	}
+
+	Reader r{
+		reinterpret_cast<const uint8_t*>(data.data()) + g_snapshot_magic.size(),
+		reinterpret_cast<const uint8_t*>(data.data()) + data.size()
+	};
+
+	uint64_t doc_count {0};
+	if (!r.varint(doc_count) || doc_count > data.size()) {
+		std::cerr << "SI error: corrupt search index snapshot '" << file_path << "'\n";
+		return false;
+	}
+
+	_docs.reserve(doc_count);
+	_doc_lookup.reserve(doc_count);
+	for (uint64_t i = 0; i < doc_count; i++) {
+		uint64_t ts {0};
+		uint64_t text_hash {0};
+		if (!r.varint(ts) || !r.varint(text_hash)) {
+			std::cerr << "SI error: corrupt search index snapshot '" << file_path << "'\n";
+			return false;
+		}
+		_doc_lookup.emplace(docKey(ts, uint32_t(text_hash)), uint32_t(_docs.size()));
+		_docs.push_back({ts, uint32_t(text_hash)});
+	}
+
+	uint64_t term_count {0};
+	if (!r.varint(term_count)) {
+		std::cerr << "SI error: corrupt search index snapshot '" << file_path << "'\n";
+		return false;
+	}
+
+	_term_ids.reserve(term_count);
+	_postings.reserve(term_count);
+	for (uint64_t i = 0; i < term_count; i++) {
+		uint64_t term_size {0};
+		std::string_view term;
+		uint64_t postings_count {0};
+		if (!r.varint(term_size) || !r.bytes(term_size, term) || !r.varint(postings_count) || postings_count > doc_count) {
+			std::cerr << "SI error: corrupt search index snapshot '" << file_path << "'\n";
+			return false;
+		}
+
+		const auto [it, inserted] = _term_ids.try_emplace(std::string{term}, uint32_t(_postings.size()));
+		if (!inserted) {
+			std::cerr << "SI error: corrupt search index snapshot '" << file_path << "'\n";
+			return false;
+		}
+		// written sorted, keep them that way if they are
+		if (_sorted_terms.empty() || _sorted_terms.back().first < it->first) {
+			_sorted_terms.emplace_back(it->first, it->second);
+		}
+		auto& postings = _postings.emplace_back();
+		postings.reserve(postings_count);
+		uint64_t doc_i {0};
+		for (uint64_t j = 0; j < postings_count; j++) {
+			uint64_t delta {0};
+			if (!r.varint(delta) || (j > 0 && delta == 0) || doc_i + delta >= doc_count) {
+				std::cerr << "SI error: corrupt search index snapshot '" << file_path << "'\n";
+				return false;
+			}
+			doc_i += delta;
+			postings.push_back(uint32_t(doc_i));
+		}
+
+		_postings_count += postings.size();
+	}
+
+	return true;
+}
+
+bool SearchIndex::loadJournal(const std::string& file_path) {
+	std::string data;
+	if (!readFile(file_path, data)) {
+		return false;
+	}
+
+	Reader r{
+		reinterpret_cast<const uint8_t*>(data.data()),
+		reinterpret_cast<const uint8_t*>(data.data()) + data.size()
+	};
+
+	std::vector<std::string> terms;
+	const uint8_t* record_end = r.ptr;
+	while (!r.empty()) {
+		uint64_t ts {0};
+		uint64_t text_hash {0};
+		uint64_t term_count {0};
+		if (!r.varint(ts) || !r.varint(text_hash) || !r.varint(term_count)) {
+			break;
+		}
+
+		terms.clear();
+		bool complete {true};
+		for (uint64_t i = 0; i < term_count; i++) {
+			uint64_t term_size {0};
+			std::string_view term;
+			if (!r.varint(term_size) || !r.bytes(term_size, term)) {
+				complete = false;
+				break;
+			}
+			terms.emplace_back(term);
+		}
+		if (!complete) {
+			break;
+		}
+
+		record_end = r.ptr;
+		_journal_docs++;
+
+		if (!contains(ts, uint32_t(text_hash))) {
+			addDoc({ts, uint32_t(text_hash)}, terms);
+		}
+	}
+
+	if (record_end != r.end) {
+		// torn write, cut it off so appending continues after the last complete record
+		const auto good_size = record_end - reinterpret_cast<const uint8_t*>(data.data());
+		std::cerr << "SI warning: dropping " << data.size() - good_size << " bytes of incomplete journal '" << file_path << "'\n";
+		std::error_code ec;
+		std::filesystem::resize_file(std::filesystem::u8path(file_path), good_size, ec);
+	}
+
+	return true;
+}
+
+bool SearchIndex::load(void) {
+	clear();
+	_journal_pending.clear();
+	_journal_docs = 0;
+
+	if (_path.empty()) {
+		return false;
+	}
+
+	if (!loadSnapshot(_path + ".idx")) {
+		// start over, the journal might still have something
+		clear();
+	}
+
+	loadJournal(_path + ".journal");
+
+	return !_docs.empty();
+}
+
+bool SearchIndex::flush(void) {
+	if (!flushJournal()) {
+		return false;
+	}
+
+	if (wantsCompact()) {
+		return compact();
+	}
+
+	return true;
+}
+
+bool SearchIndex::flushJournal(void) {
+	if (_path.empty()) {
+		return false;
+	}
+
+	if (!_journal_pending.empty()) {
+		std::ofstream file(std::filesystem::u8path(_path + ".journal"), std::ios::binary | std::ios::app);
+		if (!file.is_open()) {
+			std::cerr << "SI error: failed to open journal '" << _path << ".journal'\n";
+			return false;
+		}
+		file.write(_journal_pending.data(), _journal_pending.size());
+		if (!file.good()) {
+			std::cerr << "SI error: failed to append to journal '" << _path << ".journal'\n";
+			return false;
+		}
+		_journal_pending.clear();
+	}
+
+	return true;
+}
+
+bool SearchIndex::wantsCompact(void) const {
+	// replaying the journal on load costs about as much as the snapshot
+	// once it reaches a quarter of the docs
+	return !_path.empty() && _journal_docs >= 4096 && _journal_docs*4 >= _docs.size();
+}
+
+bool SearchIndex::compact(void) {
+	if (_path.empty()) {
+		return false;
+	}
+
+	std::string out;
+	out.reserve(g_snapshot_magic.size() + _docs.size() * 12 + _postings_count * 2 + _postings.size() * 12);
+	out += g_snapshot_magic;
+
+	writeVarint(out, _docs.size());
+	for (const auto& doc : _docs) {
+		writeVarint(out, doc.ts);
+		writeVarint(out, doc.text_hash);
+	}
+
+	// sorted, so loadSnapshot() can take the order as is
+	const auto& sorted_terms = sortedTerms();
+	writeVarint(out, sorted_terms.size());
+	for (const auto& [term, term_id] : sorted_terms) {
+		const auto& postings = _postings[term_id];
+		writeVarint(out, term.size());
+		out += term;
+		writeVarint(out, postings.size());
+		uint32_t prev {0};
+		for (const uint32_t doc_i : postings) {
+			writeVarint(out, doc_i - prev);
+			prev = doc_i;
+		}
+	}
+
+	const auto tmp_path = std::filesystem::u8path(_path + ".idx.tmp");
+	{
+		std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "SI error: failed to write snapshot '" << _path << ".idx'\n";
+			return false;
+		}
+		file.write(out.data(), out.size());
+		if (!file.good()) {
+			std::cerr << "SI error: failed to write snapshot '" << _path << ".idx'\n";
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmp_path, std::filesystem::u8path(_path + ".idx"), ec);
+	if (ec) {
+		std::cerr << "SI error: failed to replace snapshot: " << ec.message() << "\n";
+		return false;
+	}
+
+	// everything is in the snapshot now, including what was still pending
+	std::filesystem::remove(std::filesystem::u8path(_path + ".journal"), ec);
+	_journal_pending.clear();
+	_journal_docs = 0;
+
+	return true;
+}
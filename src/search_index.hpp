@@ -0,0 +1,103 @@
+#pragma once
+
+#include <entt/container/dense_map.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// inverted index over the texts of one message log.
+// documents are identified by timestamp and a hash of the text, so the same
+// message being loaded again (eg. from the message store) is not added twice.
+// persisted as a snapshot plus an append only journal of documents added since,
+// the journal gets folded into the snapshot once it grows large.
+class SearchIndex {
+	public:
+		struct Doc {
+			uint64_t ts {0}; // ms
+			uint32_t text_hash {0};
+		};
+
+		struct Result {
+			std::vector<Doc> hits; // newest first
+			size_t total {0}; // before the limit
+		};
+
+		// terms are bytes, ascii gets lower cased, everything >= 0x80 counts as a letter
+		static constexpr size_t max_term_size {32};
+		// shorter prefixes are only matched as whole terms (would hit most of the vocabulary),
+		// or ignored if there are other terms
+		static constexpr size_t min_prefix_size {2};
+
+	private:
+		std::vector<Doc> _docs;
+		entt::dense_map<uint64_t, uint32_t> _doc_lookup; // docKey() -> doc
+
+		std::unordered_map<std::string, uint32_t> _term_ids;
+		// by term id, doc indices, ascending (docs only ever get appended)
+		std::vector<std::vector<uint32_t>> _postings;
+		size_t _postings_count {0};
+
+		// for prefix lookups and writing, views into _term_ids keys.
+		// sorted on demand, when terms got added since
+		mutable std::vector<std::pair<std::string_view, uint32_t>> _sorted_terms;
+
+		// files are <_path>.idx and <_path>.journal, no persistence if empty
+		std::string _path;
+
+		std::string _journal_pending; // encoded, not yet appended
+		size_t _journal_docs {0}; // in the journal file + pending
+
+		std::vector<std::string> _tmp_terms; // reused
+
+		static uint64_t docKey(uint64_t ts, uint32_t text_hash);
+
+		void addDoc(const Doc& doc, std::vector<std::string>& terms);
+		void clear(void);
+		const std::vector<std::pair<std::string_view, uint32_t>>& sortedTerms(void) const;
+
+		bool loadSnapshot(const std::string& file_path);
+		bool loadJournal(const std::string& file_path);
+
+	public:
+		SearchIndex(void) = default;
+		SearchIndex(std::string path);
+
+		static uint32_t hashText(std::string_view text);
+
+		// splits into terms, as used by add() and query()
+		// returns true if the text ends inside a term
+		static bool tokenize(std::string_view text, std::vector<std::string>& terms_out);
+
+		// returns false if the document was already indexed
+		bool add(uint64_t ts, std::string_view text);
+		bool contains(uint64_t ts, uint32_t text_hash) const;
+
+		// all terms have to match, the last one as prefix (unless the query ends in a separator)
+		Result query(std::string_view q, size_t limit) const;
+
+		// reads snapshot and journal, replaces the current content
+		bool load(void);
+
+		// appends pending documents to the journal and compacts if it got large
+		bool flush(void);
+
+		// appends pending documents to the journal, cheap
+		bool flushJournal(void);
+
+		// the journal got large enough for compact() to pay off
+		bool wantsCompact(void) const;
+
+		// writes a new snapshot and drops the journal
+		bool compact(void);
+
+		const std::string& path(void) const { return _path; }
+		size_t docCount(void) const { return _docs.size(); }
+		size_t termCount(void) const { return _postings.size(); }
+		size_t postingsCount(void) const { return _postings_count; }
+		size_t journalDocs(void) const { return _journal_docs; }
+};
+
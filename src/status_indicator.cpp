@@ -1,10 +1,5 @@
 #include "./status_indicator.hpp"
 
-#include <solanaceae/contact/contact_store_i.hpp>
-
-#include <solanaceae/contact/components.hpp>
-#include <solanaceae/message3/components.hpp>
-
 #include "./icon_generator.hpp"
 
 #include <memory>
@@ -37,13 +32,11 @@ void StatusIndicator::updateState(State state) {
 }
 
 StatusIndicator::StatusIndicator(
-	RegistryMessageModelI& rmm,
-	ContactStore4I& cs,
+	const UnreadIndex& unread,
 	SDL_Window* main_window,
 	SystemTray* tray
 ) :
-	_rmm(rmm),
-	_cs(cs),
+	_unread(unread),
 	_main_window(main_window),
 	_tray(tray)
 {
@@ -51,27 +44,12 @@ StatusIndicator::StatusIndicator(
 	updateState(State::base);
 }
 
-void StatusIndicator::render(float delta) {
-	_cooldown -= delta;
-	if (_cooldown <= 0.f) {
-		_cooldown = 1.f; // once a second
-
-		bool has_unread = false;
-		for (const auto& c : _cs.registry().view<Contact::Components::TagBig>()) {
-			// maybe cache mm?
-			if (const auto* mm = _rmm.get(c); mm != nullptr) {
-				if (const auto* unread_storage = mm->storage<Message::Components::TagUnread>(); unread_storage != nullptr && !unread_storage->empty()) {
-					has_unread = true;
-					break;
-				}
-			}
-		}
-
-		if (has_unread) {
-			updateState(State::unread);
-		} else {
-			updateState(State::base);
-		}
+void StatusIndicator::render(float) {
+	// cheap, updateState() only touches the icons when the state flips
+	if (_unread.total() > 0) {
+		updateState(State::unread);
+	} else {
+		updateState(State::base);
 	}
 }
 
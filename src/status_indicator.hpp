@@ -1,7 +1,6 @@
 #pragma once
 
-#include <solanaceae/message3/registry_message_model.hpp>
-
+#include "./unread_index.hpp"
 #include "./sys_tray.hpp"
 
 #include <SDL3/SDL.h>
@@ -9,14 +8,11 @@
 // service that sets window and tray icon depending on program state
 
 class StatusIndicator {
-	RegistryMessageModelI& _rmm;
-	ContactStore4I& _cs;
+	const UnreadIndex& _unread;
 
 	SDL_Window* _main_window;
 	SystemTray* _tray;
 
-	float _cooldown {1.f};
-
 	enum class State {
 		base,
 		unread,
@@ -27,8 +23,7 @@ class StatusIndicator {
 
 	public:
 		StatusIndicator(
-			RegistryMessageModelI& rmm,
-			ContactStore4I& cs,
+			const UnreadIndex& unread,
 			SDL_Window* main_window,
 			SystemTray* tray = nullptr
 		);
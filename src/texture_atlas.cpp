@@ -0,0 +1,179 @@
+#include "./texture_atlas.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include <iostream>
+
+TextureAtlasSlot::~TextureAtlasSlot(void) {
+	if (_atlas != nullptr && !evicted) {
+		_atlas->release(*this);
+	}
+}
+
+TextureAtlas::TextureAtlas(TextureUploaderI& tu) : TextureAtlas(tu, Config{}) {
+}
+
+TextureAtlas::TextureAtlas(TextureUploaderI& tu, const Config& config) :
+	_tu(tu),
+	_config(config),
+	_slots_per_row(config.page_size / config.slot_size)
+{
+	assert(_config.slot_size > 2);
+	assert(_slots_per_row > 0);
+}
+
+TextureAtlas::~TextureAtlas(void) {
+	for (const auto& page : _pages) {
+		for (auto* owner : page.owners) {
+			if (owner != nullptr) {
+				owner->evicted = true;
+				owner->_atlas = nullptr;
+			}
+		}
+		_tu.destroy(page.tex);
+	}
+}
+
+bool TextureAtlas::findFreeSlot(uint32_t& page_out, uint32_t& index_out) {
+	for (size_t p = 0; p < _pages.size(); p++) {
+		auto& page = _pages[p];
+		if (page.used >= page.owners.size()) {
+			continue;
+		}
+
+		const auto it = std::find(page.owners.cbegin(), page.owners.cend(), nullptr);
+		assert(it != page.owners.cend());
+		page_out = p;
+		index_out = it - page.owners.cbegin();
+		return true;
+	}
+
+	if (_pages.size() >= _config.max_pages) {
+		return false;
+	}
+
+	// new page
+	const std::vector<uint8_t> empty(size_t(_config.page_size) * _config.page_size * 4, 0);
+	const auto tex = _tu.upload(empty.data(), _config.page_size, _config.page_size, TextureUploaderI::RGBA, TextureUploaderI::LINEAR);
+	if (tex == 0) {
+		std::cerr << "TA error: failed to create atlas page\n";
+		return false;
+	}
+
+	auto& new_page = _pages.emplace_back();
+	new_page.tex = tex;
+	new_page.owners.resize(slotsPerPage(), nullptr);
+
+	page_out = _pages.size() - 1;
+	index_out = 0;
+	return true;
+}
+
+bool TextureAtlas::findEvictableSlot(int64_t ts_now, uint32_t& page_out, uint32_t& index_out) {
+	int64_t oldest = std::numeric_limits<int64_t>::max();
+	bool found {false};
+	for (size_t p = 0; p < _pages.size(); p++) {
+		const auto& owners = _pages[p].owners;
+		for (size_t i = 0; i < owners.size(); i++) {
+			// all full at this point
+			assert(owners[i] != nullptr);
+			const int64_t last_used = owners[i]->last_used;
+			if (last_used < oldest && ts_now - last_used >= _config.min_unused_ms_before_evict) {
+				oldest = last_used;
+				page_out = p;
+				index_out = i;
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+std::shared_ptr<TextureAtlasSlot> TextureAtlas::insert(const uint8_t* data, uint32_t width, uint32_t height, int64_t ts_now) {
+	if (!_enabled) {
+		return nullptr;
+	}
+
+	if (width == 0 || height == 0 || width > maxImageSize() || height > maxImageSize()) {
+		_stats.rejected_too_large++;
+		return nullptr;
+	}
+
+	uint32_t page_i {0};
+	uint32_t index {0};
+	if (!findFreeSlot(page_i, index)) {
+		if (!findEvictableSlot(ts_now, page_i, index)) {
+			_stats.rejected_full++;
+			return nullptr;
+		}
+
+		auto& page = _pages[page_i];
+		auto* prev_owner = page.owners[index];
+		prev_owner->evicted = true;
+		prev_owner->_atlas = nullptr;
+		page.owners[index] = nullptr;
+		page.used--;
+		_stats.evictions++;
+	}
+
+	auto& page = _pages[page_i];
+
+	// surround with a copy of the edge pixels, so linear filtering does not pick up the neighbours
+	const uint32_t padded_width = width + 2;
+	const uint32_t padded_height = height + 2;
+	std::vector<uint8_t> padded(size_t(padded_width) * padded_height * 4);
+	for (uint32_t y = 0; y < padded_height; y++) {
+		const uint32_t src_y = std::clamp<int64_t>(int64_t(y) - 1, 0, height - 1);
+		for (uint32_t x = 0; x < padded_width; x++) {
+			const uint32_t src_x = std::clamp<int64_t>(int64_t(x) - 1, 0, width - 1);
+			std::memcpy(
+				padded.data() + (size_t(y) * padded_width + x) * 4,
+				data + (size_t(src_y) * width + src_x) * 4,
+				4
+			);
+		}
+	}
+
+	const uint32_t slot_x = (index % _slots_per_row) * _config.slot_size;
+	const uint32_t slot_y = (index / _slots_per_row) * _config.slot_size;
+	if (!_tu.updateRect(page.tex, slot_x, slot_y, padded_width, padded_height, padded.data())) {
+		return nullptr;
+	}
+
+	auto slot = std::make_shared<TextureAtlasSlot>();
+	slot->tex = page.tex;
+	slot->u0 = float(slot_x + 1) / _config.page_size;
+	slot->v0 = float(slot_y + 1) / _config.page_size;
+	slot->u1 = float(slot_x + 1 + width) / _config.page_size;
+	slot->v1 = float(slot_y + 1 + height) / _config.page_size;
+	slot->last_used = ts_now;
+	slot->_atlas = this;
+	slot->_page = page_i;
+	slot->_index = index;
+
+	page.owners[index] = slot.get();
+	page.used++;
+	_stats.inserts++;
+
+	return slot;
+}
+
+void TextureAtlas::release(TextureAtlasSlot& slot) {
+	auto& page = _pages.at(slot._page);
+	assert(page.owners.at(slot._index) == &slot);
+	page.owners[slot._index] = nullptr;
+	page.used--;
+	slot._atlas = nullptr;
+}
+
+size_t TextureAtlas::slotsUsed(void) const {
+	size_t used {0};
+	for (const auto& page : _pages) {
+		used += page.used;
+	}
+	return used;
+}
+
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "./texture_uploader.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TextureAtlas;
+
+// a place in an atlas page, released when the last reference goes away
+struct TextureAtlasSlot {
+	uint64_t tex {0}; // the page
+	float u0 {0.f};
+	float v0 {0.f};
+	float u1 {1.f};
+	float v1 {1.f};
+
+	// the atlas gave the slot to someone else (or is gone), the image needs to be inserted again
+	bool evicted {false};
+
+	// for lru, set by the owner when drawn
+	int64_t last_used {0}; // ms
+
+	TextureAtlasSlot(void) = default;
+	TextureAtlasSlot(const TextureAtlasSlot&) = delete;
+	~TextureAtlasSlot(void);
+
+	void touch(int64_t ts_now) { last_used = ts_now; }
+
+	protected:
+		friend class TextureAtlas;
+		TextureAtlas* _atlas {nullptr};
+		uint32_t _page {0};
+		uint32_t _index {0};
+};
+
+// packs small static images into a few large textures (pages) of fixed size slots,
+// so they dont each need their own texture (and break draw call batching).
+// once all pages are full, the least recently used slot, that was not used in
+// the last min_unused_ms_before_evict, gets taken from its owner.
+class TextureAtlas {
+	public:
+		struct Config {
+			uint32_t page_size {1024};
+			uint32_t slot_size {64}; // including a 1px border, to not bleed when filtering
+			uint32_t max_pages {8};
+			int64_t min_unused_ms_before_evict {2'000};
+		};
+
+		struct Stats {
+			uint64_t inserts {0};
+			uint64_t evictions {0};
+			uint64_t rejected_too_large {0};
+			uint64_t rejected_full {0};
+		};
+
+	private:
+		TextureUploaderI& _tu;
+		const Config _config;
+		const uint32_t _slots_per_row;
+
+		struct Page {
+			uint64_t tex {0};
+			std::vector<TextureAtlasSlot*> owners; // nullptr if free
+			size_t used {0};
+		};
+		std::vector<Page> _pages;
+
+		Stats _stats;
+
+		bool _enabled {true};
+
+		// returns false if there is no page with a free slot and no new page can be created
+		bool findFreeSlot(uint32_t& page_out, uint32_t& index_out);
+		bool findEvictableSlot(int64_t ts_now, uint32_t& page_out, uint32_t& index_out);
+
+	public:
+		TextureAtlas(TextureUploaderI& tu);
+		TextureAtlas(TextureUploaderI& tu, const Config& config);
+		~TextureAtlas(void);
+
+		// the largest image a slot can hold
+		uint32_t maxImageSize(void) const { return _config.slot_size - 2; }
+
+		// copies the RGBA image into a slot.
+		// returns nullptr if the image is too large, or the atlas is full/disabled,
+		// the caller should then use a standalone texture
+		std::shared_ptr<TextureAtlasSlot> insert(const uint8_t* data, uint32_t width, uint32_t height, int64_t ts_now);
+
+		// called by the slot
+		void release(TextureAtlasSlot& slot);
+
+		// when disabled, insert() fails, existing slots stay valid
+		void setEnabled(bool enabled) { _enabled = enabled; }
+		bool enabled(void) const { return _enabled; }
+
+		const Config& config(void) const { return _config; }
+		const Stats& stats(void) const { return _stats; }
+		size_t pageCount(void) const { return _pages.size(); }
+		size_t slotsPerPage(void) const { return size_t(_slots_per_row) * _slots_per_row; }
+		size_t slotsUsed(void) const;
+		size_t slotsUsed(size_t page) const { return _pages.at(page).used; }
+		uint64_t pageTexture(size_t page) const { return _pages.at(page).tex; }
+};
+
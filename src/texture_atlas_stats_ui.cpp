@@ -0,0 +1,94 @@
+#include "./texture_atlas_stats_ui.hpp"
+
+#include <imgui.h>
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+TextureAtlasStatsUI::TextureAtlasStatsUI(TextureAtlas& atlas, ContactTextureCache& contact_tc) : _atlas(atlas), _contact_tc(contact_tc) {
+}
+
+void TextureAtlasStatsUI::render(void) {
+	{ // main window menubar injection
+		// assumes the window "tomato" was rendered already by cg
+		// and the image codec stats added the "Images" section
+		if (ImGui::Begin("tomato")) {
+			if (ImGui::BeginMenuBar()) {
+				if (ImGui::BeginMenu("Performance")) {
+					if (ImGui::MenuItem("Avatar atlas stats", nullptr, _show_window)) {
+						_show_window = !_show_window;
+					}
+					ImGui::EndMenu();
+				}
+				ImGui::EndMenuBar();
+			}
+		}
+		ImGui::End();
+	}
+
+	if (!_show_window) {
+		return;
+	}
+
+	if (ImGui::Begin("Avatar atlas stats", &_show_window)) {
+		bool enabled = _atlas.enabled();
+		if (ImGui::Checkbox("use atlas", &enabled)) {
+			_atlas.setEnabled(enabled);
+
+			// reload all, so they move in or out
+			std::vector<Contact4> keys;
+			for (const auto& it : _contact_tc._cache) {
+				keys.push_back(it.first);
+			}
+			_contact_tc.invalidate(keys);
+		}
+		ImGui::SetItemTooltip("Toggle to compare. Exact draw call counts are in Tools > Metrics.");
+
+		const auto& config = _atlas.config();
+		ImGui::Text(
+			"%ux%u pages, %ux%u slots (images up to %ux%u)",
+			config.page_size, config.page_size,
+			config.slot_size, config.slot_size,
+			_atlas.maxImageSize(), _atlas.maxImageSize()
+		);
+
+		ImGui::SeparatorText("occupancy");
+
+		const size_t slots_per_page = _atlas.slotsPerPage();
+		const size_t slots_used = _atlas.slotsUsed();
+		const size_t slots_max = slots_per_page * config.max_pages;
+		{
+			const std::string label = std::to_string(slots_used) + "/" + std::to_string(slots_max) + " slots";
+			ImGui::ProgressBar(slots_max > 0 ? float(slots_used)/slots_max : 0.f, {-FLT_MIN, 0.f}, label.c_str());
+		}
+		ImGui::Text("pages: %zu/%u", _atlas.pageCount(), config.max_pages);
+
+		for (size_t i = 0; i < _atlas.pageCount(); i++) {
+			ImGui::PushID(int(i));
+			const std::string label = "page " + std::to_string(i) + ": " + std::to_string(_atlas.slotsUsed(i)) + "/" + std::to_string(slots_per_page);
+			ImGui::ProgressBar(float(_atlas.slotsUsed(i))/slots_per_page, {ImGui::GetFontSize() * 14, 0.f}, label.c_str());
+			if (ImGui::BeginItemTooltip()) {
+				ImGui::Image(_atlas.pageTexture(i), {256, 256});
+				ImGui::EndTooltip();
+			}
+			ImGui::PopID();
+		}
+
+		const auto& stats = _atlas.stats();
+		ImGui::Text("inserts: %" PRIu64 " evictions: %" PRIu64, stats.inserts, stats.evictions);
+		ImGui::Text("rejected, too large: %" PRIu64 " full: %" PRIu64, stats.rejected_too_large, stats.rejected_full);
+		ImGui::SetItemTooltip("rejected avatars use a texture of their own, like animated ones");
+
+		ImGui::SeparatorText("last frame");
+
+		// each avatar with its own texture needs its own draw call,
+		// avatars in the same page can be batched (if nothing else is drawn in between)
+		ImGui::Text("avatars drawn: %zu", _contact_tc.rendered_count);
+		ImGui::Text("textures used: %zu", _contact_tc.rendered_texture_count);
+		ImGui::SetItemTooltip("without the atlas, this is the same as avatars drawn");
+		ImGui::Text("avatar texture switches saved: %zu", _contact_tc.rendered_count - _contact_tc.rendered_texture_count);
+	}
+	ImGui::End();
+}
+
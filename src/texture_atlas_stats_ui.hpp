@@ -0,0 +1,17 @@
+#pragma once
+
+#include "./texture_atlas.hpp"
+#include "./chat_gui/texture_cache_defs.hpp"
+
+class TextureAtlasStatsUI {
+	TextureAtlas& _atlas;
+	ContactTextureCache& _contact_tc;
+
+	bool _show_window {false};
+
+	public:
+		TextureAtlasStatsUI(TextureAtlas& atlas, ContactTextureCache& contact_tc);
+
+		void render(void);
+};
+
@@ -5,9 +5,18 @@
 
 int64_t TextureEntry::doAnimation(const int64_t ts_now) {
 	if (frame_duration.size() > 1) { // is animation
+		// a stream only has the rest of the ring ready, dont run past it.
+		// if we fall behind, the animation slows down instead of skipping
+		size_t steps_left = stream ? frame_duration.size() - 1 : std::numeric_limits<size_t>::max();
 		do { // why is this loop so ugly
 			const int64_t duration = getDuration();
 			if (ts_now - timestamp_last_rendered >= duration) {
+				if (steps_left == 0) {
+					timestamp_last_rendered = ts_now;
+					return ts_now + duration;
+				}
+				steps_left--;
+
 				timestamp_last_rendered += duration;
 				next();
 			} else {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "./texture_uploader.hpp"
+#include "./texture_atlas.hpp"
+#include "./trace.hpp"
 
 #include <entt/container/dense_map.hpp>
 #include <entt/container/dense_set.hpp>
@@ -8,9 +10,22 @@
 #include <solanaceae/util/time.hpp>
 
 #include <optional>
+#include <memory>
 #include <vector>
 #include <cassert>
 
+struct TextureEntry;
+
+// feeds an animation into a TextureEntry that only holds a few of its frames.
+// textures and frame_duration of the entry are then a ring,
+// holding current_texture and the frames after it. the ring may grow in refill().
+struct TextureStreamI {
+	virtual ~TextureStreamI(void) {}
+
+	// replaces the frames in the slots playback moved past with the next ones
+	virtual void refill(TextureUploaderI& tu, TextureEntry& te) = 0;
+};
+
 struct TextureEntry {
 	uint32_t width {0};
 	uint32_t height {0};
@@ -26,6 +41,13 @@ struct TextureEntry {
 	// or flipped for animations
 	int64_t timestamp_last_rendered {0}; // ms
 
+	// only set for animations that get decoded during playback
+	std::shared_ptr<TextureStreamI> stream;
+
+	// only set for small static images in a shared atlas page.
+	// textures then holds the page, which is not ours to destroy
+	std::shared_ptr<TextureAtlasSlot> atlas_slot;
+
 	TextureEntry(void) = default;
 	TextureEntry(const TextureEntry& other) :
 		width(other.width),
@@ -37,7 +59,9 @@ struct TextureEntry {
 		current_texture(other.current_texture),
 
 		rendered_this_frame(other.rendered_this_frame),
-		timestamp_last_rendered(other.timestamp_last_rendered)
+		timestamp_last_rendered(other.timestamp_last_rendered),
+		stream(other.stream),
+		atlas_slot(other.atlas_slot)
 	{}
 
 	TextureEntry& operator=(const TextureEntry& other) {
@@ -51,6 +75,8 @@ struct TextureEntry {
 
 		rendered_this_frame = other.rendered_this_frame;
 		timestamp_last_rendered = other.timestamp_last_rendered;
+		stream = other.stream;
+		atlas_slot = other.atlas_slot;
 		return *this;
 	}
 
@@ -119,23 +145,64 @@ struct TextureCache {
 
 	~TextureCache(void) {
 		for (const auto& it : _cache) {
-			for (const auto& tex_id : it.second.textures) {
-				_tu.destroy(tex_id);
-			}
+			destroyTextures(it.second);
 		}
 		for (const auto& tex_id : _default_texture.textures) {
 			_tu.destroy(tex_id);
 		}
 	}
 
+	// of the last update(), for stats
+	size_t rendered_count {0};
+	size_t rendered_texture_count {0}; // distinct, so an atlas page counts once
+	entt::dense_set<uint64_t> _rendered_textures; // reused
+
+	// finished loads, only goes up. compare to notice new textures
+	uint64_t loaded_count {0};
+
+	void destroyTextures(const TextureEntry& te) {
+		if (te.atlas_slot) {
+			return; // the slot goes with the entry
+		}
+		for (const auto& tex_id : te.textures) {
+			_tu.destroy(tex_id);
+		}
+	}
+
 	struct GetInfo {
 		TextureType id;
 		uint32_t width;
 		uint32_t height;
 	};
 	GetInfo get(const KeyType& key, uint32_t width = 0, uint32_t height = 0) {
+		const auto region = getRegion(key, width, height);
+		return {region.id, region.width, region.height};
+	}
+
+	// like get(), but also returns the part of the texture to draw,
+	// which is not all of it for images in an atlas
+	struct GetRegionInfo {
+		TextureType id;
+		uint32_t width;
+		uint32_t height;
+		float u0 {0.f};
+		float v0 {0.f};
+		float u1 {1.f};
+		float v1 {1.f};
+	};
+	GetRegionInfo getRegion(const KeyType& key, uint32_t width = 0, uint32_t height = 0) {
 		auto it = _cache.find(key);
 
+		if (it != _cache.end() && it->second.atlas_slot && it->second.atlas_slot->evicted) {
+			// someone else is in our slot now, show the fallback until reloaded
+			_to_load.insert({key, LoadDims{width, height}});
+			return {
+				_default_texture.getID<TextureType>(),
+				_default_texture.src_width,
+				_default_texture.src_height
+			};
+		}
+
 		if (it != _cache.end()) {
 			// if scaled down AND smaller than requested, reload larger
 			if (
@@ -150,6 +217,15 @@ struct TextureCache {
 			}
 
 			// return current texture either way
+			if (const auto& slot = it->second.atlas_slot; slot) {
+				return {
+					it->second.template getID<TextureType>(),
+					it->second.src_width,
+					it->second.src_height,
+					slot->u0, slot->v0,
+					slot->u1, slot->v1,
+				};
+			}
 			return {
 				it->second.template getID<TextureType>(),
 				it->second.src_width,
@@ -184,10 +260,25 @@ struct TextureCache {
 		const uint64_t ts_now = getTimeMS();
 		uint64_t ts_min_next = ts_now + ms_before_purge;
 
+		rendered_count = 0;
+		_rendered_textures.clear();
+
 		std::vector<KeyType> to_purge;
 		for (auto&& [key, te] : _cache) {
 			if (te.rendered_this_frame) {
-				const uint64_t ts_next = te.doAnimation(ts_now);
+				uint64_t ts_next = te.doAnimation(ts_now);
+				if (te.stream) {
+					te.stream->refill(_tu, te);
+					// a ring that just grew from its first frame was static until now
+					if (te.frame_duration.size() > 1) {
+						ts_next = std::min<uint64_t>(ts_next, te.timestamp_last_rendered + te.getDuration());
+					}
+				}
+				if (te.atlas_slot) {
+					te.atlas_slot->touch(ts_now);
+				}
+				rendered_count++;
+				_rendered_textures.emplace(te.textures.at(te.current_texture));
 				te.rendered_this_frame = false;
 				ts_min_next = std::min(ts_min_next, ts_next);
 			} else if (
@@ -198,6 +289,8 @@ struct TextureCache {
 			}
 		}
 
+		rendered_texture_count = _rendered_textures.size();
+
 		invalidate(to_purge);
 
 		// we ignore the default texture ts :)
@@ -213,9 +306,7 @@ struct TextureCache {
 				_to_load.erase(key);
 			}
 			if (_cache.count(key)) {
-				for (const auto& tex_id : _cache.at(key).textures) {
-					_tu.destroy(tex_id);
-				}
+				destroyTextures(_cache.at(key));
 				_cache.erase(key);
 			}
 		}
@@ -226,14 +317,15 @@ struct TextureCache {
 		auto it = _to_load.cbegin();
 		while (it != _to_load.cend()) {
 			const auto& load_key = it->first;
-			auto new_entry_opt = _l.load(_tu, load_key, it->second.w, it->second.h);
+			auto new_entry_opt = [&](void) {
+				TRACE_ZONE("texture load");
+				return _l.load(_tu, load_key, it->second.w, it->second.h);
+			}();
 			if (_cache.count(load_key)) {
 				if (new_entry_opt.texture.has_value()) {
 					auto old_entry = _cache.at(load_key); // copy
 					assert(!old_entry.textures.empty());
-					for (const auto& tex_id : old_entry.textures) {
-						_tu.destroy(tex_id);
-					}
+					destroyTextures(old_entry);
 
 					_cache.erase(load_key);
 					auto& new_entry = _cache[load_key] = new_entry_opt.texture.value();
@@ -243,6 +335,7 @@ struct TextureCache {
 					new_entry.timestamp_last_rendered = old_entry.timestamp_last_rendered;
 
 					it = _to_load.erase(it);
+					loaded_count++;
 
 					// TODO: not a good idea?
 					break; // end load from queue/onlyload 1 per update
@@ -257,6 +350,7 @@ struct TextureCache {
 					_cache.emplace(load_key, new_entry_opt.texture.value());
 					_cache.at(load_key).rendered_this_frame = true; // ?
 					it = _to_load.erase(it);
+					loaded_count++;
 
 					// TODO: not a good idea?
 					break; // end load from queue/onlyload 1 per update
@@ -4,7 +4,7 @@
 #include <cstddef>
 
 struct TextureUploaderI {
-	static constexpr const char* version {"3"};
+	static constexpr const char* version {"4"};
 
 	enum Filter {
 		NEAREST,
@@ -42,6 +42,10 @@ struct TextureUploaderI {
 	virtual uint64_t upload(const uint8_t* data, uint32_t width, uint32_t height, Format format = RGBA, Filter filter = LINEAR, Access access = STATIC) = 0;
 	virtual bool update(uint64_t tex_id, const uint8_t* data, size_t size) = 0;
 
+	// updates only the width x height rect at x,y, eg a slot in an atlas.
+	// RGBA only, data is tightly packed (pitch width*4)
+	virtual bool updateRect(uint64_t tex_id, uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* data) = 0;
+
 	virtual void destroy(uint64_t tex_id) = 0;
 };
 
@@ -1,5 +1,7 @@
 #include "./tox_av.hpp"
 
+#include "./trace.hpp"
+
 #include <cassert>
 
 #include <cstdint>
@@ -84,6 +86,7 @@ uint32_t ToxAVI::toxavIterationInterval(void) const {
 }
 
 void ToxAVI::toxavIterate(void) {
+	TRACE_ZONE("toxav iterate");
 	toxav_iterate(_tox_av);
 
 	dispatch(
@@ -103,6 +106,7 @@ uint32_t ToxAVI::toxavAudioIterationInterval(void) const {
 }
 
 void ToxAVI::toxavAudioIterate(void) {
+	TRACE_ZONE("toxav audio iterate");
 	toxav_audio_iterate(_tox_av);
 
 	dispatch(
@@ -117,6 +121,7 @@ uint32_t ToxAVI::toxavVideoIterationInterval(void) const {
 }
 
 void ToxAVI::toxavVideoIterate(void) {
+	TRACE_ZONE("toxav video iterate");
 	toxav_video_iterate(_tox_av);
 
 	dispatch(
@@ -1,9 +1,6 @@
 #include "./tox_avatar_loader.hpp"
 
-#include "./image_loader_sdl_bmp.hpp"
-#include "./image_loader_qoi.hpp"
-#include "./image_loader_webp.hpp"
-#include "./image_loader_sdl_image.hpp"
+#include "./os_comps.hpp"
 
 #include <solanaceae/contact/contact_store_i.hpp>
 #include <solanaceae/contact/components.hpp>
@@ -20,6 +17,7 @@
 #include <fstream>
 #include <cassert>
 #include <vector>
+#include <algorithm>
 
 ByteSpanWithOwnership ToxAvatarLoader::loadDataFromObj(Contact4 cv) {
 	auto c = _cs.contactHandle(cv);
@@ -68,7 +66,8 @@ ByteSpanWithOwnership ToxAvatarLoader::loadDataFromObj(Contact4 cv) {
 		return ByteSpan{};
 	}
 
-	return read_data;
+	// the span might point into a mapping owned by file2, which is gone after we return
+	return std::vector<uint8_t>(read_data.ptr, read_data.ptr + read_data.size);
 }
 
 ByteSpanWithOwnership ToxAvatarLoader::loadData(Contact4 cv) {
@@ -96,11 +95,27 @@ ByteSpanWithOwnership ToxAvatarLoader::loadData(Contact4 cv) {
 	}
 }
 
-ToxAvatarLoader::ToxAvatarLoader(ContactStore4I& cs, ObjectStore2& os) : _cs(cs), _os(os) {
-	_image_loaders.push_back(std::make_unique<ImageLoaderQOI>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderSDLBMP>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderWebP>());
-	_image_loaders.push_back(std::make_unique<ImageLoaderSDLImage>());
+ToxAvatarLoader::ToxAvatarLoader(ContactStore4I& cs, ObjectStore2& os, ImageCodecRegistry& icr) : _cs(cs), _os(os), _icr(icr) {
+}
+
+ToxAvatarLoader::ToxAvatarLoader(ContactStore4I& cs, ObjectStore2& os, ImageCodecRegistry& icr, TextureAtlas& atlas) : _cs(cs), _os(os), _icr(icr), _atlas(&atlas) {
+}
+
+bool ToxAvatarLoader::insertIntoAtlas(TextureEntry& new_entry, const uint8_t* data, uint32_t width, uint32_t height) {
+	if (_atlas == nullptr) {
+		return false;
+	}
+
+	auto slot = _atlas->insert(data, width, height, getTimeMS());
+	if (!slot) {
+		return false;
+	}
+
+	new_entry.textures.push_back(slot->tex);
+	new_entry.frame_duration.push_back(250);
+	new_entry.atlas_slot = std::move(slot);
+
+	return true;
 }
 
 static float getHue_6bytes(const uint8_t* data) {
@@ -211,9 +226,11 @@ TextureLoaderResult ToxAvatarLoader::load(TextureUploaderI& tu, Contact4 c, uint
 		new_entry.width = a_m.width;
 		new_entry.height = a_m.height;
 
-		const auto n_t = tu.upload(a_m.data.data(), a_m.width, a_m.height);
-		new_entry.textures.push_back(n_t);
-		new_entry.frame_duration.push_back(250);
+		if (!insertIntoAtlas(new_entry, a_m.data.data(), a_m.width, a_m.height)) {
+			const auto n_t = tu.upload(a_m.data.data(), a_m.width, a_m.height);
+			new_entry.textures.push_back(n_t);
+			new_entry.frame_duration.push_back(250);
+		}
 
 		std::cout << "TAL: loaded memory buffer\n";
 
@@ -224,11 +241,22 @@ TextureLoaderResult ToxAvatarLoader::load(TextureUploaderI& tu, Contact4 c, uint
 		const auto tmp_buffer = loadData(c);
 
 		if (!tmp_buffer.empty()) {
-			// try all loaders after another
-			for (auto& il : _image_loaders) {
-				auto res = il->loadFromMemoryRGBA(tmp_buffer.ptr, tmp_buffer.size);
-				if (res.frames.empty() || res.height == 0 || res.width == 0) {
-					continue;
+			ObjectHandle o;
+			if (cr.all_of<Contact::Components::AvatarObj>(c)) {
+				o = _os.objectHandle(cr.get<Contact::Components::AvatarObj>(c).obj);
+			}
+
+			auto format = ImageCodecRegistry::Format::unknown;
+			if (static_cast<bool>(o)) {
+				if (const auto* icf = o.try_get<ObjComp::Ephemeral::ImageCodecFormat>(); icf != nullptr) {
+					format = static_cast<ImageCodecRegistry::Format>(icf->format);
+				}
+			}
+
+			auto res = _icr.loadFromMemoryRGBA(tmp_buffer.ptr, tmp_buffer.size, format);
+			if (!res.frames.empty() && res.height != 0 && res.width != 0) {
+				if (static_cast<bool>(o)) {
+					o.emplace_or_replace<ObjComp::Ephemeral::ImageCodecFormat>(static_cast<uint8_t>(format));
 				}
 
 				TextureEntry new_entry;
@@ -245,10 +273,13 @@ TextureLoaderResult ToxAvatarLoader::load(TextureUploaderI& tu, Contact4 c, uint
 				new_entry.width = res.width;
 				new_entry.height = res.height;
 
-				for (const auto& [ms, data] : res.frames) {
-					const auto n_t = tu.upload(data.data(), res.width, res.height);
-					new_entry.textures.push_back(n_t);
-					new_entry.frame_duration.push_back(ms);
+				// animations and large avatars get their own textures
+				if (res.frames.size() > 1 || !insertIntoAtlas(new_entry, res.frames.front().data.data(), res.width, res.height)) {
+					for (const auto& [ms, data] : res.frames) {
+						const auto n_t = tu.upload(data.data(), res.width, res.height);
+						new_entry.textures.push_back(n_t);
+						new_entry.frame_duration.push_back(ms);
+					}
 				}
 
 
@@ -291,12 +322,42 @@ TextureLoaderResult ToxAvatarLoader::load(TextureUploaderI& tu, Contact4 c, uint
 	new_entry.timestamp_last_rendered = getTimeMS();
 	new_entry.current_texture = 0;
 
-	const auto n_t = tu.upload(pixels.data(), 5, 5, TextureUploaderI::RGBA, TextureUploaderI::NEAREST);
-	new_entry.textures.push_back(n_t);
-	new_entry.frame_duration.push_back(250);
+	// the atlas filters linearly, so we scale up by whole pixels first, to stay sharp
+	uint32_t identicon_scale {0};
+	if (_atlas != nullptr) {
+		const uint32_t max_scale = _atlas->maxImageSize() / 5;
+		identicon_scale = (w != 0 && h != 0) ? std::clamp<uint32_t>(std::min(w, h) / 5, 1, max_scale) : max_scale;
+	}
+
+	bool in_atlas {false};
+	if (identicon_scale > 0) {
+		const uint32_t size = 5 * identicon_scale;
+		std::vector<uint8_t> scaled(size * size * 4);
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				const size_t src = ((y / identicon_scale) * 5 + (x / identicon_scale)) * 4;
+				std::copy_n(pixels.cbegin() + src, 4, scaled.begin() + (y * size + x) * 4);
+			}
+		}
 
-	new_entry.width = 5;
-	new_entry.height = 5;
+		in_atlas = insertIntoAtlas(new_entry, scaled.data(), size, size);
+		if (in_atlas) {
+			new_entry.width = size;
+			new_entry.height = size;
+			// so it gets reloaded sharper, if drawn larger later
+			new_entry.src_width = 5 * (_atlas->maxImageSize() / 5);
+			new_entry.src_height = new_entry.src_width;
+		}
+	}
+
+	if (!in_atlas) {
+		const auto n_t = tu.upload(pixels.data(), 5, 5, TextureUploaderI::RGBA, TextureUploaderI::NEAREST);
+		new_entry.textures.push_back(n_t);
+		new_entry.frame_duration.push_back(250);
+
+		new_entry.width = 5;
+		new_entry.height = 5;
+	}
 
 	std::cout << "TAL: generated ToxIdenticon\n";
 
@@ -5,20 +5,28 @@
 
 #include <solanaceae/file/file2.hpp>
 
-#include "./image_loader.hpp"
+#include "./image_codec_registry.hpp"
 #include "./texture_cache.hpp"
+#include "./texture_atlas.hpp"
 
 class ToxAvatarLoader {
 	ContactStore4I& _cs;
 	ObjectStore2& _os;
 
-	std::vector<std::unique_ptr<ImageLoaderI>> _image_loaders;
+	ImageCodecRegistry& _icr;
+
+	// small static avatars and identicons go here, if set
+	TextureAtlas* _atlas {nullptr};
 
 	ByteSpanWithOwnership loadDataFromObj(Contact4 cv);
 	ByteSpanWithOwnership loadData(Contact4 cv);
 
+	// returns false if the entry needs a texture of its own
+	bool insertIntoAtlas(TextureEntry& new_entry, const uint8_t* data, uint32_t width, uint32_t height);
+
 	public:
-		ToxAvatarLoader(ContactStore4I& cs, ObjectStore2& os);
+		ToxAvatarLoader(ContactStore4I& cs, ObjectStore2& os, ImageCodecRegistry& icr);
+		ToxAvatarLoader(ContactStore4I& cs, ObjectStore2& os, ImageCodecRegistry& icr, TextureAtlas& atlas);
 		TextureLoaderResult load(TextureUploaderI& tu, Contact4 c, uint32_t w, uint32_t h);
 };
 
@@ -1,5 +1,7 @@
 #include "./tox_avatar_manager.hpp"
 
+#include "./trace.hpp"
+
 // TODO: this whole thing needs a rewrite, separating tcs and rng uid os
 
 #include <solanaceae/util/config_model.hpp>
@@ -15,10 +17,12 @@
 #include <solanaceae/tox_contacts/components.hpp>
 
 #include <solanaceae/util/utils.hpp>
-#include <solanaceae/file/file2.hpp>
 
 #include <filesystem>
 #include <string_view>
+#include <fstream>
+#include <sstream>
+#include <iterator>
 
 #include <iostream>
 
@@ -29,6 +33,7 @@
 
 namespace Components {
 	struct TagAvatarImageHandled {};
+	struct TagAvatarPendingReplace {}; // waiting on the worker to clear the old file
 }
 
 ToxAvatarManager::ToxAvatarManager(
@@ -52,6 +57,13 @@ ToxAvatarManager::ToxAvatarManager(
 	// make sure it exists
 	std::filesystem::create_directories(avatar_save_path);
 
+	{
+		const auto hash_cache_path_u8 = (std::filesystem::path(avatar_save_path) / "hash_cache.txt").generic_u8string();
+		_hash_cache_path = {hash_cache_path_u8.cbegin(), hash_cache_path_u8.cend()};
+	}
+
+	_worker = std::thread([this](void) { workerRun(); });
+
 	// TODO: instead listen for new contacts, and attach
 	{ // scan tox contacts for cached avatars
 		// old sts says pubkey.png
@@ -68,9 +80,16 @@ ToxAvatarManager::ToxAvatarManager(
 		});
 #else
 		// HACK: assumed id is pubkey
-		_cs.registry().view<Contact::Components::ID>().each([this](auto c, const Contact::Components::ID& id) {
-			// try
-			addAvatarFileToContact(c, id.data);
+		const auto queue_discover = [this](const Contact4 c, const ToxKey& key) {
+			WorkerJob job{WorkerJob::Type::discover, getAvatarPath(key)};
+			job.c = c;
+			job.key = key;
+			queueJob(std::move(job));
+		};
+
+		_cs.registry().view<Contact::Components::ID>().each([&queue_discover](auto c, const Contact::Components::ID& id) {
+			// try, the worker reports back if it exists
+			queue_discover(c, id.data);
 		});
 #endif
 
@@ -79,7 +98,54 @@ ToxAvatarManager::ToxAvatarManager(
 	}
 }
 
+ToxAvatarManager::~ToxAvatarManager(void) {
+	{
+		std::lock_guard lg{_jobs_mutex};
+		_worker_stop = true;
+	}
+	_jobs_cv.notify_all();
+	// worker drains remaining jobs (eg. removes) before exiting
+	_worker.join();
+}
+
 void ToxAvatarManager::iterate(void) {
+	// worker results
+	std::vector<WorkerResult> results;
+	{
+		std::lock_guard lg{_results_mutex};
+		results.swap(_results);
+	}
+	for (const auto& res : results) {
+		switch (res.type) {
+			break; case WorkerJob::Type::discover:
+				if (res.exists && _cs.registry().valid(res.c)) {
+					addAvatarFileToContact(res.c, res.key, res);
+				}
+			break; case WorkerJob::Type::replace: {
+				auto o = res.o;
+				if (!static_cast<bool>(o) || !o.all_of<Components::TagAvatarPendingReplace>()) {
+					break; // object got destroyed in the meantime
+				}
+				o.remove<Components::TagAvatarPendingReplace>();
+
+				if (!_sb_tcs.attach(o)) {
+					std::cerr << "TAM error: failed to attach backend??\n";
+					break;
+				}
+
+				o.emplace_or_replace<ObjComp::F::SingleInfoLocal>(res.file_path);
+
+				// ... do we do anything here?
+				// like set "accepted" tag comp or something
+
+				std::cout << "TAM: accepted avatar ft\n";
+
+				_os.throwEventUpdate(o);
+			}
+			break; default: ;
+		}
+	}
+
 	// cancel queue
 
 	// accept queue
@@ -110,37 +176,24 @@ std::string ToxAvatarManager::getAvatarFileName(const ToxKey& key) const {
 	return pub_key_string + ".png"; // TODO: remove png?
 }
 
-void ToxAvatarManager::addAvatarFileToContact(const Contact4 c, const ToxKey& key) {
-	const auto file_path = getAvatarPath(key);
-	if (!std::filesystem::is_regular_file(file_path)) {
-		return;
-	}
-
-	//std::cout << "TAM: found '" << file_path << "'\n";
+void ToxAvatarManager::addAvatarFileToContact(const Contact4 c, const ToxKey& key, const WorkerResult& res) {
+	//std::cout << "TAM: found '" << res.file_path << "'\n";
 
 	// TODO: use guid instead
 	auto o = _sb_tcs.newObject(ByteSpan{key.data}, false);
-	o.emplace_or_replace<ObjComp::F::SingleInfoLocal>(file_path);
+	o.emplace_or_replace<ObjComp::F::SingleInfoLocal>(res.file_path);
 	o.emplace_or_replace<ObjComp::F::TagLocalHaveAll>();
 
 	// for file size
 	o.emplace_or_replace<ObjComp::F::SingleInfo>(
 		getAvatarFileName(key),
-		std::filesystem::file_size(file_path)
+		res.file_size
 	);
 
-	{ // toxhash for tox file id, so the remote can optimize cached files
-		auto file = o.get<ObjComp::Ephemeral::BackendFile2>().ptr->file2(o, StorageBackendIFile2::FILE2_READ);
-		if (file) {
-			auto file_buf = file->read(o.get<ObjComp::F::SingleInfo>().file_size);
-			// HACK: tox interface needs bytespan
-			if (file_buf.isOwning()) {
-				o.emplace_or_replace<ObjComp::Tox::FileID>(_t.toxHash(file_buf._data_owner));
-			} else {
-				// TODO: tox bytespan !!
-				o.emplace_or_replace<ObjComp::Tox::FileID>(_t.toxHash(std::vector<uint8_t>(file_buf.cbegin(), file_buf.cend())));
-			}
-		}
+	// toxhash for tox file id, so the remote can optimize cached files
+	// (hashed by the worker, or from the hash cache)
+	if (!res.file_id.empty()) {
+		o.emplace_or_replace<ObjComp::Tox::FileID>(res.file_id);
 	}
 
 	_os.throwEventConstruct(o);
@@ -157,12 +210,12 @@ void ToxAvatarManager::clearAvatarFromContact(const Contact4 c) {
 	auto& cr = _cs.registry();
 	if (cr.any_of<Contact::Components::AvatarFile, Contact::Components::AvatarObj>(c)) {
 		if (cr.all_of<Contact::Components::AvatarFile>(c)) {
-			std::filesystem::remove(cr.get<Contact::Components::AvatarFile>(c).file_path);
+			queueJob({WorkerJob::Type::remove, cr.get<Contact::Components::AvatarFile>(c).file_path});
 		} else if (cr.all_of<Contact::Components::AvatarObj>(c)) {
 			auto o = _os.objectHandle(cr.get<Contact::Components::AvatarObj>(c).obj);
 			if (o) {
 				if (o.all_of<ObjComp::F::SingleInfoLocal>()) {
-					std::filesystem::remove(o.get<ObjComp::F::SingleInfoLocal>().file_path);
+					queueJob({WorkerJob::Type::remove, o.get<ObjComp::F::SingleInfoLocal>().file_path});
 				}
 				// TODO: make destruction more ergonomic
 				//_sb_tcs.destroy() ??
@@ -185,9 +238,10 @@ void ToxAvatarManager::clearAvatarFromContact(const Contact4 c) {
 void ToxAvatarManager::checkObj(ObjectHandle o) {
 	if (o.any_of<
 		ObjComp::Ephemeral::File::ActionTransferAccept,
-		Components::TagAvatarImageHandled
+		Components::TagAvatarImageHandled,
+		Components::TagAvatarPendingReplace
 	>()) {
-		return; // already accepted or handled
+		return; // already accepted or handled (or about to be)
 	}
 
 	if (!o.any_of<
@@ -254,6 +308,12 @@ void ToxAvatarManager::checkObj(ObjectHandle o) {
 		contact.emplace_or_replace<Contact::Components::TagAvatarInvalidate>();
 
 		o.emplace_or_replace<Components::TagAvatarImageHandled>();
+
+		if (o.all_of<ObjComp::F::SingleInfoLocal>()) {
+			// so we dont rehash it on next start.
+			// the file id is whatever the peer claimed, the worker hashes the file itself
+			queueJob({WorkerJob::Type::remember, o.get<ObjComp::F::SingleInfoLocal>().file_path});
+		}
 	} else if (!o.all_of<
 		ObjComp::Ephemeral::BackendMeta, // hmm
 		ObjComp::Ephemeral::BackendFile2,
@@ -270,34 +330,30 @@ void ToxAvatarManager::checkObj(ObjectHandle o) {
 			return;
 		}
 
-		// already has avatar, delete old (TODO: or check hash)
+		// already has avatar, delete old, unless its the same file
 		if (contact.all_of<Contact::Components::AvatarObj>()) {
-			clearAvatarFromContact(contact);
-		}
-
-		// crude
-		// TODO: queue/async instead
-		// check file id for existing hash
-		if (std::filesystem::is_regular_file(file_path)) {
-			//const auto& supposed_file_hash = h.get<Message::Components::Transfer::FileID>().id;
-			// load file
-			// hash file
-			//_t.toxHash();
-
-			std::filesystem::remove(file_path); // hack, hard replace existing file
-		}
+			const auto old_o = _os.objectHandle(contact.get<Contact::Components::AvatarObj>().obj);
+			// our file id is the hash of the file on disk, the peers is the hash of what it sends
+			if (
+				old_o != o &&
+				static_cast<bool>(old_o) &&
+				old_o.all_of<ObjComp::Tox::FileID>() &&
+				old_o.get<ObjComp::Tox::FileID>().id == o.get<ObjComp::Tox::FileID>().id
+			) {
+				std::cout << "TAM: avatar unchanged, keeping existing\n";
+				o.emplace_or_replace<Components::TagAvatarImageHandled>();
+				return;
+			}
 
-		if (!_sb_tcs.attach(o)) {
-			std::cerr << "TAM error: failed to attach backend??\n";
-			return;
+			clearAvatarFromContact(contact);
 		}
 
-		o.emplace_or_replace<ObjComp::F::SingleInfoLocal>(file_path);
-
-		// ... do we do anything here?
-		// like set "accepted" tag comp or something
-
-		std::cout << "TAM: accepted avatar ft\n";
+		// hard replace existing file, on the worker.
+		// attaching the backend happens in iterate() once the file is gone.
+		o.emplace_or_replace<Components::TagAvatarPendingReplace>();
+		WorkerJob job{WorkerJob::Type::replace, file_path};
+		job.o = o;
+		queueJob(std::move(job));
 	} else {
 		// in progress, or canceled/aborted
 
@@ -355,3 +411,174 @@ bool ToxAvatarManager::onEvent(const ObjectStore::Events::ObjectDestory& e) {
 
 	return false;
 }
+
+void ToxAvatarManager::queueJob(WorkerJob&& job) {
+	{
+		std::lock_guard lg{_jobs_mutex};
+		_jobs.push_back(std::move(job));
+	}
+	_jobs_cv.notify_one();
+}
+
+void ToxAvatarManager::workerRun(void) {
+	Trace::setThreadName("avatar worker");
+
+	loadHashCache();
+
+	while (true) {
+		std::vector<WorkerJob> jobs;
+		{
+			std::unique_lock lk{_jobs_mutex};
+			_jobs_cv.wait(lk, [this](void) { return _worker_stop || !_jobs.empty(); });
+			if (_jobs.empty()) {
+				break; // stop
+			}
+			jobs.swap(_jobs);
+		}
+
+		std::vector<WorkerResult> results;
+		for (const auto& job : jobs) {
+			auto res = workerDo(job);
+			if (job.type == WorkerJob::Type::discover || job.type == WorkerJob::Type::replace) {
+				results.push_back(std::move(res));
+			}
+		}
+
+		if (!results.empty()) {
+			std::lock_guard lg{_results_mutex};
+			_results.insert(_results.end(), std::make_move_iterator(results.begin()), std::make_move_iterator(results.end()));
+		}
+
+		if (_hash_cache_dirty) {
+			saveHashCache();
+			_hash_cache_dirty = false;
+		}
+	}
+}
+
+ToxAvatarManager::WorkerResult ToxAvatarManager::workerDo(const WorkerJob& job) {
+	WorkerResult res{job.type, job.file_path, job.c, job.key, job.o};
+
+	std::error_code ec;
+	switch (job.type) {
+		break; case WorkerJob::Type::discover: {
+			if (!std::filesystem::is_regular_file(job.file_path, ec)) {
+				return res;
+			}
+
+			const uint64_t file_size = std::filesystem::file_size(job.file_path, ec);
+			if (ec) {
+				return res;
+			}
+			const int64_t mtime = std::filesystem::last_write_time(job.file_path, ec).time_since_epoch().count();
+			if (ec) {
+				return res;
+			}
+
+			res.exists = true;
+			res.file_size = file_size;
+
+			if (auto it = _hash_cache.find(job.file_path); it != _hash_cache.end()) {
+				if (it->second.file_size == file_size && it->second.mtime == mtime) {
+					res.file_id = it->second.file_id;
+					return res;
+				}
+			}
+
+			// cache miss, hash file
+			res.file_id = hashFile(job.file_path, file_size);
+			if (res.file_id.empty()) {
+				return res;
+			}
+			_hash_cache[job.file_path] = {file_size, mtime, res.file_id};
+			_hash_cache_dirty = true;
+		}
+		break; case WorkerJob::Type::remove:
+		case WorkerJob::Type::replace:
+			std::filesystem::remove(job.file_path, ec);
+			if (_hash_cache.erase(job.file_path) > 0) {
+				_hash_cache_dirty = true;
+			}
+		break; case WorkerJob::Type::remember: {
+			const uint64_t file_size = std::filesystem::file_size(job.file_path, ec);
+			if (ec) {
+				return res;
+			}
+			const int64_t mtime = std::filesystem::last_write_time(job.file_path, ec).time_since_epoch().count();
+			if (ec) {
+				return res;
+			}
+			auto file_id = hashFile(job.file_path, file_size);
+			if (file_id.empty()) {
+				return res;
+			}
+			_hash_cache[job.file_path] = {file_size, mtime, std::move(file_id)};
+			_hash_cache_dirty = true;
+		}
+		break; default: ;
+	}
+
+	return res;
+}
+
+std::vector<uint8_t> ToxAvatarManager::hashFile(const std::string& file_path, uint64_t file_size) {
+	std::ifstream file(std::filesystem::u8path(file_path), std::ios::binary);
+	if (!file.is_open()) {
+		return {};
+	}
+	std::vector<uint8_t> file_buf(file_size);
+	if (!file.read(reinterpret_cast<char*>(file_buf.data()), file_buf.size())) {
+		return {};
+	}
+
+	// toxHash does not touch the tox instance
+	return _t.toxHash(file_buf);
+}
+
+void ToxAvatarManager::loadHashCache(void) {
+	std::ifstream file(std::filesystem::u8path(_hash_cache_path));
+	if (!file.is_open()) {
+		return; // first start
+	}
+
+	// one entry per line: <file_size> <mtime> <hex file id> <file path>
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream ss(line);
+		HashCacheEntry entry;
+		std::string file_id_hex;
+		std::string file_path;
+		if (!(ss >> entry.file_size >> entry.mtime >> file_id_hex)) {
+			continue;
+		}
+		ss.ignore(1);
+		if (!std::getline(ss, file_path) || file_path.empty()) {
+			continue;
+		}
+		entry.file_id = hex2bin(file_id_hex);
+		_hash_cache[file_path] = std::move(entry);
+	}
+
+	std::cout << "TAM: loaded " << _hash_cache.size() << " avatar hash cache entries\n";
+}
+
+void ToxAvatarManager::saveHashCache(void) {
+	const auto tmp_path = std::filesystem::u8path(_hash_cache_path + ".tmp");
+	{
+		std::ofstream file(tmp_path, std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "TAM error: failed to write avatar hash cache\n";
+			return;
+		}
+
+		for (const auto& [file_path, entry] : _hash_cache) {
+			file << entry.file_size << " " << entry.mtime << " " << bin2hex(entry.file_id) << " " << file_path << "\n";
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmp_path, std::filesystem::u8path(_hash_cache_path), ec);
+	if (ec) {
+		std::cerr << "TAM error: failed to replace avatar hash cache: " << ec.message() << "\n";
+	}
+}
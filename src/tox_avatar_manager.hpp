@@ -3,17 +3,23 @@
 #include <solanaceae/object_store/object_store.hpp>
 #include <solanaceae/contact/fwd.hpp>
 #include <solanaceae/toxcore/tox_interface.hpp>
+#include <solanaceae/toxcore/tox_key.hpp>
 
 #include "./backends/std_fs.hpp"
 
 #include <string>
 #include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
 
 
 // RIP fishy c=<
 
 struct ConfigModelI;
-struct ToxKey;
 
 class ToxAvatarManager : public ObjectStoreEventI {
 	ObjectStore2& _os;
@@ -30,6 +36,54 @@ class ToxAvatarManager : public ObjectStoreEventI {
 	};
 	std::vector<AcceptEntry> _accept_queue;
 
+	// all filesystem work (discovery, hashing, removal) happens on the worker.
+	// jobs are processed in order, so a remove always lands before a later accept.
+	struct WorkerJob {
+		enum class Type {
+			discover, // stat and hash existing avatar file
+			remove, // delete file
+			replace, // delete file, then accept the transfer (result)
+			remember, // put the (complete) file into the hash cache
+		} type;
+
+		std::string file_path;
+		Contact4 c {entt::null};
+		ToxKey key {};
+		ObjectHandle o {};
+	};
+	struct WorkerResult {
+		WorkerJob::Type type;
+
+		std::string file_path;
+		Contact4 c {entt::null};
+		ToxKey key {};
+		ObjectHandle o {};
+
+		bool exists {false};
+		uint64_t file_size {0};
+		std::vector<uint8_t> file_id {}; // empty on read error
+	};
+
+	// persisted next to the avatars, full file path -> stat + hash
+	struct HashCacheEntry {
+		uint64_t file_size {0};
+		int64_t mtime {0};
+		std::vector<uint8_t> file_id;
+	};
+	std::map<std::string, HashCacheEntry> _hash_cache; // worker only
+	std::string _hash_cache_path;
+	bool _hash_cache_dirty {false}; // worker only
+
+	std::thread _worker;
+	std::atomic_bool _worker_stop {false};
+
+	std::mutex _jobs_mutex;
+	std::condition_variable _jobs_cv;
+	std::vector<WorkerJob> _jobs;
+
+	std::mutex _results_mutex;
+	std::vector<WorkerResult> _results;
+
 	public:
 		ToxAvatarManager(
 			ObjectStore2& os,
@@ -38,16 +92,25 @@ class ToxAvatarManager : public ObjectStoreEventI {
 			ToxI& t
 		);
 
+		~ToxAvatarManager(void);
+
 		void iterate(void);
 
 	protected:
 		// TODO: become backend and work in objects instead
 		std::string getAvatarPath(const ToxKey& key) const;
 		std::string getAvatarFileName(const ToxKey& key) const;
-		void addAvatarFileToContact(const Contact4 c, const ToxKey& key);
+		void addAvatarFileToContact(const Contact4 c, const ToxKey& key, const WorkerResult& res);
 		void clearAvatarFromContact(const Contact4 c);
 		void checkObj(ObjectHandle o);
 
+		void queueJob(WorkerJob&& job);
+		void workerRun(void);
+		WorkerResult workerDo(const WorkerJob& job);
+		std::vector<uint8_t> hashFile(const std::string& file_path, uint64_t file_size);
+		void loadHashCache(void);
+		void saveHashCache(void);
+
 	protected: // os
 		// on new obj, check for ToxTransferFriend and emplace own contact tracker
 		bool onEvent(const ObjectStore::Events::ObjectConstruct& e) override;
@@ -1,5 +1,7 @@
 #include "./tox_client.hpp"
 
+#include "./trace.hpp"
+
 // meh, change this
 #include <tox/tox_private.h>
 #include <tox/toxencryptsave.h>
@@ -12,6 +14,7 @@
 #include <filesystem>
 #include <string>
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 
 static void eee(std::string& mod) {
@@ -20,6 +23,99 @@ static void eee(std::string& mod) {
 	}
 }
 
+// journal file: magic, sha256 of the profile file it belongs to, then entries of [u32 le size][(encrypted) savedata journal entry]
+static constexpr std::array<uint8_t, 4> g_journal_magic {'t', 'x', 'j', '1'};
+
+// compact into a full save when the journal gets larger than this, or half the profile
+static constexpr size_t g_journal_max_size {64*1024};
+static constexpr size_t g_journal_max_entries {256};
+
+static std::array<uint8_t, crypto_hash_sha256_BYTES> hash_profile(const std::vector<uint8_t>& data) {
+	std::array<uint8_t, crypto_hash_sha256_BYTES> hash;
+	crypto_hash_sha256(hash.data(), data.data(), data.size());
+	return hash;
+}
+
+// appends the journal entries that belong to the profile with base_hash to profile_data
+// stops at the first incomplete entry, eg. from a crash while appending
+static size_t load_journal(const std::string& path, const std::array<uint8_t, 32>& base_hash, std::string_view password, std::vector<uint8_t>& profile_data) {
+	std::ifstream ifile{path, std::ios::binary};
+	if (!ifile.is_open()) {
+		return 0;
+	}
+
+	std::vector<uint8_t> journal{std::istreambuf_iterator<char>{ifile}, std::istreambuf_iterator<char>{}};
+
+	const size_t header_size = g_journal_magic.size() + base_hash.size();
+	if (
+		journal.size() < header_size ||
+		!std::equal(g_journal_magic.cbegin(), g_journal_magic.cend(), journal.cbegin()) ||
+		!std::equal(base_hash.cbegin(), base_hash.cend(), journal.cbegin() + g_journal_magic.size())
+	) {
+		std::cerr << "TOX ignoring journal, it does not belong to the profile\n";
+		return 0;
+	}
+
+	std::unique_ptr<Tox_Pass_Key, decltype(&tox_pass_key_free)> key {nullptr, &tox_pass_key_free};
+
+	size_t entries = 0;
+	size_t pos = header_size;
+	while (journal.size() - pos >= sizeof(uint32_t)) {
+		const uint32_t entry_size =
+			uint32_t(journal[pos]) |
+			uint32_t(journal[pos+1]) << 8 |
+			uint32_t(journal[pos+2]) << 16 |
+			uint32_t(journal[pos+3]) << 24
+		;
+		pos += sizeof(uint32_t);
+
+		if (journal.size() - pos < entry_size) {
+			std::cerr << "TOX ignoring incomplete journal entry\n";
+			break;
+		}
+
+		const uint8_t* entry = journal.data() + pos;
+		pos += entry_size;
+
+		if (password.empty()) {
+			profile_data.insert(profile_data.end(), entry, entry + entry_size);
+		} else {
+			if (entry_size <= TOX_PASS_ENCRYPTION_EXTRA_LENGTH) {
+				std::cerr << "TOX ignoring broken journal entry\n";
+				break;
+			}
+
+			if (!key) {
+				uint8_t salt[TOX_PASS_SALT_LENGTH];
+				if (!tox_get_salt(entry, salt, nullptr)) {
+					std::cerr << "TOX ignoring broken journal entry\n";
+					break;
+				}
+				key.reset(tox_pass_key_derive_with_salt(
+					reinterpret_cast<const uint8_t*>(password.data()), password.size(),
+					salt,
+					nullptr
+				));
+				if (!key) {
+					break;
+				}
+			}
+
+			const size_t offset = profile_data.size();
+			profile_data.resize(offset + entry_size - TOX_PASS_ENCRYPTION_EXTRA_LENGTH);
+			if (!tox_pass_key_decrypt(key.get(), entry, entry_size, profile_data.data() + offset, nullptr)) {
+				profile_data.resize(offset);
+				std::cerr << "TOX ignoring journal entry that fails to decrypt\n";
+				break;
+			}
+		}
+
+		entries++;
+	}
+
+	return entries;
+}
+
 ToxClient::ToxClient(ConfigModelI& conf, std::string_view save_path, std::string_view save_password, std::string_view new_username) :
 	_tox_profile_path(save_path), _tox_profile_password(save_password)
 {
@@ -47,6 +143,8 @@ ToxClient::ToxClient(ConfigModelI& conf, std::string_view save_path, std::string
 			if (profile_data.empty()) {
 				std::cerr << "empty tox save\n";
 			} else {
+				const auto profile_hash = hash_profile(profile_data);
+
 				// set options
 				if (!save_password.empty()) {
 					std::vector<uint8_t> encrypted_copy(profile_data.begin(), profile_data.end());
@@ -61,6 +159,13 @@ ToxClient::ToxClient(ConfigModelI& conf, std::string_view save_path, std::string
 						throw std::runtime_error("failed to decrypt save file!");
 					}
 				}
+
+				// the first save is a full one, which compacts the journal
+				const auto journal_entries = load_journal(journalPath(), profile_hash, save_password, profile_data);
+				if (journal_entries > 0) {
+					std::cout << "TOX loaded " << journal_entries << " journal entries\n";
+				}
+
 				tox_options_set_savedata_type(options.get(), TOX_SAVEDATA_TYPE_TOX_SAVE);
 				tox_options_set_savedata_data(options.get(), profile_data.data(), profile_data.size());
 			}
@@ -148,6 +253,7 @@ ToxClient::~ToxClient(void) {
 		saveToxProfile();
 	}
 	tox_kill(_tox);
+	tox_pass_key_free(_journal_pass_key);
 }
 
 bool ToxClient::iterate(float time_delta) {
@@ -214,15 +320,105 @@ void ToxClient::subscribeRaw(std::function<void(const Tox_Events*)> fn) {
 	_subscriber_raw = fn;
 }
 
+bool ToxClient::appendToxProfileJournal(void) {
+	if (!_journal_base_valid) {
+		return false;
+	}
+
+	if (
+		_journal_entries >= g_journal_max_entries ||
+		_journal_size > std::max(g_journal_max_size, _journal_base_size/2)
+	) {
+		return false;
+	}
+
+	std::vector<uint8_t> entry(tox_get_savedata_journal_size(_tox));
+	if (entry.empty()) {
+		// nothing we save changed (eg. only dht nodes)
+		_tox_profile_dirty = false;
+		_save_heat = 10.f;
+		return true;
+	}
+	entry.resize(tox_get_savedata_journal(_tox, entry.data(), entry.size()));
+	if (entry.empty()) {
+		return false;
+	}
+
+	if (!_tox_profile_password.empty()) {
+		if (_journal_pass_key == nullptr) {
+			eee(_tox_profile_password);
+			_journal_pass_key = tox_pass_key_derive(
+				reinterpret_cast<const uint8_t*>(_tox_profile_password.data()), _tox_profile_password.size(),
+				nullptr
+			);
+			eee(_tox_profile_password);
+			if (_journal_pass_key == nullptr) {
+				return false;
+			}
+		}
+
+		std::vector<uint8_t> unencrypted_copy(entry.begin(), entry.end());
+		entry.resize(unencrypted_copy.size() + TOX_PASS_ENCRYPTION_EXTRA_LENGTH);
+		if (!tox_pass_key_encrypt(_journal_pass_key, unencrypted_copy.data(), unencrypted_copy.size(), entry.data(), nullptr)) {
+			return false;
+		}
+	}
+
+	const bool new_journal = _journal_entries == 0;
+	try {
+		std::ofstream ofile{journalPath(), std::ios::binary | (new_journal ? std::ios::trunc : std::ios::app)};
+		if (new_journal) {
+			ofile.write(reinterpret_cast<const char*>(g_journal_magic.data()), g_journal_magic.size());
+			ofile.write(reinterpret_cast<const char*>(_journal_base_hash.data()), _journal_base_hash.size());
+		}
+
+		const uint32_t entry_size = entry.size();
+		const uint8_t size_le[sizeof(uint32_t)] {
+			uint8_t(entry_size & 0xff),
+			uint8_t((entry_size >> 8) & 0xff),
+			uint8_t((entry_size >> 16) & 0xff),
+			uint8_t((entry_size >> 24) & 0xff),
+		};
+		ofile.write(reinterpret_cast<const char*>(size_le), sizeof(size_le));
+		ofile.write(reinterpret_cast<const char*>(entry.data()), entry.size());
+		ofile.flush();
+
+		if (!ofile.good()) {
+			throw std::runtime_error("write error");
+		}
+	} catch (...) {
+		// the changes are gone from the journal, only a full save has them now
+		std::cerr << "TOX appending to journal failed!\n";
+		return false;
+	}
+
+	_journal_size += sizeof(uint32_t) + entry.size();
+	_journal_entries++;
+
+	_tox_profile_dirty = false;
+	_save_heat = 10.f;
+
+	return true;
+}
+
 void ToxClient::saveToxProfile(void) {
 	if (_tox_profile_path.empty()) {
 		return;
 	}
+
+	TRACE_ZONE("save");
+
+	if (appendToxProfileJournal()) {
+		return;
+	}
+
 	std::cout << "TOX saving\n";
 
 	std::vector<uint8_t> data{};
 	data.resize(tox_get_savedata_size(_tox));
 	tox_get_savedata(_tox, data.data());
+	tox_savedata_journal_reset(_tox);
+	_journal_base_valid = false;
 
 	if (!_tox_profile_password.empty()) {
 		std::vector<uint8_t> unencrypted_copy(data.begin(), data.end());
@@ -273,6 +469,16 @@ void ToxClient::saveToxProfile(void) {
 		_tox_profile_path
 	);
 
+	// a leftover journal does not match the new profile's hash and is ignored on load
+	std::error_code ec;
+	std::filesystem::remove(journalPath(), ec);
+
+	_journal_base_valid = true;
+	_journal_base_hash = hash_profile(data);
+	_journal_base_size = data.size();
+	_journal_size = 0;
+	_journal_entries = 0;
+
 	_tox_profile_dirty = false;
 	_save_heat = 10.f;
 }
@@ -6,11 +6,13 @@
 #include <solanaceae/toxcore/tox_event_interface.hpp>
 #include <solanaceae/toxcore/tox_event_provider_base.hpp>
 
+#include <array>
 #include <string>
 #include <string_view>
 #include <functional>
 
 struct ToxEventI;
+struct Tox_Pass_Key;
 
 class ToxClient : public ToxDefaultImpl, public ToxEventProviderBase {
 	private:
@@ -26,6 +28,14 @@ class ToxClient : public ToxDefaultImpl, public ToxEventProviderBase {
 		bool _tox_profile_dirty {true}; // set in callbacks
 		float _save_heat {0.f};
 
+		// between full saves, only what changed gets appended to a journal next to the profile
+		bool _journal_base_valid {false}; // the profile on disk was written by us
+		std::array<uint8_t, 32> _journal_base_hash {}; // sha256 of the profile file the journal belongs to
+		size_t _journal_base_size {0};
+		size_t _journal_size {0};
+		size_t _journal_entries {0};
+		Tox_Pass_Key* _journal_pass_key {nullptr}; // derived once, a full derivation per entry would defeat the point
+
 	public:
 		ToxClient(ConfigModelI& conf, std::string_view save_path, std::string_view save_password, std::string_view new_username);
 		~ToxClient(void);
@@ -49,6 +59,9 @@ class ToxClient : public ToxDefaultImpl, public ToxEventProviderBase {
 		void subscribeRaw(std::function<void(const Tox_Events*)> fn);
 
 	private:
+		std::string journalPath(void) const { return _tox_profile_path + ".journal"; }
+		// returns false if a full save is needed instead
+		bool appendToxProfileJournal(void);
 		void saveToxProfile(void);
 };
 
@@ -394,6 +394,9 @@ float ToxNetprofUI::render(float time_delta) {
 	if (_show_window_table) {
 		return 0.1f; // min 10fps
 	}
-	return 2.f;
+	if (_show_window_graph) {
+		return 2.f;
+	}
+	return 1000.f; // nothing open
 }
 
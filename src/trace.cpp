@@ -0,0 +1,152 @@
+#include "./trace.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+namespace detail {
+	std::atomic_bool g_enabled {false};
+} // detail
+
+namespace {
+
+struct Event {
+	const char* name {nullptr};
+	int64_t start_us {0};
+	int64_t dur_us {0};
+};
+
+// only its own thread writes, dump() reads
+struct ThreadBuffer {
+	// ~1.5MiB, the oldest events get overwritten
+	static constexpr uint64_t capacity {1u << 16};
+	// the thread can keep writing during a dump, so we skip the oldest slots
+	static constexpr uint64_t dump_margin {4096};
+
+	uint32_t tid {0};
+	std::atomic<const char*> name {nullptr};
+
+	// allocated before the first event is published
+	std::unique_ptr<Event[]> events;
+	std::atomic_uint64_t written {0};
+};
+
+std::mutex g_buffers_mutex; // registration and dump only
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+
+std::atomic_int64_t g_enabled_since_us {0};
+
+ThreadBuffer& threadBuffer(void) {
+	// shared, so the events survive the thread
+	thread_local const std::shared_ptr<ThreadBuffer> tb = [](void) {
+		auto new_tb = std::make_shared<ThreadBuffer>();
+
+		std::lock_guard lg{g_buffers_mutex};
+		new_tb->tid = static_cast<uint32_t>(g_buffers.size() + 1);
+		g_buffers.push_back(new_tb);
+
+		return new_tb;
+	}();
+
+	return *tb;
+}
+
+void writeEscaped(std::ostream& out, const char* str) {
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\') {
+			out << '\\';
+		}
+		out << *str;
+	}
+}
+
+} // anon
+
+int64_t detail::nowUS(void) {
+	static const auto epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void detail::record(const char* name, int64_t start_us, int64_t end_us) {
+	auto& tb = threadBuffer();
+	if (!tb.events) {
+		tb.events.reset(new Event[ThreadBuffer::capacity]);
+	}
+
+	const uint64_t i = tb.written.load(std::memory_order_relaxed);
+	tb.events[i % ThreadBuffer::capacity] = {name, start_us, end_us - start_us};
+	tb.written.store(i + 1, std::memory_order_release);
+}
+
+void setEnabled(bool enabled) {
+	if (enabled && !detail::g_enabled) {
+		g_enabled_since_us = detail::nowUS();
+	}
+	detail::g_enabled = enabled;
+}
+
+void setThreadName(const char* name) {
+	threadBuffer().name = name;
+}
+
+bool dump(const std::string& file_path) {
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	{
+		std::lock_guard lg{g_buffers_mutex};
+		buffers = g_buffers;
+	}
+
+	std::ofstream file(file_path);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	const int64_t since_us = g_enabled_since_us;
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first {true};
+	const auto separator = [&](void) {
+		if (!first) {
+			file << ",\n";
+		}
+		first = false;
+	};
+
+	for (const auto& tb : buffers) {
+		if (const char* name = tb->name.load(); name != nullptr) {
+			separator();
+			file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tb->tid << ",\"args\":{\"name\":\"";
+			writeEscaped(file, name);
+			file << "\"}}";
+		}
+
+		const uint64_t written = tb->written.load(std::memory_order_acquire);
+		if (written == 0) {
+			continue;
+		}
+
+		constexpr uint64_t readable = ThreadBuffer::capacity - ThreadBuffer::dump_margin;
+		for (uint64_t i = written > readable ? written - readable : 0; i < written; i++) {
+			const Event& event = tb->events[i % ThreadBuffer::capacity];
+			if (event.start_us < since_us) {
+				continue;
+			}
+
+			separator();
+			file << "{\"name\":\"";
+			writeEscaped(file, event.name);
+			file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tb->tid << ",\"ts\":" << event.start_us << ",\"dur\":" << event.dur_us << "}";
+		}
+	}
+
+	file << "\n]}\n";
+
+	return file.good();
+}
+
+} // Trace
+
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+// scoped zones, recorded into a buffer per thread and
+// dumped as chrome trace event json (ui.perfetto.dev, chrome://tracing).
+// always compiled in, a zone costs an atomic load while not recording.
+namespace Trace {
+
+	namespace detail {
+		extern std::atomic_bool g_enabled;
+
+		int64_t nowUS(void);
+		void record(const char* name, int64_t start_us, int64_t end_us);
+	} // detail
+
+	inline bool enabled(void) {
+		return detail::g_enabled.load(std::memory_order_relaxed);
+	}
+
+	// enabling drops everything recorded before
+	void setEnabled(bool enabled);
+
+	// call from the thread itself, name needs to outlive the dump (eg a literal)
+	void setThreadName(const char* name);
+
+	// writes the events recorded since enabling. can be called while recording
+	bool dump(const std::string& file_path);
+
+	struct Zone final {
+		const char* _name; // literal
+		int64_t _start_us {-1};
+
+		explicit Zone(const char* name) : _name(name) {
+			if (enabled()) {
+				_start_us = detail::nowUS();
+			}
+		}
+
+		~Zone(void) {
+			if (_start_us >= 0) {
+				detail::record(_name, _start_us, detail::nowUS());
+			}
+		}
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+	};
+
+} // Trace
+
+#define TRACE_ZONE_CONCAT_(a, b) a##b
+#define TRACE_ZONE_CONCAT(a, b) TRACE_ZONE_CONCAT_(a, b)
+// name has to be a string literal
+#define TRACE_ZONE(name) const ::Trace::Zone TRACE_ZONE_CONCAT(trace_zone_, __COUNTER__){name}
+
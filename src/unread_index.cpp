@@ -0,0 +1,126 @@
+#include "./unread_index.hpp"
+
+#include <solanaceae/message3/components.hpp>
+
+#include <cassert>
+
+struct UnreadIndex::RegistryGuard {
+	UnreadIndex* ui {nullptr};
+	Message3Registry* reg {nullptr};
+
+	RegistryGuard(UnreadIndex* ui_, Message3Registry* reg_) : ui(ui_), reg(reg_) {}
+	RegistryGuard(RegistryGuard&& other) noexcept : ui(other.ui), reg(other.reg) { other.ui = nullptr; }
+	RegistryGuard(const RegistryGuard&) = delete;
+	RegistryGuard& operator=(const RegistryGuard&) = delete;
+	RegistryGuard& operator=(RegistryGuard&&) = delete;
+
+	~RegistryGuard(void) {
+		if (ui != nullptr) {
+			ui->unhook(reg);
+		}
+	}
+};
+
+UnreadIndex::Entry& UnreadIndex::hook(Message3Registry& reg, Contact4 c) {
+	if (auto it = _entries.find(&reg); it != _entries.end()) {
+		return it->second;
+	}
+
+	auto& entry = _entries[&reg];
+	entry.c = c;
+
+	// already tagged before we started listening
+	entry.count = reg.storage<Message::Components::TagUnread>().size();
+	_total += entry.count;
+
+	reg.on_construct<Message::Components::TagUnread>().connect<&UnreadIndex::onUnreadConstruct>(*this);
+	reg.on_destroy<Message::Components::TagUnread>().connect<&UnreadIndex::onUnreadDestroy>(*this);
+
+	// the address might get reused by a new registry
+	reg.ctx().emplace<RegistryGuard>(this, &reg);
+
+	return entry;
+}
+
+void UnreadIndex::unhook(Message3Registry* reg) {
+	// called while the registry is being destroyed, so dont touch it
+	auto it = _entries.find(reg);
+	if (it == _entries.end()) {
+		return;
+	}
+
+	assert(_total >= it->second.count);
+	_total -= it->second.count;
+	_entries.erase(it);
+}
+
+void UnreadIndex::onUnreadConstruct(Message3Registry& reg, Message3) {
+	auto it = _entries.find(&reg);
+	assert(it != _entries.end());
+	it->second.count++;
+	_total++;
+}
+
+void UnreadIndex::onUnreadDestroy(Message3Registry& reg, Message3) {
+	auto it = _entries.find(&reg);
+	assert(it != _entries.end());
+	assert(it->second.count > 0);
+	it->second.count--;
+	_total--;
+}
+
+UnreadIndex::UnreadIndex(RegistryMessageModelI& rmm) : _rmm(rmm), _rmm_sr(_rmm.newSubRef(this)) {
+	_rmm_sr
+		.subscribe(RegistryMessageModel_Event::message_construct)
+	;
+}
+
+UnreadIndex::~UnreadIndex(void) {
+	// entries only exist for live registries, the guard removes them
+	for (auto& [reg, entry] : _entries) {
+		reg->on_construct<Message::Components::TagUnread>().disconnect(this);
+		reg->on_destroy<Message::Components::TagUnread>().disconnect(this);
+
+		if (reg->ctx().contains<RegistryGuard>()) {
+			reg->ctx().get<RegistryGuard>().ui = nullptr;
+			reg->ctx().erase<RegistryGuard>();
+		}
+	}
+}
+
+size_t UnreadIndex::count(Contact4 c) {
+	auto* reg = _rmm.get(c);
+	if (reg == nullptr) {
+		return 0;
+	}
+
+	if (auto it = _entries.find(reg); it != _entries.end()) {
+		return it->second.count;
+	}
+
+	return hook(*reg, c).count;
+}
+
+bool UnreadIndex::onEvent(const Message::Events::MessageConstruct& e) {
+	auto* reg = e.e.registry();
+	if (reg == nullptr || _entries.contains(reg)) {
+		return false;
+	}
+
+	// find the contact owning this registry
+	// (for groups, peers are resolved up to the group by the rmm)
+	Contact4 c {entt::null};
+	if (const auto* c_to = e.e.try_get<Message::Components::ContactTo>(); c_to != nullptr && _rmm.get(c_to->c) == reg) {
+		c = c_to->c;
+	} else if (const auto* c_from = e.e.try_get<Message::Components::ContactFrom>(); c_from != nullptr && _rmm.get(c_from->c) == reg) {
+		c = c_from->c;
+	} else {
+		// unattributable, gets hooked on first count() instead
+		return false;
+	}
+
+	hook(*reg, c);
+
+	return false;
+}
+
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <solanaceae/message3/registry_message_model.hpp>
+
+#include <entt/container/dense_map.hpp>
+
+#include <cstddef>
+
+// keeps the number of unread (TagUnread) messages per message registry and in total.
+// counts follow the TagUnread storage signals, so reading them is O(1)
+// and they stay correct no matter who adds or removes the tag.
+class UnreadIndex : public RegistryMessageModelEventI {
+	RegistryMessageModelI& _rmm;
+	RegistryMessageModelI::SubscriptionReference _rmm_sr;
+
+	struct Entry {
+		Contact4 c; // owner of the registry
+		size_t count {0};
+	};
+	entt::dense_map<Message3Registry*, Entry> _entries;
+	size_t _total {0};
+
+	// put into the registry context, drops the entry when the registry is destroyed
+	struct RegistryGuard;
+
+	Entry& hook(Message3Registry& reg, Contact4 c);
+	void unhook(Message3Registry* reg);
+
+	void onUnreadConstruct(Message3Registry& reg, Message3 e);
+	void onUnreadDestroy(Message3Registry& reg, Message3 e);
+
+	public:
+		UnreadIndex(RegistryMessageModelI& rmm);
+		~UnreadIndex(void);
+
+		// unread messages in the contacts (message registry)
+		size_t count(Contact4 c);
+		bool hasUnread(Contact4 c) { return count(c) > 0; }
+
+		// unread messages over all contacts
+		size_t total(void) const { return _total; }
+
+	protected: // rmm
+		bool onEvent(const Message::Events::MessageConstruct& e) override;
+};
+